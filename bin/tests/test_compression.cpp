@@ -0,0 +1,160 @@
+/*************************************************************************/
+/*  test_compression.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_compression.h"
+#include "io/compression.h"
+#include "io/file_access_compressed.h"
+#include "os/file_access.h"
+#include "math_funcs.h"
+#include "print_string.h"
+
+/* Round trips awkward inputs through the LZ4 codec and makes sure
+   corrupted or truncated data is reported instead of decoded. */
+
+namespace TestCompression {
+
+static void _check(const String& p_what,bool p_ok) {
+
+	print_line(p_what+": "+(p_ok?"yes":"NO"));
+}
+
+static Vector<uint8_t> _compress(const Vector<uint8_t>& p_src) {
+
+	Vector<uint8_t> dst;
+	dst.resize(Compression::get_max_compressed_buffer_size(p_src.size(),Compression::MODE_LZ4));
+	int size=Compression::compress(dst.ptr(),p_src.ptr(),p_src.size(),Compression::MODE_LZ4);
+	dst.resize(MAX(size,0));
+	return dst;
+}
+
+static bool _round_trip(const Vector<uint8_t>& p_src) {
+
+	Vector<uint8_t> c=_compress(p_src);
+	Vector<uint8_t> d;
+	d.resize(p_src.size()+1); //never touched past the exact size
+	d[p_src.size()]=0xAA;
+
+	int size=Compression::decompress(d.ptr(),p_src.size(),c.ptr(),c.size(),Compression::MODE_LZ4);
+	if (size!=p_src.size() || d[p_src.size()]!=0xAA)
+		return false;
+	for(int i=0;i<p_src.size();i++) {
+		if (d[i]!=p_src[i])
+			return false;
+	}
+	return true;
+}
+
+MainLoop* test() {
+
+	Vector<uint8_t> data;
+	_check("empty",_round_trip(data));
+
+	data.resize(65536);
+	for(int i=0;i<data.size();i++)
+		data[i]=Math::rand()&0xFF;
+	_check("incompressible",_round_trip(data));
+
+	for(int i=0;i<data.size();i++)
+		data[i]=i%3;
+	_check("highly repetitive",_round_trip(data));
+	_check("repetitive data shrinks",_compress(data).size()<data.size()/50);
+
+	//a random run repeated far apart, matches longer than the 4 bit length and at long offsets
+	for(int i=0;i<data.size();i++)
+		data[i]= i<4000 ? Math::rand()&0xFF : data[i%4000];
+	_check("long matches",_round_trip(data));
+
+	for(int len=1;len<64;len++) {
+		data.resize(len);
+		for(int i=0;i<len;i++)
+			data[i]=(i&4)?'a':Math::rand()&3;
+		if (!_round_trip(data)) {
+			_check("short input of "+itos(len),false);
+			break;
+		}
+	}
+
+	//corrupted input fails instead of leaving garbage
+	data.resize(10000);
+	for(int i=0;i<data.size();i++)
+		data[i]=(i/50)&1?'x':Math::rand()&0xFF;
+	Vector<uint8_t> c=_compress(data);
+	Vector<uint8_t> d;
+	d.resize(data.size());
+
+	_check("truncated input fails",Compression::decompress(d.ptr(),d.size(),c.ptr(),c.size()/2,Compression::MODE_LZ4)<0);
+	_check("short output fails",Compression::decompress(d.ptr(),d.size()-1,c.ptr(),c.size(),Compression::MODE_LZ4)<0);
+	Vector<uint8_t> longer;
+	longer.resize(d.size()+100);
+	_check("longer output expected fails",Compression::decompress(longer.ptr(),longer.size(),c.ptr(),c.size(),Compression::MODE_LZ4)<0);
+
+	bool all_caught=true;
+	for(int i=0;i<c.size();i+=7) {
+		Vector<uint8_t> bad=c;
+		bad[i]^=0xFF;
+		int size=Compression::decompress(d.ptr(),d.size(),bad.ptr(),bad.size(),Compression::MODE_LZ4);
+		if (size>=0 && size!=d.size())
+			all_caught=false; //a flipped literal may still decode to the right size
+	}
+	_check("flipped bytes never overrun",all_caught);
+
+	//compressed files with a broken header are not opened
+	Vector<uint8_t> file;
+	FileAccessCompressed::compress_buffer(data.ptr(),data.size(),file,"GCMP",Compression::MODE_LZ4,4096);
+	String path="user://test_compression.gcmp";
+	FileAccess *f=FileAccess::open(path,FileAccess::WRITE);
+	f->store_buffer(file.ptr(),file.size());
+	memdelete(f);
+
+	FileAccessCompressed *fc=memnew( FileAccessCompressed );
+	fc->configure("GCMP",Compression::MODE_LZ4,4096);
+	Vector<uint8_t> back;
+	back.resize(data.size());
+	bool ok=fc->_open(path,FileAccess::READ)==OK && fc->get_buffer(back.ptr(),back.size())==data.size();
+	memdelete(fc);
+	for(int i=0;ok && i<data.size();i++)
+		ok=back[i]==data[i];
+	_check("compressed file read back",ok);
+
+	file[8]=0xFF; //block size
+	file[9]=0xFF;
+	file[10]=0xFF;
+	file[11]=0x7F;
+	f=FileAccess::open(path,FileAccess::WRITE);
+	f->store_buffer(file.ptr(),file.size());
+	memdelete(f);
+
+	fc=memnew( FileAccessCompressed );
+	fc->configure("GCMP",Compression::MODE_LZ4,4096);
+	_check("corrupt header refused",fc->_open(path,FileAccess::READ)==ERR_FILE_CORRUPT);
+	memdelete(fc);
+
+	return NULL;
+}
+
+}
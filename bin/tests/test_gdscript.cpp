@@ -39,6 +39,7 @@
 #include "modules/gdscript/gd_parser.h"
 #include "modules/gdscript/gd_compiler.h"
 #include "modules/gdscript/gd_script.h"
+#include "modules/gdscript/gd_compiled_script.h"
 
 
 namespace TestGDScript {
@@ -531,6 +532,17 @@ static void _disassemble_class(const Ref<GDScript>& p_class,const Vector<String>
 					txt+=DADDR(3);
 					incr+=5;
 
+				} break;
+				case GDFunction::OPCODE_OPERATOR_VALIDATED: {
+
+					txt+="op-validated ";
+					txt+=DADDR(4);
+					txt+=" = ";
+					txt+=DADDR(2);
+					txt+=" #"+itos(code[ip+1])+" ";
+					txt+=DADDR(3);
+					incr+=5;
+
 				} break;
 				case GDFunction::OPCODE_SET: {
 
@@ -563,20 +575,22 @@ static void _disassemble_class(const Ref<GDScript>& p_class,const Vector<String>
 					txt+=func.get_global_name(code[ip+2]);
 					txt+="\"]=";
 					txt+=DADDR(3);
-					incr+=4;
+					txt+=" cache "+itos(code[ip+4]);
+					incr+=5;
 
 
 				} break;
 				case GDFunction::OPCODE_GET_NAMED: {
 
 					txt+=" get_named ";
-					txt+=DADDR(3);
+					txt+=DADDR(4);
 					txt+="=";
 					txt+=DADDR(1);
 					txt+="[\"";
 					txt+=func.get_global_name(code[ip+2]);
 					txt+="\"]";
-					incr+=4;
+					txt+=" cache "+itos(code[ip+3]);
+					incr+=5;
 
 				} break;
 				case GDFunction::OPCODE_ASSIGN: {
@@ -604,6 +618,24 @@ static void _disassemble_class(const Ref<GDScript>& p_class,const Vector<String>
 					txt+="= false";
 					incr+=2;
 
+				} break;
+				case GDFunction::OPCODE_ASSIGN_TYPED_BUILTIN: {
+
+					txt+=" assign-typed ";
+					txt+=DADDR(2);
+					txt+=" ("+Variant::get_type_name(Variant::Type(code[ip+1]))+")=";
+					txt+=DADDR(3);
+					incr+=4;
+
+				} break;
+				case GDFunction::OPCODE_ASSIGN_TYPED_NATIVE: {
+
+					txt+=" assign-typed ";
+					txt+=DADDR(2);
+					txt+=" ("+String(func.get_global_name(code[ip+1]))+")=";
+					txt+=DADDR(3);
+					incr+=4;
+
 				} break;
 				case GDFunction::OPCODE_CONSTRUCT: {
 
@@ -678,13 +710,35 @@ static void _disassemble_class(const Ref<GDScript>& p_class,const Vector<String>
 
 					int argc=code[ip+1];
 					if (ret) {
-						txt+=DADDR(4+argc)+"=";
+						txt+=DADDR(5+argc)+"=";
 					}
 
 					txt+=DADDR(2)+".";
 					txt+=String(func.get_global_name(code[ip+3]));
 					txt+="(";
 
+					for(int i=0;i<argc;i++) {
+						if (i>0)
+							txt+=", ";
+						txt+=DADDR(5+i);
+					}
+					txt+=")";
+					txt+=" cache "+itos(code[ip+4]);
+
+
+					incr=6+argc;
+
+				} break;
+				case GDFunction::OPCODE_CALL_METHOD_BIND: {
+
+					txt+=" call-method-bind ";
+
+					int argc=code[ip+1];
+					txt+=DADDR(4+argc)+"=";
+					txt+=DADDR(2)+".";
+					txt+=String(func.get_method_bind(code[ip+3])->get_name());
+					txt+="(";
+
 					for(int i=0;i<argc;i++) {
 						if (i>0)
 							txt+=", ";
@@ -802,14 +856,33 @@ static void _disassemble_class(const Ref<GDScript>& p_class,const Vector<String>
 				} break;
 				case GDFunction::OPCODE_ITERATE_BEGIN: {
 
-					txt+=" for-init "+DADDR(4)+" in "+DADDR(2)+" counter "+DADDR(1)+" end "+itos(code[ip+3]);
-					incr+=5;
+					txt+=" for-init "+DADDR(4)+" in "+DADDR(2)+" counter "+DADDR(1)+" lock "+itos(code[ip+5])+" end "+itos(code[ip+3]);
+					incr+=6;
 
 				} break;
 				case GDFunction::OPCODE_ITERATE: {
 
-					txt+=" for-loop "+DADDR(4)+" in "+DADDR(2)+" counter "+DADDR(1)+" end "+itos(code[ip+3]);
-					incr+=5;
+					txt+=" for-loop "+DADDR(4)+" in "+DADDR(2)+" counter "+DADDR(1)+" lock "+itos(code[ip+5])+" end "+itos(code[ip+3]);
+					incr+=6;
+
+				} break;
+				case GDFunction::OPCODE_ITERATE_RANGE_BEGIN: {
+
+					int argc=code[ip+1];
+					txt+=" for-init "+DADDR(6+argc)+" in range(";
+					for(int i=0;i<argc;i++) {
+						if (i>0)
+							txt+=", ";
+						txt+=DADDR(5+i);
+					}
+					txt+=") counter "+DADDR(2)+" end "+itos(code[ip+5+argc]);
+					incr+=7+argc;
+
+				} break;
+				case GDFunction::OPCODE_ITERATE_RANGE: {
+
+					txt+=" for-loop "+DADDR(5)+" in range counter "+DADDR(1)+" to "+DADDR(2)+" step "+DADDR(3)+" end "+itos(code[ip+4]);
+					incr+=6;
 
 				} break;
 				case GDFunction::OPCODE_LINE: {
@@ -976,6 +1049,7 @@ MainLoop* test(TestType p_test) {
 
 		}
 
+		print_line("Bytecode size: "+itos(gdc.get_code_size_before())+" -> "+itos(gdc.get_code_size_after())+" words.");
 
 		Ref<GDScript> gds =Ref<GDScript>( script );
 
@@ -995,6 +1069,19 @@ MainLoop* test(TestType p_test) {
 	} else if (p_test==TEST_BYTECODE) {
 
 		Vector<uint8_t> buf = GDTokenizerBuffer::parse_code_string(code);
+
+		Ref<GDScript> script = memnew( GDScript );
+		script->set_source_code(code);
+		script->set_script_path(test);
+		if (script->reload()==OK) {
+
+			Vector<uint8_t> compiled = GDCompiledScript::save(script,buf);
+			if (!compiled.empty()) {
+				print_line("Compiled script: "+itos(compiled.size())+" bytes, tokens: "+itos(buf.size())+" bytes.");
+				buf=compiled;
+			}
+		}
+
 		String dst = test.basename()+".gdc";
 		FileAccess *fw = FileAccess::open(dst,FileAccess::WRITE);
 		fw->store_buffer(buf.ptr(),buf.size());
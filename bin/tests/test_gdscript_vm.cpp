@@ -0,0 +1,223 @@
+/*************************************************************************/
+/*  test_gdscript_vm.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_gdscript_vm.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#endif
+
+namespace TestGDScriptVM {
+
+#ifdef GDSCRIPT_ENABLED
+
+enum {
+	ITERATIONS=1000000,
+	RUNS=3
+};
+
+/* Small scripts that stress the interpreter loop itself rather than
+   the builtin types: branching, local arithmetic, calls and member access.
+   The typed_ variants show what static types save over the untyped ones,
+   named goes through member access and calls on another instance,
+   packed walks an IntArray and coroutines keeps many functions
+   suspended, resuming each of them in turn. */
+
+static const char *_bench_script=
+"extends Reference\n"
+"\n"
+"var value = 0\n"
+"\n"
+"static func loop(n):\n"
+"\tvar i = 0\n"
+"\twhile(i < n):\n"
+"\t\ti += 1\n"
+"\treturn i\n"
+"\n"
+"static func branch(n):\n"
+"\tvar a = 0\n"
+"\tfor i in range(n):\n"
+"\t\tif (i & 1):\n"
+"\t\t\ta += 1\n"
+"\t\telif (i & 2):\n"
+"\t\t\ta -= 1\n"
+"\t\telse:\n"
+"\t\t\ta += 2\n"
+"\treturn a\n"
+"\n"
+"static func arithmetic(n):\n"
+"\tvar a = 0\n"
+"\tvar b = 1.0\n"
+"\tfor i in range(n):\n"
+"\t\ta = (a + i * 3 - 1) % 1000\n"
+"\t\tb = b * 0.5 + i\n"
+"\treturn a + b\n"
+"\n"
+"static func typed_loop(n : int) -> int:\n"
+"\tvar i : int = 0\n"
+"\twhile(i < n):\n"
+"\t\ti += 1\n"
+"\treturn i\n"
+"\n"
+"static func typed_arithmetic(n : int) -> float:\n"
+"\tvar a : int = 0\n"
+"\tvar b : float = 1.0\n"
+"\tvar i : int = 0\n"
+"\twhile(i < n):\n"
+"\t\ta = (a + i * 3 - 1) % 1000\n"
+"\t\tb = b * 0.5 + i\n"
+"\t\ti += 1\n"
+"\treturn a + b\n"
+"\n"
+"static func packed(n):\n"
+"\tvar arr = IntArray()\n"
+"\tarr.resize(n)\n"
+"\tvar a = 0\n"
+"\tfor x in arr:\n"
+"\t\ta += 1\n"
+"\treturn a\n"
+"\n"
+"static func _add(a,b):\n"
+"\treturn a + b\n"
+"\n"
+"static func calls(n):\n"
+"\tvar a = 0\n"
+"\tfor i in range(n):\n"
+"\t\ta = _add(a,1)\n"
+"\treturn a\n"
+"\n"
+"static func named(n):\n"
+"\tvar o = new()\n"
+"\tfor i in range(n):\n"
+"\t\to.value = o.value + 1\n"
+"\t\to._inc()\n"
+"\treturn o.value\n"
+"\n"
+"static func _co(n):\n"
+"\tvar a = 0\n"
+"\tfor i in range(n):\n"
+"\t\ta += i\n"
+"\t\tyield()\n"
+"\treturn a\n"
+"\n"
+"static func coroutines(n):\n"
+"\tvar states = []\n"
+"\tfor i in range(1000):\n"
+"\t\tstates.append(_co(n / 1000))\n"
+"\tvar running = true\n"
+"\twhile(running):\n"
+"\t\trunning = false\n"
+"\t\tfor i in range(states.size()):\n"
+"\t\t\tif (typeof(states[i]) == TYPE_OBJECT):\n"
+"\t\t\t\tstates[i] = states[i].resume()\n"
+"\t\t\t\trunning = true\n"
+"\treturn states.size()\n"
+"\n"
+"func _inc():\n"
+"\tvalue += 1\n"
+"\n"
+"func members(n):\n"
+"\tvalue = 0\n"
+"\tfor i in range(n):\n"
+"\t\t_inc()\n"
+"\t\tvalue = value + 1\n"
+"\treturn value\n";
+
+static void _bench_func(Object *p_obj,const StringName& p_func) {
+
+	Variant arg=ITERATIONS;
+	const Variant *argp[]={&arg};
+	Variant::CallError ce;
+	uint64_t best=0;
+
+	for(int i=0;i<RUNS;i++) {
+
+		uint64_t from=OS::get_singleton()->get_ticks_usec();
+		p_obj->call(p_func,argp,1,ce);
+		uint64_t usec=OS::get_singleton()->get_ticks_usec()-from;
+
+		if (ce.error!=Variant::CallError::CALL_OK) {
+			print_line(String(p_func)+": call failed");
+			return;
+		}
+
+		if (i==0 || usec<best)
+			best=usec;
+	}
+
+	print_line(String(p_func)+": "+itos(best/1000)+" msec");
+}
+
+MainLoop* test() {
+
+	print_line("** GDScript VM **");
+
+	Ref<GDScript> script = Ref<GDScript>( memnew( GDScript ) );
+	script->set_source_code(_bench_script);
+	Error err = script->reload();
+	if (err) {
+		print_line("gdscript vm benchmark failed to compile");
+		return NULL;
+	}
+
+	_bench_func(script.ptr(),"loop");
+	_bench_func(script.ptr(),"branch");
+	_bench_func(script.ptr(),"arithmetic");
+	_bench_func(script.ptr(),"typed_loop");
+	_bench_func(script.ptr(),"typed_arithmetic");
+	_bench_func(script.ptr(),"packed");
+	_bench_func(script.ptr(),"calls");
+	_bench_func(script.ptr(),"named");
+	_bench_func(script.ptr(),"coroutines");
+
+	Variant::CallError ce;
+	Variant instance = script->_new(NULL,0,ce);
+	Object *obj = instance;
+	if (!obj) {
+		print_line("gdscript vm benchmark failed to instance");
+		return NULL;
+	}
+
+	_bench_func(obj,"members");
+
+	return NULL;
+}
+
+#else
+
+MainLoop* test() {
+
+	print_line("GDScript is disabled.");
+	return NULL;
+}
+
+#endif
+
+}
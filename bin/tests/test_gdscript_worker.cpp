@@ -0,0 +1,174 @@
+/*************************************************************************/
+/*  test_gdscript_worker.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_gdscript_worker.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#include "modules/gdscript/gd_worker.h"
+#endif
+
+namespace TestGDScriptWorker {
+
+#ifdef GDSCRIPT_ENABLED
+
+/* Runs script functions on a GDScriptWorker: results come back through
+   wait_to_finish(), containers given as arguments are the worker's own,
+   and objects the worker was not given are refused by the VM, whether
+   they are called, passed on or were freed meanwhile. */
+
+static const char *_worker_script=
+"extends Reference\n"
+"\n"
+"func change(a,d):\n"
+"\ta[0].append(2)\n"
+"\td[\"k\"].append(3)\n"
+"\treturn a[0].size() + d[\"k\"].size()\n"
+"\n"
+"func sum(n):\n"
+"\tvar t = 0\n"
+"\tfor i in range(n):\n"
+"\t\tt += i\n"
+"\treturn t\n"
+"\n"
+"func touch(o):\n"
+"\treturn o.get_meta(\"x\")\n"
+"\n"
+"func forward(o):\n"
+"\treturn str(o)\n"
+"\n"
+"func make():\n"
+"\tvar o = Reference.new()\n"
+"\to.set_meta(\"x\",5)\n"
+"\treturn o.get_meta(\"x\")\n";
+
+static void _check(const String& p_what,bool p_ok) {
+
+	print_line(p_what+": "+(p_ok?"yes":"NO"));
+}
+
+static Variant _run(Ref<GDScriptWorker> p_worker,Object *p_instance,const StringName& p_method,const Array& p_args) {
+
+	if (p_worker->start(p_instance,p_method,p_args)!=OK)
+		return Variant();
+	return p_worker->wait_to_finish();
+}
+
+MainLoop* test() {
+
+	print_line("** GDScript Worker **");
+
+	Ref<GDScript> script = Ref<GDScript>( memnew( GDScript ) );
+	script->set_source_code(_worker_script);
+	Error err = script->reload();
+	if (err) {
+		print_line("gdscript worker test failed to compile");
+		return NULL;
+	}
+
+	Variant::CallError ce;
+	Variant instance = script->_new(NULL,0,ce);
+	Object *obj = instance;
+	if (!obj) {
+		print_line("gdscript worker test failed to instance");
+		return NULL;
+	}
+
+	Ref<GDScriptWorker> worker = memnew( GDScriptWorker );
+
+	//finishing is seen without blocking
+	Array args;
+	args.push_back(10000);
+	_check("started",worker->start(obj,"sum",args)==OK && worker->is_active());
+	for(int i=0;i<1000 && !worker->is_finished();i++)
+		OS::get_singleton()->delay_usec(1000);
+	_check("finished without waiting",worker->is_finished());
+	_check("result returned",worker->wait_to_finish()==Variant(49995000));
+	_check("done after waiting",!worker->is_active() && !worker->is_finished());
+
+	//containers are deep copied
+	Array inner(true);
+	inner.push_back(1);
+	Array outer(true);
+	outer.push_back(inner);
+	Array dinner(true);
+	dinner.push_back(1);
+	Dictionary d(true);
+	d["k"]=dinner;
+	args=Array();
+	args.push_back(outer);
+	args.push_back(d);
+	_check("worker changed its copies",_run(worker,obj,"change",args)==Variant(4));
+	_check("caller containers kept",inner.size()==1 && dinner.size()==1);
+
+	Array self(true);
+	self.push_back(self);
+	args=Array();
+	args.push_back(self);
+	_check("self containing arguments refused",worker->start(obj,"sum",args)==ERR_INVALID_PARAMETER);
+	self.clear(); //break the cycle
+
+	//objects created by the worker are its own
+	_check("own objects used",_run(worker,obj,"make",Array())==Variant(5));
+
+	//objects not given are refused
+	Object *foreign = memnew( Object );
+	foreign->set_meta("x",7);
+	args=Array();
+	args.push_back(foreign);
+	_check("foreign call refused",_run(worker,obj,"touch",args).get_type()==Variant::NIL);
+	_check("foreign argument refused",_run(worker,obj,"forward",args).get_type()==Variant::NIL);
+
+	Variant fv=foreign;
+	const Variant *fargs[]={&instance,&fv};
+	_check("foreign found",worker->find_foreign(fargs,2)==1);
+
+	worker->allow(foreign);
+	_check("allowed object accessible",worker->can_access(fv) && worker->find_foreign(fargs,2)==-1);
+	_check("allowed object used",_run(worker,obj,"touch",args)==Variant(7));
+
+	memdelete(foreign);
+	_check("freed object refused",!worker->can_access(fv));
+	_check("freed object not used",_run(worker,obj,"touch",args).get_type()==Variant::NIL);
+
+	return NULL;
+}
+
+#else
+
+MainLoop* test() {
+
+	print_line("GDScript is disabled.");
+	return NULL;
+}
+
+#endif
+
+}
@@ -0,0 +1,141 @@
+/*************************************************************************/
+/*  test_hash_map.cpp                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_hash_map.h"
+#include "hash_map.h"
+#include "oa_hash_map.h"
+#include "variant.h"
+#include "print_string.h"
+#include "os/os.h"
+
+/* Compares chained HashMap against open addressing OAHashMap for the usual
+   key types. Keys are generated up front so only the container is timed. */
+
+namespace TestHashMap {
+
+enum {
+	KEY_COUNT=20000,
+	LOOKUP_ROUNDS=20
+};
+
+struct Timing {
+
+	uint64_t insert;
+	uint64_t lookup;
+	uint64_t iterate;
+	uint64_t erase;
+	int checksum;
+};
+
+template<class M,class K>
+static Timing _bench(const Vector<K>& p_keys) {
+
+	Timing t;
+	t.checksum=0;
+	int count=p_keys.size();
+	M map;
+
+	uint64_t from=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<count;i++)
+		map.set(p_keys[i],i);
+	t.insert=OS::get_singleton()->get_ticks_usec()-from;
+
+	from=OS::get_singleton()->get_ticks_usec();
+	for(int r=0;r<LOOKUP_ROUNDS;r++) {
+		for(int i=0;i<count;i++) {
+			const int *v=map.getptr(p_keys[i]);
+			if (v)
+				t.checksum+=*v;
+		}
+	}
+	t.lookup=OS::get_singleton()->get_ticks_usec()-from;
+
+	from=OS::get_singleton()->get_ticks_usec();
+	for(int r=0;r<LOOKUP_ROUNDS;r++) {
+		const K *k=NULL;
+		while((k=map.next(k)))
+			t.checksum++;
+	}
+	t.iterate=OS::get_singleton()->get_ticks_usec()-from;
+
+	from=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<count;i++)
+		map.erase(p_keys[i]);
+	t.erase=OS::get_singleton()->get_ticks_usec()-from;
+
+	if (map.size()!=0)
+		t.checksum=-1;
+
+	return t;
+}
+
+static String _format(const Timing& p_timing) {
+
+	return "insert "+itos(p_timing.insert)+" usec, lookup "+itos(p_timing.lookup)+" usec, iterate "+itos(p_timing.iterate)+" usec, erase "+itos(p_timing.erase)+" usec";
+}
+
+template<class K,class H>
+static void _compare(const String& p_name,const Vector<K>& p_keys) {
+
+	Timing chained = _bench< HashMap<K,int,H>, K >(p_keys);
+	Timing oa = _bench< OAHashMap<K,int,H>, K >(p_keys);
+
+	print_line(p_name+" keys:");
+	print_line("\tHashMap:   "+_format(chained));
+	print_line("\tOAHashMap: "+_format(oa));
+	if (chained.checksum!=oa.checksum)
+		print_line("\tERROR: checksum mismatch");
+}
+
+MainLoop* test() {
+
+	Vector<int> int_keys;
+	Vector<StringName> name_keys;
+	Vector<Variant> variant_keys;
+
+	uint32_t seed=1;
+	for(int i=0;i<KEY_COUNT;i++) {
+
+		seed=seed*1103515245+12345;
+		int_keys.push_back(seed>>1);
+		name_keys.push_back(StringName("key_"+itos(i)));
+		switch(i%3) {
+			case 0: variant_keys.push_back(i); break;
+			case 1: variant_keys.push_back("key_"+itos(i)); break;
+			case 2: variant_keys.push_back(Vector2(i,-i)); break;
+		}
+	}
+
+	_compare<int,HashMapHahserDefault>("int",int_keys);
+	_compare<StringName,StringNameHasher>("StringName",name_keys);
+	_compare<Variant,VariantHasher>("Variant",variant_keys);
+
+	return NULL;
+}
+
+}
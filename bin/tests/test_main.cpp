@@ -47,6 +47,16 @@
 #include "test_shader_lang.h"
 #include "test_gdscript.h"
 #include "test_image.h"
+#include "test_variant.h"
+#include "test_memory.h"
+#include "test_hash_map.h"
+#include "test_gdscript_vm.h"
+#include "test_gdscript_worker.h"
+#include "test_packed_scene.h"
+#include "test_streaming_texture.h"
+#include "test_scene_pool.h"
+#include "test_resource_load_queue.h"
+#include "test_compression.h"
 
 
 const char ** tests_get_names()  {
@@ -61,6 +71,16 @@ const char ** tests_get_names()  {
 		"gui",
 		"io",
 		"shaderlang",
+		"variant",
+		"memory",
+		"hash_map",
+		"gd_vm",
+		"gd_worker",
+		"packed_scene",
+		"streaming_texture",
+		"scene_pool",
+		"resource_load_queue",
+		"compression",
 		NULL
 	};
 	
@@ -157,6 +177,56 @@ MainLoop* test_main(String p_test,const List<String>& p_args) {
 		return TestGDScript::test(TestGDScript::TEST_BYTECODE);
 	}
 
+	if (p_test=="variant") {
+
+		return TestVariant::test();
+	}
+
+	if (p_test=="memory") {
+
+		return TestMemory::test();
+	}
+
+	if (p_test=="hash_map") {
+
+		return TestHashMap::test();
+	}
+
+	if (p_test=="gd_vm") {
+
+		return TestGDScriptVM::test();
+	}
+
+	if (p_test=="gd_worker") {
+
+		return TestGDScriptWorker::test();
+	}
+
+	if (p_test=="packed_scene") {
+
+		return TestPackedScene::test();
+	}
+
+	if (p_test=="streaming_texture") {
+
+		return TestStreamingTexture::test();
+	}
+
+	if (p_test=="scene_pool") {
+
+		return TestScenePool::test();
+	}
+
+	if (p_test=="resource_load_queue") {
+
+		return TestResourceLoadQueue::test();
+	}
+
+	if (p_test=="compression") {
+
+		return TestCompression::test();
+	}
+
 	if (p_test=="image") {
 
 		return TestImage::test();
@@ -0,0 +1,157 @@
+/*************************************************************************/
+/*  test_memory.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_memory.h"
+#include "os/memory.h"
+#include "os/os.h"
+#include "os/thread.h"
+#include "print_string.h"
+#include "variant.h"
+#include "scene/main/node.h"
+
+/* Allocation heavy workloads, run with each static memory pool backend
+   (scons memory_pool=malloc/size_class) and compare the timings. */
+
+namespace TestMemory {
+
+enum {
+	RAW_ITERATIONS=1000000,
+	RAW_LIVE=1024,
+	OBJECT_ITERATIONS=100000,
+	THREAD_COUNT=4
+};
+
+static uint64_t _raw_pattern(uint32_t p_seed) {
+
+	void *live[RAW_LIVE];
+	for(int i=0;i<RAW_LIVE;i++)
+		live[i]=NULL;
+
+	uint32_t seed=p_seed;
+	uint64_t from=OS::get_singleton()->get_ticks_usec();
+
+	for(int i=0;i<RAW_ITERATIONS;i++) {
+
+		seed=seed*1103515245+12345;
+		int slot=(seed>>16)%RAW_LIVE;
+		if (live[slot])
+			memfree(live[slot]);
+		live[slot]=memalloc(8+((seed>>8)&511));
+	}
+
+	for(int i=0;i<RAW_LIVE;i++) {
+		if (live[i])
+			memfree(live[i]);
+	}
+
+	return OS::get_singleton()->get_ticks_usec()-from;
+}
+
+static void _raw_thread(void *p_ud) {
+
+	uint64_t *r_usec=(uint64_t*)p_ud;
+	*r_usec=_raw_pattern((uint32_t)(size_t)r_usec);
+}
+
+static void _print_time(const String& p_name,uint64_t p_usec) {
+
+	print_line(p_name+": "+itos(p_usec/1000)+" msec");
+}
+
+MainLoop* test() {
+
+#ifdef SIZE_CLASS_MEMORY_POOL_ENABLED
+	print_line("static memory pool: size_class");
+#else
+	print_line("static memory pool: malloc");
+#endif
+
+	_print_time("memalloc/memfree",_raw_pattern(1));
+
+	{
+		uint64_t usec[THREAD_COUNT];
+		Thread *threads[THREAD_COUNT];
+
+		uint64_t from=OS::get_singleton()->get_ticks_usec();
+		for(int i=0;i<THREAD_COUNT;i++)
+			threads[i]=Thread::create(_raw_thread,&usec[i]);
+		for(int i=0;i<THREAD_COUNT;i++)
+			Thread::wait_to_finish(threads[i]);
+
+		_print_time("memalloc/memfree, "+itos(THREAD_COUNT)+" threads",OS::get_singleton()->get_ticks_usec()-from);
+	}
+
+	{
+		uint64_t from=OS::get_singleton()->get_ticks_usec();
+		for(int i=0;i<OBJECT_ITERATIONS;i++) {
+
+			Array arr;
+			arr.push_back(Transform());
+			arr.push_back(Matrix32());
+			arr.push_back("text");
+			Dictionary d;
+			d["array"]=arr;
+			d[i]=Vector3(i,i,i);
+			Variant v=d;
+		}
+		_print_time("Variant",OS::get_singleton()->get_ticks_usec()-from);
+	}
+
+	{
+		uint64_t from=OS::get_singleton()->get_ticks_usec();
+		for(int i=0;i<OBJECT_ITERATIONS;i++) {
+
+			String s="node_";
+			s+=itos(i);
+			s=s+"/"+s.to_upper();
+			Vector<String> parts=s.split("/");
+		}
+		_print_time("String",OS::get_singleton()->get_ticks_usec()-from);
+	}
+
+	{
+		uint64_t from=OS::get_singleton()->get_ticks_usec();
+		for(int i=0;i<OBJECT_ITERATIONS/10;i++) {
+
+			Node *parent = memnew( Node );
+			for(int j=0;j<10;j++) {
+				Node *child = memnew( Node );
+				child->set_name("child_"+itos(j));
+				parent->add_child(child);
+			}
+			memdelete(parent);
+		}
+		_print_time("Node",OS::get_singleton()->get_ticks_usec()-from);
+	}
+
+	print_line("static memory usage: "+itos(Memory::get_static_mem_usage())+" bytes, max: "+itos(Memory::get_static_mem_max_usage()));
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,232 @@
+/*************************************************************************/
+/*  test_packed_scene.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_packed_scene.h"
+#include "scene/resources/packed_scene.h"
+#include "scene/main/timer.h"
+#include "print_string.h"
+#include "os/os.h"
+
+/* Times PackedScene::instance() on a projectile sized scene against
+   building the same tree by type and property names, the way scenes
+   were instanced before the instancing plan. */
+
+namespace TestPackedScene {
+
+enum {
+	CHILD_COUNT=12,
+	ITERATIONS=5000
+};
+
+struct NodeDesc {
+
+	StringName type;
+	StringName name;
+	int parent;
+	Vector<StringName> prop_names;
+	Vector<Variant> prop_values;
+	Vector<StringName> groups;
+};
+
+struct ConnDesc {
+
+	int from;
+	int to;
+	StringName signal;
+	StringName method;
+	Vector<Variant> binds;
+};
+
+static Node *_make_scene() {
+
+	Node *root = memnew( Node );
+	root->set_name("bullet");
+	root->add_to_group("bullets",true);
+
+	for(int i=0;i<CHILD_COUNT;i++) {
+
+		Timer *t = memnew( Timer );
+		t->set_name("timer"+itos(i));
+		t->set_wait_time(0.5+i);
+		t->set_one_shot(i&1);
+		t->set_autostart(i%3==0);
+		t->add_to_group("timers",true);
+		root->add_child(t);
+		t->set_owner(root);
+	}
+
+	for(int i=1;i<CHILD_COUNT;i++) {
+
+		Vector<Variant> binds;
+		binds.push_back(i);
+		root->get_child(i)->connect("timeout",root->get_child(i-1),"start",binds,Object::CONNECT_PERSIST);
+	}
+
+	return root;
+}
+
+static void _describe(Node *p_node,int p_parent,Vector<NodeDesc> &r_nodes) {
+
+	NodeDesc d;
+	d.type=p_node->get_type();
+	d.name=p_node->get_name();
+	d.parent=p_parent;
+
+	List<PropertyInfo> plist;
+	p_node->get_property_list(&plist);
+	for(List<PropertyInfo>::Element *E=plist.front();E;E=E->next()) {
+
+		if (!(E->get().usage&PROPERTY_USAGE_STORAGE))
+			continue;
+		d.prop_names.push_back(E->get().name);
+		d.prop_values.push_back(p_node->get(E->get().name));
+	}
+
+	List<Node::GroupInfo> groups;
+	p_node->get_groups(&groups);
+	for(List<Node::GroupInfo>::Element *E=groups.front();E;E=E->next())
+		d.groups.push_back(E->get().name);
+
+	int idx=r_nodes.size();
+	r_nodes.push_back(d);
+	for(int i=0;i<p_node->get_child_count();i++)
+		_describe(p_node->get_child(i),idx,r_nodes);
+}
+
+static Node *_instance_by_name(const Vector<NodeDesc>& p_nodes,const Vector<ConnDesc>& p_conns) {
+
+	Node **nodes=(Node**)alloca(sizeof(Node*)*p_nodes.size());
+
+	for(int i=0;i<p_nodes.size();i++) {
+
+		const NodeDesc &d=p_nodes[i];
+		Node *n = ObjectTypeDB::instance(d.type)->cast_to<Node>();
+		for(int j=0;j<d.prop_names.size();j++)
+			n->set(d.prop_names[j],d.prop_values[j]);
+		for(int j=0;j<d.groups.size();j++)
+			n->add_to_group(d.groups[j],true);
+		n->set_name(d.name);
+		if (d.parent>=0) {
+			nodes[d.parent]->add_child(n);
+			n->set_owner(nodes[0]);
+		}
+		nodes[i]=n;
+	}
+
+	for(int i=0;i<p_conns.size();i++) {
+
+		const ConnDesc &c=p_conns[i];
+		Vector<Variant> binds;
+		binds.resize(c.binds.size());
+		for(int j=0;j<c.binds.size();j++)
+			binds[j]=c.binds[j];
+		nodes[c.from]->connect(c.signal,nodes[c.to],c.method,binds,Object::CONNECT_PERSIST);
+	}
+
+	return nodes[0];
+}
+
+static bool _same(Node *p_a,Node *p_b) {
+
+	if (p_a->get_type()!=p_b->get_type() || p_a->get_name()!=p_b->get_name() || p_a->get_child_count()!=p_b->get_child_count())
+		return false;
+
+	List<PropertyInfo> plist;
+	p_a->get_property_list(&plist);
+	for(List<PropertyInfo>::Element *E=plist.front();E;E=E->next()) {
+
+		if (!(E->get().usage&PROPERTY_USAGE_STORAGE))
+			continue;
+		if (!(p_a->get(E->get().name)==p_b->get(E->get().name)))
+			return false;
+	}
+
+	List<Object::Connection> ca,cb;
+	p_a->get_signal_connection_list("timeout",&ca);
+	p_b->get_signal_connection_list("timeout",&cb);
+	if (ca.size()!=cb.size())
+		return false;
+
+	for(int i=0;i<p_a->get_child_count();i++) {
+		if (!_same(p_a->get_child(i),p_b->get_child(i)))
+			return false;
+	}
+
+	return true;
+}
+
+MainLoop* test() {
+
+	Node *src = _make_scene();
+
+	Ref<PackedScene> scene = memnew( PackedScene );
+	Error err = scene->pack(src);
+	if (err!=OK) {
+		print_line("ERROR: pack failed");
+		memdelete(src);
+		return NULL;
+	}
+
+	Vector<NodeDesc> nodes;
+	_describe(src,-1,nodes);
+	Vector<ConnDesc> conns;
+	for(int i=1;i<=CHILD_COUNT-1;i++) {
+		ConnDesc c;
+		c.from=i+1;
+		c.to=i;
+		c.signal="timeout";
+		c.method="start";
+		c.binds.push_back(i);
+		conns.push_back(c);
+	}
+
+	Node *check = scene->instance();
+	print_line(String("instance matches source: ")+(check && _same(src,check)?"yes":"NO"));
+	if (check)
+		memdelete(check);
+
+	uint64_t from=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<ITERATIONS;i++)
+		memdelete( _instance_by_name(nodes,conns) );
+	uint64_t by_name=OS::get_singleton()->get_ticks_usec()-from;
+
+	from=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<ITERATIONS;i++)
+		memdelete( scene->instance() );
+	uint64_t planned=OS::get_singleton()->get_ticks_usec()-from;
+
+	print_line(itos(ITERATIONS)+" instances of "+itos(nodes.size())+" nodes:");
+	print_line("\tby name:   "+itos(by_name)+" usec");
+	print_line("\tinstance(): "+itos(planned)+" usec");
+
+	memdelete(src);
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,204 @@
+/*************************************************************************/
+/*  test_resource_load_queue.cpp                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_resource_load_queue.h"
+#include "io/resource_load_queue.h"
+#include "os/thread.h"
+#include "os/mutex.h"
+#include "os/os.h"
+#include "print_string.h"
+
+/* Runs the background loader with loaders that need no files: requests
+   handed to the main thread load highest priority first, cancelled ones
+   are never loaded, two threads asking for the same path share one load,
+   and a worker that would deadlock with the main thread fails instead of
+   hanging. */
+
+namespace TestResourceLoadQueue {
+
+class TestLoader : public ResourceFormatLoader {
+public:
+
+	String extension;
+	bool thread_safe;
+	int delay_usec;
+	String other; //loaded from inside load(), to chain loads
+
+	Mutex *lock;
+	Vector<String> loaded;
+	Vector<String> scanned;
+
+	virtual RES load(const String &p_path,const String& p_original_path="") {
+
+		if (delay_usec)
+			OS::get_singleton()->delay_usec(delay_usec);
+		if (other!="")
+			ResourceLoader::load(other);
+
+		lock->lock();
+		loaded.push_back(p_path);
+		lock->unlock();
+
+		return RES( memnew( Resource ) );
+	}
+
+	virtual void get_recognized_extensions(List<String> *p_extensions) const { p_extensions->push_back(extension); }
+	virtual bool handles_type(const String& p_type) const { return p_type=="Resource"; }
+	virtual String get_resource_type(const String &p_path) const { return p_path.extension()==extension?"Resource":""; }
+	virtual bool is_thread_safe() const { return thread_safe; }
+
+	virtual void get_dependencies(const String& p_path,List<String> *p_dependencies) {
+
+		lock->lock();
+		scanned.push_back(p_path);
+		lock->unlock();
+	}
+
+	int get_loaded_count(const String& p_path) {
+
+		int count=0;
+		lock->lock();
+		for(int i=0;i<loaded.size();i++) {
+			if (loaded[i]==p_path)
+				count++;
+		}
+		lock->unlock();
+		return count;
+	}
+
+	int get_scanned_count() {
+
+		lock->lock();
+		int count=scanned.size();
+		lock->unlock();
+		return count;
+	}
+
+	TestLoader(const String& p_extension,bool p_thread_safe,int p_delay_usec=0) {
+
+		extension=p_extension;
+		thread_safe=p_thread_safe;
+		delay_usec=p_delay_usec;
+		lock=Mutex::create();
+	}
+};
+
+static void _check(const String& p_what,bool p_ok) {
+
+	print_line(p_what+": "+(p_ok?"yes":"NO"));
+}
+
+static RES _shared_res;
+
+static void _load_shared_thread(void *p_ud) {
+
+	_shared_res=ResourceLoader::load(*(String*)p_ud);
+}
+
+static bool _wait_scanned(TestLoader *p_loader,int p_count) {
+
+	for(int i=0;i<1000 && p_loader->get_scanned_count()<p_count;i++)
+		OS::get_singleton()->delay_usec(1000);
+	//scanning threads update the queue right after
+	OS::get_singleton()->delay_usec(50000);
+	return p_loader->get_scanned_count()>=p_count;
+}
+
+MainLoop* test() {
+
+	ResourceLoadQueue *lq=ResourceLoadQueue::get_singleton();
+	if (!lq) {
+		print_line("ERROR: no resource load queue");
+		return NULL;
+	}
+
+	//loads that create server side resources go through the main thread
+	TestLoader *main_loader = memnew( TestLoader("tlqm",false) );
+	ResourceLoader::add_resource_format_loader(main_loader);
+
+	String low="res://test_load_queue_low.tlqm";
+	String high="res://test_load_queue_high.tlqm";
+	String mid="res://test_load_queue_mid.tlqm";
+	lq->queue(low,"",0);
+	lq->queue(high,"",5);
+	lq->queue(mid,"",2);
+
+	_wait_scanned(main_loader,3);
+	for(int i=0;i<100 && main_loader->get_loaded_count(low)==0;i++)
+		lq->poll();
+
+	_check("higher priority loaded first",main_loader->loaded.size()==3 && main_loader->loaded[0]==high && main_loader->loaded[1]==mid && main_loader->loaded[2]==low);
+	_check("status loaded",lq->get_status(high)==ResourceLoadQueue::STATUS_LOADED);
+	_check("resource taken",lq->get_resource(high).is_valid() && lq->get_status(high)==ResourceLoadQueue::STATUS_INVALID);
+	lq->get_resource(mid);
+	lq->get_resource(low);
+
+	//cancelled requests are dropped
+	String cancelled="res://test_load_queue_cancelled.tlqm";
+	lq->queue(cancelled);
+	lq->cancel(cancelled);
+	_wait_scanned(main_loader,4);
+	for(int i=0;i<10;i++)
+		lq->poll();
+	_check("cancelled not loaded",main_loader->get_loaded_count(cancelled)==0 && lq->get_status(cancelled)==ResourceLoadQueue::STATUS_INVALID);
+
+	//a path asked for by two threads at once is loaded once
+	TestLoader *slow_loader = memnew( TestLoader("tlqs",true,100000) );
+	ResourceLoader::add_resource_format_loader(slow_loader);
+
+	String shared="res://test_load_queue_shared.tlqs";
+	Thread *t=Thread::create(_load_shared_thread,&shared);
+	OS::get_singleton()->delay_usec(20000);
+	RES res=ResourceLoader::load(shared);
+	if (t) {
+		Thread::wait_to_finish(t);
+		memdelete(t);
+	}
+	_check("shared load done once",slow_loader->get_loaded_count(shared)==1);
+	_check("shared load same resource",res.is_valid() && res==_shared_res);
+	_shared_res=RES();
+
+	//a worker loading y waits for x, which only the main thread can load,
+	//while the main thread loads x, which waits for y
+	TestLoader *x_loader = memnew( TestLoader("tlqx",false) );
+	TestLoader *y_loader = memnew( TestLoader("tlqy",true,100000) );
+	x_loader->other="res://test_load_queue_cycle.tlqy";
+	y_loader->other="res://test_load_queue_cycle.tlqx";
+	ResourceLoader::add_resource_format_loader(x_loader);
+	ResourceLoader::add_resource_format_loader(y_loader);
+
+	lq->queue(x_loader->other);
+	OS::get_singleton()->delay_usec(20000);
+	RES x=ResourceLoader::load(y_loader->other);
+	RES y=lq->get_resource(x_loader->other);
+	_check("cycle with the main thread fails instead of hanging",x.is_valid() && y.is_valid());
+
+	return NULL;
+}
+
+}
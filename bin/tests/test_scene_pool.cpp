@@ -0,0 +1,162 @@
+/*************************************************************************/
+/*  test_scene_pool.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_scene_pool.h"
+#include "scene/main/scene_pool.h"
+#include "message_queue.h"
+#include "print_string.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#endif
+
+/* Runs instances of a small scene through the scene pool: released trees
+   are handed out again, detached only once idle, discarded when the pool
+   is full, and pooled nodes freed by someone else are skipped. Scripts
+   on a reused tree get _pool_reset() called, on every node. */
+
+namespace TestScenePool {
+
+static void _check(const String& p_what,bool p_ok) {
+
+	print_line(p_what+": "+(p_ok?"yes":"NO"));
+}
+
+#ifdef GDSCRIPT_ENABLED
+
+static const char *_reset_script=
+"extends Node\n"
+"\n"
+"var resets = 0\n"
+"\n"
+"func _pool_reset():\n"
+"\tresets += 1\n";
+
+static void _test_reset(ScenePool *p_pool,const Ref<PackedScene>& p_scene) {
+
+	Ref<GDScript> script = Ref<GDScript>( memnew( GDScript ) );
+	script->set_source_code(_reset_script);
+	if (script->reload()!=OK) {
+		print_line("ERROR: reset script failed to compile");
+		return;
+	}
+
+	Node *a=p_pool->instance(p_scene);
+	Node *shape=a->get_node(NodePath("shape"));
+	a->set_script(script.get_ref_ptr());
+	shape->set_script(script.get_ref_ptr());
+	_check("no reset on a fresh instance",int(a->get("resets"))==0);
+
+	p_pool->release(a);
+	Node *b=p_pool->instance(p_scene);
+	_check("reset called on a pool hit",b==a && int(b->get("resets"))==1 && int(shape->get("resets"))==1);
+
+	memdelete(b);
+}
+
+#endif
+
+MainLoop* test() {
+
+	ScenePool *pool=ScenePool::get_singleton();
+	if (!pool) {
+		print_line("ERROR: no scene pool");
+		return NULL;
+	}
+
+	Node *src = memnew( Node );
+	src->set_name("pickup");
+	Node *child = memnew( Node );
+	child->set_name("shape");
+	src->add_child(child);
+	child->set_owner(src);
+
+	Ref<PackedScene> scene = memnew( PackedScene );
+	Error err = scene->pack(src);
+	memdelete(src);
+	if (err!=OK) {
+		print_line("ERROR: pack failed");
+		return NULL;
+	}
+
+	int old_max=pool->get_max_pooled();
+	pool->clear();
+	pool->reset_stats();
+	pool->set_max_pooled(2);
+
+	//miss, then hit on the released instance
+	Node *a=pool->instance(scene);
+	_check("first instance misses",a && pool->get_miss_count()==1 && pool->get_hit_count()==0);
+	pool->release(a);
+	_check("released instance pooled",pool->get_pooled_count(scene)==1);
+	Node *b=pool->instance(scene);
+	_check("pooled instance reused",b==a && pool->get_hit_count()==1 && pool->get_pooled_count(scene)==0);
+
+	//an attached instance stays where it is until idle time
+	Node *parent = memnew( Node );
+	parent->add_child(b);
+	pool->release(b);
+	_check("still attached when released",b->get_parent()==parent && pool->get_pooled_count(scene)==0);
+	MessageQueue::get_singleton()->flush();
+	_check("detached and pooled once idle",parent->get_child_count()==0 && pool->get_pooled_count(scene)==1);
+
+	//released beyond the maximum, freed instead
+	pool->set_max_pooled(1);
+	Node *c=pool->instance(scene);
+	Node *d=pool->instance(scene);
+	pool->release(c);
+	pool->release(d);
+	_check("full pool discards",pool->get_discarded_count()==1 && pool->get_pooled_count(scene)==1);
+
+	//c is pooled, freeing it elsewhere must not hand it out again,
+	//compare ids as the new instance may well get the same address
+	ObjectID c_id=c->get_instance_ID();
+	memdelete(c);
+	uint64_t hits=pool->get_hit_count();
+	Node *e=pool->instance(scene);
+	_check("freed pooled node skipped",e && e->get_instance_ID()!=c_id && pool->get_hit_count()==hits);
+
+	//freed while waiting to be detached
+	parent->add_child(e);
+	pool->release(e);
+	memdelete(parent);
+	MessageQueue::get_singleton()->flush();
+	_check("freed before idle ignored",pool->get_pooled_count(scene)==0);
+
+#ifdef GDSCRIPT_ENABLED
+	_test_reset(pool,scene);
+#endif
+
+	pool->clear();
+	pool->reset_stats();
+	pool->set_max_pooled(old_max);
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,126 @@
+/*************************************************************************/
+/*  test_streaming_texture.cpp                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_streaming_texture.h"
+#include "scene/resources/streaming_texture.h"
+#include "os/file_access.h"
+#include "os/os.h"
+#include "print_string.h"
+
+/* Saves an image as a streaming texture and loads it back: only the
+   small mipmaps must be resident after loading, the rest must arrive
+   through the streamer, and files that are not streaming textures (or
+   are newer, or have a corrupt header) must be refused. */
+
+namespace TestStreamingTexture {
+
+enum {
+	WIDTH=512,
+	HEIGHT=256
+};
+
+static void _check(const String& p_what,bool p_ok) {
+
+	print_line(p_what+": "+(p_ok?"yes":"NO"));
+}
+
+MainLoop* test() {
+
+	String path="user://test_streaming_texture.stex";
+
+	DVector<uint8_t> data;
+	data.resize(WIDTH*HEIGHT*4);
+	{
+		DVector<uint8_t>::Write w=data.write();
+		for(int i=0;i<data.size();i++)
+			w[i]=(i*7)&0xFF;
+	}
+
+	Image img(WIDTH,HEIGHT,0,Image::FORMAT_RGBA,data);
+	Error err = StreamingTexture::save_image(path,img,Texture::FLAGS_DEFAULT);
+	_check("saved",err==OK);
+	if (err!=OK)
+		return NULL;
+
+	Ref<StreamingTexture> tex = memnew( StreamingTexture );
+	err = tex->load(path);
+	_check("loaded",err==OK);
+	if (err!=OK)
+		return NULL;
+
+	_check("size kept",tex->get_width()==WIDTH && tex->get_height()==HEIGHT);
+	_check("format kept",tex->get_format()==Image::FORMAT_RGBA && tex->has_alpha());
+	_check("all mipmap levels listed",tex->get_level_count()==10); //512x256 down to 1x1
+
+	//level 3 is 64x32, the largest one that stays in memory
+	_check("only small levels resident",tex->get_resident_level()==3);
+
+	if (TextureStreamer::get_singleton()) {
+
+		//no frame was drawn yet, so it counts as drawn and the large levels are read in
+		for(int i=0;i<100 && tex->get_resident_level()!=0;i++) {
+			TextureStreamer::get_singleton()->poll();
+			OS::get_singleton()->delay_usec(10000);
+		}
+		_check("large levels streamed in",tex->get_resident_level()==0);
+		_check("resident memory counted",TextureStreamer::get_singleton()->get_resident_memory()>=uint64_t(WIDTH*HEIGHT*4));
+	}
+
+	FileAccess *f=FileAccess::open(path,FileAccess::WRITE);
+	f->store_buffer((const uint8_t*)"GDST",4);
+	f->store_32(99);
+	memdelete(f);
+	Ref<StreamingTexture> newer = memnew( StreamingTexture );
+	_check("newer version refused",newer->load(path)==ERR_FILE_UNRECOGNIZED);
+
+	//a single level claiming a negative size
+	f=FileAccess::open(path,FileAccess::WRITE);
+	f->store_buffer((const uint8_t*)"GDST",4);
+	f->store_32(1);
+	f->store_32(4);
+	f->store_32(4);
+	f->store_32(Image::FORMAT_RGBA);
+	f->store_32(0);
+	f->store_32(1);
+	f->store_32(4);
+	f->store_32(4);
+	f->store_32(uint32_t(-64));
+	memdelete(f);
+	Ref<StreamingTexture> corrupt = memnew( StreamingTexture );
+	_check("corrupt level size refused",corrupt->load(path)==ERR_FILE_CORRUPT);
+
+	f=FileAccess::open(path,FileAccess::WRITE);
+	f->store_buffer((const uint8_t*)"RSRC",4);
+	memdelete(f);
+	Ref<StreamingTexture> other = memnew( StreamingTexture );
+	_check("other files refused",other->load(path)==ERR_FILE_UNRECOGNIZED);
+
+	return NULL;
+}
+
+}
@@ -0,0 +1,180 @@
+/*************************************************************************/
+/*  test_variant.cpp                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "test_variant.h"
+#include "variant.h"
+#include "print_string.h"
+#include "os/os.h"
+
+#ifdef GDSCRIPT_ENABLED
+#include "modules/gdscript/gd_script.h"
+#endif
+
+namespace TestVariant {
+
+enum {
+	EVALUATE_ITERATIONS=1000000,
+	SCRIPT_ITERATIONS=200000
+};
+
+static void _bench_evaluate(const String& p_name,Variant::Operator p_op,const Variant& p_a,const Variant& p_b) {
+
+	Variant ret;
+	bool valid=true;
+
+	uint64_t from=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<EVALUATE_ITERATIONS;i++) {
+
+		Variant::evaluate(p_op,p_a,p_b,ret,valid);
+	}
+	uint64_t usec=OS::get_singleton()->get_ticks_usec()-from;
+
+	if (!valid) {
+		print_line(p_name+": invalid operation");
+		return;
+	}
+
+	print_line(p_name+": "+itos(usec/1000)+" msec, "+rtos(double(EVALUATE_ITERATIONS)/(double(usec)+1.0))+" Mops/s");
+}
+
+static void _bench_evaluator(const String& p_name,Variant::Operator p_op,const Variant& p_a,const Variant& p_b) {
+
+	Variant::OperatorEvaluator evaluator=Variant::get_operator_evaluator(p_op,p_a.get_type(),p_b.get_type());
+	if (!evaluator) {
+		print_line(p_name+" (cached evaluator): none");
+		return;
+	}
+
+	Variant ret;
+
+	uint64_t from=OS::get_singleton()->get_ticks_usec();
+	for(int i=0;i<EVALUATE_ITERATIONS;i++) {
+
+		evaluator(p_a,p_b,ret);
+	}
+	uint64_t usec=OS::get_singleton()->get_ticks_usec()-from;
+
+	print_line(p_name+" (cached evaluator): "+itos(usec/1000)+" msec, "+rtos(double(EVALUATE_ITERATIONS)/(double(usec)+1.0))+" Mops/s");
+}
+
+#ifdef GDSCRIPT_ENABLED
+
+static const char *_bench_script=
+"static func math_2d(n):\n"
+"\tvar t = Matrix32().rotated(0.1)\n"
+"\tvar p = Vector2(1,2)\n"
+"\tfor i in range(n):\n"
+"\t\tp = t.xform(p) + Vector2(1,0)\n"
+"\t\tt = t * t\n"
+"\treturn p\n"
+"\n"
+"static func math_3d(n):\n"
+"\tvar t = Transform()\n"
+"\tvar v = Vector3(1,2,3)\n"
+"\tvar a = AABB(Vector3(),Vector3(1,1,1))\n"
+"\tfor i in range(n):\n"
+"\t\tt = t.rotated(Vector3(0,1,0),0.01)\n"
+"\t\tv = t.xform(v)\n"
+"\t\ta = t.xform(a)\n"
+"\treturn v\n"
+"\n"
+"static func arithmetic(n):\n"
+"\tvar a = 0\n"
+"\tvar b = 0.0\n"
+"\tfor i in range(n):\n"
+"\t\ta = a + i * 2 - 1\n"
+"\t\tb = b + i * 0.5\n"
+"\treturn a + b\n";
+
+static void _bench_script_func(Object *p_script,const StringName& p_func) {
+
+	Variant arg=SCRIPT_ITERATIONS;
+	const Variant *argp[]={&arg};
+	Variant::CallError ce;
+
+	uint64_t from=OS::get_singleton()->get_ticks_usec();
+	p_script->call(p_func,argp,1,ce);
+	uint64_t usec=OS::get_singleton()->get_ticks_usec()-from;
+
+	if (ce.error!=Variant::CallError::CALL_OK) {
+		print_line(String(p_func)+": call failed");
+		return;
+	}
+
+	print_line("gdscript "+String(p_func)+": "+itos(usec/1000)+" msec");
+}
+
+static void _bench_scripts() {
+
+	Ref<GDScript> script = Ref<GDScript>( memnew( GDScript ) );
+	script->set_source_code(_bench_script);
+	Error err = script->reload();
+	if (err) {
+		print_line("gdscript benchmark failed to compile");
+		return;
+	}
+
+	_bench_script_func(script.ptr(),"math_2d");
+	_bench_script_func(script.ptr(),"math_3d");
+	_bench_script_func(script.ptr(),"arithmetic");
+}
+
+#endif
+
+MainLoop* test() {
+
+	print_line("** Variant::evaluate **");
+
+	_bench_evaluate("int + int",Variant::OP_ADD,10,20);
+	_bench_evaluate("real * real",Variant::OP_MULTIPLY,10.0,0.5);
+	_bench_evaluate("int < real",Variant::OP_LESS,10,20.0);
+	_bench_evaluate("Vector3 + Vector3",Variant::OP_ADD,Vector3(1,2,3),Vector3(3,2,1));
+	_bench_evaluate("Vector2 * real",Variant::OP_MULTIPLY,Vector2(1,2),2.0);
+	_bench_evaluate("Matrix32 * Matrix32",Variant::OP_MULTIPLY,Matrix32(0.5,Vector2(1,2)),Matrix32(0.2,Vector2(3,4)));
+	_bench_evaluate("Matrix32 == Matrix32",Variant::OP_EQUAL,Matrix32(0.5,Vector2(1,2)),Matrix32(0.5,Vector2(1,2)));
+	_bench_evaluate("Transform * Transform",Variant::OP_MULTIPLY,Transform(),Transform());
+	_bench_evaluate("Transform * Vector3",Variant::OP_MULTIPLY,Transform(),Vector3(1,2,3));
+	_bench_evaluate("Matrix3 * Matrix3",Variant::OP_MULTIPLY,Matrix3(),Matrix3());
+	_bench_evaluate("Transform == Transform",Variant::OP_EQUAL,Transform(),Transform());
+
+	_bench_evaluator("int + int",Variant::OP_ADD,10,20);
+	_bench_evaluator("real * real",Variant::OP_MULTIPLY,10.0,0.5);
+	_bench_evaluator("Vector3 + Vector3",Variant::OP_ADD,Vector3(1,2,3),Vector3(3,2,1));
+	_bench_evaluator("Transform * Vector3",Variant::OP_MULTIPLY,Transform(),Vector3(1,2,3));
+
+#ifdef GDSCRIPT_ENABLED
+	print_line("** GDScript **");
+	_bench_scripts();
+#endif
+
+	print_line("variant pool: "+itos(VariantPoolAllocator::get_used())+" used, "+itos(VariantPoolAllocator::get_allocated())+" allocated");
+
+	return NULL;
+}
+
+}
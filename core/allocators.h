@@ -195,4 +195,103 @@ public:
 };
 
 
+/**
+ * Fixed size chunk allocator. Chunks are carved out of pages requested from
+ * memalloc and recycled through an intrusive free list, so a matching
+ * alloc/free pair never reaches the static memory pool. Pages are kept
+ * until clear() is called, which must only happen when nothing is in use.
+ * This class does no locking.
+ */
+
+template<int CHUNK_SIZE, int PAGE_CHUNKS=256>
+class ChunkAllocator {
+
+	union Chunk {
+
+		Chunk *next;
+		uint64_t _align;
+		uint8_t data[CHUNK_SIZE];
+	};
+
+	struct Page {
+
+		Page *next;
+		Chunk chunks[PAGE_CHUNKS];
+	};
+
+	Page *pages;
+	Chunk *free_list;
+	int used;
+	int allocated;
+
+public:
+
+	void* alloc() {
+
+		if (!free_list) {
+
+			Page *page = (Page*)memalloc(sizeof(Page));
+			ERR_FAIL_COND_V( !page, NULL );
+			page->next=pages;
+			pages=page;
+
+			for(int i=0;i<PAGE_CHUNKS;i++) {
+
+				page->chunks[i].next=free_list;
+				free_list=&page->chunks[i];
+			}
+
+			allocated+=PAGE_CHUNKS;
+		}
+
+		Chunk *c=free_list;
+		free_list=c->next;
+		used++;
+		return c;
+	}
+
+	void free(void* p_ptr) {
+
+		ERR_FAIL_COND( used==0 );
+
+		Chunk *c=(Chunk*)p_ptr;
+		c->next=free_list;
+		free_list=c;
+		used--;
+	}
+
+	int get_used() const { return used; }
+	int get_allocated() const { return allocated; }
+
+	void clear() {
+
+		ERR_FAIL_COND( used>0 );
+
+		while(pages) {
+
+			Page *p=pages;
+			pages=p->next;
+			memfree(p);
+		}
+
+		free_list=NULL;
+		allocated=0;
+	}
+
+	ChunkAllocator() {
+
+		pages=NULL;
+		free_list=NULL;
+		used=0;
+		allocated=0;
+	}
+
+	~ChunkAllocator() {
+
+		if (used==0)
+			clear();
+	}
+};
+
+
 #endif // ALLOCATORS_H
@@ -33,6 +33,177 @@
 #include "zip_io.h"
 #include "os/copymem.h"
 
+#include <string.h>
+
+/* LZ4 block format (compatible with the reference one), greedy matching
+   with a small hash table. Good ratios are left to deflate, this is about
+   decompression speed. */
+
+#define LZ4_HASH_BITS 12
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5 //spec: the block ends with at least 5 literals..
+#define LZ4_MF_LIMIT 12 //..and the last match starts 12 bytes before the end
+
+static _FORCE_INLINE_ uint32_t _lz4_read32(const uint8_t *p_ptr) {
+
+	uint32_t v;
+	memcpy(&v,p_ptr,4);
+	return v;
+}
+
+static _FORCE_INLINE_ uint32_t _lz4_hash(uint32_t p_seq) {
+
+	return (p_seq*2654435761U)>>(32-LZ4_HASH_BITS);
+}
+
+static _FORCE_INLINE_ uint8_t *_lz4_store_length(uint8_t *p_dst,int p_len) {
+
+	while(p_len>=255) {
+		*p_dst++=255;
+		p_len-=255;
+	}
+	*p_dst++=p_len;
+	return p_dst;
+}
+
+static int _lz4_compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size) {
+
+	int table[1<<LZ4_HASH_BITS];
+	for(int i=0;i<(1<<LZ4_HASH_BITS);i++)
+		table[i]=-1;
+
+	const uint8_t *ip=p_src;
+	const uint8_t *anchor=p_src;
+	const uint8_t *end=p_src+p_src_size;
+	uint8_t *op=p_dst;
+
+	if (p_src_size>LZ4_MF_LIMIT) {
+
+		const uint8_t *mf_limit=end-LZ4_MF_LIMIT;
+		const uint8_t *match_limit=end-LZ4_LAST_LITERALS;
+
+		while(ip<=mf_limit) {
+
+			uint32_t seq=_lz4_read32(ip);
+			uint32_t h=_lz4_hash(seq);
+			int ref=table[h];
+			table[h]=ip-p_src;
+
+			if (ref<0 || (ip-p_src)-ref>65535 || _lz4_read32(p_src+ref)!=seq) {
+				ip++;
+				continue;
+			}
+
+			const uint8_t *m=p_src+ref;
+			while(ip>anchor && m>p_src && ip[-1]==m[-1]) {
+				ip--;
+				m--;
+			}
+
+			int len=LZ4_MIN_MATCH;
+			while(ip+len<match_limit && ip[len]==m[len])
+				len++;
+
+			int lit=ip-anchor;
+			uint8_t *token=op++;
+			*token=MIN(lit,15)<<4;
+			if (lit>=15)
+				op=_lz4_store_length(op,lit-15);
+			memcpy(op,anchor,lit);
+			op+=lit;
+
+			int ofs=ip-m;
+			*op++=ofs&0xFF;
+			*op++=ofs>>8;
+
+			int ml=len-LZ4_MIN_MATCH;
+			*token|=MIN(ml,15);
+			if (ml>=15)
+				op=_lz4_store_length(op,ml-15);
+
+			ip+=len;
+			anchor=ip;
+			if (ip<=mf_limit)
+				table[_lz4_hash(_lz4_read32(ip-2))]=ip-2-p_src;
+		}
+	}
+
+	int lit=end-anchor;
+	*op++=MIN(lit,15)<<4;
+	if (lit>=15)
+		op=_lz4_store_length(op,lit-15);
+	memcpy(op,anchor,lit);
+	op+=lit;
+
+	return op-p_dst;
+}
+
+static int _lz4_decompress(uint8_t *p_dst, int p_dst_size, const uint8_t *p_src, int p_src_size) {
+
+	const uint8_t *ip=p_src;
+	const uint8_t *iend=p_src+p_src_size;
+	uint8_t *op=p_dst;
+	uint8_t *oend=p_dst+p_dst_size;
+
+	while(ip<iend) {
+
+		int token=*ip++;
+
+		int lit=token>>4;
+		if (lit==15) {
+			int s;
+			do {
+				if (ip>=iend)
+					return -1;
+				s=*ip++;
+				lit+=s;
+			} while(s==255);
+		}
+
+		if (lit>iend-ip || lit>oend-op)
+			return -1;
+		memcpy(op,ip,lit);
+		op+=lit;
+		ip+=lit;
+
+		if (ip>=iend)
+			break; //last sequence has no match
+
+		if (iend-ip<2)
+			return -1;
+		int ofs=ip[0]|(ip[1]<<8);
+		ip+=2;
+		if (ofs==0 || ofs>op-p_dst)
+			return -1;
+
+		int ml=token&15;
+		if (ml==15) {
+			int s;
+			do {
+				if (ip>=iend)
+					return -1;
+				s=*ip++;
+				ml+=s;
+			} while(s==255);
+		}
+		ml+=LZ4_MIN_MATCH;
+
+		if (ml>oend-op)
+			return -1;
+
+		const uint8_t *m=op-ofs;
+		if (ofs>=ml) {
+			memcpy(op,m,ml);
+		} else {
+			for(int i=0;i<ml;i++) //overlapping, repeats the pattern
+				op[i]=m[i];
+		}
+		op+=ml;
+	}
+
+	return op-p_dst;
+}
+
 int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size,Mode p_mode) {
 
 	switch(p_mode) {
@@ -69,6 +240,10 @@ int Compression::compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size,M
 			return aout;
 
 		} break;
+		case MODE_LZ4: {
+
+			return _lz4_compress(p_dst,p_src,p_src_size);
+		} break;
 	}
 
 	ERR_FAIL_V(-1);
@@ -99,6 +274,10 @@ int Compression::get_max_compressed_buffer_size(int p_src_size,Mode p_mode){
 			deflateEnd(&strm);
 			return aout;
 		} break;
+		case MODE_LZ4: {
+
+			return p_src_size+p_src_size/255+16;
+		} break;
 	}
 
 	ERR_FAIL_V(-1);
@@ -107,7 +286,7 @@ int Compression::get_max_compressed_buffer_size(int p_src_size,Mode p_mode){
 
 
 
-void Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size,Mode p_mode){
+int Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size,Mode p_mode){
 
 	switch(p_mode) {
 		case MODE_FASTLZ: {
@@ -119,7 +298,7 @@ void Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *
 			} else {
 				fastlz_decompress(p_src,p_src_size,p_dst,p_dst_max_size);
 			}
-			return;
+			return p_dst_max_size;
 		} break;
 		case MODE_DEFLATE: {
 
@@ -130,7 +309,7 @@ void Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *
 			strm.avail_in= 0;
 			strm.next_in=Z_NULL;
 			int err = inflateInit(&strm);
-			ERR_FAIL_COND(err!=Z_OK);
+			ERR_FAIL_COND_V(err!=Z_OK,-1);
 
 			strm.avail_in=p_src_size;
 			strm.avail_out=p_dst_max_size;
@@ -138,11 +317,19 @@ void Compression::decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *
 			strm.next_out=p_dst;
 
 			err = inflate(&strm,Z_FINISH);
+			int total = p_dst_max_size-strm.avail_out;
 			inflateEnd(&strm);
-			ERR_FAIL_COND(err!=Z_STREAM_END);
-			return;
+			ERR_FAIL_COND_V(err!=Z_STREAM_END,-1);
+			return total;
+		} break;
+		case MODE_LZ4: {
+
+			//blocks are decoded to their exact size, anything shorter is truncated
+			int ret = _lz4_decompress(p_dst,p_dst_max_size,p_src,p_src_size);
+			ERR_FAIL_COND_V(ret!=p_dst_max_size,-1);
+			return ret;
 		} break;
 	}
 
-	ERR_FAIL();
+	ERR_FAIL_V(-1);
 }
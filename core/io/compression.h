@@ -37,13 +37,14 @@ public:
 
 	enum Mode {
 		MODE_FASTLZ,
-		MODE_DEFLATE
+		MODE_DEFLATE,
+		MODE_LZ4 // fast to decompress, for data read at load time
 	};
 
 
 	static int compress(uint8_t *p_dst, const uint8_t *p_src, int p_src_size,Mode p_mode=MODE_FASTLZ);
 	static int get_max_compressed_buffer_size(int p_src_size,Mode p_mode=MODE_FASTLZ);
-	static void decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size,Mode p_mode=MODE_FASTLZ);
+	static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size,Mode p_mode=MODE_FASTLZ); ///< decompressed size, -1 on corrupt data
 
 	Compression();
 };
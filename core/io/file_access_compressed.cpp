@@ -28,6 +28,156 @@
 /*************************************************************************/
 #include "file_access_compressed.h"
 #include "print_string.h"
+#include "os/os.h"
+#include "os/thread.h"
+#include "os/mutex.h"
+#include "os/copymem.h"
+#include "io/marshalls.h"
+
+//below this, starting threads costs more than what they save
+#define PARALLEL_MIN_SIZE (256*1024)
+
+struct _BlockJobs {
+
+	Mutex *lock;
+	int next;
+	int count;
+	void (*func)(void*,int);
+	void *userdata;
+};
+
+static void _block_jobs_thread(void *p_ud) {
+
+	_BlockJobs *bj=(_BlockJobs*)p_ud;
+
+	while(true) {
+
+		bj->lock->lock();
+		int idx=bj->next++;
+		bj->lock->unlock();
+
+		if (idx>=bj->count)
+			break;
+		bj->func(bj->userdata,idx);
+	}
+}
+
+static void _run_block_jobs(int p_count, void (*p_func)(void*,int), void *p_userdata, bool p_parallel) {
+
+	int thread_count = p_parallel ? MIN(OS::get_singleton()->get_processor_count(),p_count)-1 : 0;
+	Mutex *lock = thread_count>0 ? Mutex::create() : NULL;
+
+	if (!lock) {
+		for(int i=0;i<p_count;i++)
+			p_func(p_userdata,i);
+		return;
+	}
+
+	_BlockJobs bj;
+	bj.lock=lock;
+	bj.next=0;
+	bj.count=p_count;
+	bj.func=p_func;
+	bj.userdata=p_userdata;
+
+	Vector<Thread*> threads;
+	for(int i=0;i<thread_count;i++) {
+		Thread *t = Thread::create(_block_jobs_thread,&bj);
+		if (t)
+			threads.push_back(t);
+	}
+
+	_block_jobs_thread(&bj); //this thread helps too
+
+	for(int i=0;i<threads.size();i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	memdelete(lock);
+}
+
+struct _CompressJobs {
+
+	const uint8_t *src;
+	int len;
+	int block_size;
+	Compression::Mode mode;
+	uint8_t *dst; //one max sized slot per block
+	int dst_slot;
+	int *sizes;
+};
+
+static void _compress_block(void *p_ud, int p_idx) {
+
+	_CompressJobs *cj=(_CompressJobs*)p_ud;
+	int from=p_idx*cj->block_size;
+	int bl=MIN(cj->block_size,cj->len-from);
+	cj->sizes[p_idx]=Compression::compress(&cj->dst[p_idx*cj->dst_slot],&cj->src[from],bl,cj->mode);
+}
+
+struct _DecompressJobs {
+
+	const uint8_t *src;
+	const int *offsets;
+	const int *sizes;
+	uint8_t *dst;
+	int block_size;
+	Compression::Mode mode;
+};
+
+static void _decompress_block(void *p_ud, int p_idx) {
+
+	_DecompressJobs *dj=(_DecompressJobs*)p_ud;
+	Compression::decompress(&dj->dst[p_idx*dj->block_size],dj->block_size,&dj->src[dj->offsets[p_idx]],dj->sizes[p_idx],dj->mode);
+}
+
+void FileAccessCompressed::compress_buffer(const uint8_t *p_src, int p_len, Vector<uint8_t>& r_dst, const String& p_magic, Compression::Mode p_mode, int p_block_size) {
+
+	CharString mgc = p_magic.ascii();
+	ERR_FAIL_COND(mgc.length()!=4);
+
+	int bc=(p_len/p_block_size)+1;
+	int slot=Compression::get_max_compressed_buffer_size(p_block_size,p_mode);
+
+	Vector<uint8_t> cdata;
+	cdata.resize(bc*slot);
+	Vector<int> block_sizes;
+	block_sizes.resize(bc);
+
+	_CompressJobs cj;
+	cj.src=p_src;
+	cj.len=p_len;
+	cj.block_size=p_block_size;
+	cj.mode=p_mode;
+	cj.dst=cdata.ptr();
+	cj.dst_slot=slot;
+	cj.sizes=block_sizes.ptr();
+	_run_block_jobs(bc,_compress_block,&cj,p_len>=PARALLEL_MIN_SIZE);
+
+	int total=16+bc*4+4;
+	for(int i=0;i<bc;i++)
+		total+=block_sizes[i];
+
+	r_dst.resize(total);
+	uint8_t *w=r_dst.ptr();
+
+	copymem(w,mgc.get_data(),4); //header 4
+	encode_uint32(p_mode,&w[4]); //compression mode 4
+	encode_uint32(p_block_size,&w[8]); //block size 4
+	encode_uint32(p_len,&w[12]); //max amount of data written 4
+	int ofs=16;
+	for(int i=0;i<bc;i++) {
+		encode_uint32(block_sizes[i],&w[ofs]);
+		ofs+=4;
+	}
+	for(int i=0;i<bc;i++) {
+		copymem(&w[ofs],&cj.dst[i*slot],block_sizes[i]);
+		ofs+=block_sizes[i];
+	}
+	copymem(&w[ofs],mgc.get_data(),4); //magic at the end too
+}
+
 void FileAccessCompressed::configure(const String& p_magic, Compression::Mode p_mode, int p_block_size) {
 
 	magic=p_magic.ascii().get_data();
@@ -64,14 +214,29 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 	cmode=(Compression::Mode)f->get_32();
 	block_size=f->get_32();
 	read_total=f->get_32();
+
+	//everything below is sized from the header, make sure it fits in the file
+	size_t len=f->get_len();
+	if (cmode<Compression::MODE_FASTLZ || cmode>Compression::MODE_LZ4 || block_size<=0 || block_size>(1<<24) || read_total<0 || size_t(read_total/block_size)>=len/4) {
+		f=NULL;
+		ERR_EXPLAIN("Corrupt compressed file header");
+		ERR_FAIL_V(ERR_FILE_CORRUPT);
+	}
+
 	int bc = (read_total/block_size)+1;
-	int acc_ofs=f->get_pos()+bc*4;
+	size_t acc_ofs=f->get_pos()+bc*4;
 	int max_bs=0;
+	read_blocks.clear();
 	for(int i=0;i<bc;i++) {
 
 		ReadBlock rb;
 		rb.offset=acc_ofs;
 		rb.csize=f->get_32();
+		if (rb.csize<0 || size_t(rb.csize)>len-MIN(acc_ofs,len)) {
+			f=NULL;
+			ERR_EXPLAIN("Corrupt compressed file block table");
+			ERR_FAIL_V(ERR_FILE_CORRUPT);
+		}
 		acc_ofs+=rb.csize;
 		max_bs=MAX(max_bs,rb.csize);
 		read_blocks.push_back(rb);
@@ -82,16 +247,19 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 	comp_buffer.resize(max_bs);
 	buffer.resize(block_size);
 	read_ptr=buffer.ptr();
-	f->get_buffer(comp_buffer.ptr(),read_blocks[0].csize);
 	at_end=false;
 	read_eof=false;
 	read_block_count=bc;
-	read_block_size=read_blocks.size()==1?read_total:block_size;
-
-	Compression::decompress(buffer.ptr(),read_block_size,comp_buffer.ptr(),read_blocks[0].csize,cmode);
+	read_block_size=_get_block_size(0);
 	read_block=0;
 	read_pos=0;
 
+	if (f->get_buffer(comp_buffer.ptr(),read_blocks[0].csize)!=read_blocks[0].csize || Compression::decompress(buffer.ptr(),read_block_size,comp_buffer.ptr(),read_blocks[0].csize,cmode)<0) {
+		f=NULL;
+		ERR_EXPLAIN("Corrupt compressed file data");
+		ERR_FAIL_V(ERR_FILE_CORRUPT);
+	}
+
 	return OK;
 
 }
@@ -137,7 +305,12 @@ Error FileAccessCompressed::_open(const String& p_path, int p_mode_flags){
 			return ERR_FILE_UNRECOGNIZED;
 		}
 
-		open_after_magic(f);
+		FileAccess *base=f;
+		Error err=open_after_magic(base);
+		if (err!=OK) {
+			memdelete(base);
+			return err;
+		}
 
 	}
 
@@ -153,37 +326,9 @@ void FileAccessCompressed::close(){
 	if (writing) {
 		//save block table and all compressed blocks
 
-		CharString mgc = magic.utf8();
-		f->store_buffer((const uint8_t*)mgc.get_data(),mgc.length()); //write header 4
-		f->store_32(cmode); //write compression mode 4
-		f->store_32(block_size); //write block size 4
-		f->store_32(write_max); //max amount of data written 4
-		int bc=(write_max/block_size)+1;
-
-		for(int i=0;i<bc;i++) {
-			f->store_32(0); //compressed sizes, will update later
-		}
-
-
-		Vector<int> block_sizes;
-		for(int i=0;i<bc;i++) {
-
-			int bl = i==(bc-1) ? write_max % block_size : block_size;
-			uint8_t *bp = &write_ptr[i*block_size];
-
-			Vector<uint8_t> cblock;
-			cblock.resize(Compression::get_max_compressed_buffer_size(bl,cmode));
-			int s = Compression::compress(cblock.ptr(),bp,bl,cmode);
-
-			f->store_buffer(cblock.ptr(),s);
-			block_sizes.push_back(s);
-		}
-
-		f->seek(16); //ok write block sizes
-		for(int i=0;i<bc;i++)
-			f->store_32(block_sizes[i]);
-		f->seek_end();
-		f->store_buffer((const uint8_t*)mgc.get_data(),mgc.length()); //magic at the end too
+		Vector<uint8_t> data;
+		compress_buffer(write_ptr,write_max,data,magic,cmode,block_size);
+		f->store_buffer(data.ptr(),data.size());
 
 		buffer.clear();
 
@@ -217,18 +362,21 @@ void FileAccessCompressed::seek(size_t p_position){
 	} else {
 
 		ERR_FAIL_COND(p_position>read_total);
+		read_eof=false;
 		if (p_position==read_total) {
 			at_end=true;
 		} else {
 
+			at_end=false;
+
 			int block_idx = p_position/block_size;
 			if (block_idx!=read_block) {
 
 				read_block=block_idx;
 				f->seek(read_blocks[read_block].offset);
 				f->get_buffer(comp_buffer.ptr(),read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptr(),read_blocks.size()==1?read_total:block_size,comp_buffer.ptr(),read_blocks[read_block].csize,cmode);
-				read_block_size=read_block==read_block_count-1?read_total%block_size:block_size;
+				Compression::decompress(buffer.ptr(),_get_block_size(read_block),comp_buffer.ptr(),read_blocks[read_block].csize,cmode);
+				read_block_size=_get_block_size(read_block);
 			}
 
 			read_pos=p_position%block_size;
@@ -303,8 +451,8 @@ uint8_t FileAccessCompressed::get_8() const{
 		if (read_block<read_block_count) {
 			//read another block of compressed data
 			f->get_buffer(comp_buffer.ptr(),read_blocks[read_block].csize);
-			Compression::decompress(buffer.ptr(),read_blocks.size()==1?read_total:block_size,comp_buffer.ptr(),read_blocks[read_block].csize,cmode);
-			read_block_size=read_block==read_block_count-1?read_total%block_size:block_size;
+			Compression::decompress(buffer.ptr(),_get_block_size(read_block),comp_buffer.ptr(),read_blocks[read_block].csize,cmode);
+			read_block_size=_get_block_size(read_block);
 			read_pos=0;
 
 		} else {
@@ -317,6 +465,40 @@ uint8_t FileAccessCompressed::get_8() const{
 	return ret;
 
 }
+void FileAccessCompressed::_decompress_blocks(int p_from, int p_count, uint8_t *p_dst) const {
+
+	//blocks are contiguous, read them all at once (in place, when mapped)
+	int from_ofs=read_blocks[p_from].offset;
+	int len=read_blocks[p_from+p_count-1].offset+read_blocks[p_from+p_count-1].csize-from_ofs;
+
+	f->seek(from_ofs);
+	Vector<uint8_t> cdata;
+	const uint8_t *src=f->get_mapped_buffer(len);
+	if (!src) {
+		cdata.resize(len);
+		f->get_buffer(cdata.ptr(),len);
+		src=cdata.ptr();
+	}
+
+	Vector<int> offsets;
+	Vector<int> sizes;
+	offsets.resize(p_count);
+	sizes.resize(p_count);
+	for(int i=0;i<p_count;i++) {
+		offsets[i]=read_blocks[p_from+i].offset-from_ofs;
+		sizes[i]=read_blocks[p_from+i].csize;
+	}
+
+	_DecompressJobs dj;
+	dj.src=src;
+	dj.offsets=offsets.ptr();
+	dj.sizes=sizes.ptr();
+	dj.dst=p_dst;
+	dj.block_size=block_size;
+	dj.mode=cmode;
+	_run_block_jobs(p_count,_decompress_block,&dj,p_count*block_size>=PARALLEL_MIN_SIZE);
+}
+
 int FileAccessCompressed::get_buffer(uint8_t *p_dst, int p_length) const{
 
 	ERR_FAIL_COND_V(writing,0);
@@ -327,32 +509,49 @@ int FileAccessCompressed::get_buffer(uint8_t *p_dst, int p_length) const{
 		return 0;
 	}
 
+	int dst_ofs=0;
 
-	for(int i=0;i<p_length;i++) {
+	while(true) {
 
+		int n=MIN(read_block_size-read_pos,p_length-dst_ofs);
+		copymem(&p_dst[dst_ofs],&read_ptr[read_pos],n);
+		dst_ofs+=n;
+		read_pos+=n;
+		if (read_pos<read_block_size)
+			return p_length;
 
-		p_dst[i]=read_ptr[read_pos];
-		read_pos++;
-		if (read_pos>=read_block_size) {
-			read_block++;
+		//whole blocks that fit go straight to the destination, the last one (partial) is read as usual
+		int whole=MIN((p_length-dst_ofs)/block_size,read_block_count-read_block-2);
+		if (whole>0) {
 
-			if (read_block<read_block_count) {
-				//read another block of compressed data
-				f->get_buffer(comp_buffer.ptr(),read_blocks[read_block].csize);
-				Compression::decompress(buffer.ptr(),read_blocks.size()==1?read_total:block_size,comp_buffer.ptr(),read_blocks[read_block].csize,cmode);
-				read_block_size=read_block==read_block_count-1?read_total%block_size:block_size;
-				read_pos=0;
+			_decompress_blocks(read_block+1,whole,&p_dst[dst_ofs]);
+			dst_ofs+=whole*block_size;
+			read_block+=whole;
+			//keep the buffer in sync with the current block
+			copymem(buffer.ptr(),&p_dst[dst_ofs-block_size],block_size);
+			read_block_size=block_size;
+			read_pos=block_size;
+		}
 
-			} else {
-				read_block--;
-				at_end=true;
-				if (i<p_length-1)
-				 read_eof=true;
-				return i;
+		read_block++;
 
-			}
+		if (read_block<read_block_count) {
+			//read another block of compressed data
+			f->get_buffer(comp_buffer.ptr(),read_blocks[read_block].csize);
+			Compression::decompress(buffer.ptr(),_get_block_size(read_block),comp_buffer.ptr(),read_blocks[read_block].csize,cmode);
+			read_block_size=_get_block_size(read_block);
+			read_pos=0;
+
+		} else {
+			read_block--;
+			at_end=true;
+			if (dst_ofs<p_length)
+			 read_eof=true;
+			return dst_ofs;
 		}
 
+		if (dst_ofs==p_length)
+			return p_length;
 	}
 
 	return p_length;
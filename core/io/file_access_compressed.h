@@ -64,10 +64,15 @@ class FileAccessCompressed : public FileAccess {
 	String magic;
 	mutable Vector<uint8_t> buffer;
 	FileAccess *f;
+
+	void _decompress_blocks(int p_from, int p_count, uint8_t *p_dst) const;
+	_FORCE_INLINE_ int _get_block_size(int p_block) const { return p_block==read_block_count-1 ? read_total%block_size : block_size; } ///< uncompressed, the last one is partial
 public:
 
 	void configure(const String& p_magic, Compression::Mode p_mode=Compression::MODE_FASTLZ, int p_block_size=4096);
 
+	static void compress_buffer(const uint8_t *p_src, int p_len, Vector<uint8_t>& r_dst, const String& p_magic="GCMP", Compression::Mode p_mode=Compression::MODE_FASTLZ, int p_block_size=4096); ///< same data close() writes, blocks are compressed in parallel
+
 	Error open_after_magic(FileAccess *p_base);
 
 	virtual Error _open(const String& p_path, int p_mode_flags); ///< open a file
@@ -158,6 +158,16 @@ int FileAccessMemory::get_buffer(uint8_t *p_dst,int p_length) const {
 	return read;
 };
 
+const uint8_t *FileAccessMemory::get_mapped_buffer(int p_length) const {
+
+	if (!data || pos+p_length>length)
+		return NULL;
+
+	const uint8_t *ptr = &data[pos];
+	pos += p_length;
+	return ptr;
+};
+
 Error FileAccessMemory::get_error() const {
 
 	return pos >= length ? ERR_FILE_EOF : OK;
@@ -28,13 +28,26 @@
 /*************************************************************************/
 #include "file_access_pack.h"
 #include "version.h"
+#include "hashfuncs.h"
+#include "io/marshalls.h"
+#include "io/file_access_compressed.h"
 
 #include <stdio.h>
+#include <string.h>
 
-#define PACK_VERSION 0
+/* Version 1 packs use the first reserved header fields for a hash index:
+   u64 index offset and u32 bucket count, then u32 size of the file table
+   (which starts at the file count). The index offset is relative to the
+   pack start. Each bucket is u32 path hash and u32 offset of the entry from
+   the start of the table, zero when the bucket is empty.
+   Version 2 adds u32 flags after the MD5 of each file entry. */
+
+#define PACK_VERSION 2
+#define PACK_BLOCK_SIZE 16384
 
 Error PackedData::add_pack(const String& p_path) {
 
+	pack_order++;
 	for (int i=0; i<sources.size(); i++) {
 
 		if (sources[i]->try_open_pack(p_path)) {
@@ -46,7 +59,7 @@ Error PackedData::add_pack(const String& p_path) {
 	return ERR_FILE_UNRECOGNIZED;
 };
 
-void PackedData::add_path(const String& pkg_path, const String& path, uint64_t ofs, uint64_t size,const uint8_t* p_md5, PackSource* p_src) {
+void PackedData::add_path(const String& pkg_path, const String& path, uint64_t ofs, uint64_t size,const uint8_t* p_md5, PackSource* p_src, uint32_t p_flags) {
 
 	PathMD5 pmd5(path.md5_buffer());
 	//printf("adding path %ls, %lli, %lli\n", path.c_str(), pmd5.a, pmd5.b);
@@ -60,34 +73,206 @@ void PackedData::add_path(const String& pkg_path, const String& path, uint64_t o
 	for(int i=0;i<16;i++)
 		pf.md5[i]=p_md5[i];
 	pf.src = p_src;
+	pf.order=pack_order;
+	pf.flags=p_flags;
 
 	files[pmd5]=pf;
 
 	if (!exists) {
-		//search for dir
-		String p = path.replace_first("res://","");
-		PackedDir *cd=root;
+		_add_dir_path(path);
+	}
+}
+
+void PackedData::_add_dir_path(const String& p_path) {
+
+	//search for dir
+	String p = p_path.replace_first("res://","");
+	PackedDir *cd=root;
+
+	if (p.find("/")!=-1) { //in a subdir
+
+		Vector<String> ds=p.get_base_dir().split("/");
+
+		for(int j=0;j<ds.size();j++) {
+
+			if (!cd->subdirs.has(ds[j])) {
+
+				PackedDir *pd = memnew( PackedDir );
+				pd->name=ds[j];
+				pd->parent=cd;
+				cd->subdirs[pd->name]=pd;
+				cd=pd;
+			} else {
+				cd=cd->subdirs[ds[j]];
+			}
+		}
+	}
+	cd->files.insert(p_path.get_file());
+}
+
+Error PackedData::add_index(const String& p_pack, FileAccess *p_file, int p_version, uint64_t p_table_ofs, uint32_t p_table_size, uint64_t p_index_ofs, uint32_t p_buckets, PackSource* p_src) {
+
+	ERR_FAIL_COND_V(p_buckets==0 || (p_buckets&(p_buckets-1)) || p_table_size<4, ERR_INVALID_DATA);
+	ERR_FAIL_COND_V(p_table_ofs+p_table_size>p_file->get_len() || p_index_ofs+uint64_t(p_buckets)*8>p_file->get_len(), ERR_INVALID_DATA);
+
+	PackIndex *pi = memnew( PackIndex );
+	pi->pack=p_pack;
+	pi->f=p_file;
+	pi->table_size=p_table_size;
+	pi->entry_size=p_version>=2 ? 36 : 32;
+	pi->bucket_mask=p_buckets-1;
+	pi->src=p_src;
+	pi->order=pack_order;
+	pi->listed=false;
+
+	p_file->seek(p_table_ofs);
+	pi->table=p_file->get_mapped_buffer(p_table_size);
+	if (!pi->table) {
+		pi->table_data.resize(p_table_size);
+		p_file->get_buffer(pi->table_data.ptr(),p_table_size);
+		pi->table=pi->table_data.ptr();
+	}
+
+	p_file->seek(p_index_ofs);
+	pi->buckets=p_file->get_mapped_buffer(p_buckets*8);
+	if (!pi->buckets) {
+		pi->bucket_data.resize(p_buckets*8);
+		p_file->get_buffer(pi->bucket_data.ptr(),p_buckets*8);
+		pi->buckets=pi->bucket_data.ptr();
+	}
+
+	indices.push_back(pi);
+	dirs_pending=true;
+
+	return OK;
+}
+
+bool PackedData::_find_indexed(const String& p_path,int p_min_order,PackedFile *r_file) const {
+
+	CharString cs=p_path.utf8();
+	uint32_t len=cs.length();
+	uint32_t hash=hash_path(cs);
+
+	for(int i=indices.size()-1;i>=0;i--) {
+
+		const PackIndex *pi=indices[i];
+		if (pi->order<=p_min_order)
+			break;
 
-		if (p.find("/")!=-1) { //in a subdir
+		uint32_t b=hash&pi->bucket_mask;
+		for(uint32_t j=0;j<=pi->bucket_mask;j++) {
 
-			Vector<String> ds=p.get_base_dir().split("/");
+			const uint8_t *bucket=&pi->buckets[b*8];
+			uint32_t entry=decode_uint32(&bucket[4]);
+			if (entry==0)
+				break; //not in this pack
 
-			for(int j=0;j<ds.size();j++) {
+			if (decode_uint32(bucket)==hash && uint64_t(entry)+4<=pi->table_size) {
 
-				if (!cd->subdirs.has(ds[j])) {
+				const uint8_t *e=&pi->table[entry];
+				uint32_t sl=decode_uint32(e);
+				if (sl==len && uint64_t(entry)+4+sl+pi->entry_size<=pi->table_size && memcmp(&e[4],cs.get_data(),len)==0) {
 
-					PackedDir *pd = memnew( PackedDir );
-					pd->name=ds[j];
-					pd->parent=cd;
-					cd->subdirs[pd->name]=pd;
-					cd=pd;
-				} else {
-					cd=cd->subdirs[ds[j]];
+					e+=4+sl;
+					r_file->pack=pi->pack;
+					r_file->offset=decode_uint64(e);
+					r_file->size=decode_uint64(&e[8]);
+					for(int k=0;k<16;k++)
+						r_file->md5[k]=e[16+k];
+					r_file->src=pi->src;
+					r_file->order=pi->order;
+					r_file->flags=pi->entry_size>32 ? decode_uint32(&e[32]) : 0;
+					return true;
 				}
 			}
+
+			b=(b+1)&pi->bucket_mask;
+		}
+	}
+
+	return false;
+}
+
+PackedData::PackedDir *PackedData::_get_root() {
+
+	GLOBAL_LOCK_FUNCTION
+
+	if (!dirs_pending)
+		return root;
+
+	//listing is rare, the directory tree is built the first time it's needed
+	for(int i=0;i<indices.size();i++) {
+
+		PackIndex *pi=indices[i];
+		if (pi->listed)
+			continue;
+
+		uint32_t count=decode_uint32(pi->table);
+		uint64_t ofs=4;
+		for(uint32_t j=0;j<count && ofs+4<=pi->table_size;j++) {
+
+			uint32_t sl=decode_uint32(&pi->table[ofs]);
+			if (ofs+4+sl+pi->entry_size>pi->table_size)
+				break;
+
+			CharString cs;
+			cs.resize(sl+1);
+			memcpy(cs.ptr(),&pi->table[ofs+4],sl);
+			cs[sl]=0;
+			String path;
+			path.parse_utf8(cs.ptr());
+			_add_dir_path(path);
+
+			ofs+=4+sl+pi->entry_size;
 		}
-		cd->files.insert(path.get_file());
+
+		pi->listed=true;
+	}
+
+	dirs_pending=false;
+	return root;
+}
+
+uint32_t PackedData::hash_path(const CharString& p_utf8) {
+
+	return hash_djb2_buffer((const uint8_t*)p_utf8.get_data(),p_utf8.length());
+}
+
+bool PackedData::compress_file(const uint8_t *p_src, int p_len, Vector<uint8_t>& r_dst, Compression::Mode p_mode) {
+
+	FileAccessCompressed::compress_buffer(p_src,p_len,r_dst,"GCPK",p_mode,PACK_BLOCK_SIZE);
+	//already compressed formats barely shrink, those are stored as they are
+	return r_dst.size() < p_len-p_len/16;
+}
+
+uint32_t PackedData::store_hash_index(FileAccess *p_file, const Vector<String>& p_paths, const Vector<uint32_t>& p_entries) {
+
+	ERR_FAIL_COND_V(p_paths.size()!=p_entries.size(),0);
+
+	//at most half full, so probes stay short
+	uint32_t bucket_count=nearest_power_of_2(MAX(p_paths.size()*2,1));
+	uint32_t mask=bucket_count-1;
+
+	Vector<uint32_t> buckets;
+	buckets.resize(bucket_count*2);
+	for(int i=0;i<buckets.size();i++)
+		buckets[i]=0;
+
+	for(int i=0;i<p_paths.size();i++) {
+
+		uint32_t hash=hash_path(p_paths[i].utf8());
+		uint32_t b=hash&mask;
+		while(buckets[b*2+1])
+			b=(b+1)&mask;
+
+		buckets[b*2]=hash;
+		buckets[b*2+1]=p_entries[i];
 	}
+
+	for(int i=0;i<buckets.size();i++)
+		p_file->store_32(buckets[i]);
+
+	return bucket_count;
 }
 
 void PackedData::add_pack_source(PackSource *p_source) {
@@ -103,10 +288,21 @@ PackedData::PackedData() {
 	root=memnew(PackedDir);
 	root->parent=NULL;
 	disabled=false;
+	pack_order=0;
+	dirs_pending=false;
 
 	add_pack_source(memnew(PackedSourcePCK));
 }
 
+PackedData::~PackedData() {
+
+	for(int i=0;i<indices.size();i++) {
+
+		memdelete(indices[i]->f);
+		memdelete(indices[i]);
+	}
+}
+
 
 //////////////////////////////////////////////////////////////////
 
@@ -118,6 +314,7 @@ bool PackedSourcePCK::try_open_pack(const String& p_path) {
 
 	//printf("try open %ls!\n", p_path.c_str());
 
+	uint64_t pack_start = 0;
 	uint32_t magic= f->get_32();
 
 	if (magic != 0x43504447) {
@@ -135,6 +332,7 @@ bool PackedSourcePCK::try_open_pack(const String& p_path) {
 
 		uint64_t ds = f->get_64();
 		f->seek( f->get_pos() -ds-8 );
+		pack_start = f->get_pos();
 
 		magic = f->get_32();
 		if (magic != 0x43504447) {
@@ -155,11 +353,33 @@ bool PackedSourcePCK::try_open_pack(const String& p_path) {
 	ERR_EXPLAIN("Pack created with a newer version of the engine: "+itos(ver_major)+"."+itos(ver_minor)+"."+itos(ver_rev));
 	ERR_FAIL_COND_V( ver_major > VERSION_MAJOR || (ver_major == VERSION_MAJOR && ver_minor > VERSION_MINOR), ERR_INVALID_DATA);
 
-	for(int i=0;i<16;i++) {
+	uint64_t index_ofs = 0;
+	uint32_t bucket_count = 0;
+	uint32_t table_size = 0;
+	int reserved = 16;
+
+	if (version>=1) {
+		index_ofs = f->get_64();
+		bucket_count = f->get_32();
+		table_size = f->get_32();
+		reserved-=4;
+	}
+
+	for(int i=0;i<reserved;i++) {
 		//reserved
 		f->get_32();
 	}
 
+	if (bucket_count) {
+		//nothing to read, the index is used in place
+		uint64_t table_ofs = f->get_pos();
+		if (PackedData::get_singleton()->add_index(p_path, f, version, table_ofs, table_size, pack_start+index_ofs, bucket_count, this)!=OK) {
+			memdelete(f);
+			return false;
+		}
+		return true;
+	}
+
 	int file_count = f->get_32();
 
 	for(int i=0;i<file_count;i++) {
@@ -177,15 +397,35 @@ bool PackedSourcePCK::try_open_pack(const String& p_path) {
 		uint64_t size = f->get_64();
 		uint8_t md5[16];
 		f->get_buffer(md5,16);
-		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5,this);
+		uint32_t flags = version>=2 ? f->get_32() : 0;
+		PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5,this,flags);
 	};
 
+	memdelete(f);
 	return true;
 };
 
 FileAccess* PackedSourcePCK::get_file(const String &p_path, PackedData::PackedFile* p_file) {
 
-	return memnew( FileAccessPack(p_path, *p_file));
+	FileAccess *f = memnew( FileAccessPack(p_path, *p_file));
+	if (!(p_file->flags&PackedData::PACK_FILE_COMPRESSED))
+		return f;
+
+	uint8_t magic[4];
+	if (f->get_buffer(magic,4)!=4 || magic[0]!='G' || magic[1]!='C' || magic[2]!='P' || magic[3]!='K') {
+		memdelete(f);
+		ERR_EXPLAIN("Invalid compressed file in pack: "+p_path);
+		ERR_FAIL_V(NULL);
+	}
+
+	FileAccessCompressed *fc = memnew( FileAccessCompressed );
+	if (fc->open_after_magic(f)!=OK) {
+		memdelete(fc);
+		memdelete(f);
+		ERR_EXPLAIN("Invalid compressed file in pack: "+p_path);
+		ERR_FAIL_V(NULL);
+	}
+	return fc; //owns the pack file access now
 };
 
 //////////////////////////////////////////////////////////////////
@@ -248,6 +488,35 @@ uint8_t FileAccessPack::get_8() const {
 	return f->get_8();
 }
 
+//the pack file reads multi-byte values in one go (mapped, mostly)
+
+uint16_t FileAccessPack::get_16() const {
+
+	if (pos+2>pf.size)
+		return FileAccess::get_16();
+
+	pos+=2;
+	return f->get_16();
+}
+
+uint32_t FileAccessPack::get_32() const {
+
+	if (pos+4>pf.size)
+		return FileAccess::get_32();
+
+	pos+=4;
+	return f->get_32();
+}
+
+uint64_t FileAccessPack::get_64() const {
+
+	if (pos+8>pf.size)
+		return FileAccess::get_64();
+
+	pos+=8;
+	return f->get_64();
+}
+
 
 int FileAccessPack::get_buffer(uint8_t *p_dst,int p_length) const {
 
@@ -269,6 +538,18 @@ int FileAccessPack::get_buffer(uint8_t *p_dst,int p_length) const {
 	return to_read;
 }
 
+const uint8_t *FileAccessPack::get_mapped_buffer(int p_length) const {
+
+	ERR_FAIL_COND_V(p_length<0,NULL);
+	if (eof || pos>pf.size || uint64_t(p_length)>pf.size-pos)
+		return NULL;
+
+	const uint8_t *ptr=f->get_mapped_buffer(p_length);
+	if (ptr)
+		pos+=p_length;
+	return ptr;
+}
+
 void FileAccessPack::set_endian_swap(bool p_swap) {
 	FileAccess::set_endian_swap(p_swap);
 	f->set_endian_swap(p_swap);
@@ -302,7 +583,7 @@ bool FileAccessPack::file_exists(const String& p_name) {
 FileAccessPack::FileAccessPack(const String& p_path, const PackedData::PackedFile& p_file) {
 
 	pf=p_file;
-	f=FileAccess::open(pf.pack,FileAccess::READ);
+	f=FileAccess::open_mapped(pf.pack); //packs are not written while the game runs
 	if (!f) {
 		ERR_EXPLAIN("Can't open pack-referenced file: "+String(pf.pack));
 		ERR_FAIL_COND(!f);
@@ -398,7 +679,7 @@ Error DirAccessPack::change_dir(String p_dir) {
 	PackedData::PackedDir *pd;
 
 	if (absolute)
-		pd = PackedData::get_singleton()->root;
+		pd = PackedData::get_singleton()->_get_root();
 	else
 		pd = current;
 
@@ -476,7 +757,7 @@ size_t DirAccessPack::get_space_left(){
 
 DirAccessPack::DirAccessPack() {
 
-	current=PackedData::get_singleton()->root;
+	current=PackedData::get_singleton()->_get_root();
 	cdir=false;
 }
 
@@ -34,6 +34,7 @@
 #include "map.h"
 #include "list.h"
 #include "print_string.h"
+#include "io/compression.h"
 
 class PackSource;
 
@@ -43,6 +44,11 @@ friend class DirAccessPack;
 friend class PackSource;
 
 public:
+
+	enum {
+		PACK_FILE_COMPRESSED=1 ///< stored as FileAccessCompressed blocks, so it can be seeked and read in parallel
+	};
+
 	struct PackedFile {
 
 		String pack;
@@ -50,6 +56,8 @@ public:
 		uint64_t size;
 		uint8_t md5[16];
 		PackSource* src;
+		int order; //packs added later override the earlier ones
+		uint32_t flags;
 	};
 
 private:
@@ -86,7 +94,26 @@ private:
 		};
 	};
 
+	/* Packs with a hash index are not loaded into the map, the index and
+	   the file table are probed where they are (mapped, when possible). */
+	struct PackIndex {
+
+		String pack;
+		FileAccess *f;
+		const uint8_t *table;
+		const uint8_t *buckets;
+		Vector<uint8_t> table_data; //copies, when the file can't be mapped
+		Vector<uint8_t> bucket_data;
+		uint32_t table_size;
+		uint32_t entry_size; //after the path, depends on the pack version
+		uint32_t bucket_mask;
+		PackSource *src;
+		int order;
+		bool listed; //paths were added to the directory tree
+	};
+
 	Map<PathMD5,PackedFile> files;
+	Vector<PackIndex*> indices;
 
 	Vector<PackSource*> sources;
 
@@ -95,11 +122,22 @@ private:
 
 	static PackedData *singleton;
 	bool disabled;
+	int pack_order;
+	bool dirs_pending;
+
+	void _add_dir_path(const String& p_path);
+	PackedDir *_get_root();
+	bool _find_indexed(const String& p_path,int p_min_order,PackedFile *r_file) const;
 
 public:
 
 	void add_pack_source(PackSource* p_source);
-	void add_path(const String& pkg_path, const String& path, uint64_t ofs, uint64_t size,const uint8_t* p_md5, PackSource* p_src); // for PackSource
+	void add_path(const String& pkg_path, const String& path, uint64_t ofs, uint64_t size,const uint8_t* p_md5, PackSource* p_src, uint32_t p_flags=0); // for PackSource
+	Error add_index(const String& p_pack, FileAccess *p_file, int p_version, uint64_t p_table_ofs, uint32_t p_table_size, uint64_t p_index_ofs, uint32_t p_buckets, PackSource* p_src); // for PackSource, takes the file
+
+	static uint32_t hash_path(const CharString& p_utf8);
+	static uint32_t store_hash_index(FileAccess *p_file, const Vector<String>& p_paths, const Vector<uint32_t>& p_entries); ///< for pack writers, returns the bucket count
+	static bool compress_file(const uint8_t *p_src, int p_len, Vector<uint8_t>& r_dst, Compression::Mode p_mode); ///< for pack writers, false if not worth storing compressed
 
 	void set_disabled(bool p_disabled) { disabled=p_disabled; }
 	_FORCE_INLINE_ bool is_disabled() const { return disabled; }
@@ -111,6 +149,7 @@ public:
 	_FORCE_INLINE_ bool has_path(const String& p_path);
 
 	PackedData();
+	~PackedData();
 };
 
 class PackSource {
@@ -155,9 +194,13 @@ public:
 	virtual bool eof_reached() const;
 
 	virtual uint8_t get_8() const;
+	virtual uint16_t get_16() const;
+	virtual uint32_t get_32() const;
+	virtual uint64_t get_64() const;
 
 
 	virtual int get_buffer(uint8_t *p_dst,int p_length) const;
+	virtual const uint8_t *get_mapped_buffer(int p_length) const;
 
 	virtual void set_endian_swap(bool p_swap);
 
@@ -178,19 +221,32 @@ public:
 FileAccess *PackedData::try_open_path(const String& p_path) {
 
 	//print_line("try open path " + p_path);
-	PathMD5 pmd5(p_path.md5_buffer());
-	Map<PathMD5,PackedFile>::Element *E=files.find(pmd5);
-	if (!E)
+	PackedFile *pf=NULL;
+	if (!files.empty()) {
+		Map<PathMD5,PackedFile>::Element *E=files.find(PathMD5(p_path.md5_buffer()));
+		if (E)
+			pf=&E->get();
+	}
+
+	PackedFile ipf;
+	if (indices.size() && _find_indexed(p_path,pf?pf->order:-1,&ipf))
+		pf=&ipf;
+
+	if (!pf)
 		return NULL; //not found
-	if (E->get().offset==0)
+	if (pf->offset==0)
 		return NULL; //was erased
 
-	return E->get().src->get_file(p_path, &E->get());
+	return pf->src->get_file(p_path, pf);
 }
 
 bool PackedData::has_path(const String& p_path) {
 
-	return files.has(PathMD5(p_path.md5_buffer()));
+	if (!files.empty() && files.has(PathMD5(p_path.md5_buffer())))
+		return true;
+
+	PackedFile ipf;
+	return indices.size() && _find_indexed(p_path,-1,&ipf);
 }
 
 
@@ -31,6 +31,8 @@
 #include "globals.h"
 #include "io/file_access_compressed.h"
 #include "io/marshalls.h"
+#include "os/os.h"
+#include "os/thread.h"
 //#define print_bl(m_what) print_line(m_what)
 #define print_bl(m_what)
 
@@ -99,13 +101,14 @@ enum {
 	OBJECT_EMPTY=0,
 	OBJECT_EXTERNAL_RESOURCE=1,
 	OBJECT_INTERNAL_RESOURCE=2,
-	FORMAT_VERSION=0
+	FORMAT_VERSION=0,
+	PAYLOAD_MIN_SIZE=32768 //images and arrays this big are listed in the payload table
 
 
 };
 
 
-void ResourceInteractiveLoaderBinary::_advance_padding(uint32_t p_len) {
+static void _skip_padding(FileAccess *f,uint32_t p_len) {
 
 	uint32_t extra = 4-(p_len%4);
 	if (extra<4) {
@@ -115,6 +118,240 @@ void ResourceInteractiveLoaderBinary::_advance_padding(uint32_t p_len) {
 
 }
 
+//images and packed arrays, the bulk of most files. These don't reference
+//anything else, so they can be decoded from any thread and in any order.
+static Error _parse_payload(FileAccess *f,uint32_t p_type,Variant& r_v) {
+
+	switch(p_type) {
+
+		case VARIANT_IMAGE: {
+
+
+			uint32_t encoding = f->get_32();
+			if (encoding==IMAGE_ENCODING_EMPTY) {
+				r_v=Variant();
+				break;
+			} else if (encoding==IMAGE_ENCODING_RAW) {
+				uint32_t width = f->get_32();
+				uint32_t height = f->get_32();
+				uint32_t mipmaps = f->get_32();
+				uint32_t format = f->get_32();
+				Image::Format fmt;
+				switch(format) {
+
+					case IMAGE_FORMAT_GRAYSCALE: { fmt=Image::FORMAT_GRAYSCALE; } break;
+					case IMAGE_FORMAT_INTENSITY: { fmt=Image::FORMAT_INTENSITY; } break;
+					case IMAGE_FORMAT_GRAYSCALE_ALPHA: { fmt=Image::FORMAT_GRAYSCALE_ALPHA; } break;
+					case IMAGE_FORMAT_RGB: { fmt=Image::FORMAT_RGB; } break;
+					case IMAGE_FORMAT_RGBA: { fmt=Image::FORMAT_RGBA; } break;
+					case IMAGE_FORMAT_INDEXED: { fmt=Image::FORMAT_INDEXED; } break;
+					case IMAGE_FORMAT_INDEXED_ALPHA: { fmt=Image::FORMAT_INDEXED_ALPHA; } break;
+					case IMAGE_FORMAT_BC1: { fmt=Image::FORMAT_BC1; } break;
+					case IMAGE_FORMAT_BC2: { fmt=Image::FORMAT_BC2; } break;
+					case IMAGE_FORMAT_BC3: { fmt=Image::FORMAT_BC3; } break;
+					case IMAGE_FORMAT_BC4: { fmt=Image::FORMAT_BC4; } break;
+					case IMAGE_FORMAT_BC5: { fmt=Image::FORMAT_BC5; } break;
+					case IMAGE_FORMAT_PVRTC2: { fmt=Image::FORMAT_PVRTC2; } break;
+					case IMAGE_FORMAT_PVRTC2_ALPHA: { fmt=Image::FORMAT_PVRTC2_ALPHA; } break;
+					case IMAGE_FORMAT_PVRTC4: { fmt=Image::FORMAT_PVRTC4; } break;
+					case IMAGE_FORMAT_PVRTC4_ALPHA: { fmt=Image::FORMAT_PVRTC4_ALPHA; } break;
+					case IMAGE_FORMAT_ETC: { fmt=Image::FORMAT_ETC; } break;
+					case IMAGE_FORMAT_ATC: { fmt=Image::FORMAT_ATC; } break;
+					case IMAGE_FORMAT_ATC_ALPHA_EXPLICIT: { fmt=Image::FORMAT_ATC_ALPHA_EXPLICIT; } break;
+					case IMAGE_FORMAT_ATC_ALPHA_INTERPOLATED: { fmt=Image::FORMAT_ATC_ALPHA_INTERPOLATED; } break;
+					case IMAGE_FORMAT_CUSTOM: { fmt=Image::FORMAT_CUSTOM; } break;
+					default: {
+
+						ERR_FAIL_V(ERR_FILE_CORRUPT);
+					}
+
+				}
+
+
+				uint32_t datalen = f->get_32();
+
+				DVector<uint8_t> imgdata;
+				imgdata.resize(datalen);
+				DVector<uint8_t>::Write w = imgdata.write();
+				f->get_buffer(w.ptr(),datalen);
+				_skip_padding(f,datalen);
+				w=DVector<uint8_t>::Write();
+
+				r_v=Image(width,height,mipmaps,fmt,imgdata);
+
+			} else {
+				//compressed
+				DVector<uint8_t> data;
+				data.resize(f->get_32());
+				DVector<uint8_t>::Write w = data.write();
+				f->get_buffer(w.ptr(),data.size());
+				w = DVector<uint8_t>::Write();
+
+				Image img;
+
+				if (encoding==IMAGE_ENCODING_LOSSY && Image::lossy_unpacker) {
+
+					img = Image::lossy_unpacker(data);
+				} else if (encoding==IMAGE_ENCODING_LOSSLESS && Image::lossless_unpacker) {
+
+					img = Image::lossless_unpacker(data);
+				}
+				_skip_padding(f,data.size());
+
+
+				r_v=img;
+
+			}
+
+		} break;
+		case VARIANT_RAW_ARRAY: {
+
+			uint32_t len = f->get_32();
+
+			DVector<uint8_t> array;
+			array.resize(len);
+			DVector<uint8_t>::Write w = array.write();
+			f->get_buffer(w.ptr(),len);
+			_skip_padding(f,len);
+			w=DVector<uint8_t>::Write();
+			r_v=array;
+
+		} break;
+		case VARIANT_INT_ARRAY: {
+
+			uint32_t len = f->get_32();
+
+			DVector<int> array;
+			array.resize(len);
+			DVector<int>::Write w = array.write();
+			f->get_buffer((uint8_t*)w.ptr(),len*4);
+#ifdef BIG_ENDIAN_ENABLED
+			{
+				uint32_t *ptr=(uint32_t*)w.ptr();
+				for(int i=0;i<len;i++) {
+
+					ptr[i]=BSWAP32(ptr[i]);
+				}
+			}
+
+#endif
+			w=DVector<int>::Write();
+			r_v=array;
+		} break;
+		case VARIANT_REAL_ARRAY: {
+
+			uint32_t len = f->get_32();
+
+			DVector<real_t> array;
+			array.resize(len);
+			DVector<real_t>::Write w = array.write();
+			f->get_buffer((uint8_t*)w.ptr(),len*sizeof(real_t));
+#ifdef BIG_ENDIAN_ENABLED
+			{
+				uint32_t *ptr=(uint32_t*)w.ptr();
+				for(int i=0;i<len;i++) {
+
+					ptr[i]=BSWAP32(ptr[i]);
+				}
+			}
+
+#endif
+
+			w=DVector<real_t>::Write();
+			r_v=array;
+		} break;
+		case VARIANT_VECTOR2_ARRAY: {
+
+			uint32_t len = f->get_32();
+
+			DVector<Vector2> array;
+			array.resize(len);
+			DVector<Vector2>::Write w = array.write();
+			if (sizeof(Vector2)==8) {
+				f->get_buffer((uint8_t*)w.ptr(),len*sizeof(real_t)*2);
+#ifdef BIG_ENDIAN_ENABLED
+			{
+				uint32_t *ptr=(uint32_t*)w.ptr();
+				for(int i=0;i<len*2;i++) {
+
+					ptr[i]=BSWAP32(ptr[i]);
+				}
+			}
+
+#endif
+
+			} else {
+				ERR_EXPLAIN("Vector2 size is NOT 8!");
+				ERR_FAIL_V(ERR_UNAVAILABLE);
+			}
+			w=DVector<Vector2>::Write();
+			r_v=array;
+
+		} break;
+		case VARIANT_VECTOR3_ARRAY: {
+
+			uint32_t len = f->get_32();
+
+			DVector<Vector3> array;
+			array.resize(len);
+			DVector<Vector3>::Write w = array.write();
+			if (sizeof(Vector3)==12) {
+				f->get_buffer((uint8_t*)w.ptr(),len*sizeof(real_t)*3);
+#ifdef BIG_ENDIAN_ENABLED
+				{
+					uint32_t *ptr=(uint32_t*)w.ptr();
+					for(int i=0;i<len*3;i++) {
+
+						ptr[i]=BSWAP32(ptr[i]);
+					}
+				}
+
+#endif
+
+			} else {
+				ERR_EXPLAIN("Vector3 size is NOT 12!");
+				ERR_FAIL_V(ERR_UNAVAILABLE);
+			}
+			w=DVector<Vector3>::Write();
+			r_v=array;
+
+		} break;
+		case VARIANT_COLOR_ARRAY: {
+
+			uint32_t len = f->get_32();
+
+			DVector<Color> array;
+			array.resize(len);
+			DVector<Color>::Write w = array.write();
+			if (sizeof(Color)==16) {
+				f->get_buffer((uint8_t*)w.ptr(),len*sizeof(real_t)*4);
+#ifdef BIG_ENDIAN_ENABLED
+			{
+				uint32_t *ptr=(uint32_t*)w.ptr();
+				for(int i=0;i<len*4;i++) {
+
+					ptr[i]=BSWAP32(ptr[i]);
+				}
+			}
+
+#endif
+
+			} else {
+				ERR_EXPLAIN("Color size is NOT 16!");
+				ERR_FAIL_V(ERR_UNAVAILABLE);
+			}
+			w=DVector<Color>::Write();
+			r_v=array;
+		} break;
+
+		default: {
+			ERR_FAIL_V(ERR_FILE_CORRUPT);
+		} break;
+	}
+
+	return OK;
+}
+
 Error ResourceInteractiveLoaderBinary::parse_variant(Variant& r_v)  {
 
 
@@ -254,85 +491,20 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant& r_v)  {
 			r_v=v;
 
 		} break;
-		case VARIANT_IMAGE: {
-
-
-			uint32_t encoding = f->get_32();
-			if (encoding==IMAGE_ENCODING_EMPTY) {
-				r_v=Variant();
-				break;
-			} else if (encoding==IMAGE_ENCODING_RAW) {
-				uint32_t width = f->get_32();
-				uint32_t height = f->get_32();
-				uint32_t mipmaps = f->get_32();
-				uint32_t format = f->get_32();
-				Image::Format fmt;
-				switch(format) {
-
-					case IMAGE_FORMAT_GRAYSCALE: { fmt=Image::FORMAT_GRAYSCALE; } break;
-					case IMAGE_FORMAT_INTENSITY: { fmt=Image::FORMAT_INTENSITY; } break;
-					case IMAGE_FORMAT_GRAYSCALE_ALPHA: { fmt=Image::FORMAT_GRAYSCALE_ALPHA; } break;
-					case IMAGE_FORMAT_RGB: { fmt=Image::FORMAT_RGB; } break;
-					case IMAGE_FORMAT_RGBA: { fmt=Image::FORMAT_RGBA; } break;
-					case IMAGE_FORMAT_INDEXED: { fmt=Image::FORMAT_INDEXED; } break;
-					case IMAGE_FORMAT_INDEXED_ALPHA: { fmt=Image::FORMAT_INDEXED_ALPHA; } break;
-					case IMAGE_FORMAT_BC1: { fmt=Image::FORMAT_BC1; } break;
-					case IMAGE_FORMAT_BC2: { fmt=Image::FORMAT_BC2; } break;
-					case IMAGE_FORMAT_BC3: { fmt=Image::FORMAT_BC3; } break;
-					case IMAGE_FORMAT_BC4: { fmt=Image::FORMAT_BC4; } break;
-					case IMAGE_FORMAT_BC5: { fmt=Image::FORMAT_BC5; } break;
-					case IMAGE_FORMAT_PVRTC2: { fmt=Image::FORMAT_PVRTC2; } break;
-					case IMAGE_FORMAT_PVRTC2_ALPHA: { fmt=Image::FORMAT_PVRTC2_ALPHA; } break;
-					case IMAGE_FORMAT_PVRTC4: { fmt=Image::FORMAT_PVRTC4; } break;
-					case IMAGE_FORMAT_PVRTC4_ALPHA: { fmt=Image::FORMAT_PVRTC4_ALPHA; } break;
-					case IMAGE_FORMAT_ETC: { fmt=Image::FORMAT_ETC; } break;
-					case IMAGE_FORMAT_ATC: { fmt=Image::FORMAT_ATC; } break;
-					case IMAGE_FORMAT_ATC_ALPHA_EXPLICIT: { fmt=Image::FORMAT_ATC_ALPHA_EXPLICIT; } break;
-					case IMAGE_FORMAT_ATC_ALPHA_INTERPOLATED: { fmt=Image::FORMAT_ATC_ALPHA_INTERPOLATED; } break;
-					case IMAGE_FORMAT_CUSTOM: { fmt=Image::FORMAT_CUSTOM; } break;
-					default: {
-
-						ERR_FAIL_V(ERR_FILE_CORRUPT);
-					}
-
-				}
-
-
-				uint32_t datalen = f->get_32();
-
-				DVector<uint8_t> imgdata;
-				imgdata.resize(datalen);
-				DVector<uint8_t>::Write w = imgdata.write();
-				f->get_buffer(w.ptr(),datalen);
-				_advance_padding(datalen);
-				w=DVector<uint8_t>::Write();
-
-				r_v=Image(width,height,mipmaps,fmt,imgdata);
-
-			} else {
-				//compressed
-				DVector<uint8_t> data;
-				data.resize(f->get_32());
-				DVector<uint8_t>::Write w = data.write();
-				f->get_buffer(w.ptr(),data.size());
-				w = DVector<uint8_t>::Write();
-
-				Image img;
-
-				if (encoding==IMAGE_ENCODING_LOSSY && Image::lossy_unpacker) {
-
-					img = Image::lossy_unpacker(data);
-				} else if (encoding==IMAGE_ENCODING_LOSSLESS && Image::lossless_unpacker) {
-
-					img = Image::lossless_unpacker(data);
-				}
-				_advance_padding(data.size());
-
-
-				r_v=img;
+		case VARIANT_IMAGE:
+		case VARIANT_RAW_ARRAY:
+		case VARIANT_INT_ARRAY:
+		case VARIANT_REAL_ARRAY:
+		case VARIANT_VECTOR2_ARRAY:
+		case VARIANT_VECTOR3_ARRAY:
+		case VARIANT_COLOR_ARRAY: {
 
-			}
+			if (payload_lock && _take_payload(r_v))
+				break; //decoded in advance
 
+			Error err = _parse_payload(f,type,r_v);
+			if (err)
+				return err;
 		} break;
 		case VARIANT_NODE_PATH: {
 
@@ -443,170 +615,182 @@ Error ResourceInteractiveLoaderBinary::parse_variant(Variant& r_v)  {
 			r_v=a;
 
 		} break;
-		case VARIANT_RAW_ARRAY: {
+		case VARIANT_STRING_ARRAY: {
 
 			uint32_t len = f->get_32();
-
-			DVector<uint8_t> array;
+			DVector<String> array;
 			array.resize(len);
-			DVector<uint8_t>::Write w = array.write();
-			f->get_buffer(w.ptr(),len);
-			_advance_padding(len);
-			w=DVector<uint8_t>::Write();
+			DVector<String>::Write w = array.write();
+			for(uint32_t i=0;i<len;i++)
+				w[i]=get_unicode_string();
+			w=DVector<String>::Write();
 			r_v=array;
 
+
 		} break;
-		case VARIANT_INT_ARRAY: {
+		default: {
+			ERR_FAIL_V(ERR_FILE_CORRUPT);
+		} break;
+	}
 
-			uint32_t len = f->get_32();
 
-			DVector<int> array;
-			array.resize(len);
-			DVector<int>::Write w = array.write();
-			f->get_buffer((uint8_t*)w.ptr(),len*4);
-#ifdef BIG_ENDIAN_ENABLED
-			{
-				uint32_t *ptr=(uint32_t*)w.ptr();
-				for(int i=0;i<len;i++) {
 
-					ptr[i]=BSWAP32(ptr[i]);
-				}
-			}
+	return OK; //never reach anyway
 
-#endif
-			w=DVector<int>::Write();
-			r_v=array;
-		} break;
-		case VARIANT_REAL_ARRAY: {
+}
 
-			uint32_t len = f->get_32();
 
-			DVector<real_t> array;
-			array.resize(len);
-			DVector<real_t>::Write w = array.write();
-			f->get_buffer((uint8_t*)w.ptr(),len*sizeof(real_t));
-#ifdef BIG_ENDIAN_ENABLED
-			{
-				uint32_t *ptr=(uint32_t*)w.ptr();
-				for(int i=0;i<len;i++) {
+int ResourceInteractiveLoaderBinary::_find_payload(uint64_t p_offset) const {
 
-					ptr[i]=BSWAP32(ptr[i]);
-				}
-			}
+	//sorted, as they were saved in file order
+	int low=0;
+	int high=payloads.size()-1;
+	while(low<=high) {
 
-#endif
+		int mid=(low+high)/2;
+		if (payloads[mid].offset==p_offset)
+			return mid;
+		if (payloads[mid].offset<p_offset)
+			low=mid+1;
+		else
+			high=mid-1;
+	}
 
-			w=DVector<real_t>::Write();
-			r_v=array;
-		} break;
-		case VARIANT_STRING_ARRAY: {
+	return -1;
+}
 
-			uint32_t len = f->get_32();
-			DVector<String> array;
-			array.resize(len);
-			DVector<String>::Write w = array.write();
-			for(uint32_t i=0;i<len;i++)
-				w[i]=get_unicode_string();
-			w=DVector<String>::Write();
-			r_v=array;
+void ResourceInteractiveLoaderBinary::_payload_thread_func(void *p_ud) {
 
+	ResourceInteractiveLoaderBinary *ria=(ResourceInteractiveLoaderBinary*)p_ud;
 
-		} break;
-		case VARIANT_VECTOR2_ARRAY: {
+	//each thread reads through its own file
+	FileAccess *f=FileAccess::open(ria->file_path,FileAccess::READ);
+	if (!f)
+		return; //not decoded, parse_variant() reads them as usual
+	f->set_endian_swap(ria->f->get_endian_swap());
 
-			uint32_t len = f->get_32();
+	Payload *pw=ria->payloads.ptr();
 
-			DVector<Vector2> array;
-			array.resize(len);
-			DVector<Vector2>::Write w = array.write();
-			if (sizeof(Vector2)==8) {
-				f->get_buffer((uint8_t*)w.ptr(),len*sizeof(real_t)*2);
-#ifdef BIG_ENDIAN_ENABLED
-			{
-				uint32_t *ptr=(uint32_t*)w.ptr();
-				for(int i=0;i<len*2;i++) {
+	while(true) {
 
-					ptr[i]=BSWAP32(ptr[i]);
-				}
+		//payloads are in file order, the same order the stages need them
+		int idx=-1;
+		ria->payload_lock->lock();
+		while(ria->next_payload<ria->payloads.size()) {
+
+			int i=ria->next_payload++;
+			if (!pw[i].claimed) {
+				pw[i].claimed=true;
+				idx=i;
+				break;
 			}
+		}
+		ria->payload_lock->unlock();
 
-#endif
+		if (idx<0)
+			break;
 
-			} else {
-				ERR_EXPLAIN("Vector2 size is NOT 8!");
-				ERR_FAIL_V(ERR_UNAVAILABLE);
-			}
-			w=DVector<Vector2>::Write();
-			r_v=array;
+		Variant value;
+		f->seek(pw[idx].offset-4);
+		uint32_t type=f->get_32();
+		bool ok=_parse_payload(f,type,value)==OK;
+
+		ria->payload_lock->lock();
+		if (ok) {
+			pw[idx].value=value;
+			pw[idx].end=f->get_pos();
+			pw[idx].decoded=true;
+		}
+		pw[idx].done=true;
+		ria->payload_lock->unlock();
+	}
 
-		} break;
-		case VARIANT_VECTOR3_ARRAY: {
+	memdelete(f);
+}
 
-			uint32_t len = f->get_32();
+void ResourceInteractiveLoaderBinary::_start_payloads() {
 
-			DVector<Vector3> array;
-			array.resize(len);
-			DVector<Vector3>::Write w = array.write();
-			if (sizeof(Vector3)==12) {
-				f->get_buffer((uint8_t*)w.ptr(),len*sizeof(real_t)*3);
-#ifdef BIG_ENDIAN_ENABLED
-				{
-					uint32_t *ptr=(uint32_t*)w.ptr();
-					for(int i=0;i<len*3;i++) {
+	if (payloads.size()==0 || file_path=="")
+		return;
 
-						ptr[i]=BSWAP32(ptr[i]);
-					}
-				}
+	int count=MIN(OS::get_singleton()->get_processor_count()-1,payloads.size());
+	if (count<=0)
+		return; //nothing to gain, decode them as they come
 
-#endif
+	payload_lock=Mutex::create();
+	if (!payload_lock)
+		return;
 
-			} else {
-				ERR_EXPLAIN("Vector3 size is NOT 12!");
-				ERR_FAIL_V(ERR_UNAVAILABLE);
-			}
-			w=DVector<Vector3>::Write();
-			r_v=array;
+	payloads.ptr(); //make it unique before threads write to it
+	next_payload=0;
 
-		} break;
-		case VARIANT_COLOR_ARRAY: {
+	for(int i=0;i<count;i++) {
 
-			uint32_t len = f->get_32();
+		Thread *t=Thread::create(_payload_thread_func,this);
+		if (!t)
+			break;
+		payload_threads.push_back(t);
+	}
 
-			DVector<Color> array;
-			array.resize(len);
-			DVector<Color>::Write w = array.write();
-			if (sizeof(Color)==16) {
-				f->get_buffer((uint8_t*)w.ptr(),len*sizeof(real_t)*4);
-#ifdef BIG_ENDIAN_ENABLED
-			{
-				uint32_t *ptr=(uint32_t*)w.ptr();
-				for(int i=0;i<len*4;i++) {
+	if (payload_threads.empty()) {
+		memdelete(payload_lock);
+		payload_lock=NULL;
+	}
+}
 
-					ptr[i]=BSWAP32(ptr[i]);
-				}
-			}
+void ResourceInteractiveLoaderBinary::_finish_payloads() {
 
-#endif
+	if (!payload_lock)
+		return;
 
-			} else {
-				ERR_EXPLAIN("Color size is NOT 16!");
-				ERR_FAIL_V(ERR_UNAVAILABLE);
-			}
-			w=DVector<Color>::Write();
-			r_v=array;
-		} break;
+	//don't start new ones, but let the threads finish what they took
+	payload_lock->lock();
+	next_payload=payloads.size();
+	payload_lock->unlock();
 
-		default: {
-			ERR_FAIL_V(ERR_FILE_CORRUPT);
-		} break;
+	for(int i=0;i<payload_threads.size();i++) {
+
+		Thread::wait_to_finish(payload_threads[i]);
+		memdelete(payload_threads[i]);
 	}
+	payload_threads.clear();
 
+	memdelete(payload_lock);
+	payload_lock=NULL;
+}
 
+bool ResourceInteractiveLoaderBinary::_take_payload(Variant& r_v) {
 
-	return OK; //never reach anyway
+	int idx=_find_payload(f->get_pos());
+	if (idx==-1)
+		return false;
 
-}
+	Payload &p=payloads.ptr()[idx];
+
+	payload_lock->lock();
+	if (!p.claimed) {
+		//no thread got to it yet, the caller decodes it
+		p.claimed=true;
+		payload_lock->unlock();
+		return false;
+	}
+
+	while(!p.done) {
+		payload_lock->unlock();
+		OS::get_singleton()->delay_usec(100);
+		payload_lock->lock();
+	}
+
+	bool decoded=p.decoded;
+	if (decoded) {
+		r_v=p.value;
+		p.value=Variant();
+		f->seek(p.end);
+	}
+	payload_lock->unlock();
 
+	return decoded;
+}
 
 void ResourceInteractiveLoaderBinary::set_local_path(const String& p_local_path) {
 
@@ -652,6 +836,11 @@ Error ResourceInteractiveLoaderBinary::poll(){
 
 	s-=external_resources.size();
 
+	if (!payloads_started) {
+		_start_payloads();
+		payloads_started=true;
+	}
+
 
 	if (s>=internal_resources.size()) {
 
@@ -762,6 +951,7 @@ Error ResourceInteractiveLoaderBinary::poll(){
 			res->set_import_metadata(imd);
 
 		}
+		_finish_payloads();
 		f->close();
 		resource=res;
 		error=ERR_FILE_EOF;
@@ -785,11 +975,19 @@ int ResourceInteractiveLoaderBinary::get_stage_count() const {
 String ResourceInteractiveLoaderBinary::get_unicode_string() {
 
 	int len = f->get_32();
+
+	String s;
+	const uint8_t *mapped = f->get_mapped_buffer(len);
+	if (mapped) {
+		//read in place
+		s.parse_utf8((const char*)mapped,len);
+		return s;
+	}
+
 	if (len>str_buf.size()) {
 		str_buf.resize(len);
 	}
 	f->get_buffer((uint8_t*)&str_buf[0],len);
-	String s;
 	s.parse_utf8(&str_buf[0]);
 	return s;
 }
@@ -830,6 +1028,7 @@ void ResourceInteractiveLoaderBinary::open(FileAccess *p_f) {
 		FileAccessCompressed *fac = memnew( FileAccessCompressed );
 		fac->open_after_magic(f);
 		f=fac;
+		compressed=true;
 
 	} else if (header[0]!='R' || header[1]!='S' || header[2]!='R' || header[3]!='C') {
 		//not normal
@@ -874,7 +1073,8 @@ void ResourceInteractiveLoaderBinary::open(FileAccess *p_f) {
 	print_bl("type: "+type);
 
 	importmd_ofs = f->get_64();
-	for(int i=0;i<14;i++)
+	uint64_t payload_ofs = f->get_64(); //zero in older files
+	for(int i=0;i<12;i++)
 		f->get_32(); //skip a few reserved fields
 
 	uint32_t string_table_size=f->get_32();
@@ -923,6 +1123,32 @@ void ResourceInteractiveLoaderBinary::open(FileAccess *p_f) {
 
 	print_bl("int resources: "+itos(int_resources_size));
 
+	if (payload_ofs && !compressed) {
+
+		uint64_t pos=f->get_pos();
+		uint64_t len=f->get_len();
+		uint32_t payload_count=0;
+		if (payload_ofs<=len-4) {
+			f->seek(payload_ofs);
+			payload_count=f->get_32();
+		}
+		if (payload_ofs>len-4 || payload_count>(len-f->get_pos())/8) {
+			//each entry is a 64 bits offset, a table that does not fit in the file is corrupt
+			error=ERR_FILE_CORRUPT;
+			ERR_EXPLAIN("Corrupt payload table: "+local_path);
+			ERR_FAIL();
+		}
+		payloads.resize(payload_count);
+		for(uint32_t i=0;i<payload_count;i++) {
+			payloads[i].offset=f->get_64();
+			payloads[i].end=0;
+			payloads[i].claimed=false;
+			payloads[i].done=false;
+			payloads[i].decoded=false;
+		}
+		f->seek(pos);
+	}
+
 
 	if (f->eof_reached()) {
 
@@ -986,10 +1212,15 @@ ResourceInteractiveLoaderBinary::ResourceInteractiveLoaderBinary() {
 	endian_swap=false;
 	use_real64=false;
 	error=OK;
+	compressed=false;
+	payloads_started=false;
+	next_payload=0;
+	payload_lock=NULL;
 }
 
 ResourceInteractiveLoaderBinary::~ResourceInteractiveLoaderBinary() {
 
+	_finish_payloads();
 	if (f)
 		memdelete(f);
 }
@@ -1009,6 +1240,7 @@ Ref<ResourceInteractiveLoader> ResourceFormatLoaderBinary::load_interactive(cons
 	Ref<ResourceInteractiveLoaderBinary> ria = memnew( ResourceInteractiveLoaderBinary );
 	ria->local_path=Globals::get_singleton()->localize_path(p_path);
 	ria->res_path=ria->local_path;
+	ria->file_path=p_path;
 //	ria->set_local_path( Globals::get_singleton()->localize_path(p_path) );
 	ria->open(f);
 
@@ -1159,6 +1391,19 @@ void ResourceFormatSaverBinaryInstance::_pad_buffer(int p_bytes) {
 
 void ResourceFormatSaverBinaryInstance::write_variant(const Variant& p_property,const PropertyInfo& p_hint) {
 
+	bool payload=false;
+	switch(p_property.get_type()) {
+		case Variant::IMAGE:
+		case Variant::RAW_ARRAY:
+		case Variant::INT_ARRAY:
+		case Variant::REAL_ARRAY:
+		case Variant::VECTOR2_ARRAY:
+		case Variant::VECTOR3_ARRAY:
+		case Variant::COLOR_ARRAY: payload=true; break;
+		default: {}
+	}
+	uint64_t payload_at = payload ? f->get_pos()+4 : 0; //after the type
+
 	switch(p_property.get_type()) {
 
 		case Variant::NIL: {
@@ -1577,6 +1822,9 @@ void ResourceFormatSaverBinaryInstance::write_variant(const Variant& p_property,
 			ERR_FAIL();
 		}
 	}
+
+	if (payload && f->get_pos()-payload_at>=PAYLOAD_MIN_SIZE)
+		payloads.push_back(payload_at);
 }
 
 
@@ -1782,7 +2030,9 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path,const RES& p_
 	save_unicode_string(p_resource->get_type());
 	uint64_t md_at = f->get_pos();
 	f->store_64(0); //offset to impoty metadata
-	for(int i=0;i<14;i++)
+	uint64_t payload_table_at = f->get_pos();
+	f->store_64(0); //offset to payload table
+	for(int i=0;i<12;i++)
 		f->store_32(0); // reserved
 
 
@@ -1907,6 +2157,18 @@ Error ResourceFormatSaverBinaryInstance::save(const String &p_path,const RES& p_
 		f->seek_end();
 	}
 
+	if (payloads.size()) {
+		//lets the loader decode them in parallel
+		uint64_t payload_pos = f->get_pos();
+		f->store_32(payloads.size());
+		for(int i=0;i<payloads.size();i++)
+			f->store_64(payloads[i]);
+
+		f->seek(payload_table_at);
+		f->store_64(payload_pos);
+		f->seek_end();
+	}
+
 
 	f->store_buffer((const uint8_t*)"RSRC",4); //magic at end
 
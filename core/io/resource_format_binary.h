@@ -32,6 +32,8 @@
 #include "io/resource_loader.h"
 #include "io/resource_saver.h"
 #include "os/file_access.h"
+#include "os/mutex.h"
+#include "os/thread.h"
 
 
 class ResourceInteractiveLoaderBinary : public ResourceInteractiveLoader {
@@ -68,8 +70,31 @@ class ResourceInteractiveLoaderBinary : public ResourceInteractiveLoader {
 
 	Vector<IntResoucre> internal_resources;
 
+	struct Payload {
+		uint64_t offset;
+		uint64_t end;
+		bool claimed; //a thread (or parse_variant()) is decoding it
+		bool done;
+		bool decoded; //done and valid
+		Variant value;
+	};
+
+	//large images and arrays, decoded by threads ahead of the stages that use them
+	String file_path;
+	bool compressed;
+	Vector<Payload> payloads;
+	bool payloads_started;
+	int next_payload;
+	Mutex *payload_lock;
+	Vector<Thread*> payload_threads;
+
+	static void _payload_thread_func(void *p_ud);
+	void _start_payloads();
+	void _finish_payloads();
+	bool _take_payload(Variant& r_v);
+	int _find_payload(uint64_t p_offset) const;
+
 	String get_unicode_string();
-	void _advance_padding(uint32_t p_len);
 
 	Error error;
 
@@ -132,6 +157,7 @@ class ResourceFormatSaverBinaryInstance  {
 	Map<RES,int> resource_map;
 	Map<StringName,int> string_map;
 	Vector<StringName> strings;
+	Vector<uint64_t> payloads;
 
 
 	Set<RES> external_resources;
@@ -0,0 +1,773 @@
+/*************************************************************************/
+/*  resource_load_queue.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "resource_load_queue.h"
+#include "globals.h"
+#include "path_remap.h"
+#include "os/os.h"
+#include "os/file_access.h"
+
+static _THREAD_LOCAL bool _load_queue_worker=false;
+
+ResourceLoadQueue *ResourceLoadQueue::singleton=NULL;
+_THREAD_LOCAL ResourceLoadQueue::Task *ResourceLoadQueue::thread_task=NULL;
+
+ResourceLoadQueue *ResourceLoadQueue::get_singleton() {
+
+	return singleton;
+}
+
+bool ResourceLoadQueue::_is_main_thread() const {
+
+	return Thread::get_caller_ID()==Thread::get_main_ID();
+}
+
+static void _prefetch(const String& p_path) {
+
+	//read the file once so it's in the OS cache when the main thread parses it
+	String path = PathRemap::get_singleton() ? PathRemap::get_singleton()->get_remap(p_path) : p_path;
+	FileAccess *f=FileAccess::open(path,FileAccess::READ);
+	if (!f)
+		return;
+
+	uint8_t buf[16384];
+	while(f->get_buffer(buf,sizeof(buf))==sizeof(buf)) {}
+	memdelete(f);
+}
+
+void ResourceLoadQueue::_thread_func(void *p_userdata) {
+
+	ResourceLoadQueue *lq=(ResourceLoadQueue*)p_userdata;
+	_load_queue_worker=true;
+
+	while(true) {
+
+		lq->semaphore->wait();
+		if (lq->exit_threads)
+			break;
+
+		lq->mutex->lock();
+		Task *t=lq->_pick(&lq->ready);
+		if (t)
+			lq->_run(t,true);
+		lq->mutex->unlock();
+	}
+}
+
+void ResourceLoadQueue::_start() {
+
+	if (started)
+		return;
+
+	started=true;
+	main_budget_usec=uint64_t(int(GLOBAL_DEF("resources/load_queue_main_msec",4)))*1000;
+	int count=GLOBAL_DEF("resources/load_queue_threads",0); //0 means one less than the processors
+	if (count<=0)
+		count=MAX(1,OS::get_singleton()->get_processor_count()-1);
+
+	wait_semaphore=Semaphore::create();
+	semaphore=Semaphore::create();
+	if (!semaphore)
+		return; //no threads, the main thread does everything
+
+	for(int i=0;i<count;i++) {
+
+		Thread *t=Thread::create(_thread_func,this);
+		if (t)
+			threads.push_back(t);
+	}
+}
+
+ResourceLoadQueue::Task *ResourceLoadQueue::_create_task(const String& p_path,const String& p_type_hint,int p_priority) {
+
+	Task *t = memnew( Task );
+	t->path=p_path;
+	t->type_hint=p_type_hint;
+	t->priority=p_priority;
+	t->state=STATE_SCAN;
+	t->thread_safe=false;
+	t->requested=false;
+	t->waiters=0;
+	t->progress=0;
+	t->outer=NULL;
+	tasks[p_path]=t;
+	return t;
+}
+
+void ResourceLoadQueue::_release(Task *p_task) {
+
+	if (p_task->requested || p_task->waiters || !p_task->parents.empty())
+		return;
+
+	switch(p_task->state) {
+
+		case STATE_SCAN:
+		case STATE_LOAD: {
+
+			ready.erase(p_task);
+		} break;
+		case STATE_MAIN: {
+
+			main_ready.erase(p_task);
+		} break;
+		case STATE_WAIT: {
+
+			List<Task*> deps=p_task->dependencies;
+			p_task->dependencies.clear();
+			for(List<Task*>::Element *E=deps.front();E;E=E->next()) {
+
+				E->get()->parents.erase(p_task);
+				_release(E->get());
+			}
+		} break;
+		case STATE_LOADING: {
+
+			return; //dropped when done
+		} break;
+		case STATE_DONE: {} break;
+	}
+
+	tasks.erase(p_task->path);
+	memdelete(p_task);
+}
+
+void ResourceLoadQueue::_raise_priority(Task *p_task,int p_priority) {
+
+	//dependencies always have at least the priority of their parents
+	if (p_task->priority>=p_priority)
+		return;
+
+	p_task->priority=p_priority;
+	for(List<Task*>::Element *E=p_task->dependencies.front();E;E=E->next()) {
+
+		_raise_priority(E->get(),p_priority);
+	}
+}
+
+void ResourceLoadQueue::_schedule(Task *p_task) {
+
+	if (p_task->thread_safe) {
+
+		p_task->state=STATE_LOAD;
+		ready.push_back(p_task);
+		if (threads.size())
+			semaphore->post();
+	} else {
+
+		p_task->state=STATE_MAIN;
+		main_ready.push_back(p_task);
+		_wake_waiters(); //a waiting main thread loads it
+	}
+}
+
+void ResourceLoadQueue::_finish(Task *p_task,const RES& p_resource) {
+
+	p_task->state=STATE_DONE;
+	p_task->resource=p_resource;
+	p_task->progress=1.0;
+	p_task->dependency_refs.clear();
+
+	for(List<Task*>::Element *E=p_task->parents.front();E;E=E->next()) {
+
+		Task *p=E->get();
+		p->dependencies.erase(p_task);
+		if (p_resource.is_valid())
+			p->dependency_refs.push_back(p_resource);
+		if (p->dependencies.empty() && p->state==STATE_WAIT)
+			_schedule(p);
+	}
+	p_task->parents.clear();
+
+	if (p_task->requested)
+		finished.push_back(p_task->path);
+
+	_release(p_task);
+	_wake_waiters();
+}
+
+void ResourceLoadQueue::_wake_waiters() {
+
+	while(sleeping>0) {
+		sleeping--;
+		wait_semaphore->post();
+	}
+}
+
+ResourceLoadQueue::Task *ResourceLoadQueue::_pick(List<Task*> *p_from) const {
+
+	Task *best=NULL;
+	for(List<Task*>::Element *E=p_from->front();E;E=E->next()) {
+
+		if (!best || E->get()->priority>best->priority)
+			best=E->get();
+	}
+
+	return best;
+}
+
+ResourceLoadQueue::Task *ResourceLoadQueue::_find_work(Task *p_task,bool p_main) {
+
+	if (p_task->state==STATE_SCAN || p_task->state==STATE_LOAD)
+		return p_task;
+	if (p_main && p_task->state==STATE_MAIN)
+		return p_task;
+
+	for(List<Task*>::Element *E=p_task->dependencies.front();E;E=E->next()) {
+
+		Task *w=_find_work(E->get(),p_main);
+		if (w)
+			return w;
+	}
+
+	return NULL;
+}
+
+void ResourceLoadQueue::_run(Task *p_task,bool p_complete) {
+
+	switch(p_task->state) {
+
+		case STATE_SCAN: {
+
+			ready.erase(p_task);
+			_scan(p_task);
+		} break;
+		case STATE_LOAD: {
+
+			ready.erase(p_task);
+			_load(p_task);
+		} break;
+		case STATE_MAIN: {
+
+			main_ready.erase(p_task);
+			p_task->state=STATE_LOADING;
+			if (!p_complete && !main_current) {
+				main_current=p_task;
+				_main_step(p_task);
+			} else {
+				while(!_main_step(p_task)) {}
+			}
+		} break;
+		default: {
+
+			ERR_FAIL();
+		}
+	}
+}
+
+void ResourceLoadQueue::_scan(Task *p_task) {
+
+	p_task->state=STATE_LOADING;
+	String path=p_task->path;
+	String type_hint=p_task->type_hint;
+
+	mutex->unlock();
+
+	List<String> deps;
+	ResourceLoader::get_dependencies(path,&deps);
+	bool thread_safe=ResourceLoader::is_thread_safe(path,type_hint);
+	if (!thread_safe)
+		_prefetch(path);
+
+	mutex->lock();
+
+	p_task->thread_safe=thread_safe;
+	p_task->state=STATE_WAIT;
+
+	for(List<String>::Element *E=deps.front();E;E=E->next()) {
+
+		String dep_path=Globals::get_singleton()->localize_path(E->get());
+		if (dep_path==path)
+			continue;
+
+		Map<String,Task*>::Element *D=tasks.find(dep_path);
+		Task *d=D?D->get():NULL;
+		if (!d) {
+
+			if (ResourceCache::has(dep_path)) {
+				p_task->dependency_refs.push_back(RES(ResourceCache::get(dep_path)));
+				continue;
+			}
+
+			d=_create_task(dep_path,"",p_task->priority);
+			ready.push_back(d);
+			if (threads.size())
+				semaphore->post();
+		}
+
+		if (d->state==STATE_DONE) {
+			if (d->resource.is_valid())
+				p_task->dependency_refs.push_back(d->resource);
+			continue;
+		}
+
+		_raise_priority(d,p_task->priority);
+		d->parents.push_back(p_task);
+		p_task->dependencies.push_back(d);
+	}
+
+	if (p_task->dependencies.empty())
+		_schedule(p_task);
+
+	_release(p_task); //may have been cancelled meanwhile
+	_wake_waiters(); //new dependencies to help with, or to block on
+}
+
+void ResourceLoadQueue::_load(Task *p_task) {
+
+	p_task->state=STATE_LOADING;
+	p_task->outer=thread_task;
+	thread_task=p_task;
+	bool main=_is_main_thread();
+	if (main)
+		_push_main_frame(p_task,false);
+
+	mutex->unlock();
+	RES res = ResourceLoader::_load(p_task->path,p_task->type_hint,false);
+	mutex->lock();
+
+	if (main)
+		_pop_main_frame();
+	thread_task=p_task->outer;
+	p_task->outer=NULL;
+
+	_finish(p_task,res);
+}
+
+bool ResourceLoadQueue::_main_step(Task *p_task) {
+
+	bool current = p_task==main_current;
+
+	if (!p_task->requested && !p_task->waiters && p_task->parents.empty()) {
+		//cancelled, drop it
+		if (current)
+			main_current=NULL;
+		_finish(p_task,RES());
+		return true;
+	}
+
+	Ref<ResourceInteractiveLoader> ril=p_task->ril;
+	RES res;
+	bool done=false;
+
+	if (current)
+		main_busy=true;
+	_push_main_frame(p_task,false);
+	mutex->unlock();
+
+	if (ril.is_null()) {
+
+		if (ResourceCache::has(p_task->path)) {
+			res=RES(ResourceCache::get(p_task->path));
+			done=true;
+		} else {
+			ril=ResourceLoader::load_interactive(p_task->path,p_task->type_hint);
+			if (ril.is_null())
+				done=true;
+		}
+	}
+
+	if (!done) {
+
+		Error err = ril->poll();
+		if (err==ERR_FILE_EOF) {
+			res=ril->get_resource();
+			done=true;
+		} else if (err!=OK) {
+			done=true;
+		}
+	}
+
+	mutex->lock();
+	_pop_main_frame();
+	if (current)
+		main_busy=false;
+
+	if (done) {
+
+		p_task->ril=Ref<ResourceInteractiveLoader>();
+		if (current)
+			main_current=NULL;
+		_finish(p_task,res);
+	} else {
+
+		p_task->ril=ril;
+		p_task->progress=float(ril->get_stage())/MAX(1,ril->get_stage_count());
+	}
+
+	return done;
+}
+
+void ResourceLoadQueue::_push_main_frame(Task *p_task,bool p_wait) {
+
+	MainFrame f;
+	f.task=p_task;
+	f.wait=p_wait;
+	main_frames.push_back(f);
+	_wake_waiters(); //waiting workers check again whether they block the main thread
+}
+
+void ResourceLoadQueue::_pop_main_frame() {
+
+	main_frames.resize(main_frames.size()-1);
+}
+
+bool ResourceLoadQueue::_depends_on(Task *p_task,Task *p_dependency) const {
+
+	if (p_task==p_dependency)
+		return true;
+
+	for(const List<Task*>::Element *E=p_task->dependencies.front();E;E=E->next()) {
+
+		if (_depends_on(E->get(),p_dependency))
+			return true;
+	}
+
+	return false;
+}
+
+bool ResourceLoadQueue::_blocks_main(Task *p_task) const {
+
+	//p_task (or one of its dependencies) is being loaded by the main thread,
+	//which further up its stack waits for something this thread is loading
+	for(int i=0;i<main_frames.size();i++) {
+
+		if (main_frames[i].wait || !_depends_on(p_task,main_frames[i].task))
+			continue;
+
+		for(int j=i+1;j<main_frames.size();j++) {
+
+			if (!main_frames[j].wait)
+				continue;
+			for(Task *t=thread_task;t;t=t->outer) {
+
+				if (_depends_on(main_frames[j].task,t))
+					return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool ResourceLoadQueue::_wait(Task *p_task) {
+
+	//help while waiting, the main thread also takes care of handed over loads
+	bool main=_is_main_thread();
+	_raise_priority(p_task,PRIORITY_WAIT);
+
+	if (main)
+		_push_main_frame(p_task,true);
+
+	while(p_task->state!=STATE_DONE && !exit_threads) {
+
+		if (!main && _blocks_main(p_task)) {
+			//the main thread can't get back to it before this thread is done
+			ERR_EXPLAIN("Dependency cycle with the main thread, can't load in the background: "+p_task->path);
+			ERR_FAIL_V(false);
+		}
+
+		if (main && main_current && !main_busy) {
+			Task *t=main_current;
+			while(!_main_step(t)) {}
+			continue;
+		}
+
+		Task *w=_find_work(p_task,main);
+		if (!w && main)
+			w=_pick(&main_ready);
+		if (w) {
+			_run(w,true);
+			continue;
+		}
+
+		if (wait_semaphore) {
+			sleeping++;
+			mutex->unlock();
+			wait_semaphore->wait();
+			mutex->lock();
+		} else {
+			mutex->unlock();
+			OS::get_singleton()->delay_usec(1000);
+			mutex->lock();
+		}
+	}
+
+	if (main)
+		_pop_main_frame();
+
+	return p_task->state==STATE_DONE;
+}
+
+Error ResourceLoadQueue::queue(const String& p_path,const String& p_type_hint,int p_priority) {
+
+	String local_path = Globals::get_singleton()->localize_path(p_path);
+	ERR_FAIL_COND_V(local_path=="",ERR_INVALID_PARAMETER);
+
+	_start();
+
+	mutex->lock();
+
+	Map<String,Task*>::Element *E=tasks.find(local_path);
+	if (E) {
+
+		E->get()->requested=true;
+		_raise_priority(E->get(),p_priority);
+		mutex->unlock();
+		return OK;
+	}
+
+	Task *t=_create_task(local_path,p_type_hint,p_priority);
+	t->requested=true;
+
+	if (ResourceCache::has(local_path)) {
+
+		_finish(t,RES(ResourceCache::get(local_path)));
+	} else {
+
+		ready.push_back(t);
+		if (threads.size())
+			semaphore->post();
+		_wake_waiters();
+	}
+
+	mutex->unlock();
+
+	return OK;
+}
+
+void ResourceLoadQueue::cancel(const String& p_path) {
+
+	String local_path = Globals::get_singleton()->localize_path(p_path);
+
+	mutex->lock();
+	Map<String,Task*>::Element *E=tasks.find(local_path);
+	if (E) {
+		E->get()->requested=false;
+		_release(E->get());
+	}
+	mutex->unlock();
+}
+
+ResourceLoadQueue::Status ResourceLoadQueue::get_status(const String& p_path) {
+
+	String local_path = Globals::get_singleton()->localize_path(p_path);
+
+	Status status=STATUS_INVALID;
+	mutex->lock();
+	Map<String,Task*>::Element *E=tasks.find(local_path);
+	if (E) {
+		switch(E->get()->state) {
+			case STATE_DONE: status=E->get()->resource.is_valid()?STATUS_LOADED:STATUS_FAILED; break;
+			case STATE_LOADING: status=STATUS_LOADING; break;
+			default: status=STATUS_QUEUED;
+		}
+	}
+	mutex->unlock();
+
+	return status;
+}
+
+float ResourceLoadQueue::get_progress(const String& p_path) {
+
+	String local_path = Globals::get_singleton()->localize_path(p_path);
+
+	float progress=0;
+	mutex->lock();
+	Map<String,Task*>::Element *E=tasks.find(local_path);
+	if (E)
+		progress=E->get()->progress;
+	mutex->unlock();
+
+	return progress;
+}
+
+RES ResourceLoadQueue::get_resource(const String& p_path) {
+
+	String local_path = Globals::get_singleton()->localize_path(p_path);
+
+	mutex->lock();
+	Map<String,Task*>::Element *E=tasks.find(local_path);
+	if (!E || !E->get()->requested) {
+		mutex->unlock();
+		ERR_EXPLAIN("Resource was not queued: "+p_path);
+		ERR_FAIL_V(RES());
+	}
+
+	Task *t=E->get();
+	t->waiters++;
+	bool done=_wait(t);
+	t->waiters--;
+	RES res=done?t->resource:RES();
+	t->requested=false;
+	_release(t);
+	mutex->unlock();
+
+	return res;
+}
+
+void ResourceLoadQueue::poll() {
+
+	if (!started)
+		return;
+
+	ERR_FAIL_COND(!_is_main_thread());
+
+	uint64_t begin=OS::get_singleton()->get_ticks_usec();
+
+	mutex->lock();
+
+	while(OS::get_singleton()->get_ticks_usec()-begin < main_budget_usec) {
+
+		if (main_current) {
+			_main_step(main_current);
+			continue;
+		}
+
+		Task *t=_pick(&main_ready);
+		if (!t && threads.empty())
+			t=_pick(&ready);
+		if (!t)
+			break;
+		_run(t,false);
+	}
+
+	List<String> loaded=finished;
+	finished.clear();
+
+	mutex->unlock();
+
+	for(List<String>::Element *E=loaded.front();E;E=E->next()) {
+
+		emit_signal("resource_loaded",E->get());
+	}
+}
+
+bool ResourceLoadQueue::load_shared(const String& p_path,const String& p_type_hint,RES *r_resource) {
+
+	if (!started)
+		return false;
+
+	mutex->lock();
+
+	Task *t=NULL;
+	bool done=true;
+	Map<String,Task*>::Element *E=tasks.find(p_path);
+	if (E) {
+
+		t=E->get();
+		t->waiters++;
+		done=_wait(t);
+
+	} else {
+
+		//load it right here, but other threads asking for it will wait for this one
+		t=_create_task(p_path,p_type_hint,PRIORITY_WAIT);
+		t->waiters++;
+		t->thread_safe=ResourceLoader::is_thread_safe(p_path,p_type_hint);
+
+		if (_load_queue_worker && !t->thread_safe) {
+
+			t->state=STATE_MAIN;
+			main_ready.push_back(t);
+			done=_wait(t);
+		} else {
+
+			t->state=STATE_LOAD;
+			_load(t);
+		}
+	}
+
+	t->waiters--;
+	*r_resource=done?t->resource:RES(); //a failed dependency, not a second load of it
+	_release(t);
+
+	mutex->unlock();
+
+	return true;
+}
+
+void ResourceLoadQueue::_bind_methods() {
+
+	ObjectTypeDB::bind_method(_MD("queue","path","type_hint","priority"),&ResourceLoadQueue::queue,DEFVAL(""),DEFVAL(0));
+	ObjectTypeDB::bind_method(_MD("cancel","path"),&ResourceLoadQueue::cancel);
+	ObjectTypeDB::bind_method(_MD("get_status","path"),&ResourceLoadQueue::get_status);
+	ObjectTypeDB::bind_method(_MD("get_progress","path"),&ResourceLoadQueue::get_progress);
+	ObjectTypeDB::bind_method(_MD("get_resource:Resource","path"),&ResourceLoadQueue::get_resource);
+
+	ADD_SIGNAL( MethodInfo("resource_loaded",PropertyInfo(Variant::STRING,"path")) );
+
+	BIND_CONSTANT( STATUS_INVALID );
+	BIND_CONSTANT( STATUS_QUEUED );
+	BIND_CONSTANT( STATUS_LOADING );
+	BIND_CONSTANT( STATUS_LOADED );
+	BIND_CONSTANT( STATUS_FAILED );
+}
+
+ResourceLoadQueue::ResourceLoadQueue() {
+
+	singleton=this;
+	mutex=Mutex::create();
+	semaphore=NULL;
+	wait_semaphore=NULL;
+	sleeping=0;
+	started=false;
+	exit_threads=false;
+	main_budget_usec=4000;
+	main_current=NULL;
+	main_busy=false;
+}
+
+ResourceLoadQueue::~ResourceLoadQueue() {
+
+	exit_threads=true;
+	for(int i=0;i<threads.size();i++) {
+		semaphore->post();
+	}
+	if (wait_semaphore) {
+		mutex->lock();
+		_wake_waiters();
+		mutex->unlock();
+	}
+	for(int i=0;i<threads.size();i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	for(Map<String,Task*>::Element *E=tasks.front();E;E=E->next()) {
+		memdelete(E->get());
+	}
+	tasks.clear();
+
+	if (semaphore)
+		memdelete(semaphore);
+	if (wait_semaphore)
+		memdelete(wait_semaphore);
+	memdelete(mutex);
+	singleton=NULL;
+}
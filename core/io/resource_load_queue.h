@@ -0,0 +1,168 @@
+/*************************************************************************/
+/*  resource_load_queue.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef RESOURCE_LOAD_QUEUE_H
+#define RESOURCE_LOAD_QUEUE_H
+
+#include "io/resource_loader.h"
+#include "os/thread.h"
+#include "os/mutex.h"
+#include "os/semaphore.h"
+
+/* Loads resources in the background. Requested paths are scanned for
+   dependencies by a pool of worker threads, dependencies are queued too
+   and everything is loaded in dependency order, highest priority first.
+   Loaders that declare themselves thread safe run on the workers, the rest
+   (most of them, as they create server side resources) are handed over to
+   the main thread, which loads them a few steps per frame in poll(). */
+
+class ResourceLoadQueue : public Object {
+
+	OBJ_TYPE(ResourceLoadQueue,Object);
+public:
+
+	enum Status {
+		STATUS_INVALID,
+		STATUS_QUEUED,
+		STATUS_LOADING,
+		STATUS_LOADED,
+		STATUS_FAILED
+	};
+
+private:
+
+	enum State {
+		STATE_SCAN, //waiting for a worker to scan dependencies
+		STATE_WAIT, //waiting for dependencies to load
+		STATE_LOAD, //waiting for a worker to load it
+		STATE_MAIN, //waiting for the main thread to load it
+		STATE_LOADING,
+		STATE_DONE
+	};
+
+	enum {
+		PRIORITY_WAIT=0x7FFFFFFF //someone is blocked on it
+	};
+
+	struct Task {
+
+		String path;
+		String type_hint;
+		int priority;
+		State state;
+		bool thread_safe;
+		bool requested; //queued explicitly (not only as a dependency)
+		int waiters;
+		float progress;
+		Ref<ResourceInteractiveLoader> ril;
+		RES resource;
+		List<RES> dependency_refs; //keep loaded dependencies in the cache until done
+		List<Task*> dependencies; //pending ones
+		List<Task*> parents;
+		Task *outer; //what the loading thread was loading when it started this one
+	};
+
+	/* What the main thread is doing, innermost last. A main thread load can
+	   only finish after every wait above it in this stack. */
+	struct MainFrame {
+
+		Task *task;
+		bool wait; //waiting for it, otherwise loading it
+	};
+
+	Mutex *mutex;
+	Semaphore *semaphore;
+	Semaphore *wait_semaphore; //posted once per sleeping waiter when something changes
+	int sleeping;
+	Vector<Thread*> threads;
+	bool started;
+	volatile bool exit_threads;
+	uint64_t main_budget_usec;
+
+	Map<String,Task*> tasks;
+	List<Task*> ready; //for workers
+	List<Task*> main_ready; //for the main thread
+	Task *main_current;
+	bool main_busy; //main_current is being polled
+	Vector<MainFrame> main_frames;
+	List<String> finished;
+
+	static ResourceLoadQueue *singleton;
+	static _THREAD_LOCAL Task *thread_task; //innermost load on the calling thread
+
+	static void _thread_func(void *p_userdata);
+	void _start();
+
+	Task *_create_task(const String& p_path,const String& p_type_hint,int p_priority);
+	void _release(Task *p_task);
+	void _raise_priority(Task *p_task,int p_priority);
+	void _schedule(Task *p_task);
+	void _finish(Task *p_task,const RES& p_resource);
+	void _wake_waiters();
+
+	Task *_pick(List<Task*> *p_from) const;
+	Task *_find_work(Task *p_task,bool p_main);
+	void _run(Task *p_task,bool p_complete);
+	void _scan(Task *p_task);
+	void _load(Task *p_task);
+	bool _main_step(Task *p_task);
+	bool _wait(Task *p_task); ///< false if waiting would deadlock with the main thread
+
+	void _push_main_frame(Task *p_task,bool p_wait);
+	void _pop_main_frame();
+	bool _depends_on(Task *p_task,Task *p_dependency) const;
+	bool _blocks_main(Task *p_task) const;
+
+	bool _is_main_thread() const;
+
+protected:
+
+	static void _bind_methods();
+
+public:
+
+	static ResourceLoadQueue *get_singleton();
+
+	Error queue(const String& p_path,const String& p_type_hint="",int p_priority=0);
+	void cancel(const String& p_path);
+	Status get_status(const String& p_path);
+	float get_progress(const String& p_path);
+	RES get_resource(const String& p_path); ///< waits if needed, and removes the request
+
+	void poll(); ///< called by the main loop every frame
+
+	bool load_shared(const String& p_path,const String& p_type_hint,RES *r_resource); ///< used by ResourceLoader::load(), so a path is never loaded twice at the same time
+
+	ResourceLoadQueue();
+	~ResourceLoadQueue();
+};
+
+VARIANT_ENUM_CAST(ResourceLoadQueue::Status);
+
+#endif // RESOURCE_LOAD_QUEUE_H
@@ -32,6 +32,7 @@
 #include "path_remap.h"
 #include "os/file_access.h"
 #include "os/os.h"
+#include "resource_load_queue.h"
 ResourceFormatLoader *ResourceLoader::loader[MAX_LOADERS];
 
 int ResourceLoader::loader_count=0;
@@ -163,7 +164,19 @@ RES ResourceLoader::load(const String &p_path,const String& p_type_hint,bool p_n
 		return RES( ResourceCache::get(local_path ) );
 	}
 
-	String remapped_path = PathRemap::get_singleton()->get_remap(local_path);
+	if (!p_no_cache && ResourceLoadQueue::get_singleton()) {
+		//may be loading in the background already
+		RES res;
+		if (ResourceLoadQueue::get_singleton()->load_shared(local_path,p_type_hint,&res))
+			return res;
+	}
+
+	return _load(local_path,p_type_hint,p_no_cache);
+}
+
+RES ResourceLoader::_load(const String &p_local_path,const String& p_type_hint,bool p_no_cache) {
+
+	String remapped_path = PathRemap::get_singleton()->get_remap(p_local_path);
 
 	if (OS::get_singleton()->is_stdout_verbose())
 		print_line("load resource: "+remapped_path);
@@ -178,11 +191,11 @@ RES ResourceLoader::load(const String &p_path,const String& p_type_hint,bool p_n
 		if (p_type_hint!="" && !loader[i]->handles_type(p_type_hint))
 			continue;
 		found=true;
-		RES res = loader[i]->load(remapped_path,local_path);
+		RES res = loader[i]->load(remapped_path,p_local_path);
 		if (res.is_null())
 			continue;
 		if (!p_no_cache)
-			res->set_path(local_path);
+			res->set_path(p_local_path);
 #ifdef TOOLS_ENABLED
 
 		res->set_edited(false);
@@ -197,9 +210,9 @@ RES ResourceLoader::load(const String &p_path,const String& p_type_hint,bool p_n
 	}
 
 	if (found) {
-		ERR_EXPLAIN("Failed loading resource: "+p_path);
+		ERR_EXPLAIN("Failed loading resource: "+p_local_path);
 	} else {
-		ERR_EXPLAIN("No loader found for resource: "+p_path);
+		ERR_EXPLAIN("No loader found for resource: "+p_local_path);
 	}
 	ERR_FAIL_V(RES());
 	return RES();
@@ -382,6 +395,26 @@ String ResourceLoader::get_resource_type(const String &p_path) {
 	return "";
 
 }
+
+bool ResourceLoader::is_thread_safe(const String &p_path,const String& p_type_hint) {
+
+	String local_path = Globals::get_singleton()->localize_path(p_path);
+	String remapped_path = PathRemap::get_singleton()->get_remap(local_path);
+	String extension=remapped_path.extension();
+
+	//same loader load() would pick
+	for (int i=0;i<loader_count;i++) {
+
+		if (!loader[i]->recognize(extension))
+			continue;
+		if (p_type_hint!="" && !loader[i]->handles_type(p_type_hint))
+			continue;
+		return loader[i]->is_thread_safe();
+	}
+
+	return false;
+}
+
 ResourceLoadErrorNotify ResourceLoader::err_notify=NULL;
 void *ResourceLoader::err_notify_ud=NULL;
 
@@ -66,6 +66,7 @@ public:
 	virtual String get_resource_type(const String &p_path) const=0;
 	virtual void get_dependencies(const String& p_path,List<String> *p_dependencies);
 	virtual Error load_import_metadata(const String &p_path, Ref<ResourceImportMetadata>& r_var) const { return ERR_UNAVAILABLE; }
+	virtual bool is_thread_safe() const { return false; } ///< can load from any thread (creates no server side resources)
 
 	virtual ~ResourceFormatLoader() {}
 };
@@ -89,6 +90,9 @@ class ResourceLoader {
 	static bool abort_on_missing_resource;
 
 	static String find_complete_path(const String& p_path,const String& p_type);
+
+friend class ResourceLoadQueue;
+	static RES _load(const String &p_local_path,const String& p_type_hint,bool p_no_cache);
 public:
 
 
@@ -100,6 +104,7 @@ public:
 	static void get_recognized_extensions_for_type(const String& p_type,List<String> *p_extensions);
 	static void add_resource_format_loader(ResourceFormatLoader *p_format_loader);
 	static String get_resource_type(const String &p_path);
+	static bool is_thread_safe(const String &p_path,const String& p_type_hint="");
 	static void get_dependencies(const String& p_path,List<String> *p_dependencies);
 
 	static String guess_full_filename(const String &p_path,const String& p_type);
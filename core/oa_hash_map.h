@@ -0,0 +1,472 @@
+/*************************************************************************/
+/*  oa_hash_map.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef OA_HASH_MAP_H
+#define OA_HASH_MAP_H
+
+#include "hash_map.h"
+
+/**
+ * @class OAHashMap
+ *
+ * Open addressing (Robin Hood) version of HashMap, with the same interface. Pairs are stored
+ * inline in a single power of two table and collisions are solved by linear probing, where
+ * entries far from their ideal slot steal the place of entries closer to theirs. This keeps
+ * probe sequences short and lookups inside one or two cache lines, at the cost of:
+ *
+ *  - Pointers and references to keys/data are invalidated when inserting or erasing.
+ *  - The table is not shrunk on erase, only clear() releases memory.
+ *
+ * Use it for maps that are read much more than written (type databases, constant tables).
+ * If stable pointers are needed, or the iteration order is saved somewhere, use HashMap.
+ * Dictionary stays on HashMap for both reasons.
+ * @param TKey  Key, search is based on it, needs to be hasheable. It is unique in this container.
+ * @param TData Data, data associated with the key
+ * @param Hasher Hasher object, needs to provide a valid static hash function for TKey
+ * @param MIN_HASH_TABLE_POWER Miminum size of the hash table, as a power of two.
+ * @param MAX_LOAD_FACTOR_PERCENT Occupancy at which the table is doubled.
+*/
+
+template<class TKey, class TData, class Hasher=HashMapHahserDefault,uint8_t MIN_HASH_TABLE_POWER=3,uint8_t MAX_LOAD_FACTOR_PERCENT=80>
+class OAHashMap {
+public:
+
+	struct Pair {
+
+		TKey key;
+		TData data;
+
+		Pair() {}
+		Pair(const TKey& p_key, const TData& p_data) { key=p_key; data=p_data; }
+	};
+
+private:
+
+	enum {
+		EMPTY_HASH=0 // hash value reserved for unused slots
+	};
+
+	uint32_t *hashes;
+	Pair *pairs;
+	uint8_t hash_table_power;
+	uint32_t elements;
+
+	static _FORCE_INLINE_ uint32_t _sanitize_hash(uint32_t p_hash) {
+
+		return p_hash==EMPTY_HASH ? EMPTY_HASH+1 : p_hash;
+	}
+
+	_FORCE_INLINE_ uint32_t _get_capacity() const { return 1<<hash_table_power; }
+
+	/* distance from the slot the hash wants to be in */
+	_FORCE_INLINE_ uint32_t _get_probe_length(uint32_t p_pos, uint32_t p_hash) const {
+
+		uint32_t mask=_get_capacity()-1;
+		return (p_pos - (p_hash&mask))&mask;
+	}
+
+	template<class C>
+	_FORCE_INLINE_ int _find_pos(const C& p_key, uint32_t p_hash) const {
+
+		if (!hashes)
+			return -1;
+
+		uint32_t mask=_get_capacity()-1;
+		uint32_t pos=p_hash&mask;
+		uint32_t distance=0;
+
+		while(true) {
+
+			uint32_t h = hashes[pos];
+			if (h==EMPTY_HASH)
+				return -1;
+			/* an entry closer to home than us means the key can't be further ahead */
+			if (distance > _get_probe_length(pos,h))
+				return -1;
+			/* checking hash first avoids comparing key, which may take longer */
+			if (h==p_hash && pairs[pos].key==p_key)
+				return pos;
+
+			pos=(pos+1)&mask;
+			distance++;
+		}
+
+		return -1;
+	}
+
+	void _allocate(uint8_t p_power) {
+
+		hash_table_power=p_power;
+		uint32_t capacity=_get_capacity();
+		hashes = (uint32_t*)memalloc(sizeof(uint32_t)*capacity);
+		pairs = (Pair*)memalloc(sizeof(Pair)*capacity);
+		for(uint32_t i=0;i<capacity;i++)
+			hashes[i]=EMPTY_HASH;
+	}
+
+	/* places a pair known not to be in the table, returns where it ended up */
+	uint32_t _place(const Pair& p_pair, uint32_t p_hash) {
+
+		uint32_t mask=_get_capacity()-1;
+		uint32_t pos=p_hash&mask;
+		uint32_t distance=0;
+		uint32_t hash=p_hash;
+		Pair pair=p_pair;
+		int placed_pos=-1;
+
+		while(true) {
+
+			if (hashes[pos]==EMPTY_HASH) {
+
+				memnew_placement(&pairs[pos],Pair(pair));
+				hashes[pos]=hash;
+				elements++;
+				return placed_pos<0 ? pos : placed_pos;
+			}
+
+			uint32_t existing_distance=_get_probe_length(pos,hashes[pos]);
+			if (existing_distance < distance) {
+				/* rob the rich: take this slot and keep placing the evicted entry */
+				SWAP(hash,hashes[pos]);
+				SWAP(pair,pairs[pos]);
+				if (placed_pos<0)
+					placed_pos=pos;
+				distance=existing_distance;
+			}
+
+			pos=(pos+1)&mask;
+			distance++;
+		}
+
+		return 0;
+	}
+
+	void _resize(uint8_t p_power) {
+
+		uint32_t *old_hashes=hashes;
+		Pair *old_pairs=pairs;
+		uint32_t old_capacity=_get_capacity();
+
+		_allocate(p_power);
+		elements=0;
+
+		for(uint32_t i=0;i<old_capacity;i++) {
+
+			if (old_hashes[i]==EMPTY_HASH)
+				continue;
+			_place(old_pairs[i],old_hashes[i]);
+			old_pairs[i].~Pair();
+		}
+
+		memfree(old_hashes);
+		memfree(old_pairs);
+	}
+
+	uint32_t _insert(const Pair& p_pair, uint32_t p_hash) {
+
+		if (!hashes) {
+			_allocate(MIN_HASH_TABLE_POWER);
+			elements=0;
+		} else if ( (elements+1)*100 > _get_capacity()*MAX_LOAD_FACTOR_PERCENT ) {
+			_resize(hash_table_power+1);
+		}
+
+		return _place(p_pair,p_hash);
+	}
+
+	int _get_key_pos(const TKey* p_key) const {
+
+		/* fast path, key is already a pointer into the table (usual when iterating) */
+		const uint8_t *ptr = (const uint8_t*)p_key;
+		const uint8_t *base = (const uint8_t*)pairs;
+		if (ptr>=base && ptr<base+sizeof(Pair)*_get_capacity()) {
+
+			uint32_t pos = (ptr-base)/sizeof(Pair);
+			if (&pairs[pos].key==p_key && hashes[pos]!=EMPTY_HASH)
+				return pos;
+		}
+
+		return _find_pos(*p_key,_sanitize_hash(Hasher::hash(*p_key)));
+	}
+
+	void copy_from(const OAHashMap& p_t) {
+
+		if (&p_t==this)
+			return; /* much less bother with that */
+
+		clear();
+
+		if (!p_t.hashes)
+			return;
+
+		_allocate(p_t.hash_table_power);
+		elements=p_t.elements;
+
+		for(uint32_t i=0;i<_get_capacity();i++) {
+
+			hashes[i]=p_t.hashes[i];
+			if (hashes[i]!=EMPTY_HASH)
+				memnew_placement(&pairs[i],Pair(p_t.pairs[i]));
+		}
+	}
+
+public:
+
+	void set( const TKey& p_key, const TData& p_data ) {
+
+		set( Pair( p_key, p_data ) );
+	}
+
+	void set( const Pair& p_pair ) {
+
+		uint32_t hash=_sanitize_hash(Hasher::hash(p_pair.key));
+		int pos=_find_pos(p_pair.key,hash);
+		if (pos>=0) {
+			pairs[pos].data=p_pair.data;
+			return;
+		}
+
+		_insert(p_pair,hash);
+	}
+
+	bool has( const TKey& p_key ) const {
+
+		return getptr(p_key)!=NULL;
+	}
+
+	/**
+	 * Get a key from data, return a const reference.
+	 * WARNING: this doesn't check errors, use either getptr and check NULL, or check
+	 * first with has(key)
+	 */
+
+	const TData& get( const TKey& p_key ) const {
+
+		const TData* res = getptr(p_key);
+		ERR_FAIL_COND_V(!res,*res);
+		return *res;
+	}
+
+	TData& get( const TKey& p_key )  {
+
+		TData* res = getptr(p_key);
+		ERR_FAIL_COND_V(!res,*res);
+		return *res;
+	}
+
+	/**
+	 * Same as get, except it can return NULL when item was not found.
+	 * The pointer is only valid until the map is modified.
+	 */
+
+	_FORCE_INLINE_ TData* getptr( const TKey& p_key ) {
+
+		int pos=_find_pos(p_key,_sanitize_hash(Hasher::hash(p_key)));
+		return pos<0 ? NULL : &pairs[pos].data;
+	}
+
+	_FORCE_INLINE_ const TData* getptr( const TKey& p_key ) const {
+
+		int pos=_find_pos(p_key,_sanitize_hash(Hasher::hash(p_key)));
+		return pos<0 ? NULL : &pairs[pos].data;
+	}
+
+	/**
+	 * Same as get, except it can return NULL when item was not found.
+	 * This version is custom, will take a hash and a custom key (that should support operator==()
+	 */
+
+	template<class C>
+	_FORCE_INLINE_ TData* custom_getptr( C p_custom_key,uint32_t p_custom_hash )  {
+
+		int pos=_find_pos(p_custom_key,_sanitize_hash(p_custom_hash));
+		return pos<0 ? NULL : &pairs[pos].data;
+	}
+
+	template<class C>
+	_FORCE_INLINE_ const TData* custom_getptr( C p_custom_key,uint32_t p_custom_hash ) const {
+
+		int pos=_find_pos(p_custom_key,_sanitize_hash(p_custom_hash));
+		return pos<0 ? NULL : &pairs[pos].data;
+	}
+
+	/**
+	 * Erase an item, return true if erasing was succesful
+	 */
+
+	bool erase( const TKey& p_key ) {
+
+		int found=_find_pos(p_key,_sanitize_hash(Hasher::hash(p_key)));
+		if (found<0)
+			return false;
+
+		uint32_t mask=_get_capacity()-1;
+		uint32_t pos=found;
+		pairs[pos].~Pair();
+		hashes[pos]=EMPTY_HASH;
+
+		/* backward shift the entries that follow, so no tombstones are needed */
+		uint32_t next=(pos+1)&mask;
+		while(hashes[next]!=EMPTY_HASH && _get_probe_length(next,hashes[next])>0) {
+
+			memnew_placement(&pairs[pos],Pair(pairs[next]));
+			hashes[pos]=hashes[next];
+			pairs[next].~Pair();
+			hashes[next]=EMPTY_HASH;
+
+			pos=next;
+			next=(next+1)&mask;
+		}
+
+		elements--;
+		return true;
+	}
+
+	inline const TData& operator[](const TKey& p_key) const { //constref
+
+		return get(p_key);
+	}
+
+	inline TData& operator[](const TKey& p_key ) { //assignment
+
+		uint32_t hash=_sanitize_hash(Hasher::hash(p_key));
+		int pos=_find_pos(p_key,hash);
+		if (pos<0)
+			pos=_insert(Pair(p_key,TData()),hash);
+
+		return pairs[pos].data;
+	}
+
+	/**
+	 * Get the next key to p_key, and the first key if p_key is null.
+	 * Returns a pointer to the next key if found, NULL otherwise.
+	 * Adding/Removing elements while iterating will, of course, have unexpected results, don't do it.
+	 *
+	 * Example:
+	 *
+	 * 	const TKey *k=NULL;
+	 *
+	 * 	while( (k=table.next(k)) ) {
+	 *
+	 * 		print( *k );
+	 * 	}
+	 *
+	*/
+	const TKey* next(const TKey* p_key) const {
+
+		if (!hashes) return NULL;
+
+		uint32_t from=0;
+		if (p_key) {
+
+			int pos=_get_key_pos(p_key);
+			ERR_FAIL_COND_V(pos<0,NULL);
+			from=pos+1;
+		}
+
+		for(uint32_t i=from;i<_get_capacity();i++) {
+
+			if (hashes[i]!=EMPTY_HASH)
+				return &pairs[i].key;
+		}
+
+		return NULL;
+	}
+
+	inline unsigned int size() const {
+
+		return elements;
+	}
+
+	inline bool empty() const {
+
+		return elements==0;
+	}
+
+	void clear() {
+
+		if (hashes) {
+
+			for(uint32_t i=0;i<_get_capacity();i++) {
+
+				if (hashes[i]!=EMPTY_HASH)
+					pairs[i].~Pair();
+			}
+
+			memfree(hashes);
+			memfree(pairs);
+		}
+
+		hashes=NULL;
+		pairs=NULL;
+		hash_table_power=0;
+		elements=0;
+	}
+
+	void operator=(const OAHashMap& p_table) {
+
+		copy_from(p_table);
+	}
+
+	void get_key_list(List<TKey> *p_keys) const {
+
+		if (!hashes)
+			return;
+		for(uint32_t i=0;i<_get_capacity();i++) {
+
+			if (hashes[i]!=EMPTY_HASH)
+				p_keys->push_back(pairs[i].key);
+		}
+	}
+
+	OAHashMap() {
+
+		hashes=NULL;
+		pairs=NULL;
+		elements=0;
+		hash_table_power=0;
+	}
+
+	OAHashMap(const OAHashMap& p_table) {
+
+		hashes=NULL;
+		pairs=NULL;
+		elements=0;
+		hash_table_power=0;
+
+		copy_from(p_table);
+	}
+
+	~OAHashMap() {
+
+		clear();
+	}
+
+};
+
+#endif
@@ -595,6 +595,24 @@ public:
 
 };
 
+#ifdef DEBUG_ENABLED
+
+//keeps an object from being freed while one of its methods runs
+struct _ObjectDebugLock {
+
+	Object *obj;
+
+	_ObjectDebugLock(Object *p_obj) {
+		obj=p_obj;
+		obj->_lock_index.ref();
+	}
+	~_ObjectDebugLock() {
+		obj->_lock_index.unref();
+	}
+};
+
+#endif
+
 
 bool predelete_handler(Object *p_object);
 void postinitialize_handler(Object *p_object);
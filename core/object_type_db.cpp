@@ -287,6 +287,16 @@ Object *ObjectTypeDB::instance(const String &p_type) {
 
 	return ti->creation_func();
 }
+ObjectTypeDB::CreationFunc ObjectTypeDB::get_creation_func(const StringName &p_type) {
+
+	OBJTYPE_LOCK;
+
+	TypeInfo *ti=types.getptr(p_type);
+	if (!ti || ti->disabled)
+		return NULL;
+	return ti->creation_func;
+}
+
 bool ObjectTypeDB::can_instance(const String &p_type) {
 	
 	OBJTYPE_LOCK;
@@ -712,6 +722,44 @@ bool ObjectTypeDB::get_property(Object* p_object,const StringName& p_property, V
 	return false;
 }
 
+MethodBind *ObjectTypeDB::get_property_setter(StringName p_type,const StringName& p_property) {
+
+	TypeInfo *check=types.getptr(p_type);
+	while(check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg) {
+
+			if (!psg->setter || psg->index>=0)
+				return NULL;
+			return psg->_setptr;
+		}
+
+		check=check->inherits_ptr;
+	}
+
+	return NULL;
+}
+
+MethodBind *ObjectTypeDB::get_property_getter(StringName p_type,const StringName& p_property) {
+
+	TypeInfo *check=types.getptr(p_type);
+	while(check) {
+		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+		if (psg) {
+
+			if (!psg->getter || psg->index>=0)
+				return NULL;
+			return psg->_getptr;
+		}
+
+		if (check->constant_map.has(p_property))
+			return NULL;
+
+		check=check->inherits_ptr;
+	}
+
+	return NULL;
+}
 
 void ObjectTypeDB::set_method_flags(StringName p_type,StringName p_method,int p_flags) {
 
@@ -32,6 +32,7 @@
 #include "object.h"
 #include "method_bind.h"
 #include "print_string.h"
+#include "oa_hash_map.h"
 /**
 	@author Juan Linietsky <reduzio@gmail.com>
 */
@@ -122,9 +123,9 @@ class ObjectTypeDB {
 	struct TypeInfo {
 		
 		TypeInfo *inherits_ptr;
-		HashMap<StringName,MethodBind*,StringNameHasher> method_map;
-		HashMap<StringName,int,StringNameHasher> constant_map;
-		HashMap<StringName,MethodInfo,StringNameHasher> signal_map;
+		OAHashMap<StringName,MethodBind*,StringNameHasher> method_map;
+		OAHashMap<StringName,int,StringNameHasher> constant_map;
+		OAHashMap<StringName,MethodInfo,StringNameHasher> signal_map;
 		List<PropertyInfo> property_list;
 #ifdef DEBUG_METHODS_ENABLED
 		List<StringName> constant_order;
@@ -132,7 +133,7 @@ class ObjectTypeDB {
 		List<MethodInfo> virtual_methods;
 		StringName category;
 #endif
-		HashMap<StringName,PropertySetGet,StringNameHasher> property_setget;
+		OAHashMap<StringName,PropertySetGet,StringNameHasher> property_setget;
 
 
 		StringName inherits;
@@ -235,6 +236,8 @@ public:
 	static bool is_type(const String &p_type,const String& p_inherits);
 	static bool can_instance(const String &p_type);	
 	static Object *instance(const String &p_type);
+	typedef Object* (*CreationFunc)();
+	static CreationFunc get_creation_func(const StringName &p_type); ///< NULL unless the type itself can be instanced, compat types are not resolved
 
 #if 0
 	template<class N, class M>
@@ -458,6 +461,8 @@ public:
 	static void get_property_list(StringName p_type,List<PropertyInfo> *p_list,bool p_no_inheritance=false);
 	static bool set_property(Object* p_object,const StringName& p_property, const Variant& p_value);
 	static bool get_property(Object* p_object,const StringName& p_property, Variant& r_value);
+	static MethodBind *get_property_setter(StringName p_type,const StringName& p_property); ///< NULL unless set_property() would call this bind directly
+	static MethodBind *get_property_getter(StringName p_type,const StringName& p_property); ///< NULL unless get_property() would call this bind directly
 
 
 
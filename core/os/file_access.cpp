@@ -121,6 +121,32 @@ FileAccess *FileAccess::open(const String& p_path, int p_mode_flags, Error *r_er
 	return ret;
 }
 
+FileAccess *FileAccess::open_mapped(const String& p_path, Error *r_error) {
+
+	FileAccess *ret=NULL;
+	if (PackedData::get_singleton() && !PackedData::get_singleton()->is_disabled()) {
+		ret = PackedData::get_singleton()->try_open_path(p_path);
+		if (ret) {
+			if (r_error)
+				*r_error=OK;
+			return ret;
+		}
+	}
+
+	ret=create_for_path(p_path);
+	Error err = ret->_open_mapped(p_path);
+
+	if (r_error)
+		*r_error=err;
+	if (err!=OK) {
+
+		memdelete(ret);
+		ret=NULL;
+	}
+
+	return ret;
+}
+
 
 FileAccess::CreateFunc FileAccess::get_create_func(AccessType p_access) {
 
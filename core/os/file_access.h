@@ -54,6 +54,7 @@ protected:
 
 	String fix_path(const String& p_path) const;
 	virtual Error _open(const String& p_path, int p_mode_flags)=0; ///< open a file
+	virtual Error _open_mapped(const String& p_path) { return _open(p_path,READ); } ///< open a file for reading, mapped in memory if the backend can
 	virtual uint64_t _get_modified_time(const String& p_file)=0;
 
 
@@ -100,6 +101,7 @@ public:
 	virtual real_t get_real() const;
 
 	virtual int get_buffer(uint8_t *p_dst,int p_length) const; ///< get an array of bytes
+	virtual const uint8_t *get_mapped_buffer(int p_length) const { return NULL; } ///< get the next bytes in place (when the file is mapped in memory) and skip them. Valid until the file is closed. NULL if not supported, use get_buffer() then.
 	virtual String get_line() const;
 	virtual Vector<String> get_csv_line() const;
 	
@@ -137,6 +139,7 @@ public:
 	static FileAccess *create(AccessType p_access); /// Create a file access (for the current platform) this is the only portable way of accessing files.
 	static FileAccess *create_for_path(const String& p_path);
 	static FileAccess *open(const String& p_path, int p_mode_flags, Error *r_error=NULL); /// Create a file access (for the current platform) this is the only portable way of accessing files.
+	static FileAccess *open_mapped(const String& p_path, Error *r_error=NULL); ///< like open() for READ, but the file may be mapped in memory. Only for files nothing writes to while they are open (such as packs), a truncated mapping crashes on read.
 	static CreateFunc get_create_func(AccessType p_access);
 	static bool exists(const String& p_name); ///< return true if a file exists
 	static uint64_t get_modified_time(const String& p_file);
@@ -61,6 +61,8 @@ public:
 
 	virtual void dump_mem_to_file(const char* p_file)=0;
 
+	virtual void thread_exit() {} ///< the calling thread is finishing, give back anything kept for it
+
 	MemoryPoolStatic();
 	virtual ~MemoryPoolStatic();
 
@@ -0,0 +1,428 @@
+/*************************************************************************/
+/*  memory_pool_static_size_class.cpp                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "memory_pool_static_size_class.h"
+#include "error_macros.h"
+#include "os/memory.h"
+#include "os/copymem.h"
+#include "os/os.h"
+#include "os/thread.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+// block sizes include the header and are multiples of 16
+const uint32_t MemoryPoolStaticSizeClass::size_classes[SIZE_CLASS_COUNT]={
+	32,48,64,80,96,128,160,192,256,320,384,512,768,1024,1536,2048
+};
+
+static _THREAD_LOCAL void *_thread_cache=NULL;
+static _THREAD_LOCAL void *_thread_cache_owner=NULL;
+
+MemoryPoolStaticSizeClass::ThreadCache *MemoryPoolStaticSizeClass::_get_thread_cache() {
+
+	if (_thread_cache_owner==this)
+		return (ThreadCache*)_thread_cache;
+
+	// first allocation from this thread, the cache is freed in thread_exit()
+	ThreadCache *tc = (ThreadCache*)::malloc(sizeof(ThreadCache));
+	ERR_FAIL_COND_V(!tc,NULL);
+	for(int i=0;i<SIZE_CLASS_COUNT;i++) {
+		tc->free_list[i]=NULL;
+		tc->free_count[i]=0;
+	}
+	tc->usage=0;
+	tc->allocs=0;
+
+	{
+		MutexLock lock(mutex);
+		tc->next=caches;
+		caches=tc;
+	}
+
+	_thread_cache=tc;
+	_thread_cache_owner=this;
+	return tc;
+}
+
+void MemoryPoolStaticSizeClass::_fetch_from_central(ThreadCache *p_cache,int p_class) {
+
+	MutexLock lock(mutex);
+
+	if (central_count[p_class]<TRANSFER_BLOCKS) {
+
+		uint8_t *mem = (uint8_t*)::malloc(SLAB_SIZE);
+		ERR_FAIL_COND(!mem);
+
+		Slab *slab=(Slab*)mem;
+		slab->next=slabs;
+		slabs=slab;
+		slab_count++;
+
+		uint32_t block_size=size_classes[p_class];
+		for(uint32_t ofs=HEADER_SIZE;ofs+block_size<=SLAB_SIZE;ofs+=block_size) {
+
+			Block *b=(Block*)&mem[ofs];
+			b->next=central_free[p_class];
+			central_free[p_class]=b;
+			central_count[p_class]++;
+		}
+	}
+
+	for(int i=0;i<TRANSFER_BLOCKS && central_free[p_class];i++) {
+
+		Block *b=central_free[p_class];
+		central_free[p_class]=b->next;
+		central_count[p_class]--;
+
+		b->next=p_cache->free_list[p_class];
+		p_cache->free_list[p_class]=b;
+		p_cache->free_count[p_class]++;
+	}
+}
+
+void MemoryPoolStaticSizeClass::_release_to_central(ThreadCache *p_cache,int p_class) {
+
+	MutexLock lock(mutex);
+
+	for(int i=0;i<TRANSFER_BLOCKS && p_cache->free_list[p_class];i++) {
+
+		Block *b=p_cache->free_list[p_class];
+		p_cache->free_list[p_class]=b->next;
+		p_cache->free_count[p_class]--;
+
+		b->next=central_free[p_class];
+		central_free[p_class]=b;
+		central_count[p_class]++;
+	}
+}
+
+void *MemoryPoolStaticSizeClass::_alloc_large(size_t p_bytes) {
+
+	Header *h = (Header*)::malloc(p_bytes+HEADER_SIZE);
+	ERR_FAIL_COND_V(!h,NULL); //out of memory, or unreasonable request
+	h->size_class=LARGE_CLASS;
+	h->size=p_bytes;
+
+	MutexLock lock(mutex);
+	large_usage+=p_bytes;
+	large_allocs++;
+
+	return ((uint8_t*)h)+HEADER_SIZE;
+}
+
+void* MemoryPoolStaticSizeClass::alloc(size_t p_bytes,const char *p_description) {
+
+	ERR_FAIL_COND_V(p_bytes==0,0);
+
+	size_t total=p_bytes+HEADER_SIZE;
+	if (total>MAX_SMALL_SIZE)
+		return _alloc_large(p_bytes);
+
+	int sc=class_for_size[(total+15)>>4];
+
+	ThreadCache *tc=_get_thread_cache();
+	ERR_FAIL_COND_V(!tc,NULL);
+
+	if (!tc->free_list[sc]) {
+		_fetch_from_central(tc,sc);
+		ERR_FAIL_COND_V(!tc->free_list[sc],NULL);
+	}
+
+	Block *b=tc->free_list[sc];
+	tc->free_list[sc]=b->next;
+	tc->free_count[sc]--;
+	tc->usage+=size_classes[sc];
+	tc->allocs++;
+
+	Header *h=(Header*)b;
+	h->size_class=sc;
+	h->size=p_bytes;
+
+	return ((uint8_t*)h)+HEADER_SIZE;
+}
+
+void MemoryPoolStaticSizeClass::free(void *p_ptr) {
+
+	ERR_FAIL_COND(p_ptr==0);
+
+	Header *h=(Header*)(((uint8_t*)p_ptr)-HEADER_SIZE);
+
+	if (h->size_class==LARGE_CLASS) {
+
+		{
+			MutexLock lock(mutex);
+			large_usage-=h->size;
+			large_allocs--;
+		}
+		::free(h);
+		return;
+	}
+
+	int sc=h->size_class;
+	ERR_FAIL_INDEX(sc,SIZE_CLASS_COUNT);
+
+	ThreadCache *tc=_get_thread_cache();
+	ERR_FAIL_COND(!tc);
+
+	// blocks freed from another thread simply move to this thread's cache
+	Block *b=(Block*)h;
+	b->next=tc->free_list[sc];
+	tc->free_list[sc]=b;
+	tc->free_count[sc]++;
+	tc->usage-=size_classes[sc];
+	tc->allocs--;
+
+	if (tc->free_count[sc]>CACHE_MAX_BLOCKS)
+		_release_to_central(tc,sc);
+}
+
+void* MemoryPoolStaticSizeClass::realloc(void *p_memory,size_t p_bytes) {
+
+	if (p_memory==NULL)
+		return alloc(p_bytes);
+
+	if (p_bytes==0) {
+		this->free(p_memory);
+		return NULL;
+	}
+
+	Header *h=(Header*)(((uint8_t*)p_memory)-HEADER_SIZE);
+	size_t total=p_bytes+HEADER_SIZE;
+
+	if (h->size_class==LARGE_CLASS && total>MAX_SMALL_SIZE) {
+
+		size_t old_size=h->size;
+		Header *new_h = (Header*)::realloc(h,total);
+		ERR_FAIL_COND_V(!new_h,NULL);
+		new_h->size=p_bytes;
+
+		MutexLock lock(mutex);
+		large_usage+=p_bytes;
+		large_usage-=old_size;
+		return ((uint8_t*)new_h)+HEADER_SIZE;
+	}
+
+	if (h->size_class!=LARGE_CLASS && total<=size_classes[h->size_class]) {
+		//still fits
+		h->size=p_bytes;
+		return p_memory;
+	}
+
+	void *mem=alloc(p_bytes);
+	ERR_FAIL_COND_V(!mem,NULL);
+	copymem(mem,p_memory,MIN(h->size,p_bytes));
+	this->free(p_memory);
+	return mem;
+}
+
+size_t MemoryPoolStaticSizeClass::_compute_usage() {
+
+	MutexLock lock(mutex);
+
+	int64_t usage=large_usage+retired_usage;
+	for(ThreadCache *tc=caches;tc;tc=tc->next)
+		usage+=tc->usage; // other threads may be updating theirs, this is an estimate
+
+	if (usage<0)
+		usage=0;
+	if ((size_t)usage>max_usage)
+		max_usage=usage;
+
+	return usage;
+}
+
+size_t MemoryPoolStaticSizeClass::get_available_mem() const {
+
+	return 0xffffffff;
+}
+
+size_t MemoryPoolStaticSizeClass::get_total_usage() {
+
+	return _compute_usage();
+}
+
+size_t MemoryPoolStaticSizeClass::get_max_usage() {
+
+	_compute_usage();
+	return max_usage;
+}
+
+int MemoryPoolStaticSizeClass::get_alloc_count() {
+
+	MutexLock lock(mutex);
+
+	int64_t allocs=large_allocs+retired_allocs;
+	for(ThreadCache *tc=caches;tc;tc=tc->next)
+		allocs+=tc->allocs;
+
+	return allocs;
+}
+void * MemoryPoolStaticSizeClass::get_alloc_ptr(int p_alloc_idx) {
+
+	return 0;
+}
+const char* MemoryPoolStaticSizeClass::get_alloc_description(int p_alloc_idx) {
+
+	return "";
+}
+size_t MemoryPoolStaticSizeClass::get_alloc_size(int p_alloc_idx) {
+
+	return 0;
+}
+
+void MemoryPoolStaticSizeClass::dump_mem_to_file(const char* p_file) {
+
+	FILE *f = fopen(p_file,"wb");
+	ERR_FAIL_COND(!f);
+
+	size_t usage=_compute_usage();
+
+	MutexLock lock(mutex);
+
+	int threads=0;
+	int64_t allocs=large_allocs+retired_allocs;
+	for(ThreadCache *tc=caches;tc;tc=tc->next) {
+		threads++;
+		allocs+=tc->allocs;
+	}
+
+	fprintf(f,"usage: %i bytes, max usage: %i bytes\n",(int)usage,(int)max_usage);
+	fprintf(f,"allocations: %i, large: %i bytes in %i\n",(int)allocs,(int)large_usage,(int)large_allocs);
+	fprintf(f,"slabs: %i (%i bytes), thread caches: %i\n",slab_count,slab_count*SLAB_SIZE,threads);
+	for(int i=0;i<SIZE_CLASS_COUNT;i++) {
+		fprintf(f,"class %i bytes: %i free in central list\n",size_classes[i],central_count[i]);
+	}
+
+	fclose(f);
+}
+
+void MemoryPoolStaticSizeClass::thread_exit() {
+
+	if (_thread_cache_owner!=this)
+		return; //never allocated
+
+	ThreadCache *tc=(ThreadCache*)_thread_cache;
+	_thread_cache=NULL;
+	_thread_cache_owner=NULL;
+
+	{
+		MutexLock lock(mutex);
+
+		for(int i=0;i<SIZE_CLASS_COUNT;i++) {
+
+			while(tc->free_list[i]) {
+
+				Block *b=tc->free_list[i];
+				tc->free_list[i]=b->next;
+				b->next=central_free[i];
+				central_free[i]=b;
+				central_count[i]++;
+			}
+		}
+
+		//blocks this thread allocated may be freed by others, keep the counts balanced
+		retired_usage+=tc->usage;
+		retired_allocs+=tc->allocs;
+
+		ThreadCache **from=&caches;
+		while(*from && *from!=tc)
+			from=&(*from)->next;
+		if (*from)
+			*from=tc->next;
+	}
+
+	::free(tc);
+}
+
+MemoryPoolStaticSizeClass::MemoryPoolStaticSizeClass() {
+
+	ERR_FAIL_COND(sizeof(Header)>HEADER_SIZE);
+
+	int sc=0;
+	for(int i=0;i<=(MAX_SMALL_SIZE>>4);i++) {
+
+		while((uint32_t)(i<<4)>size_classes[sc])
+			sc++;
+		class_for_size[i]=sc;
+	}
+
+	for(int i=0;i<SIZE_CLASS_COUNT;i++) {
+		central_free[i]=NULL;
+		central_count[i]=0;
+	}
+
+	slabs=NULL;
+	slab_count=0;
+	caches=NULL;
+	large_usage=0;
+	large_allocs=0;
+	retired_usage=0;
+	retired_allocs=0;
+	max_usage=0;
+
+	mutex=NULL;
+#ifndef NO_THREADS
+
+	mutex=Mutex::create(); // at this point, this should work
+#endif
+
+}
+
+MemoryPoolStaticSizeClass::~MemoryPoolStaticSizeClass() {
+
+	Mutex *old_mutex=mutex;
+	mutex=NULL;
+	if (old_mutex)
+		memdelete(old_mutex);
+
+#ifdef DEBUG_MEMORY_ENABLED
+
+	if (OS::get_singleton()->is_stdout_verbose()) {
+		size_t usage=_compute_usage();
+		if (usage > 0 ) {
+			printf("**ERROR: STATIC ALLOC: ** MEMORY LEAKS DETECTED **\n");
+			printf("**ERROR: STATIC ALLOC: %i bytes of memory in use at exit.\n",(int)usage);
+		}
+	}
+#endif
+
+	while(caches) {
+		ThreadCache *tc=caches;
+		caches=tc->next;
+		::free(tc);
+	}
+
+	while(slabs) {
+		Slab *s=slabs;
+		slabs=s->next;
+		::free(s);
+	}
+
+	_thread_cache=NULL;
+	_thread_cache_owner=NULL;
+}
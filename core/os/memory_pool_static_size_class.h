@@ -0,0 +1,134 @@
+/*************************************************************************/
+/*  memory_pool_static_size_class.h                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef MEMORY_POOL_STATIC_SIZE_CLASS_H
+#define MEMORY_POOL_STATIC_SIZE_CLASS_H
+
+#include "os/memory_pool_static.h"
+#include "os/mutex.h"
+
+/**
+ * Static memory pool that serves small allocations from size classes.
+ * Each thread keeps its own free lists, so the common alloc/free path takes
+ * no lock. Threads refill from (and return to) central free lists in
+ * batches, and the central lists grow by carving slabs obtained from malloc.
+ * Allocations larger than the biggest class go straight to malloc.
+ *
+ * Usage statistics are kept per thread and only added up when queried.
+ * When a thread finishes, its cache goes back to the central lists.
+ */
+
+class MemoryPoolStaticSizeClass : public MemoryPoolStatic {
+public:
+
+	enum {
+		SIZE_CLASS_COUNT=16,
+		MAX_SMALL_SIZE=2048,
+		SLAB_SIZE=64*1024,
+		CACHE_MAX_BLOCKS=128, ///< blocks a thread may hoard per class before giving some back
+		TRANSFER_BLOCKS=32 ///< blocks moved at once between a thread and the central lists
+	};
+
+private:
+
+	enum {
+		LARGE_CLASS=0xFFFF,
+		HEADER_SIZE=DEFAULT_ALIGNMENT ///< keeps returned pointers aligned, Header must fit in it
+	};
+
+	struct Header {
+
+		size_t size;
+		uint32_t size_class;
+	};
+
+	struct Block {
+
+		Block *next;
+	};
+
+	struct Slab {
+
+		Slab *next;
+	};
+
+	struct ThreadCache {
+
+		Block *free_list[SIZE_CLASS_COUNT];
+		int free_count[SIZE_CLASS_COUNT];
+		int64_t usage;
+		int64_t allocs;
+		ThreadCache *next;
+	};
+
+	static const uint32_t size_classes[SIZE_CLASS_COUNT];
+	uint8_t class_for_size[(MAX_SMALL_SIZE>>4)+1];
+
+	Block *central_free[SIZE_CLASS_COUNT];
+	int central_count[SIZE_CLASS_COUNT];
+	Slab *slabs;
+	int slab_count;
+	ThreadCache *caches;
+	int64_t large_usage;
+	int64_t large_allocs;
+	int64_t retired_usage; ///< left behind by threads that finished
+	int64_t retired_allocs;
+	size_t max_usage;
+
+	Mutex *mutex;
+
+	ThreadCache *_get_thread_cache();
+	void _fetch_from_central(ThreadCache *p_cache,int p_class);
+	void _release_to_central(ThreadCache *p_cache,int p_class);
+	void *_alloc_large(size_t p_bytes);
+	size_t _compute_usage();
+
+public:
+
+	virtual void* alloc(size_t p_bytes,const char *p_description="");
+	virtual void free(void *p_ptr);
+	virtual void* realloc(void *p_memory,size_t p_bytes);
+	virtual size_t get_available_mem() const;
+	virtual size_t get_total_usage();
+	virtual size_t get_max_usage();
+
+	virtual int get_alloc_count();
+	/* allocations are not tracked individually, these return nothing */
+	virtual void * get_alloc_ptr(int p_alloc_idx);
+	virtual const char* get_alloc_description(int p_alloc_idx);
+	virtual size_t get_alloc_size(int p_alloc_idx);
+
+	virtual void dump_mem_to_file(const char* p_file);
+
+	virtual void thread_exit();
+
+	MemoryPoolStaticSizeClass();
+	~MemoryPoolStaticSizeClass();
+};
+
+#endif
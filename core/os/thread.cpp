@@ -27,6 +27,8 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 #include "thread.h"
+#include "os/memory_pool_static.h"
+#include "error_macros.h"
 
 
 Thread* (*Thread::create_func)(ThreadCreateCallback,void *,const Settings&)=NULL;
@@ -51,6 +53,28 @@ Thread* Thread::create(ThreadCreateCallback p_callback,void * p_user,const Setti
 	return NULL;
 }
 
+enum {
+	MAX_EXIT_CALLBACKS=8
+};
+
+static Thread::ExitCallback _exit_callbacks[MAX_EXIT_CALLBACKS];
+static int _exit_callback_count=0;
+
+void Thread::add_exit_callback(ExitCallback p_callback) {
+
+	ERR_FAIL_COND(_exit_callback_count==MAX_EXIT_CALLBACKS);
+	_exit_callbacks[_exit_callback_count++]=p_callback;
+}
+
+void Thread::thread_exited() {
+
+	for(int i=_exit_callback_count-1;i>=0;i--)
+		_exit_callbacks[i]();
+
+	//last, the callbacks may free memory
+	MemoryPoolStatic::get_singleton()->thread_exit();
+}
+
 void Thread::wait_to_finish(Thread *p_thread) {
 	
 	if (wait_to_finish_func)
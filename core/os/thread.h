@@ -38,6 +38,15 @@
 
 typedef void (*ThreadCreateCallback)(void *p_userdata);
 
+/* storage class for variables that hold a separate value for each thread */
+#if defined(NO_THREADS)
+#define _THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define _THREAD_LOCAL __declspec(thread)
+#else
+#define _THREAD_LOCAL __thread
+#endif
+
 class Thread {
 public:
 			
@@ -79,6 +88,13 @@ public:
 	static ID get_caller_ID(); ///< get the ID of the caller function ID
 	static void wait_to_finish(Thread *p_thread); ///< waits until thread is finished, and deallocates it.
 	static Thread * create(ThreadCreateCallback p_callback,void * p_user,const Settings& p_settings=Settings()); ///< Static function to create a thread, will call p_callback
+
+	/* per thread caches must be given back when a thread finishes, exit
+	   callbacks run on every thread created here once p_callback returns.
+	   Register them on startup, before any thread is created. */
+	typedef void (*ExitCallback)();
+	static void add_exit_callback(ExitCallback p_callback);
+	static void thread_exited(); ///< platform implementations call this at the end of the thread function
 	
 	
 	virtual ~Thread();
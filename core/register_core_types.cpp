@@ -76,6 +76,9 @@ extern Mutex *_global_mutex;
 
 extern void register_variant_methods();
 extern void unregister_variant_methods();
+extern void register_variant_pool();
+extern void register_variant_operators();
+extern void unregister_variant_pool();
 
 
 void register_core_types() {
@@ -83,11 +86,14 @@ void register_core_types() {
 	
 	_global_mutex=Mutex::create();
 
+	register_variant_pool();
+
 
 	StringName::setup();
 
 
 	register_variant_methods();
+	register_variant_operators();
 
 
 	CoreStringNames::create();
@@ -213,6 +219,8 @@ void unregister_core_types() {
 	ObjectDB::cleanup();
 	StringName::cleanup();
 
+	unregister_variant_pool();
+
 	if (_global_mutex) {
 		memdelete(_global_mutex);
 		_global_mutex=NULL; //still needed at a few places
@@ -161,28 +161,33 @@ void Resource::set_path(const String& p_path, bool p_take_over) {
 
 	if (path_cache==p_path)
 		return;
-		
-	if (path_cache!="") {
-		
-		ResourceCache::resources.erase(path_cache);
-	}
 
-	path_cache="";
-	if (ResourceCache::resources.has( p_path )) {
-		if (p_take_over) {
+	{
+		//resources may be loaded from several threads at once
+		GLOBAL_LOCK_FUNCTION
 
-			ResourceCache::resources.get(p_path)->set_name("");
-		} else {
-			ERR_EXPLAIN("Another resource is loaded from path: "+p_path);
-			ERR_FAIL_COND( ResourceCache::resources.has( p_path ) );
+		if (path_cache!="") {
+
+			ResourceCache::resources.erase(path_cache);
 		}
 
-	}
-	path_cache=p_path;
-	
-	if (path_cache!="") {
-		
-		ResourceCache::resources[path_cache]=this;;
+		path_cache="";
+		if (ResourceCache::resources.has( p_path )) {
+			if (p_take_over) {
+
+				ResourceCache::resources.get(p_path)->set_name("");
+			} else {
+				ERR_EXPLAIN("Another resource is loaded from path: "+p_path);
+				ERR_FAIL_COND( ResourceCache::resources.has( p_path ) );
+			}
+
+		}
+		path_cache=p_path;
+
+		if (path_cache!="") {
+
+			ResourceCache::resources[path_cache]=this;;
+		}
 	}
 
 	_change_notify("resource/path");
@@ -331,8 +336,10 @@ Resource::Resource() {
 
 Resource::~Resource() {
 	
-	if (path_cache!="")
+	if (path_cache!="") {
+		GLOBAL_LOCK_FUNCTION
 		ResourceCache::resources.erase(path_cache);
+	}
 	if (owners.size()) {
 		WARN_PRINT("Resource is still owned");
 	}
@@ -380,6 +387,7 @@ Resource *ResourceCache::get(const String& p_path) {
 
 void ResourceCache::get_cached_resources(List<Ref<Resource> > *p_resources) {
 
+	GLOBAL_LOCK_FUNCTION
 
 	const String* K=NULL;
 	while((K=resources.next(K))) {
@@ -393,6 +401,7 @@ void ResourceCache::get_cached_resources(List<Ref<Resource> > *p_resources) {
 
 int ResourceCache::get_cached_resource_count() {
 
+	GLOBAL_LOCK_FUNCTION
 	return resources.size();
 }
 
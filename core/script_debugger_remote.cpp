@@ -331,6 +331,12 @@ void ScriptDebuggerRemote::_poll_events() {
 
 			if (request_scene_tree)
 				request_scene_tree(request_scene_tree_ud);
+		} else if (command=="start_profiling") {
+
+			_profiling_start();
+		} else if (command=="stop_profiling") {
+
+			_profiling_stop();
 		}
 
 	}
@@ -371,11 +377,83 @@ void ScriptDebuggerRemote::idle_poll() {
 		}
 	    }
 
+	    if (profiling) {
+
+		uint64_t pt = OS::get_singleton()->get_ticks_msec();
+		if (pt-last_profile_time > 1000) {
+
+			last_profile_time=pt;
+			_send_profiling_data();
+		}
+	    }
+
 	    _poll_events();
 
 }
 
 
+void ScriptDebuggerRemote::_profiling_start() {
+
+	if (profiling)
+		return;
+
+	profile_info.resize(GLOBAL_DEF("debug/profiler_max_functions",16384));
+	for(int i=0;i<ScriptServer::get_language_count();i++)
+		ScriptServer::get_language(i)->profiling_start();
+
+	profiling=true;
+	last_profile_time=OS::get_singleton()->get_ticks_msec();
+}
+
+void ScriptDebuggerRemote::_profiling_stop() {
+
+	if (!profiling)
+		return;
+
+	_send_profiling_data(); //last chunk, so the table shows the final totals
+
+	for(int i=0;i<ScriptServer::get_language_count();i++)
+		ScriptServer::get_language(i)->profiling_stop();
+
+	profiling=false;
+	profile_info.clear();
+}
+
+static void _profiling_info_to_array(Array& r_array,const ScriptLanguage::ProfilingInfo *p_info,int p_count) {
+
+	//flat array of signature, call count, total msec, self msec
+	for(int i=0;i<p_count;i++) {
+
+		r_array.push_back(String(p_info[i].signature));
+		r_array.push_back(int(p_info[i].call_count));
+		r_array.push_back(double(p_info[i].total_time)/1000.0);
+		r_array.push_back(double(p_info[i].self_time)/1000.0);
+	}
+}
+
+void ScriptDebuggerRemote::_send_profiling_data() {
+
+	Array accumulated;
+	Array frame;
+
+	ScriptLanguage::ProfilingInfo *info = &profile_info[0];
+	int info_max = profile_info.size();
+
+	for(int i=0;i<ScriptServer::get_language_count();i++) {
+
+		ScriptLanguage *lang=ScriptServer::get_language(i);
+		int count = lang->profiling_get_accumulated_data(info,info_max);
+		_profiling_info_to_array(accumulated,info,count);
+		count = lang->profiling_get_frame_data(info,info_max);
+		_profiling_info_to_array(frame,info,count);
+	}
+
+	packet_peer_stream->put_var("profile_data");
+	packet_peer_stream->put_var(2);
+	packet_peer_stream->put_var(accumulated);
+	packet_peer_stream->put_var(frame);
+}
+
 void ScriptDebuggerRemote::send_message(const String& p_message, const Array &p_args) {
 
 	mutex->lock();
@@ -427,6 +505,8 @@ ScriptDebuggerRemote::ScriptDebuggerRemote() {
 	requested_quit=false;
 	performance = Globals::get_singleton()->get_singleton_object("Performance");
 	last_perf_time=0;
+	profiling=false;
+	last_profile_time=0;
 	poll_every=0;
 	request_scene_tree=NULL;
 
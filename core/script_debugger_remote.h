@@ -47,6 +47,9 @@ class ScriptDebuggerRemote : public ScriptDebugger {
 
 	uint64_t last_perf_time;
 	Object *performance;
+	bool profiling;
+	uint64_t last_profile_time;
+	Vector<ScriptLanguage::ProfilingInfo> profile_info;
 	bool requested_quit;
 	Mutex *mutex;
 	List<String> output_strings;
@@ -59,6 +62,9 @@ class ScriptDebuggerRemote : public ScriptDebugger {
 
 	void _get_output();
 	void _poll_events();
+	void _profiling_start();
+	void _profiling_stop();
+	void _send_profiling_data();
 	uint32_t poll_every;
 
 
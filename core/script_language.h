@@ -165,6 +165,23 @@ public:
 	virtual void get_public_functions(List<MethodInfo> *p_functions) const=0;
 	virtual void get_public_constants(List<Pair<String,Variant> > *p_constants) const=0;
 
+	/* PROFILER FUNCTIONS */
+
+	struct ProfilingInfo {
+
+		StringName signature;
+		uint64_t call_count;
+		uint64_t total_time; // usec, including called script functions
+		uint64_t self_time; // usec, excluding called script functions
+	};
+
+	virtual void profiling_start() {}
+	virtual void profiling_stop() {}
+	virtual bool is_profiling() const { return false; }
+	// both return the amount of entries written to p_info_arr
+	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr,int p_info_max) { return 0; }
+	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr,int p_info_max) { return 0; }
+
 	virtual void frame();
 
 	virtual ~ScriptLanguage() {};	
@@ -32,6 +32,141 @@
 #include "scene/main/node.h"
 #include "scene/gui/control.h"
 #include "io/marshalls.h"
+#include "allocators.h"
+#include "os/mutex.h"
+#include "os/thread.h"
+#include "safe_refcount.h"
+
+
+
+/* Matrix32, AABB, Matrix3 and Transform don't fit in _data._mem, so they are
+   heap allocated. Temporaries of these types are created all the time by
+   script math, so they come from a chunk pool instead of the static pool.
+   Each thread keeps a few free chunks of its own, so the pool lock is only
+   taken to move chunks in batches. */
+
+#define _VARIANT_MAX_SIZE(m_a,m_b) ((m_a)>(m_b)?(m_a):(m_b))
+
+enum {
+	VARIANT_POOL_CHUNK_SIZE=_VARIANT_MAX_SIZE( _VARIANT_MAX_SIZE(sizeof(Matrix32),sizeof(AABB)), _VARIANT_MAX_SIZE(sizeof(Matrix3),sizeof(Transform)) )
+};
+
+enum {
+	VARIANT_POOL_CACHE_MAX=64, ///< free chunks a thread may keep
+	VARIANT_POOL_TRANSFER=16 ///< chunks moved at once between a thread and the pool
+};
+
+struct _VariantPoolFree {
+
+	_VariantPoolFree *next;
+};
+
+static ChunkAllocator<VARIANT_POOL_CHUNK_SIZE> _variant_pool;
+static Mutex *_variant_pool_mutex=NULL;
+static SafeRefCount _variant_pool_registered; //read without the lock on every free, zero while not registered
+
+static _THREAD_LOCAL _VariantPoolFree *_variant_pool_cache=NULL;
+static _THREAD_LOCAL int _variant_pool_cache_count=0;
+
+static void _variant_pool_release(int p_count) {
+
+	//pool lock must be held
+	for(int i=0;i<p_count && _variant_pool_cache;i++) {
+
+		_VariantPoolFree *c=_variant_pool_cache;
+		_variant_pool_cache=c->next;
+		_variant_pool_cache_count--;
+		_variant_pool.free(c);
+	}
+
+	if (!_variant_pool_registered.get() && _variant_pool.get_used()==0) {
+		//last one alive after unregister, nobody else will use the pages
+		_variant_pool.clear();
+	}
+}
+
+static void _variant_pool_thread_exit() {
+
+	if (!_variant_pool_cache)
+		return;
+
+	MutexLock lock(_variant_pool_mutex);
+	_variant_pool_release(_variant_pool_cache_count);
+}
+
+void *VariantPoolAllocator::alloc(size_t p_bytes) {
+
+	ERR_FAIL_COND_V( p_bytes>VARIANT_POOL_CHUNK_SIZE, NULL );
+
+	if (!_variant_pool_cache) {
+
+		MutexLock lock(_variant_pool_mutex);
+		for(int i=0;i<VARIANT_POOL_TRANSFER;i++) {
+
+			_VariantPoolFree *c=(_VariantPoolFree*)_variant_pool.alloc();
+			ERR_BREAK(!c);
+			c->next=_variant_pool_cache;
+			_variant_pool_cache=c;
+			_variant_pool_cache_count++;
+		}
+		ERR_FAIL_COND_V(!_variant_pool_cache,NULL);
+	}
+
+	_VariantPoolFree *c=_variant_pool_cache;
+	_variant_pool_cache=c->next;
+	_variant_pool_cache_count--;
+	return c;
+}
+
+void VariantPoolAllocator::free(void *p_ptr) {
+
+	_VariantPoolFree *c=(_VariantPoolFree*)p_ptr;
+	c->next=_variant_pool_cache;
+	_variant_pool_cache=c;
+	_variant_pool_cache_count++;
+
+	if (!_variant_pool_registered.get()) {
+		//after unregister, give everything back so the pages can go
+		MutexLock lock(_variant_pool_mutex);
+		_variant_pool_release(_variant_pool_cache_count);
+	} else if (_variant_pool_cache_count>VARIANT_POOL_CACHE_MAX) {
+
+		MutexLock lock(_variant_pool_mutex);
+		_variant_pool_release(VARIANT_POOL_TRANSFER);
+	}
+}
+
+int VariantPoolAllocator::get_used() {
+
+	return _variant_pool.get_used();
+}
+
+int VariantPoolAllocator::get_allocated() {
+
+	return _variant_pool.get_allocated();
+}
+
+void register_variant_pool() {
+
+	_variant_pool_mutex=Mutex::create();
+	_variant_pool_registered.init();
+	Thread::add_exit_callback(_variant_pool_thread_exit);
+}
+
+void unregister_variant_pool() {
+
+	//static variants may still be alive, their chunks go back as they are freed
+	_variant_pool_registered.unref();
+
+	Mutex *m=_variant_pool_mutex;
+	_variant_pool_mutex=NULL;
+	if (m)
+		memdelete(m);
+
+	//other threads are finished by now, only this one may keep chunks
+	_variant_pool_release(_variant_pool_cache_count);
+}
+
 
 
 
@@ -624,6 +759,17 @@ void Variant::reference(const Variant& p_variant) {
 	
 	if (this == &p_variant)
 		return;
+
+	if (type==p_variant.type) {
+		// pooled math types can be overwritten in place
+		switch(type) {
+			case MATRIX32: { *_data._matrix32=*p_variant._data._matrix32; return; } break;
+			case _AABB: { *_data._aabb=*p_variant._data._aabb; return; } break;
+			case MATRIX3: { *_data._matrix3=*p_variant._data._matrix3; return; } break;
+			case TRANSFORM: { *_data._transform=*p_variant._data._transform; return; } break;
+			default: {}
+		}
+	}
 		
 	clear();
 		
@@ -670,7 +816,7 @@ void Variant::reference(const Variant& p_variant) {
 		} break;
 		case MATRIX32: {
 
-			_data._matrix32 = memnew( Matrix32( *p_variant._data._matrix32 ) );
+			_data._matrix32 = memnew_allocator( Matrix32( *p_variant._data._matrix32 ), VariantPoolAllocator );
 
 		} break;
 		case VECTOR3: {
@@ -690,7 +836,7 @@ void Variant::reference(const Variant& p_variant) {
 		} break;*/
 		case _AABB: {
 		
-			_data._aabb = memnew( AABB( *p_variant._data._aabb ) );
+			_data._aabb = memnew_allocator( AABB( *p_variant._data._aabb ), VariantPoolAllocator );
 		} break;
 		case QUAT: {
 		
@@ -699,12 +845,12 @@ void Variant::reference(const Variant& p_variant) {
 		} break;
 		case MATRIX3: {
 		
-			_data._matrix3 = memnew( Matrix3( *p_variant._data._matrix3 ) );
+			_data._matrix3 = memnew_allocator( Matrix3( *p_variant._data._matrix3 ), VariantPoolAllocator );
 		
 		} break;
 		case TRANSFORM: {
 		
-			_data._transform = memnew( Transform( *p_variant._data._transform ) );
+			_data._transform = memnew_allocator( Transform( *p_variant._data._transform ), VariantPoolAllocator );
 		
 		} break;
 		
@@ -807,21 +953,21 @@ void Variant::clear() {
 	*/
 		case MATRIX32: {
 
-			memdelete( _data._matrix32 );
+			memdelete_allocator<Matrix32,VariantPoolAllocator>( _data._matrix32 );
 
 		} break;
 		case _AABB: {
 		
-			memdelete( _data._aabb );
+			memdelete_allocator<AABB,VariantPoolAllocator>( _data._aabb );
 		
 		} break;
 		case MATRIX3: {
 		
-			memdelete( _data._matrix3 );
+			memdelete_allocator<Matrix3,VariantPoolAllocator>( _data._matrix3 );
 		} break;
 		case TRANSFORM: {
 		
-			memdelete( _data._transform );
+			memdelete_allocator<Transform,VariantPoolAllocator>( _data._transform );
 		
 		} break;
 		
@@ -1923,13 +2069,13 @@ Variant::Variant(const Plane& p_plane) {
 Variant::Variant(const AABB& p_aabb) {
 
 	type=_AABB;
-	_data._aabb = memnew( AABB( p_aabb ) );
+	_data._aabb = memnew_allocator( AABB( p_aabb ), VariantPoolAllocator );
 }
 
 Variant::Variant(const Matrix3& p_matrix) {
 
 	type=MATRIX3;
-	_data._matrix3= memnew( Matrix3( p_matrix ) );
+	_data._matrix3= memnew_allocator( Matrix3( p_matrix ), VariantPoolAllocator );
 
 }
 
@@ -1942,14 +2088,14 @@ Variant::Variant(const Quat& p_quat) {
 Variant::Variant(const Transform& p_transform) {
 
 	type=TRANSFORM;
-	_data._transform = memnew( Transform( p_transform ) );
+	_data._transform = memnew_allocator( Transform( p_transform ), VariantPoolAllocator );
 
 }
 
 Variant::Variant(const Matrix32& p_transform) {
 
 	type=MATRIX32;
-	_data._matrix32 = memnew( Matrix32( p_transform ) );
+	_data._matrix32 = memnew_allocator( Matrix32( p_transform ), VariantPoolAllocator );
 
 }
 Variant::Variant(const Color& p_color) {
@@ -71,6 +71,15 @@ typedef DVector<Vector2> Vector2Array;
 typedef DVector<Vector3> Vector3Array;
 typedef DVector<Color> ColorArray;
 
+class VariantPoolAllocator {
+public:
+	static void *alloc(size_t p_bytes);
+	static void free(void *p_ptr);
+
+	static int get_used(); ///< includes the free chunks threads keep for themselves
+	static int get_allocated();
+};
+
 class Variant {
 public:
 
@@ -123,8 +132,9 @@ private:
 
 
 	friend class _VariantCall;
+	friend class _VariantOperators;
 	// Variant takes 20 bytes when real_t is float, and 36 if double
-	// it only allocates extra memory for aabb/matrix.
+	// it only allocates extra memory for aabb/matrix, which comes from VariantPoolAllocator.
 	
 	Type type;
 
@@ -360,7 +370,10 @@ public:
 	};
 
 
+	typedef void (*OperatorEvaluator)(const Variant& p_a,const Variant& p_b,Variant &r_ret);
+
 	static String get_operator_name(Operator p_op);
+	static OperatorEvaluator get_operator_evaluator(Operator p_op,Type p_type_a,Type p_type_b); ///< NULL if the operation has no direct evaluator, use evaluate() instead
 	static void evaluate(const Operator& p_op,const Variant& p_a, const Variant& p_b,Variant &r_ret,bool &r_valid);
 	static _FORCE_INLINE_ Variant evaluate(const Operator& p_op,const Variant& p_a, const Variant& p_b) {
 
@@ -210,11 +210,195 @@ case m_name: {r_valid=false;\
 return;}
 
 
+/* Specialized evaluators for the most common typed operations. They skip the
+   operator/type switches entirely, so once a caller knows both operand types
+   it can fetch one with Variant::get_operator_evaluator() and call it
+   directly. Only operations that can never fail are registered here; any
+   combination without an entry goes through the generic switch below. */
+
+class _VariantOperators {
+public:
+
+	static Variant::OperatorEvaluator table[Variant::OP_MAX][Variant::VARIANT_MAX][Variant::VARIANT_MAX];
+
+#define _OP_INT(m_v) (m_v)._data._int
+#define _OP_REAL(m_v) (m_v)._data._real
+#define _OP_BOOL(m_v) (m_v)._data._bool
+#define _OP_MEM(m_v,m_type) (*reinterpret_cast<const m_type*>((m_v)._data._mem))
+#define _OP_PTR(m_v,m_sub) (*(m_v)._data.m_sub)
+
+#define OPERATOR_EVALUATOR(m_name,m_expr)\
+	static void m_name(const Variant& p_a, const Variant& p_b, Variant &r_ret) { r_ret=m_expr; }
+
+#define OPERATOR_EVALUATORS_NUM(m_name,m_op)\
+	OPERATOR_EVALUATOR(m_name##_int_int, _OP_INT(p_a) m_op _OP_INT(p_b))\
+	OPERATOR_EVALUATOR(m_name##_int_real, _OP_INT(p_a) m_op _OP_REAL(p_b))\
+	OPERATOR_EVALUATOR(m_name##_real_int, _OP_REAL(p_a) m_op _OP_INT(p_b))\
+	OPERATOR_EVALUATOR(m_name##_real_real, _OP_REAL(p_a) m_op _OP_REAL(p_b))
+
+	OPERATOR_EVALUATORS_NUM(equal,==)
+	OPERATOR_EVALUATORS_NUM(not_equal,!=)
+	OPERATOR_EVALUATORS_NUM(less,<)
+	OPERATOR_EVALUATORS_NUM(less_equal,<=)
+	OPERATOR_EVALUATORS_NUM(greater,>)
+	OPERATOR_EVALUATORS_NUM(greater_equal,>=)
+	OPERATOR_EVALUATORS_NUM(add,+)
+	OPERATOR_EVALUATORS_NUM(sub,-)
+	OPERATOR_EVALUATORS_NUM(mul,*)
+	// int/int is left out, it needs the division by zero check
+	OPERATOR_EVALUATOR(div_int_real, _OP_INT(p_a) / _OP_REAL(p_b))
+	OPERATOR_EVALUATOR(div_real_int, _OP_REAL(p_a) / _OP_INT(p_b))
+	OPERATOR_EVALUATOR(div_real_real, _OP_REAL(p_a) / _OP_REAL(p_b))
+
+	OPERATOR_EVALUATOR(neg_int, -_OP_INT(p_a))
+	OPERATOR_EVALUATOR(neg_real, -_OP_REAL(p_a))
+	OPERATOR_EVALUATOR(shl_int_int, _OP_INT(p_a) << _OP_INT(p_b))
+	OPERATOR_EVALUATOR(shr_int_int, _OP_INT(p_a) >> _OP_INT(p_b))
+	OPERATOR_EVALUATOR(bit_and_int_int, _OP_INT(p_a) & _OP_INT(p_b))
+	OPERATOR_EVALUATOR(bit_or_int_int, _OP_INT(p_a) | _OP_INT(p_b))
+	OPERATOR_EVALUATOR(bit_xor_int_int, _OP_INT(p_a) ^ _OP_INT(p_b))
+	OPERATOR_EVALUATOR(bit_neg_int, ~_OP_INT(p_a))
+
+	OPERATOR_EVALUATOR(and_bool_bool, _OP_BOOL(p_a) && _OP_BOOL(p_b))
+	OPERATOR_EVALUATOR(or_bool_bool, _OP_BOOL(p_a) || _OP_BOOL(p_b))
+	OPERATOR_EVALUATOR(not_bool, !_OP_BOOL(p_a))
+	OPERATOR_EVALUATOR(equal_bool_bool, _OP_BOOL(p_a) == _OP_BOOL(p_b))
+	OPERATOR_EVALUATOR(not_equal_bool_bool, _OP_BOOL(p_a) != _OP_BOOL(p_b))
+
+	OPERATOR_EVALUATOR(equal_string_string, _OP_MEM(p_a,String) == _OP_MEM(p_b,String))
+	OPERATOR_EVALUATOR(not_equal_string_string, _OP_MEM(p_a,String) != _OP_MEM(p_b,String))
+	OPERATOR_EVALUATOR(add_string_string, _OP_MEM(p_a,String) + _OP_MEM(p_b,String))
+
+#define OPERATOR_EVALUATORS_VEC(m_vec,m_type)\
+	OPERATOR_EVALUATOR(equal_##m_vec, _OP_MEM(p_a,m_type) == _OP_MEM(p_b,m_type))\
+	OPERATOR_EVALUATOR(not_equal_##m_vec, _OP_MEM(p_a,m_type) != _OP_MEM(p_b,m_type))\
+	OPERATOR_EVALUATOR(add_##m_vec, _OP_MEM(p_a,m_type) + _OP_MEM(p_b,m_type))\
+	OPERATOR_EVALUATOR(sub_##m_vec, _OP_MEM(p_a,m_type) - _OP_MEM(p_b,m_type))\
+	OPERATOR_EVALUATOR(mul_##m_vec, _OP_MEM(p_a,m_type) * _OP_MEM(p_b,m_type))\
+	OPERATOR_EVALUATOR(mul_##m_vec##_int, _OP_MEM(p_a,m_type) * _OP_INT(p_b))\
+	OPERATOR_EVALUATOR(mul_##m_vec##_real, _OP_MEM(p_a,m_type) * _OP_REAL(p_b))\
+	OPERATOR_EVALUATOR(mul_int_##m_vec, _OP_INT(p_a) * _OP_MEM(p_b,m_type))\
+	OPERATOR_EVALUATOR(mul_real_##m_vec, _OP_REAL(p_a) * _OP_MEM(p_b,m_type))\
+	OPERATOR_EVALUATOR(div_##m_vec, _OP_MEM(p_a,m_type) / _OP_MEM(p_b,m_type))\
+	OPERATOR_EVALUATOR(div_##m_vec##_int, _OP_MEM(p_a,m_type) / _OP_INT(p_b))\
+	OPERATOR_EVALUATOR(div_##m_vec##_real, _OP_MEM(p_a,m_type) / _OP_REAL(p_b))\
+	OPERATOR_EVALUATOR(neg_##m_vec, -_OP_MEM(p_a,m_type))
+
+	OPERATOR_EVALUATORS_VEC(vector2,Vector2)
+	OPERATOR_EVALUATORS_VEC(vector3,Vector3)
+
+	OPERATOR_EVALUATOR(mul_matrix32_matrix32, _OP_PTR(p_a,_matrix32) * _OP_PTR(p_b,_matrix32))
+	OPERATOR_EVALUATOR(mul_matrix3_matrix3, _OP_PTR(p_a,_matrix3) * _OP_PTR(p_b,_matrix3))
+	OPERATOR_EVALUATOR(mul_matrix3_vector3, p_a._data._matrix3->xform(_OP_MEM(p_b,Vector3)))
+	OPERATOR_EVALUATOR(mul_transform_transform, _OP_PTR(p_a,_transform) * _OP_PTR(p_b,_transform))
+	OPERATOR_EVALUATOR(mul_transform_vector3, p_a._data._transform->xform(_OP_MEM(p_b,Vector3)))
+
+	static void register_evaluators();
+};
+
+Variant::OperatorEvaluator _VariantOperators::table[Variant::OP_MAX][Variant::VARIANT_MAX][Variant::VARIANT_MAX];
+
+void _VariantOperators::register_evaluators() {
+
+#define REGISTER_EVALUATOR(m_op,m_type_a,m_type_b,m_func)\
+	table[Variant::m_op][Variant::m_type_a][Variant::m_type_b]=m_func;
+
+	// unary operators are compiled with the operand repeated, so accept any right side
+#define REGISTER_EVALUATOR_UNARY(m_op,m_type,m_func)\
+	for(int i=0;i<Variant::VARIANT_MAX;i++)\
+		table[Variant::m_op][Variant::m_type][i]=m_func;
+
+#define REGISTER_EVALUATORS_NUM(m_op,m_name)\
+	REGISTER_EVALUATOR(m_op,INT,INT,m_name##_int_int);\
+	REGISTER_EVALUATOR(m_op,INT,REAL,m_name##_int_real);\
+	REGISTER_EVALUATOR(m_op,REAL,INT,m_name##_real_int);\
+	REGISTER_EVALUATOR(m_op,REAL,REAL,m_name##_real_real);
+
+	REGISTER_EVALUATORS_NUM(OP_EQUAL,equal);
+	REGISTER_EVALUATORS_NUM(OP_NOT_EQUAL,not_equal);
+	REGISTER_EVALUATORS_NUM(OP_LESS,less);
+	REGISTER_EVALUATORS_NUM(OP_LESS_EQUAL,less_equal);
+	REGISTER_EVALUATORS_NUM(OP_GREATER,greater);
+	REGISTER_EVALUATORS_NUM(OP_GREATER_EQUAL,greater_equal);
+	REGISTER_EVALUATORS_NUM(OP_ADD,add);
+	REGISTER_EVALUATORS_NUM(OP_SUBSTRACT,sub);
+	REGISTER_EVALUATORS_NUM(OP_MULTIPLY,mul);
+	REGISTER_EVALUATOR(OP_DIVIDE,INT,REAL,div_int_real);
+	REGISTER_EVALUATOR(OP_DIVIDE,REAL,INT,div_real_int);
+	REGISTER_EVALUATOR(OP_DIVIDE,REAL,REAL,div_real_real);
+
+	REGISTER_EVALUATOR_UNARY(OP_NEGATE,INT,neg_int);
+	REGISTER_EVALUATOR_UNARY(OP_NEGATE,REAL,neg_real);
+	REGISTER_EVALUATOR(OP_SHIFT_LEFT,INT,INT,shl_int_int);
+	REGISTER_EVALUATOR(OP_SHIFT_RIGHT,INT,INT,shr_int_int);
+	REGISTER_EVALUATOR(OP_BIT_AND,INT,INT,bit_and_int_int);
+	REGISTER_EVALUATOR(OP_BIT_OR,INT,INT,bit_or_int_int);
+	REGISTER_EVALUATOR(OP_BIT_XOR,INT,INT,bit_xor_int_int);
+	REGISTER_EVALUATOR_UNARY(OP_BIT_NEGATE,INT,bit_neg_int);
+
+	REGISTER_EVALUATOR(OP_AND,BOOL,BOOL,and_bool_bool);
+	REGISTER_EVALUATOR(OP_OR,BOOL,BOOL,or_bool_bool);
+	REGISTER_EVALUATOR_UNARY(OP_NOT,BOOL,not_bool);
+	REGISTER_EVALUATOR(OP_EQUAL,BOOL,BOOL,equal_bool_bool);
+	REGISTER_EVALUATOR(OP_NOT_EQUAL,BOOL,BOOL,not_equal_bool_bool);
+
+	REGISTER_EVALUATOR(OP_EQUAL,STRING,STRING,equal_string_string);
+	REGISTER_EVALUATOR(OP_NOT_EQUAL,STRING,STRING,not_equal_string_string);
+	REGISTER_EVALUATOR(OP_ADD,STRING,STRING,add_string_string);
+
+#define REGISTER_EVALUATORS_VEC(m_type,m_vec)\
+	REGISTER_EVALUATOR(OP_EQUAL,m_type,m_type,equal_##m_vec);\
+	REGISTER_EVALUATOR(OP_NOT_EQUAL,m_type,m_type,not_equal_##m_vec);\
+	REGISTER_EVALUATOR(OP_ADD,m_type,m_type,add_##m_vec);\
+	REGISTER_EVALUATOR(OP_SUBSTRACT,m_type,m_type,sub_##m_vec);\
+	REGISTER_EVALUATOR(OP_MULTIPLY,m_type,m_type,mul_##m_vec);\
+	REGISTER_EVALUATOR(OP_MULTIPLY,m_type,INT,mul_##m_vec##_int);\
+	REGISTER_EVALUATOR(OP_MULTIPLY,m_type,REAL,mul_##m_vec##_real);\
+	REGISTER_EVALUATOR(OP_MULTIPLY,INT,m_type,mul_int_##m_vec);\
+	REGISTER_EVALUATOR(OP_MULTIPLY,REAL,m_type,mul_real_##m_vec);\
+	REGISTER_EVALUATOR(OP_DIVIDE,m_type,m_type,div_##m_vec);\
+	REGISTER_EVALUATOR(OP_DIVIDE,m_type,INT,div_##m_vec##_int);\
+	REGISTER_EVALUATOR(OP_DIVIDE,m_type,REAL,div_##m_vec##_real);\
+	REGISTER_EVALUATOR_UNARY(OP_NEGATE,m_type,neg_##m_vec);
+
+	REGISTER_EVALUATORS_VEC(VECTOR2,vector2);
+	REGISTER_EVALUATORS_VEC(VECTOR3,vector3);
+
+	REGISTER_EVALUATOR(OP_MULTIPLY,MATRIX32,MATRIX32,mul_matrix32_matrix32);
+	REGISTER_EVALUATOR(OP_MULTIPLY,MATRIX3,MATRIX3,mul_matrix3_matrix3);
+	REGISTER_EVALUATOR(OP_MULTIPLY,MATRIX3,VECTOR3,mul_matrix3_vector3);
+	REGISTER_EVALUATOR(OP_MULTIPLY,TRANSFORM,TRANSFORM,mul_transform_transform);
+	REGISTER_EVALUATOR(OP_MULTIPLY,TRANSFORM,VECTOR3,mul_transform_vector3);
+
+}
+
+void register_variant_operators() {
+
+	_VariantOperators::register_evaluators();
+}
+
+Variant::OperatorEvaluator Variant::get_operator_evaluator(Operator p_op,Type p_type_a,Type p_type_b) {
+
+	ERR_FAIL_INDEX_V(p_op,OP_MAX,NULL);
+	ERR_FAIL_INDEX_V(p_type_a,VARIANT_MAX,NULL);
+	ERR_FAIL_INDEX_V(p_type_b,VARIANT_MAX,NULL);
+	return _VariantOperators::table[p_op][p_type_a][p_type_b];
+}
+
 void Variant::evaluate(const Operator& p_op, const Variant& p_a, const Variant& p_b, Variant &r_ret, bool &r_valid) {
 
 
 	r_valid=true;
 
+	if (p_op<OP_MAX) {
+
+		OperatorEvaluator evaluator=_VariantOperators::table[p_op][p_a.type][p_b.type];
+		if (evaluator) {
+			evaluator(p_a,p_b,r_ret);
+			return;
+		}
+	}
+
 	switch(p_op) {
 
 		case OP_EQUAL: {
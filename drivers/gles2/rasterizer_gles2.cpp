@@ -1371,6 +1371,15 @@ void RasterizerGLES2::texture_set_reload_hook(RID p_texture,ObjectID p_owner,con
 }
 
 
+int RasterizerGLES2::texture_get_frames_since_drawn(RID p_texture) const {
+
+	Texture * texture = texture_owner.get(p_texture);
+
+	ERR_FAIL_COND_V(!texture,0);
+
+	return MIN(frame-texture->last_pass,0x7FFFFFFF);
+}
+
 GLuint RasterizerGLES2::_texture_get_name(RID p_tex) {
 
 	Texture * texture = texture_owner.get(p_tex);
@@ -5145,6 +5154,7 @@ bool RasterizerGLES2::_setup_material(const Geometry *p_geometry,const Material
 				if (t) {
 					if (t->render_target)
 						t->render_target->last_pass=frame;
+					t->last_pass=frame;
 					if (E->key()==p_material->shader_cache->first_texture) {
 						tc0_idx=texcoord;
 						tc0_id_cache=t->tex_id;
@@ -6029,7 +6039,8 @@ void RasterizerGLES2::_render(const Geometry *p_geometry,const Material *p_mater
 
 				if (c.texture.is_valid() && texture_owner.owns(c.texture)) {
 
-					const Texture *t = texture_owner.get(c.texture);
+					Texture *t = texture_owner.get(c.texture);
+					t->last_pass=frame;
 					glActiveTexture(GL_TEXTURE0+tc0_idx);
 					glBindTexture(t->target,t->tex_id);
 					restore_tex=true;
@@ -6211,6 +6222,7 @@ void RasterizerGLES2::_setup_shader_params(const Material *p_material) {
 					break;
 				glUniform1i( material_shader.get_custom_uniform_location(idx), tex_idx);
 				glActiveTexture(tex_idx);
+				texture->last_pass=frame;
 				glBindTexture(texture->target,texture->tex_id);
 
 			} break;
@@ -7950,6 +7962,7 @@ RasterizerGLES2::Texture* RasterizerGLES2::_bind_canvas_texture(const RID& p_tex
 
 		if (texture->render_target)
 			texture->render_target->last_pass=frame;
+		texture->last_pass=frame;
 
 		glBindTexture(GL_TEXTURE_2D,texture->tex_id);
 		canvas_tex=p_texture;
@@ -8553,10 +8566,12 @@ void RasterizerGLES2::_canvas_item_setup_shader_uniforms(CanvasItem *shader_owne
 
 				glActiveTexture(GL_TEXTURE0+tex_id);
 				Texture *t=texture_owner.get(rid);
-				if (!t)
+				if (!t) {
 					glBindTexture(GL_TEXTURE_2D,white_tex);
-				else
+				} else {
+					t->last_pass=frame;
 					glBindTexture(t->target,t->tex_id);
+				}
 
 				glUniform1i(loc,tex_id);
 				tex_id++;
@@ -8775,6 +8790,7 @@ void RasterizerGLES2::canvas_render_items(CanvasItem *p_item_list,int p_z,const
 						glBindTexture(GL_TEXTURE_2D,white_tex);
 					} else {
 
+						t->last_pass=frame;
 						glBindTexture(t->target,t->tex_id);
 					}
 
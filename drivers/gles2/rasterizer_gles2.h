@@ -135,6 +135,7 @@ class RasterizerGLES2 : public Rasterizer {
 
 		bool active;
 		GLuint tex_id;
+		uint64_t last_pass; //frame it was last drawn in, for streaming
 
 		RenderTarget *render_target;
 
@@ -154,6 +155,7 @@ class RasterizerGLES2 : public Rasterizer {
 			compressed=false;
 			total_data_size=0;
 			target=GL_TEXTURE_2D;
+			last_pass=0;
 
 			reloader=0;
 		}
@@ -1272,6 +1274,7 @@ public:
 	virtual bool texture_has_alpha(RID p_texture) const;
 	virtual void texture_set_size_override(RID p_texture,int p_width, int p_height);
 	virtual void texture_set_reload_hook(RID p_texture,ObjectID p_owner,const StringName& p_function) const;
+	virtual int texture_get_frames_since_drawn(RID p_texture) const;
 
 	GLuint _texture_get_name(RID p_tex);
 
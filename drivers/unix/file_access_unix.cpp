@@ -34,6 +34,14 @@
 #include <sys/stat.h>
 #include "print_string.h"
 #include "core/os/os.h"
+#include "core/io/marshalls.h"
+#include "core/os/copymem.h"
+
+#ifdef UNIX_ENABLED
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #ifndef ANDROID_ENABLED
 #include <sys/statvfs.h>
@@ -57,11 +65,57 @@ void FileAccessUnix::check_errors() const {
 
 }
 
+bool FileAccessUnix::_map(const String& p_path) {
+
+#ifdef UNIX_ENABLED
+	int fd = ::open(p_path.utf8().get_data(),O_RDONLY);
+	if (fd<0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd,&st)==0 && S_ISREG(st.st_mode) && st.st_size>0 && uint64_t(st.st_size)<=uint64_t(size_t(-1))) {
+
+		void *ptr = mmap(NULL,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+		if (ptr!=MAP_FAILED) {
+			map=(uint8_t*)ptr;
+			map_len=st.st_size;
+			map_pos=0;
+		}
+	}
+
+	::close(fd); //the mapping stays valid
+	return map!=NULL;
+#else
+	return false;
+#endif
+}
+
+void FileAccessUnix::_read(uint8_t *p_dst,int p_length) const {
+
+	if (map && map_pos+p_length<=map_len) {
+
+		copymem(p_dst,&map[map_pos],p_length);
+		map_pos+=p_length;
+	} else {
+
+		int r=get_buffer(p_dst,p_length);
+		for(int i=MAX(r,0);i<p_length;i++)
+			p_dst[i]=0;
+	}
+
+	if (endian_swap) {
+		//big endian file
+		for(int i=0;i<p_length/2;i++)
+			SWAP(p_dst[i],p_dst[p_length-i-1]);
+	}
+}
+
 Error FileAccessUnix::_open(const String& p_path, int p_mode_flags) {
 
 	if (f)
 		fclose(f);
 	f=NULL;
+	close();
 
 	String path=fix_path(p_path);
 	//printf("opening %ls, %i\n", path.c_str(), Memory::get_static_mem_usage());
@@ -108,8 +162,35 @@ Error FileAccessUnix::_open(const String& p_path, int p_mode_flags) {
 	}
 
 }
+
+Error FileAccessUnix::_open_mapped(const String& p_path) {
+
+	if (f)
+		fclose(f);
+	f=NULL;
+	close();
+
+	if (_map(fix_path(p_path))) {
+
+		last_error=OK;
+		flags=READ;
+		return OK;
+	}
+
+	return _open(p_path,READ); //pipes, empty files, no mmap()
+}
+
 void FileAccessUnix::close() {
 
+#ifdef UNIX_ENABLED
+	if (map) {
+		munmap(map,map_len);
+		map=NULL;
+		map_len=0;
+		map_pos=0;
+	}
+#endif
+
 	if (!f)
 		return;
 	fclose(f);
@@ -127,10 +208,16 @@ void FileAccessUnix::close() {
 }
 bool FileAccessUnix::is_open() const{
 
-	return (f!=NULL);
+	return (f!=NULL || map!=NULL);
 }
 void FileAccessUnix::seek(size_t p_position) {
 
+	if (map) {
+		last_error=OK;
+		map_pos=p_position;
+		return;
+	}
+
 	ERR_FAIL_COND(!f);
 
 	last_error=OK;
@@ -139,12 +226,20 @@ void FileAccessUnix::seek(size_t p_position) {
 }
 void FileAccessUnix::seek_end(int64_t p_position)  {
 
+	if (map) {
+		last_error=OK;
+		map_pos=map_len+p_position;
+		return;
+	}
+
 	ERR_FAIL_COND(!f);
 	if ( fseek(f,p_position,SEEK_END) )
 		check_errors();
 }
 size_t FileAccessUnix::get_pos() const{
 
+	if (map)
+		return map_pos;
 
 	size_t aux_position=0;
 	if ( !(aux_position = ftell(f)) ) {
@@ -154,6 +249,8 @@ size_t FileAccessUnix::get_pos() const{
 }
 size_t FileAccessUnix::get_len() const{
 
+	if (map)
+		return map_len;
 
 	ERR_FAIL_COND_V(!f,0);
 
@@ -173,6 +270,14 @@ bool FileAccessUnix::eof_reached() const{
 
 uint8_t FileAccessUnix::get_8() const{
 
+	if (map) {
+		if (map_pos>=map_len) {
+			last_error=ERR_FILE_EOF;
+			return 0;
+		}
+		return map[map_pos++];
+	}
+
 	ERR_FAIL_COND_V(!f,0);
 	uint8_t b;
 	if (fread(&b,1,1,f) == 0) {
@@ -182,14 +287,55 @@ uint8_t FileAccessUnix::get_8() const{
 	return b;
 }
 
+uint16_t FileAccessUnix::get_16() const{
+
+	uint8_t b[2];
+	_read(b,2);
+	return decode_uint16(b);
+}
+
+uint32_t FileAccessUnix::get_32() const{
+
+	uint8_t b[4];
+	_read(b,4);
+	return decode_uint32(b);
+}
+
+uint64_t FileAccessUnix::get_64() const{
+
+	uint8_t b[8];
+	_read(b,8);
+	return decode_uint64(b);
+}
+
 int FileAccessUnix::get_buffer(uint8_t *p_dst, int p_length) const {
 
+	if (map) {
+		int read = map_pos<map_len ? MIN(size_t(p_length),map_len-map_pos) : 0;
+		copymem(p_dst,&map[map_pos],read);
+		map_pos+=read;
+		if (read<p_length)
+			last_error=ERR_FILE_EOF;
+		return read;
+	}
+
 	ERR_FAIL_COND_V(!f,-1);
 	int read = fread(p_dst, 1, p_length, f);
 	check_errors();
 	return read;
 };
 
+const uint8_t *FileAccessUnix::get_mapped_buffer(int p_length) const {
+
+	ERR_FAIL_COND_V(p_length<0,NULL);
+	if (!map || map_pos>map_len || size_t(p_length)>map_len-map_pos)
+		return NULL;
+
+	const uint8_t *ptr=&map[map_pos];
+	map_pos+=p_length;
+	return ptr;
+}
+
 Error FileAccessUnix::get_error() const{
 
 	return last_error;
@@ -246,6 +392,9 @@ FileAccessUnix::FileAccessUnix() {
 	f=NULL;
 	flags=0;
 	last_error=OK;
+	map=NULL;
+	map_len=0;
+	map_pos=0;
 
 }
 FileAccessUnix::~FileAccessUnix() {
@@ -45,11 +45,22 @@ class FileAccessUnix : public FileAccess {
 	void check_errors() const;
 	mutable Error last_error;
 	String save_path;
+
+	/* files opened with open_mapped() are mapped in memory when possible,
+	   reads are then just copies (or no copy at all). Regular reads use
+	   stdio, since a mapped file truncated by someone else faults. */
+	uint8_t *map;
+	size_t map_len;
+	mutable size_t map_pos;
+
+	bool _map(const String& p_path);
+	void _read(uint8_t *p_dst,int p_length) const;
 	
 		static FileAccess* create_libc();
 public:
 	
 	virtual Error _open(const String& p_path, int p_mode_flags); ///< open a file
+	virtual Error _open_mapped(const String& p_path);
 	virtual void close(); ///< close a file
 	virtual bool is_open() const; ///< true when file is open 
 
@@ -61,7 +72,11 @@ public:
 	virtual bool eof_reached() const; ///< reading passed EOF 
 
 	virtual uint8_t get_8() const; ///< get a byte 
+	virtual uint16_t get_16() const;
+	virtual uint32_t get_32() const;
+	virtual uint64_t get_64() const;
 	virtual int get_buffer(uint8_t *p_dst, int p_length) const;
+	virtual const uint8_t *get_mapped_buffer(int p_length) const;
 
 	virtual Error get_error() const; ///< get last error 
 
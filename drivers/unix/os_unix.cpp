@@ -31,6 +31,7 @@
 #ifdef UNIX_ENABLED
 
 #include "memory_pool_static_malloc.h"
+#include "os/memory_pool_static_size_class.h"
 #include "os/memory_pool_dynamic_static.h"
 #include "thread_posix.h"
 #include "semaphore_posix.h"
@@ -92,7 +93,7 @@ int OS_Unix::unix_initialize_audio(int p_audio_driver) {
 	return 0;
 }
 	
-static MemoryPoolStaticMalloc *mempool_static=NULL;
+static MemoryPoolStatic *mempool_static=NULL;
 static MemoryPoolDynamicStatic *mempool_dynamic=NULL;
 	
 	
@@ -121,7 +122,11 @@ void OS_Unix::initialize_core() {
 	PacketPeerUDPPosix::make_default();
 	IP_Unix::make_default();
 #endif
+#ifdef SIZE_CLASS_MEMORY_POOL_ENABLED
+	mempool_static = new MemoryPoolStaticSizeClass;
+#else
 	mempool_static = new MemoryPoolStaticMalloc;
+#endif
 	mempool_dynamic = memnew( MemoryPoolDynamicStatic );
 
 	ticks_start=0;
@@ -47,6 +47,7 @@ void *ThreadPosix::thread_callback(void *userdata) {
 	ThreadPosix *t=reinterpret_cast<ThreadPosix*>(userdata);
 	t->callback(t->user);
 	t->id=(ID)pthread_self();
+	thread_exited();
 	return NULL;
 }
 
@@ -47,6 +47,7 @@ DWORD ThreadWindows::thread_callback( LPVOID userdata ) {
 	ThreadWindows *t=reinterpret_cast<ThreadWindows*>(userdata);
 	t->callback(t->user);
 	t->id=(ID)GetCurrentThreadId(); // must implement
+	thread_exited();
 	return 0;
 }
 
@@ -39,6 +39,9 @@
 #include "script_debugger_remote.h"
 #include "message_queue.h"
 #include "path_remap.h"
+#include "io/resource_load_queue.h"
+#include "scene/resources/streaming_texture.h"
+#include "scene/main/scene_pool.h"
 #include "input_map.h"
 #include "io/resource_loader.h"
 #include "scene/main/scene_main_loop.h"
@@ -86,6 +89,8 @@ static ScriptDebugger *script_debugger=NULL;
 static MessageQueue *message_queue=NULL;
 static Performance *performance = NULL;
 static PathRemap *path_remap;
+static ResourceLoadQueue *resource_load_queue=NULL;
+static ScenePool *scene_pool=NULL;
 static PackedData *packed_data=NULL;
 static FileAccessNetworkClient *file_access_network_client=NULL;
 static TranslationServer *translation_server = NULL;
@@ -195,6 +200,8 @@ Error Main::setup(const char *execpath,int argc, char *argv[],bool p_second_phas
 	translation_server = memnew( TranslationServer );
 	performance = memnew( Performance );
 	globals->add_singleton(Globals::Singleton("Performance",performance));
+	resource_load_queue = memnew( ResourceLoadQueue );
+	globals->add_singleton(Globals::Singleton("ResourceLoadQueue",resource_load_queue));
 
 	MAIN_PRINT("Main: Parse CMDLine");
 
@@ -726,6 +733,8 @@ Error Main::setup(const char *execpath,int argc, char *argv[],bool p_second_phas
 	print_help(execpath);
 	
 
+	if (resource_load_queue)
+		memdelete(resource_load_queue);
 	if (performance)
 		memdelete(performance);
 	if (input_map)
@@ -810,6 +819,9 @@ Error Main::setup2() {
 	register_scene_types();
 	register_server_types();
 
+	scene_pool = memnew( ScenePool );
+	Globals::get_singleton()->add_singleton(Globals::Singleton("ScenePool",scene_pool));
+
 #ifdef TOOLS_ENABLED
 	EditorNode::register_editor_types();
 	ObjectTypeDB::register_type<PCKPacker>(); // todo: move somewhere else
@@ -1336,6 +1348,12 @@ bool Main::iteration() {
 	OS::get_singleton()->get_main_loop()->idle( step*time_scale );
 	message_queue->flush();
 
+	resource_load_queue->poll();
+	message_queue->flush();
+
+	if (TextureStreamer::get_singleton())
+		TextureStreamer::get_singleton()->poll();
+
 	if (SpatialSoundServer::get_singleton())
 		SpatialSoundServer::get_singleton()->update( step*time_scale );
 	if (SpatialSound2DServer::get_singleton())
@@ -1431,6 +1449,12 @@ void Main::cleanup() {
 
 	OS::get_singleton()->delete_main_loop();
 
+	if (resource_load_queue) //stop loading before the servers go away
+		memdelete(resource_load_queue);
+
+	if (scene_pool)
+		memdelete(scene_pool);
+
 	OS::get_singleton()->_cmdline.clear();
 	OS::get_singleton()->_execpath="";
 	OS::get_singleton()->_local_clipboard="";
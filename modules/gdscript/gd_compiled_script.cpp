@@ -0,0 +1,1001 @@
+/*************************************************************************/
+/*  gd_compiled_script.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "gd_compiled_script.h"
+#include "gd_compiler.h"
+#include "gd_functions.h"
+#include "io/marshalls.h"
+#include "io/resource_loader.h"
+
+struct GDCompiledScript::Writer {
+
+	Vector<uint8_t> buf;
+
+	void put_32(uint32_t p_value) {
+
+		int pos=buf.size();
+		buf.resize(pos+4);
+		encode_uint32(p_value,&buf[pos]);
+	}
+
+	void put_string(const String& p_string) {
+
+		CharString cs=p_string.utf8();
+		put_32(cs.length());
+		int pos=buf.size();
+		buf.resize(pos+cs.length());
+		for(int i=0;i<cs.length();i++)
+			buf[pos+i]=cs[i];
+	}
+
+	bool put_variant(const Variant& p_value) {
+
+		int len;
+		Error err = encode_variant(p_value,NULL,len);
+		if (err!=OK)
+			return false;
+		put_32(len);
+		int pos=buf.size();
+		buf.resize(pos+len);
+		encode_variant(p_value,&buf[pos],len);
+		return true;
+	}
+};
+
+struct GDCompiledScript::Reader {
+
+	const uint8_t *ptr;
+	int len;
+	int pos;
+	bool error;
+
+	uint32_t get_32() {
+
+		if (error || pos+4>len) {
+			error=true;
+			return 0;
+		}
+		uint32_t v=decode_uint32(&ptr[pos]);
+		pos+=4;
+		return v;
+	}
+
+	String get_string() {
+
+		int l=get_32();
+		if (error || l<0 || pos+l>len) {
+			error=true;
+			return String();
+		}
+		String s;
+		s.parse_utf8((const char*)&ptr[pos],l);
+		pos+=l;
+		return s;
+	}
+
+	Variant get_variant() {
+
+		int l=get_32();
+		if (error || l<0 || pos+l>len) {
+			error=true;
+			return Variant();
+		}
+		Variant v;
+		if (decode_variant(v,&ptr[pos],l)!=OK)
+			error=true;
+		pos+=l;
+		return v;
+	}
+
+	//counts are checked against what is left, so a damaged file can't make us allocate much
+	int get_count(int p_item_size=1) {
+
+		int c=get_32();
+		if (error || c<0 || c>(len-pos)/p_item_size) {
+			error=true;
+			return 0;
+		}
+		return c;
+	}
+};
+
+/* References to classes of the file being loaded, set once all of them exist. */
+struct GDCompiledScript::Fixup {
+
+	enum Type {
+		BASE,
+		CLASS_CONSTANT,
+		FUNCTION_CONSTANT
+	};
+
+	Type type;
+	GDScript *script;
+	StringName name;
+	GDFunction *function;
+	int index;
+	String path; //empty for classes of the file being loaded
+	Vector<StringName> chain; //subclass names from the root class
+};
+
+enum {
+	BASE_NONE,
+	BASE_NATIVE,
+	BASE_SCRIPT
+};
+
+enum {
+	CONSTANT_VALUE,
+	CONSTANT_RESOURCE,
+	CONSTANT_CLASS
+};
+
+static bool _has_objects(const Variant& p_value) {
+
+	switch(p_value.get_type()) {
+
+		case Variant::OBJECT: {
+
+			return !p_value.is_zero();
+		} break;
+		case Variant::ARRAY: {
+
+			Array a=p_value;
+			for(int i=0;i<a.size();i++) {
+				if (_has_objects(a[i]))
+					return true;
+			}
+		} break;
+		case Variant::DICTIONARY: {
+
+			Dictionary d=p_value;
+			List<Variant> keys;
+			d.get_key_list(&keys);
+			for(List<Variant>::Element *E=keys.front();E;E=E->next()) {
+				if (_has_objects(E->get()) || _has_objects(d[E->get()]))
+					return true;
+			}
+		} break;
+		default: {}
+	}
+
+	return false;
+}
+
+bool GDCompiledScript::_get_address_operands(const Vector<int>& p_code,Vector<int>& r_positions) {
+
+	for(int ip=0;ip<p_code.size();) {
+
+		GDCompiler::Instruction instr;
+		String err;
+		if (!GDCompiler::_decode_instruction(p_code.ptr(),p_code.size(),ip,instr,err))
+			return false;
+
+		for(int i=0;i<instr.fixed_count;i++)
+			r_positions.push_back(ip+instr.fixed_addr[i]);
+		for(int i=0;i<instr.range_count;i++)
+			r_positions.push_back(ip+instr.range_from+i);
+		ip+=instr.len;
+	}
+
+	return true;
+}
+
+static int _address_type(int p_address) {
+
+	return (p_address&GDFunction::ADDR_TYPE_MASK)>>GDFunction::ADDR_BITS;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool GDCompiledScript::_save_object(Writer& w,const GDScript *p_root,const Object *p_object) {
+
+	const GDScript *script = p_object->cast_to<GDScript>();
+
+	if (script) {
+		//classes are stored by where they are, subclasses have no file of their own
+		Vector<StringName> chain;
+		const GDScript *root=script;
+		while(root->_owner) {
+			chain.push_back(root->name);
+			root=root->_owner;
+		}
+		chain.invert();
+
+		if (root!=p_root && (root->get_path()=="" || root->get_path().find("::")!=-1))
+			return false;
+
+		w.put_32(CONSTANT_CLASS);
+		w.put_string(root==p_root ? String() : root->get_path());
+		w.put_32(chain.size());
+		for(int i=0;i<chain.size();i++)
+			w.put_string(chain[i]);
+		return true;
+	}
+
+	const Resource *res = p_object->cast_to<Resource>();
+	if (!res || res->get_path()=="" || res->get_path().find("::")!=-1)
+		return false; //only resources that can be loaded again
+
+	w.put_32(CONSTANT_RESOURCE);
+	w.put_string(res->get_path());
+	return true;
+}
+
+bool GDCompiledScript::_save_constant(Writer& w,const GDScript *p_root,const Variant& p_value) {
+
+	if (p_value.get_type()==Variant::OBJECT && !p_value.is_zero())
+		return _save_object(w,p_root,(Object*)p_value);
+
+	if (_has_objects(p_value))
+		return false;
+
+	w.put_32(CONSTANT_VALUE);
+	return w.put_variant(p_value);
+}
+
+bool GDCompiledScript::_save_function(Writer& w,const GDScript *p_root,const GDFunction& p_func,const Map<int,StringName>& p_global_names) {
+
+	w.put_32(p_func._static);
+	w.put_32(p_func._argument_count);
+	w.put_32(p_func._stack_size);
+	w.put_32(p_func._call_size);
+	w.put_32(p_func._iterator_lock_count);
+	w.put_32(p_func._initial_line);
+
+#ifdef TOOLS_ENABLED
+	w.put_32(p_func.arg_names.size());
+	for(int i=0;i<p_func.arg_names.size();i++)
+		w.put_string(p_func.arg_names[i]);
+#else
+	w.put_32(0);
+#endif
+
+	w.put_32(p_func.default_arguments.size());
+	for(int i=0;i<p_func.default_arguments.size();i++)
+		w.put_32(p_func.default_arguments[i]);
+
+	w.put_32(p_func.constants.size());
+	for(int i=0;i<p_func.constants.size();i++) {
+		if (!_save_constant(w,p_root,p_func.constants[i]))
+			return false;
+	}
+
+	w.put_32(p_func.global_names.size());
+	for(int i=0;i<p_func.global_names.size();i++)
+		w.put_string(p_func.global_names[i]);
+
+	w.put_32(p_func.operator_funcs.size());
+	for(int i=0;i<p_func.operator_funcs.size();i++) {
+		const GDFunction::OperatorFunc &of=p_func.operator_funcs[i];
+		w.put_32(of.op|(of.type_a<<8)|(of.type_b<<16));
+	}
+
+	w.put_32(p_func.methods.size());
+	for(int i=0;i<p_func.methods.size();i++) {
+		w.put_string(p_func.methods[i]->get_instance_type());
+		w.put_string(p_func.methods[i]->get_name());
+	}
+
+	w.put_32(p_func.caches.size());
+
+	//global indices depend on what the engine registered, store them by name
+	Vector<int> code=p_func.code;
+	Vector<int> addresses;
+	ERR_FAIL_COND_V(!_get_address_operands(code,addresses),false);
+
+	Map<int,int> global_map;
+	Vector<StringName> globals;
+	for(int i=0;i<addresses.size();i++) {
+
+		int addr=code[addresses[i]];
+		if (_address_type(addr)!=GDFunction::ADDR_TYPE_GLOBAL)
+			continue;
+		int idx=addr&GDFunction::ADDR_MASK;
+		if (!global_map.has(idx)) {
+			const Map<int,StringName>::Element *E=p_global_names.find(idx);
+			ERR_FAIL_COND_V(!E,false);
+			global_map[idx]=globals.size();
+			globals.push_back(E->get());
+		}
+		code[addresses[i]]=global_map[idx]|(GDFunction::ADDR_TYPE_GLOBAL<<GDFunction::ADDR_BITS);
+	}
+
+	w.put_32(globals.size());
+	for(int i=0;i<globals.size();i++)
+		w.put_string(globals[i]);
+
+	w.put_32(code.size());
+	for(int i=0;i<code.size();i++)
+		w.put_32(code[i]);
+
+	w.put_32(p_func.stack_debug.size());
+	for(const List<GDFunction::StackDebug>::Element *E=p_func.stack_debug.front();E;E=E->next()) {
+		w.put_32(E->get().line);
+		w.put_32(E->get().pos);
+		w.put_32(E->get().added);
+		w.put_string(E->get().identifier);
+	}
+
+	return true;
+}
+
+bool GDCompiledScript::_save_class(Writer& w,const GDScript *p_root,const GDScript *p_script,const Map<int,StringName>& p_global_names) {
+
+	w.put_string(p_script->name);
+	w.put_32(p_script->tool);
+
+	if (p_script->base.is_valid()) {
+
+		w.put_32(BASE_SCRIPT);
+		Writer bw;
+		if (!_save_object(bw,p_root,p_script->base.ptr()))
+			return false;
+		//skip the constant kind, bases are always classes
+		for(int i=4;i<bw.buf.size();i++)
+			w.buf.push_back(bw.buf[i]);
+	} else if (p_script->native.is_valid()) {
+
+		w.put_32(BASE_NATIVE);
+		w.put_string(p_script->native->get_name());
+	} else {
+
+		w.put_32(BASE_NONE);
+	}
+
+	//members inherited from the base are added back on load
+	Map<int,StringName> own_members;
+	for(const Set<StringName>::Element *E=p_script->members.front();E;E=E->next()) {
+		own_members[p_script->member_indices[E->get()].index]=E->get();
+	}
+
+	w.put_32(own_members.size());
+	for(Map<int,StringName>::Element *E=own_members.front();E;E=E->next()) {
+
+		const GDScript::MemberInfo &mi=p_script->member_indices[E->get()];
+		w.put_string(E->get());
+		w.put_32(mi.index);
+		w.put_string(mi.setter);
+		w.put_string(mi.getter);
+		w.put_32(mi.data_type.kind);
+		w.put_32(mi.data_type.builtin_type);
+		w.put_string(mi.data_type.native_type);
+	}
+
+	w.put_32(p_script->member_info.size());
+	for(const Map<StringName,PropertyInfo>::Element *E=p_script->member_info.front();E;E=E->next()) {
+
+		w.put_string(E->key());
+		w.put_32(E->get().type);
+		w.put_32(E->get().hint);
+		w.put_string(E->get().hint_string);
+		w.put_32(E->get().usage);
+	}
+
+	int constant_count=0;
+	for(const Map<StringName,Variant>::Element *E=p_script->constants.front();E;E=E->next()) {
+		if (!p_script->subclasses.has(E->key()))
+			constant_count++;
+	}
+
+	w.put_32(constant_count);
+	for(const Map<StringName,Variant>::Element *E=p_script->constants.front();E;E=E->next()) {
+
+		if (p_script->subclasses.has(E->key()))
+			continue;
+		w.put_string(E->key());
+		if (!_save_constant(w,p_root,E->get()))
+			return false;
+	}
+
+	w.put_32(p_script->subclasses.size());
+	for(const Map<StringName,Ref<GDScript> >::Element *E=p_script->subclasses.front();E;E=E->next()) {
+
+		w.put_string(E->key());
+		if (!_save_class(w,p_root,E->get().ptr(),p_global_names))
+			return false;
+	}
+
+	w.put_32(p_script->member_functions.size());
+	for(const Map<StringName,GDFunction>::Element *E=p_script->member_functions.front();E;E=E->next()) {
+
+		w.put_string(E->key());
+		if (!_save_function(w,p_root,E->get(),p_global_names))
+			return false;
+	}
+
+	return true;
+}
+
+bool GDCompiledScript::is_compiled_script(const Vector<uint8_t>& p_buffer) {
+
+	return p_buffer.size()>=8 && p_buffer[0]=='G' && p_buffer[1]=='D' && p_buffer[2]=='S' && p_buffer[3]=='B';
+}
+
+Vector<uint8_t> GDCompiledScript::save(const Ref<GDScript>& p_script,const Vector<uint8_t>& p_tokens) {
+
+	ERR_FAIL_COND_V(p_script.is_null(),Vector<uint8_t>());
+
+	if (!p_script->is_valid())
+		return Vector<uint8_t>();
+
+	Map<int,StringName> global_names;
+	for(const Map<StringName,int>::Element *E=GDScriptLanguage::get_singleton()->get_global_map().front();E;E=E->next()) {
+		global_names[E->get()]=E->key();
+	}
+
+	Writer w;
+	w.buf.resize(4);
+	w.buf[0]='G';
+	w.buf[1]='D';
+	w.buf[2]='S';
+	w.buf[3]='B';
+	w.put_32(FORMAT_VERSION);
+	//the bytecode is only valid for the same opcodes, types and built-in functions
+	w.put_32(GDFunction::OPCODE_END);
+	w.put_32(GDFunction::ADDR_BITS);
+	w.put_32(Variant::VARIANT_MAX);
+	w.put_32(Variant::OP_MAX);
+	w.put_32(GDFunctions::FUNC_MAX);
+
+	w.put_32(p_tokens.size());
+	int pos=w.buf.size();
+	w.buf.resize(pos+p_tokens.size());
+	for(int i=0;i<p_tokens.size();i++)
+		w.buf[pos+i]=p_tokens[i];
+
+	if (!_save_class(w,p_script.ptr(),p_script.ptr(),global_names))
+		return Vector<uint8_t>();
+
+	return w.buf;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+bool GDCompiledScript::_load_constant(Reader& r,Variant& r_value,Fixup& r_fixup,bool& r_needs_fixup) {
+
+	r_needs_fixup=false;
+
+	switch(r.get_32()) {
+
+		case CONSTANT_VALUE: {
+
+			r_value=r.get_variant();
+		} break;
+		case CONSTANT_RESOURCE: {
+
+			String path=r.get_string();
+			if (r.error)
+				return false;
+			r_value=ResourceLoader::load(path);
+			if (r_value.is_zero())
+				return false;
+		} break;
+		case CONSTANT_CLASS: {
+
+			r_fixup.path=r.get_string();
+			int count=r.get_count();
+			r_fixup.chain.resize(count);
+			for(int i=0;i<count;i++)
+				r_fixup.chain[i]=r.get_string();
+			r_needs_fixup=true;
+		} break;
+		default: {
+			r.error=true;
+		}
+	}
+
+	return !r.error;
+}
+
+bool GDCompiledScript::_load_function(Reader& r,GDScript *p_script,const StringName& p_name,GDFunction& r_func,List<Fixup>& r_fixups) {
+
+	r_func.name=p_name;
+	r_func._static=r.get_32();
+	r_func._argument_count=r.get_32();
+	r_func._stack_size=r.get_32();
+	r_func._call_size=r.get_32();
+	r_func._iterator_lock_count=r.get_32();
+	r_func._initial_line=r.get_32();
+	if (r_func._stack_size<0 || r_func._call_size<0 || r_func._iterator_lock_count<0)
+		r.error=true;
+	r_func._script=p_script;
+	r_func.source=p_script->get_path();
+
+	int count=r.get_count();
+#ifdef TOOLS_ENABLED
+	r_func.arg_names.resize(count);
+	for(int i=0;i<count;i++)
+		r_func.arg_names[i]=r.get_string();
+#else
+	for(int i=0;i<count;i++)
+		r.get_string();
+#endif
+
+	count=r.get_count(4);
+	r_func.default_arguments.resize(count);
+	for(int i=0;i<count;i++)
+		r_func.default_arguments[i]=r.get_32();
+
+	count=r.get_count();
+	r_func.constants.resize(count);
+	for(int i=0;i<count;i++) {
+
+		Fixup fixup;
+		bool needs_fixup;
+		if (!_load_constant(r,r_func.constants[i],fixup,needs_fixup))
+			return false;
+		if (needs_fixup) {
+			fixup.type=Fixup::FUNCTION_CONSTANT;
+			fixup.script=p_script;
+			fixup.function=&r_func;
+			fixup.index=i;
+			r_fixups.push_back(fixup);
+		}
+	}
+
+	count=r.get_count();
+	r_func.global_names.resize(count);
+	for(int i=0;i<count;i++)
+		r_func.global_names[i]=r.get_string();
+
+	count=r.get_count(4);
+	r_func.operator_funcs.resize(count);
+	for(int i=0;i<count;i++) {
+
+		uint32_t key=r.get_32();
+		int op=key&0xFF, a=(key>>8)&0xFF, b=(key>>16)&0xFF;
+		if (op>=Variant::OP_MAX || a>=Variant::VARIANT_MAX || b>=Variant::VARIANT_MAX)
+			return false;
+		GDFunction::OperatorFunc &of=r_func.operator_funcs[i];
+		of.op=Variant::Operator(op);
+		of.type_a=Variant::Type(a);
+		of.type_b=Variant::Type(b);
+		of.func=Variant::get_operator_evaluator(of.op,of.type_a,of.type_b);
+		if (!of.func)
+			return false;
+	}
+
+	count=r.get_count();
+	r_func.methods.resize(count);
+	for(int i=0;i<count;i++) {
+
+		StringName type=r.get_string();
+		StringName method=r.get_string();
+		r_func.methods[i]=ObjectTypeDB::get_method(type,method);
+		if (!r_func.methods[i])
+			return false;
+	}
+
+	count=r.get_32();
+	if (count<0 || count>(1<<GDFunction::ADDR_BITS))
+		return false;
+	r_func.caches.resize(count);
+
+	count=r.get_count();
+	Vector<int> globals;
+	globals.resize(count);
+	for(int i=0;i<count;i++) {
+
+		StringName global=r.get_string();
+		const Map<StringName,int>::Element *E=GDScriptLanguage::get_singleton()->get_global_map().find(global);
+		if (!E)
+			return false;
+		globals[i]=E->get();
+	}
+
+	count=r.get_count(4);
+	r_func.code.resize(count);
+	for(int i=0;i<count;i++)
+		r_func.code[i]=r.get_32();
+
+	count=r.get_count();
+	for(int i=0;i<count;i++) {
+
+		GDFunction::StackDebug sd;
+		sd.line=r.get_32();
+		sd.pos=r.get_32();
+		sd.added=r.get_32();
+		sd.identifier=r.get_string();
+		r_func.stack_debug.push_back(sd);
+	}
+
+	if (r.error)
+		return false;
+
+	Vector<int> addresses;
+	if (!_get_address_operands(r_func.code,addresses))
+		return false;
+
+	for(int i=0;i<addresses.size();i++) {
+
+		int addr=r_func.code[addresses[i]];
+		if (_address_type(addr)!=GDFunction::ADDR_TYPE_GLOBAL)
+			continue;
+		int idx=addr&GDFunction::ADDR_MASK;
+		if (idx>=globals.size())
+			return false;
+		r_func.code[addresses[i]]=globals[idx]|(GDFunction::ADDR_TYPE_GLOBAL<<GDFunction::ADDR_BITS);
+	}
+
+	//same as GDCompiler::_parse_function does once the code is generated
+	r_func._constant_count=r_func.constants.size();
+	r_func._constants_ptr=r_func.constants.size() ? &r_func.constants[0] : NULL;
+	r_func._global_names_count=r_func.global_names.size();
+	r_func._global_names_ptr=r_func.global_names.size() ? &r_func.global_names[0] : NULL;
+	r_func._code_size=r_func.code.size();
+	r_func._code_ptr=r_func.code.size() ? &r_func.code[0] : NULL;
+	r_func._operator_funcs_count=r_func.operator_funcs.size();
+	r_func._operator_funcs_ptr=r_func.operator_funcs.size() ? &r_func.operator_funcs[0] : NULL;
+	r_func._methods_count=r_func.methods.size();
+	r_func._methods_ptr=r_func.methods.size() ? &r_func.methods[0] : NULL;
+	r_func._cache_count=r_func.caches.size();
+	r_func._caches_ptr=r_func.caches.size() ? &r_func.caches[0] : NULL;
+	r_func._default_arg_count=r_func.default_arguments.size();
+	r_func._default_arg_ptr=r_func.default_arguments.size() ? &r_func.default_arguments[0] : NULL;
+
+#ifdef DEBUG_ENABLED
+	r_func.func_cname=(String(r_func.source)+" - "+String(r_func.name)).utf8();
+	r_func._func_cname=r_func.func_cname.get_data();
+	r_func.profile.signature=String(r_func.source)+"::"+itos(r_func._initial_line)+"::"+String(r_func.name);
+	GDScriptLanguage::get_singleton()->add_profiled_function(&r_func);
+#endif
+
+	return true;
+}
+
+bool GDCompiledScript::_load_class(Reader& r,GDScript *p_script,GDScript *p_owner,List<Fixup>& r_fixups) {
+
+	//same state GDCompiler::_parse_class starts from
+	p_script->native=Ref<GDNativeClass>();
+	p_script->base=Ref<GDScript>();
+	p_script->_base=NULL;
+	p_script->members.clear();
+	p_script->constants.clear();
+	p_script->member_functions.clear();
+	p_script->member_indices.clear();
+	p_script->member_info.clear();
+	p_script->initializer=NULL;
+	p_script->subclasses.clear();
+	p_script->_owner=p_owner;
+
+	p_script->name=r.get_string();
+	p_script->tool=r.get_32();
+
+	switch(r.get_32()) {
+
+		case BASE_NONE: {
+		} break;
+		case BASE_NATIVE: {
+
+			StringName native=r.get_string();
+			const Map<StringName,int>::Element *E=GDScriptLanguage::get_singleton()->get_global_map().find(native);
+			if (E)
+				p_script->native=GDScriptLanguage::get_singleton()->get_global_array()[E->get()];
+			if (p_script->native.is_null())
+				return false;
+		} break;
+		case BASE_SCRIPT: {
+
+			Fixup fixup;
+			fixup.type=Fixup::BASE;
+			fixup.script=p_script;
+			fixup.path=r.get_string();
+			int count=r.get_count();
+			fixup.chain.resize(count);
+			for(int i=0;i<count;i++)
+				fixup.chain[i]=r.get_string();
+			r_fixups.push_back(fixup);
+		} break;
+		default: {
+			return false;
+		}
+	}
+
+	int count=r.get_count();
+	for(int i=0;i<count;i++) {
+
+		StringName name=r.get_string();
+		GDScript::MemberInfo mi;
+		mi.index=r.get_32();
+		mi.setter=r.get_string();
+		mi.getter=r.get_string();
+		mi.data_type.kind=GDDataType::Kind(r.get_32());
+		mi.data_type.builtin_type=Variant::Type(r.get_32());
+		mi.data_type.native_type=r.get_string();
+		if (mi.data_type.kind>GDDataType::NATIVE || mi.data_type.builtin_type<0 || mi.data_type.builtin_type>=Variant::VARIANT_MAX)
+			return false;
+		p_script->member_indices[name]=mi;
+		p_script->members.insert(name);
+	}
+
+	count=r.get_count();
+	for(int i=0;i<count;i++) {
+
+		StringName name=r.get_string();
+		PropertyInfo pi;
+		pi.name=name;
+		pi.type=Variant::Type(r.get_32());
+		pi.hint=PropertyHint(r.get_32());
+		pi.hint_string=r.get_string();
+		pi.usage=r.get_32();
+		p_script->member_info[name]=pi;
+	}
+
+	count=r.get_count();
+	for(int i=0;i<count;i++) {
+
+		StringName name=r.get_string();
+		Variant value;
+		Fixup fixup;
+		bool needs_fixup;
+		if (!_load_constant(r,value,fixup,needs_fixup))
+			return false;
+		if (needs_fixup) {
+			fixup.type=Fixup::CLASS_CONSTANT;
+			fixup.script=p_script;
+			fixup.name=name;
+			r_fixups.push_back(fixup);
+		}
+		p_script->constants.insert(name,value);
+	}
+
+	count=r.get_count();
+	for(int i=0;i<count;i++) {
+
+		StringName name=r.get_string();
+		Ref<GDScript> subclass = memnew( GDScript );
+		if (!_load_class(r,subclass.ptr(),p_script,r_fixups))
+			return false;
+		p_script->constants.insert(name,subclass);
+		p_script->subclasses.insert(name,subclass);
+	}
+
+	count=r.get_count();
+	for(int i=0;i<count;i++) {
+
+		StringName name=r.get_string();
+		if (r.error)
+			return false;
+		//read in place, the function registers its own address for profiling
+		p_script->member_functions[name]=GDFunction();
+		if (!_load_function(r,p_script,name,p_script->member_functions[name],r_fixups))
+			return false;
+	}
+
+	if (p_script->member_functions.has("_init"))
+		p_script->initializer=&p_script->member_functions["_init"];
+
+	return !r.error;
+}
+
+GDScript *GDCompiledScript::_find_class(GDScript *p_root,const Vector<StringName>& p_chain) {
+
+	GDScript *script=p_root;
+	for(int i=0;script && i<p_chain.size();i++) {
+
+		Map<StringName,Ref<GDScript> >::Element *E=script->subclasses.find(p_chain[i]);
+		script = E ? E->get().ptr() : NULL;
+	}
+	return script;
+}
+
+bool GDCompiledScript::_resolve_base(GDScript *p_root,GDScript *p_script,const Map<GDScript*,const Fixup*>& p_bases,Set<GDScript*>& r_resolved,Set<GDScript*>& r_resolving) {
+
+	if (r_resolved.has(p_script))
+		return true;
+	if (r_resolving.has(p_script))
+		return false; //cyclic inheritance
+
+	int base_count=0;
+	const Map<GDScript*,const Fixup*>::Element *E=p_bases.find(p_script);
+
+	if (E) {
+
+		const Fixup *fixup=E->get();
+		Ref<GDScript> base;
+
+		if (fixup->path=="") {
+
+			r_resolving.insert(p_script);
+			GDScript *found=_find_class(p_root,fixup->chain);
+			bool ok = found && _resolve_base(p_root,found,p_bases,r_resolved,r_resolving);
+			r_resolving.erase(p_script);
+			if (!ok)
+				return false;
+			base=Ref<GDScript>(found);
+		} else {
+
+			Ref<GDScript> file=ResourceLoader::load(fixup->path);
+			if (file.is_null() || !file->valid)
+				return false;
+			GDScript *found=_find_class(file.ptr(),fixup->chain);
+			if (!found)
+				return false;
+			base=Ref<GDScript>(found);
+		}
+
+		for(const Map<StringName,GDScript::MemberInfo>::Element *F=base->member_indices.front();F;F=F->next()) {
+
+			if (p_script->members.has(F->key()))
+				return false;
+			p_script->member_indices[F->key()]=F->get();
+		}
+
+		base_count=base->member_indices.size();
+		p_script->base=base;
+		p_script->_base=base.ptr();
+	}
+
+	//own members go after the ones of the base, which may have changed since export
+	for(const Set<StringName>::Element *F=p_script->members.front();F;F=F->next()) {
+
+		int index=p_script->member_indices[F->get()].index;
+		if (index<base_count || index>=base_count+p_script->members.size())
+			return false;
+	}
+
+	r_resolved.insert(p_script);
+	return true;
+}
+
+bool GDCompiledScript::_resolve_class(GDScript *p_root,GDScript *p_script,const Map<GDScript*,const Fixup*>& p_bases,Set<GDScript*>& r_resolved) {
+
+	Set<GDScript*> resolving;
+	if (!_resolve_base(p_root,p_script,p_bases,r_resolved,resolving))
+		return false;
+
+	for(Map<StringName,Ref<GDScript> >::Element *E=p_script->subclasses.front();E;E=E->next()) {
+
+		if (!_resolve_class(p_root,E->get().ptr(),p_bases,r_resolved))
+			return false;
+	}
+
+	return true;
+}
+
+bool GDCompiledScript::_verify_class(GDScript *p_script) {
+
+	int member_count=p_script->member_indices.size();
+
+	for(Map<StringName,GDFunction>::Element *E=p_script->member_functions.front();E;E=E->next()) {
+
+		GDFunction &func=E->get();
+
+		//the compiler checks everything but member indices, which are resolved here
+		GDCompiler compiler;
+		if (compiler._verify_function(&func,NULL)!=OK)
+			return false;
+
+		Vector<int> addresses;
+		_get_address_operands(func.code,addresses);
+		for(int i=0;i<addresses.size();i++) {
+
+			int addr=func.code[addresses[i]];
+			if (_address_type(addr)==GDFunction::ADDR_TYPE_MEMBER && (addr&GDFunction::ADDR_MASK)>=member_count)
+				return false;
+		}
+	}
+
+	for(Map<StringName,Ref<GDScript> >::Element *E=p_script->subclasses.front();E;E=E->next()) {
+
+		if (!_verify_class(E->get().ptr()))
+			return false;
+	}
+
+	return true;
+}
+
+Error GDCompiledScript::load(const Vector<uint8_t>& p_buffer,GDScript *p_script,Vector<uint8_t> *r_tokens) {
+
+	ERR_FAIL_COND_V(!is_compiled_script(p_buffer),ERR_INVALID_DATA);
+
+	Reader r;
+	r.ptr=p_buffer.ptr();
+	r.len=p_buffer.size();
+	r.pos=4;
+	r.error=false;
+
+	if (r.get_32()!=FORMAT_VERSION)
+		return ERR_INVALID_DATA;
+
+	bool compatible=true;
+	if (r.get_32()!=GDFunction::OPCODE_END)
+		compatible=false;
+	if (r.get_32()!=GDFunction::ADDR_BITS)
+		compatible=false;
+	if (r.get_32()!=Variant::VARIANT_MAX)
+		compatible=false;
+	if (r.get_32()!=Variant::OP_MAX)
+		compatible=false;
+	if (r.get_32()!=GDFunctions::FUNC_MAX)
+		compatible=false;
+
+	//the token stream can be used even if the bytecode can't
+	int token_len=r.get_count();
+	if (r.error)
+		return ERR_INVALID_DATA;
+	if (r_tokens) {
+		r_tokens->resize(token_len);
+		for(int i=0;i<token_len;i++)
+			(*r_tokens)[i]=r.ptr[r.pos+i];
+	}
+	r.pos+=token_len;
+
+	if (!compatible)
+		return ERR_INVALID_DATA;
+
+	//members and functions are about to be rebuilt
+	GDFunction::invalidate_caches();
+
+	List<Fixup> fixups;
+	if (!_load_class(r,p_script,NULL,fixups) || r.error || r.pos!=r.len)
+		return ERR_INVALID_DATA;
+
+	Map<GDScript*,const Fixup*> bases;
+	for(List<Fixup>::Element *E=fixups.front();E;E=E->next()) {
+		if (E->get().type==Fixup::BASE)
+			bases[E->get().script]=&E->get();
+	}
+
+	Set<GDScript*> resolved;
+	if (!_resolve_class(p_script,p_script,bases,resolved))
+		return ERR_INVALID_DATA;
+
+	for(List<Fixup>::Element *E=fixups.front();E;E=E->next()) {
+
+		const Fixup &fixup=E->get();
+		if (fixup.type==Fixup::BASE)
+			continue;
+
+		GDScript *found=NULL;
+		Ref<GDScript> file;
+		if (fixup.path=="") {
+			found=_find_class(p_script,fixup.chain);
+		} else {
+			file=ResourceLoader::load(fixup.path);
+			if (file.is_valid())
+				found=_find_class(file.ptr(),fixup.chain);
+		}
+
+		if (!found)
+			return ERR_INVALID_DATA;
+
+		Ref<GDScript> value(found);
+		if (fixup.type==Fixup::CLASS_CONSTANT) {
+			fixup.script->constants[fixup.name]=value;
+		} else {
+			fixup.function->constants[fixup.index]=value;
+			fixup.function->_constants_ptr=&fixup.function->constants[0];
+		}
+	}
+
+	if (!_verify_class(p_script))
+		return ERR_INVALID_DATA;
+
+	return OK;
+}
@@ -0,0 +1,71 @@
+/*************************************************************************/
+/*  gd_compiled_script.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef GD_COMPILED_SCRIPT_H
+#define GD_COMPILED_SCRIPT_H
+
+#include "gd_script.h"
+
+/* Stores what GDCompiler produced for a script (classes, members, constants
+   and function bytecode), so exported scripts can be loaded without being
+   parsed and compiled again. The token stream of the script is stored along,
+   to compile from when the image does not match the running engine. */
+
+class GDCompiledScript {
+
+	enum {
+		FORMAT_VERSION=2
+	};
+
+	struct Writer;
+	struct Reader;
+	struct Fixup;
+
+	static bool _get_address_operands(const Vector<int>& p_code,Vector<int>& r_positions);
+
+	static bool _save_object(Writer& w,const GDScript *p_root,const Object *p_object);
+	static bool _save_constant(Writer& w,const GDScript *p_root,const Variant& p_value);
+	static bool _save_function(Writer& w,const GDScript *p_root,const GDFunction& p_func,const Map<int,StringName>& p_global_names);
+	static bool _save_class(Writer& w,const GDScript *p_root,const GDScript *p_script,const Map<int,StringName>& p_global_names);
+
+	static bool _load_constant(Reader& r,Variant& r_value,Fixup& r_fixup,bool& r_needs_fixup);
+	static bool _load_function(Reader& r,GDScript *p_script,const StringName& p_name,GDFunction& r_func,List<Fixup>& r_fixups);
+	static bool _load_class(Reader& r,GDScript *p_script,GDScript *p_owner,List<Fixup>& r_fixups);
+	static GDScript *_find_class(GDScript *p_root,const Vector<StringName>& p_chain);
+	static bool _resolve_base(GDScript *p_root,GDScript *p_script,const Map<GDScript*,const Fixup*>& p_bases,Set<GDScript*>& r_resolved,Set<GDScript*>& r_resolving);
+	static bool _resolve_class(GDScript *p_root,GDScript *p_script,const Map<GDScript*,const Fixup*>& p_bases,Set<GDScript*>& r_resolved);
+	static bool _verify_class(GDScript *p_script);
+
+public:
+
+	static bool is_compiled_script(const Vector<uint8_t>& p_buffer);
+	static Vector<uint8_t> save(const Ref<GDScript>& p_script,const Vector<uint8_t>& p_tokens); ///< empty if the script can't be stored this way
+	static Error load(const Vector<uint8_t>& p_buffer,GDScript *p_script,Vector<uint8_t> *r_tokens=NULL); ///< r_tokens receives the fallback token stream even on failure
+};
+
+#endif // GD_COMPILED_SCRIPT_H
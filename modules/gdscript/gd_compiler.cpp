@@ -28,6 +28,7 @@
 /*************************************************************************/
 #include "gd_compiler.h"
 #include "gd_script.h"
+#include "os/os.h"
 /* TODO:
 
    *AND and OR need early abort
@@ -54,6 +55,361 @@ void GDCompiler::_set_error(const String& p_error,const GDParser::Node *p_node)
 	}
 }
 
+GDDataType GDCompiler::_resolve_type(const GDParser::DataType& p_type) {
+
+	GDDataType type;
+	switch(p_type.kind) {
+
+		case GDParser::DataType::UNTYPED: {
+		} break;
+		case GDParser::DataType::BUILTIN: {
+
+			type.kind=GDDataType::BUILTIN;
+			type.builtin_type=p_type.builtin_type;
+		} break;
+		case GDParser::DataType::NATIVE: {
+
+			type.kind=GDDataType::NATIVE;
+			type.native_type=p_type.native_type;
+		} break;
+	}
+
+	return type;
+}
+
+GDDataType GDCompiler::_get_identifier_type(CodeGen& codegen,const StringName& p_identifier,bool p_initializer) {
+
+	//same lookup order as _parse_expression, only locals and members can be typed
+
+	if (!p_initializer && codegen.stack_identifiers.has(p_identifier)) {
+
+		const Map<StringName,GDDataType>::Element *E=codegen.stack_identifier_types.find(p_identifier);
+		return E ? E->get() : GDDataType();
+	}
+
+	if (!codegen.function_node || !codegen.function_node->_static) {
+
+		const Map<StringName,GDScript::MemberInfo>::Element *E=codegen.script->member_indices.find(p_identifier);
+		if (E)
+			return E->get().data_type;
+	}
+
+	return GDDataType();
+}
+
+GDDataType GDCompiler::_get_operator_type(Variant::Operator p_op,const GDDataType& p_a,const GDDataType& p_b) {
+
+	GDDataType type;
+
+	switch(p_op) {
+
+		case Variant::OP_EQUAL:
+		case Variant::OP_NOT_EQUAL:
+		case Variant::OP_LESS:
+		case Variant::OP_LESS_EQUAL:
+		case Variant::OP_GREATER:
+		case Variant::OP_GREATER_EQUAL:
+		case Variant::OP_AND:
+		case Variant::OP_OR:
+		case Variant::OP_NOT:
+		case Variant::OP_IN: {
+			//these either fail or return a bool, regardless of the operands
+			type.kind=GDDataType::BUILTIN;
+			type.builtin_type=Variant::BOOL;
+			return type;
+		} break;
+		default: {}
+	}
+
+	if (p_a.kind!=GDDataType::BUILTIN || p_b.kind!=GDDataType::BUILTIN)
+		return type;
+
+	if (p_a.builtin_type==Variant::INT && p_b.builtin_type==Variant::INT && (p_op==Variant::OP_DIVIDE || p_op==Variant::OP_MODULE)) {
+		//not in the evaluator table because of the division by zero check
+		type.kind=GDDataType::BUILTIN;
+		type.builtin_type=Variant::INT;
+		return type;
+	}
+
+	Variant::OperatorEvaluator evaluator = Variant::get_operator_evaluator(p_op,p_a.builtin_type,p_b.builtin_type);
+	if (!evaluator)
+		return type;
+
+	//evaluators always return the same type for the same operands, so run it once to find out which
+	Variant::CallError ce;
+	Variant a = Variant::construct(p_a.builtin_type,NULL,0,ce);
+	Variant b = Variant::construct(p_b.builtin_type,NULL,0,ce);
+	Variant ret;
+	evaluator(a,b,ret);
+
+	type.kind=GDDataType::BUILTIN;
+	type.builtin_type=ret.get_type();
+	return type;
+}
+
+GDDataType GDCompiler::_get_expression_type(CodeGen& codegen,const GDParser::Node *p_expression,bool p_initializer) {
+
+	GDDataType type;
+
+	switch(p_expression->type) {
+
+		case GDParser::Node::TYPE_CONSTANT: {
+
+			const GDParser::ConstantNode *cn = static_cast<const GDParser::ConstantNode*>(p_expression);
+			if (cn->value.get_type()!=Variant::NIL && cn->value.get_type()!=Variant::OBJECT) {
+				type.kind=GDDataType::BUILTIN;
+				type.builtin_type=cn->value.get_type();
+			}
+		} break;
+		case GDParser::Node::TYPE_IDENTIFIER: {
+
+			const GDParser::IdentifierNode *in = static_cast<const GDParser::IdentifierNode*>(p_expression);
+			type=_get_identifier_type(codegen,in->name,p_initializer);
+		} break;
+		case GDParser::Node::TYPE_ARRAY: {
+
+			type.kind=GDDataType::BUILTIN;
+			type.builtin_type=Variant::ARRAY;
+		} break;
+		case GDParser::Node::TYPE_DICTIONARY: {
+
+			type.kind=GDDataType::BUILTIN;
+			type.builtin_type=Variant::DICTIONARY;
+		} break;
+		case GDParser::Node::TYPE_OPERATOR: {
+
+			const GDParser::OperatorNode *on = static_cast<const GDParser::OperatorNode*>(p_expression);
+
+			switch(on->op) {
+
+				case GDParser::OperatorNode::OP_CALL: {
+
+					if (on->arguments[0]->type==GDParser::Node::TYPE_TYPE) {
+
+						Variant::Type vtype = static_cast<const GDParser::TypeNode*>(on->arguments[0])->vtype;
+						if (vtype!=Variant::OBJECT) {
+							type.kind=GDDataType::BUILTIN;
+							type.builtin_type=vtype;
+						}
+					}
+				} break;
+				case GDParser::OperatorNode::OP_EXTENDS:
+				case GDParser::OperatorNode::OP_AND:
+				case GDParser::OperatorNode::OP_OR:
+				case GDParser::OperatorNode::OP_NOT:
+				case GDParser::OperatorNode::OP_IN:
+				case GDParser::OperatorNode::OP_EQUAL:
+				case GDParser::OperatorNode::OP_NOT_EQUAL:
+				case GDParser::OperatorNode::OP_LESS:
+				case GDParser::OperatorNode::OP_LESS_EQUAL:
+				case GDParser::OperatorNode::OP_GREATER:
+				case GDParser::OperatorNode::OP_GREATER_EQUAL: {
+
+					type.kind=GDDataType::BUILTIN;
+					type.builtin_type=Variant::BOOL;
+				} break;
+				case GDParser::OperatorNode::OP_NEG:
+				case GDParser::OperatorNode::OP_BIT_INVERT: {
+
+					GDDataType a = _get_expression_type(codegen,on->arguments[0]);
+					type=_get_operator_type(on->op==GDParser::OperatorNode::OP_NEG?Variant::OP_NEGATE:Variant::OP_BIT_NEGATE,a,a);
+				} break;
+				case GDParser::OperatorNode::OP_ADD:
+				case GDParser::OperatorNode::OP_SUB:
+				case GDParser::OperatorNode::OP_MUL:
+				case GDParser::OperatorNode::OP_DIV:
+				case GDParser::OperatorNode::OP_MOD:
+				case GDParser::OperatorNode::OP_SHIFT_LEFT:
+				case GDParser::OperatorNode::OP_SHIFT_RIGHT:
+				case GDParser::OperatorNode::OP_BIT_AND:
+				case GDParser::OperatorNode::OP_BIT_OR:
+				case GDParser::OperatorNode::OP_BIT_XOR: {
+
+					Variant::Operator op=Variant::OP_MAX;
+					switch(on->op) {
+						case GDParser::OperatorNode::OP_ADD: op=Variant::OP_ADD; break;
+						case GDParser::OperatorNode::OP_SUB: op=Variant::OP_SUBSTRACT; break;
+						case GDParser::OperatorNode::OP_MUL: op=Variant::OP_MULTIPLY; break;
+						case GDParser::OperatorNode::OP_DIV: op=Variant::OP_DIVIDE; break;
+						case GDParser::OperatorNode::OP_MOD: op=Variant::OP_MODULE; break;
+						case GDParser::OperatorNode::OP_SHIFT_LEFT: op=Variant::OP_SHIFT_LEFT; break;
+						case GDParser::OperatorNode::OP_SHIFT_RIGHT: op=Variant::OP_SHIFT_RIGHT; break;
+						case GDParser::OperatorNode::OP_BIT_AND: op=Variant::OP_BIT_AND; break;
+						case GDParser::OperatorNode::OP_BIT_OR: op=Variant::OP_BIT_OR; break;
+						case GDParser::OperatorNode::OP_BIT_XOR: op=Variant::OP_BIT_XOR; break;
+						default: {}
+					}
+
+					GDDataType a = _get_expression_type(codegen,on->arguments[0],p_initializer);
+					GDDataType b = _get_expression_type(codegen,on->arguments[1],p_initializer);
+					type=_get_operator_type(op,a,b);
+				} break;
+				default: {}
+			}
+		} break;
+		default: {}
+	}
+
+	return type;
+}
+
+bool GDCompiler::_get_constant_value(CodeGen& codegen,const GDParser::Node *p_expression,Variant& r_value,bool p_initializer) {
+
+	//the parser already reduces literals, this also sees through named constants
+
+	switch(p_expression->type) {
+
+		case GDParser::Node::TYPE_CONSTANT: {
+
+			r_value=static_cast<const GDParser::ConstantNode*>(p_expression)->value;
+			return r_value.get_type()!=Variant::OBJECT;
+		} break;
+		case GDParser::Node::TYPE_IDENTIFIER: {
+
+			StringName identifier = static_cast<const GDParser::IdentifierNode*>(p_expression)->name;
+
+			//same lookup order as _parse_expression
+			if (!p_initializer && codegen.stack_identifiers.has(identifier))
+				return false;
+			if ((!codegen.function_node || !codegen.function_node->_static) && codegen.script->member_indices.has(identifier))
+				return false;
+
+			GDScript *owner = codegen.script;
+			while (owner) {
+
+				GDScript *scr = owner;
+				GDNativeClass *nc=NULL;
+				while(scr) {
+
+					const Map<StringName,Variant>::Element *E=scr->constants.find(identifier);
+					if (E) {
+						//constants of base scripts in other files can change when those are reloaded
+						if (scr!=owner || E->get().get_type()==Variant::OBJECT)
+							return false;
+						r_value=E->get();
+						return true;
+					}
+					if (scr->native.is_valid())
+						nc=scr->native.ptr();
+					scr=scr->_base;
+				}
+
+				if (nc) {
+
+					bool success=false;
+					int constant = ObjectTypeDB::get_integer_constant(nc->get_name(),identifier,&success);
+					if (success) {
+						r_value=constant;
+						return true;
+					}
+				}
+
+				owner=owner->_owner;
+			}
+		} break;
+		case GDParser::Node::TYPE_OPERATOR: {
+
+			const GDParser::OperatorNode *on = static_cast<const GDParser::OperatorNode*>(p_expression);
+
+			Variant::Operator op=Variant::OP_MAX;
+			bool unary=false;
+
+			switch(on->op) {
+				case GDParser::OperatorNode::OP_NEG: op=Variant::OP_NEGATE; unary=true; break;
+				case GDParser::OperatorNode::OP_NOT: op=Variant::OP_NOT; unary=true; break;
+				case GDParser::OperatorNode::OP_BIT_INVERT: op=Variant::OP_BIT_NEGATE; unary=true; break;
+				case GDParser::OperatorNode::OP_IN: op=Variant::OP_IN; break;
+				case GDParser::OperatorNode::OP_EQUAL: op=Variant::OP_EQUAL; break;
+				case GDParser::OperatorNode::OP_NOT_EQUAL: op=Variant::OP_NOT_EQUAL; break;
+				case GDParser::OperatorNode::OP_LESS: op=Variant::OP_LESS; break;
+				case GDParser::OperatorNode::OP_LESS_EQUAL: op=Variant::OP_LESS_EQUAL; break;
+				case GDParser::OperatorNode::OP_GREATER: op=Variant::OP_GREATER; break;
+				case GDParser::OperatorNode::OP_GREATER_EQUAL: op=Variant::OP_GREATER_EQUAL; break;
+				case GDParser::OperatorNode::OP_AND: op=Variant::OP_AND; break;
+				case GDParser::OperatorNode::OP_OR: op=Variant::OP_OR; break;
+				case GDParser::OperatorNode::OP_ADD: op=Variant::OP_ADD; break;
+				case GDParser::OperatorNode::OP_SUB: op=Variant::OP_SUBSTRACT; break;
+				case GDParser::OperatorNode::OP_MUL: op=Variant::OP_MULTIPLY; break;
+				case GDParser::OperatorNode::OP_DIV: op=Variant::OP_DIVIDE; break;
+				case GDParser::OperatorNode::OP_MOD: op=Variant::OP_MODULE; break;
+				case GDParser::OperatorNode::OP_SHIFT_LEFT: op=Variant::OP_SHIFT_LEFT; break;
+				case GDParser::OperatorNode::OP_SHIFT_RIGHT: op=Variant::OP_SHIFT_RIGHT; break;
+				case GDParser::OperatorNode::OP_BIT_AND: op=Variant::OP_BIT_AND; break;
+				case GDParser::OperatorNode::OP_BIT_OR: op=Variant::OP_BIT_OR; break;
+				case GDParser::OperatorNode::OP_BIT_XOR: op=Variant::OP_BIT_XOR; break;
+				default: return false;
+			}
+
+			Variant a,b;
+			if (!_get_constant_value(codegen,on->arguments[0],a,p_initializer))
+				return false;
+			if (!unary && !_get_constant_value(codegen,on->arguments[1],b,p_initializer))
+				return false;
+
+			//integer division by zero is only checked in debug builds
+			if ((op==Variant::OP_DIVIDE || op==Variant::OP_MODULE) && (b.get_type()==Variant::INT || b.get_type()==Variant::BOOL) && int(b)==0)
+				return false;
+
+			bool valid=false;
+			Variant::evaluate(op,a,b,r_value,valid);
+			//invalid operations are left for the runtime to report
+			return valid && r_value.get_type()!=Variant::OBJECT;
+		} break;
+		default: {}
+	}
+
+	return false;
+}
+
+bool GDCompiler::_needs_typed_assign(const GDDataType& p_dst,const GDDataType& p_src,const GDParser::Node *p_node) {
+
+	//the check can be skipped when the value is known to have the right type,
+	//and known mismatches are reported right away
+	if (!p_dst.has_type() || p_dst==p_src)
+		return false;
+
+	if (!p_src.has_type())
+		return true;
+
+	if (p_dst.kind==GDDataType::NATIVE && p_src.kind==GDDataType::NATIVE) {
+
+		return !ObjectTypeDB::is_type(p_src.native_type,p_dst.native_type);
+	}
+
+	bool numeric = p_dst.kind==GDDataType::BUILTIN && p_src.kind==GDDataType::BUILTIN &&
+		(p_dst.builtin_type==Variant::INT || p_dst.builtin_type==Variant::REAL) &&
+		(p_src.builtin_type==Variant::INT || p_src.builtin_type==Variant::REAL);
+
+	if (!numeric)
+		_set_error("Can't assign a value of type '"+p_src.get_name()+"' to a variable of type '"+p_dst.get_name()+"'.",p_node);
+
+	return true;
+}
+
+void GDCompiler::_write_typed_assign(CodeGen& codegen,const GDDataType& p_type,int p_dst,int p_src) {
+
+	switch(p_type.kind) {
+
+		case GDDataType::UNTYPED: {
+
+			codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN);
+		} break;
+		case GDDataType::BUILTIN: {
+
+			codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN_TYPED_BUILTIN);
+			codegen.opcodes.push_back(p_type.builtin_type);
+		} break;
+		case GDDataType::NATIVE: {
+
+			codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN_TYPED_NATIVE);
+			codegen.opcodes.push_back(codegen.get_name_map_pos(p_type.native_type));
+		} break;
+	}
+
+	codegen.opcodes.push_back(p_dst);
+	codegen.opcodes.push_back(p_src);
+}
+
 bool GDCompiler::_create_unary_operator(CodeGen& codegen,const GDParser::OperatorNode *on,Variant::Operator op, int p_stack_level) {
 
 	ERR_FAIL_COND_V(on->arguments.size()!=1,false);
@@ -62,8 +418,18 @@ bool GDCompiler::_create_unary_operator(CodeGen& codegen,const GDParser::Operato
 	if (src_address_a<0)
 		return false;
 
-	codegen.opcodes.push_back(GDFunction::OPCODE_OPERATOR); // perform operator
-	codegen.opcodes.push_back(op); //which operator
+	GDDataType type_a = _get_expression_type(codegen,on->arguments[0]);
+	Variant::OperatorEvaluator evaluator = NULL;
+	if (type_a.kind==GDDataType::BUILTIN)
+		evaluator = Variant::get_operator_evaluator(op,type_a.builtin_type,type_a.builtin_type);
+
+	if (evaluator) {
+		codegen.opcodes.push_back(GDFunction::OPCODE_OPERATOR_VALIDATED); // operand type is known
+		codegen.opcodes.push_back(codegen.get_operator_func_pos(op,type_a.builtin_type,type_a.builtin_type,evaluator));
+	} else {
+		codegen.opcodes.push_back(GDFunction::OPCODE_OPERATOR); // perform operator
+		codegen.opcodes.push_back(op); //which operator
+	}
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_a); // argument 2 (repeated)
 	//codegen.opcodes.push_back(GDFunction::ADDR_TYPE_NIL); // argument 2 (unary only takes one parameter)
@@ -85,9 +451,19 @@ bool GDCompiler::_create_binary_operator(CodeGen& codegen,const GDParser::Operat
 	if (src_address_b<0)
 		return false;
 
+	GDDataType type_a = _get_expression_type(codegen,on->arguments[0],p_initializer);
+	GDDataType type_b = _get_expression_type(codegen,on->arguments[1],p_initializer);
+	Variant::OperatorEvaluator evaluator = NULL;
+	if (type_a.kind==GDDataType::BUILTIN && type_b.kind==GDDataType::BUILTIN)
+		evaluator = Variant::get_operator_evaluator(op,type_a.builtin_type,type_b.builtin_type);
 
-	codegen.opcodes.push_back(GDFunction::OPCODE_OPERATOR); // perform operator
-	codegen.opcodes.push_back(op); //which operator
+	if (evaluator) {
+		codegen.opcodes.push_back(GDFunction::OPCODE_OPERATOR_VALIDATED); // both operand types are known
+		codegen.opcodes.push_back(codegen.get_operator_func_pos(op,type_a.builtin_type,type_b.builtin_type,evaluator));
+	} else {
+		codegen.opcodes.push_back(GDFunction::OPCODE_OPERATOR); // perform operator
+		codegen.opcodes.push_back(op); //which operator
+	}
 	codegen.opcodes.push_back(src_address_a); // argument 1
 	codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
 	return true;
@@ -112,7 +488,7 @@ int GDCompiler::_parse_subexpression(CodeGen& codegen,const GDParser::Node *p_ex
 }
 */
 
-int GDCompiler::_parse_assign_right_expression(CodeGen& codegen,const GDParser::OperatorNode *p_expression, int p_stack_level) {
+int GDCompiler::_parse_assign_right_expression(CodeGen& codegen,const GDParser::OperatorNode *p_expression, int p_stack_level, GDDataType *r_type) {
 
 	Variant::Operator var_op=Variant::OP_MAX;
 
@@ -142,6 +518,13 @@ int GDCompiler::_parse_assign_right_expression(CodeGen& codegen,const GDParser::
 
 	bool initializer = p_expression->op==GDParser::OperatorNode::OP_INIT_ASSIGN;
 
+	if (r_type) {
+		if (var_op==Variant::OP_MAX)
+			*r_type=_get_expression_type(codegen,p_expression->arguments[1],initializer);
+		else
+			*r_type=_get_operator_type(var_op,_get_expression_type(codegen,p_expression->arguments[0],initializer),_get_expression_type(codegen,p_expression->arguments[1],initializer));
+	}
+
 	if (var_op==Variant::OP_MAX) {
 
 		return _parse_expression(codegen,p_expression->arguments[1],p_stack_level,false,initializer);
@@ -203,6 +586,13 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 
 					if (scr->constants.has(identifier)) {
 
+						Variant value;
+						if (_get_constant_value(codegen,in,value,p_initializer)) {
+							//known at compile time, make it a local constant (faster access)
+							int idx = codegen.get_constant_pos(value);
+							return idx|(GDFunction::ADDR_TYPE_LOCAL_CONSTANT<<GDFunction::ADDR_BITS);
+						}
+
 						//int idx=scr->constants[identifier];
 						int idx = codegen.get_name_map_pos(identifier);
 						return idx|(GDFunction::ADDR_TYPE_CLASS_CONSTANT<<GDFunction::ADDR_BITS); //argument (stack root)
@@ -366,6 +756,14 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 			//hell breaks loose
 
 			const GDParser::OperatorNode *on = static_cast<const GDParser::OperatorNode*>(p_expression);
+
+			Variant folded;
+			if (_get_constant_value(codegen,on,folded,p_initializer)) {
+
+				int idx = codegen.get_constant_pos(folded);
+				return idx|(GDFunction::ADDR_TYPE_LOCAL_CONSTANT<<GDFunction::ADDR_BITS);
+			}
+
 			switch(on->op) {
 
 
@@ -509,11 +907,33 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 
 						}
 
-						codegen.opcodes.push_back(p_root?GDFunction::OPCODE_CALL:GDFunction::OPCODE_CALL_RETURN); // perform operator
-						codegen.opcodes.push_back(on->arguments.size()-2);
-						codegen.alloc_call(on->arguments.size()-2);
-						for(int i=0;i<arguments.size();i++)
-							codegen.opcodes.push_back(arguments[i]);
+						MethodBind *method=NULL;
+						GDDataType base_type = _get_expression_type(codegen,instance);
+						if (base_type.kind==GDDataType::NATIVE) {
+							//base is statically typed, so the engine method can be resolved now
+							method=ObjectTypeDB::get_method(base_type.native_type,static_cast<const GDParser::IdentifierNode*>(on->arguments[1])->name);
+						}
+
+						if (method) {
+
+							codegen.opcodes.push_back(GDFunction::OPCODE_CALL_METHOD_BIND);
+							codegen.opcodes.push_back(on->arguments.size()-2);
+							codegen.alloc_call(on->arguments.size()-2);
+							codegen.opcodes.push_back(arguments[0]);
+							codegen.opcodes.push_back(codegen.get_method_pos(method));
+							for(int i=2;i<arguments.size();i++)
+								codegen.opcodes.push_back(arguments[i]);
+						} else {
+
+							codegen.opcodes.push_back(p_root?GDFunction::OPCODE_CALL:GDFunction::OPCODE_CALL_RETURN); // perform operator
+							codegen.opcodes.push_back(on->arguments.size()-2);
+							codegen.alloc_call(on->arguments.size()-2);
+							for(int i=0;i<arguments.size();i++) {
+								codegen.opcodes.push_back(arguments[i]);
+								if (i==1)
+									codegen.opcodes.push_back(codegen.alloc_cache());
+							}
+						}
 					}
 				} break;
 				case GDParser::OperatorNode::OP_YIELD: {
@@ -586,6 +1006,8 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 					codegen.opcodes.push_back(named?GDFunction::OPCODE_GET_NAMED:GDFunction::OPCODE_GET); // perform operator
 					codegen.opcodes.push_back(from); // argument 1
 					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
+					if (named)
+						codegen.opcodes.push_back(codegen.alloc_cache());
 
 				} break;
 				case GDParser::OperatorNode::OP_AND: {
@@ -781,6 +1203,8 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 							codegen.opcodes.push_back(named ? GDFunction::OPCODE_GET_NAMED : GDFunction::OPCODE_GET);
 							codegen.opcodes.push_back(prev_pos);
 							codegen.opcodes.push_back(key_idx);
+							if (named)
+								codegen.opcodes.push_back(codegen.alloc_cache());
 							slevel++;
 							codegen.alloc_stack(slevel);
 							int dst_pos = (GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS)|slevel;
@@ -788,6 +1212,8 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 							codegen.opcodes.push_back(dst_pos);
 
 							//add in reverse order, since it will be reverted
+							if (named)
+								setchain.push_back(codegen.alloc_cache());
 							setchain.push_back(dst_pos);
 							setchain.push_back(key_idx);
 							setchain.push_back(prev_pos);
@@ -834,14 +1260,13 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 						codegen.opcodes.push_back(prev_pos);
 						codegen.opcodes.push_back(set_index);
 						codegen.opcodes.push_back(set_value);
+						if (named)
+							codegen.opcodes.push_back(codegen.alloc_cache());
 
-						for(int i=0;i<setchain.size();i+=4) {
-
+						//instructions in the chain have different sizes, but are already in order
+						for(int i=0;i<setchain.size();i++) {
 
-							codegen.opcodes.push_back(setchain[i+0]);
-							codegen.opcodes.push_back(setchain[i+1]);
-							codegen.opcodes.push_back(setchain[i+2]);
-							codegen.opcodes.push_back(setchain[i+3]);
+							codegen.opcodes.push_back(setchain[i]);
 						}
 
 						return retval;
@@ -861,16 +1286,26 @@ int GDCompiler::_parse_expression(CodeGen& codegen,const GDParser::Node *p_expre
 							codegen.alloc_stack(slevel);
 						}
 
-						int src_address_b = _parse_assign_right_expression(codegen,on,slevel);
+						GDDataType src_type;
+						int src_address_b = _parse_assign_right_expression(codegen,on,slevel,&src_type);
 						if (src_address_b<0)
 							return -1;
 
+						GDDataType dst_type;
+						if (on->arguments[0]->type==GDParser::Node::TYPE_IDENTIFIER)
+							dst_type=_get_identifier_type(codegen,static_cast<const GDParser::IdentifierNode*>(on->arguments[0])->name,on->op==GDParser::OperatorNode::OP_INIT_ASSIGN);
 
+						if (_needs_typed_assign(dst_type,src_type,on)) {
 
+							_write_typed_assign(codegen,dst_type,dst_address_a,src_address_b);
+						} else {
 
-						codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN); // perform operator
-						codegen.opcodes.push_back(dst_address_a); // argument 1
-						codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
+							codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN); // perform operator
+							codegen.opcodes.push_back(dst_address_a); // argument 1
+							codegen.opcodes.push_back(src_address_b); // argument 2 (unary only takes one parameter)
+						}
+						if (error!="")
+							return -1;
 						return dst_address_a; //if anything, returns wathever was assigned or correct stack position
 
 					}
@@ -999,50 +1434,116 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 
 
 
+						//for i in range(...) counts without creating the array
+						const GDParser::OperatorNode *range_call=NULL;
+						if (cf->arguments[1]->type==GDParser::Node::TYPE_OPERATOR) {
+							const GDParser::OperatorNode *on=static_cast<const GDParser::OperatorNode*>(cf->arguments[1]);
+							if (on->op==GDParser::OperatorNode::OP_CALL && on->arguments[0]->type==GDParser::Node::TYPE_BUILT_IN_FUNCTION &&
+							    static_cast<const GDParser::BuiltInFunctionNode*>(on->arguments[0])->function==GDFunctions::GEN_RANGE &&
+							    on->arguments.size()>=2 && on->arguments.size()<=4)
+								range_call=on;
+						}
+
 						int slevel=p_stack_level;
 						int iter_stack_pos=slevel;
 						int iterator_pos = (slevel++)|(GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS);
 						int counter_pos = (slevel++)|(GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS);
 						int container_pos = (slevel++)|(GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS);
+						int step_pos = range_call ? (slevel++)|(GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS) : -1;
 						codegen.alloc_stack(slevel);
 
 						    codegen.push_stack_identifiers();
 						      codegen.add_stack_identifier(static_cast<const GDParser::IdentifierNode*>(cf->arguments[0])->name,iter_stack_pos);
 
-						int ret = _parse_expression(codegen,cf->arguments[1],slevel,false);
-						if (ret<0)
-							return ERR_COMPILATION_FAILED;
+						int break_pos;
+						int continue_pos;
 
-						//assign container
-						codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN);
-						codegen.opcodes.push_back(container_pos);
-						codegen.opcodes.push_back(ret);
+						if (range_call) {
 
-						//begin loop
-						codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE_BEGIN);
-						codegen.opcodes.push_back(counter_pos);
-						codegen.opcodes.push_back(container_pos);
-						codegen.opcodes.push_back(codegen.opcodes.size()+4);
-						codegen.opcodes.push_back(iterator_pos);
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP); //skip code for next
-						codegen.opcodes.push_back(codegen.opcodes.size()+8);
-						//break loop
-						int break_pos=codegen.opcodes.size();
-						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP); //skip code for next
-						codegen.opcodes.push_back(0); //skip code for next
-						//next loop
-						int continue_pos=codegen.opcodes.size();
-						codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE);
-						codegen.opcodes.push_back(counter_pos);
-						codegen.opcodes.push_back(container_pos);
-						codegen.opcodes.push_back(break_pos);
-						codegen.opcodes.push_back(iterator_pos);
+							Vector<int> arguments;
+							for(int i=1;i<range_call->arguments.size();i++) {
 
+								int ret = _parse_expression(codegen,range_call->arguments[i],slevel);
+								if (ret<0)
+									return ERR_COMPILATION_FAILED;
+								if (ret&GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS) {
+									slevel++;
+									codegen.alloc_stack(slevel);
+								}
+								arguments.push_back(ret);
+							}
+
+							//begin loop, container holds the limit
+							codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE_RANGE_BEGIN);
+							codegen.opcodes.push_back(arguments.size());
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(step_pos);
+							codegen.alloc_call(arguments.size());
+							for(int i=0;i<arguments.size();i++)
+								codegen.opcodes.push_back(arguments[i]);
+							codegen.opcodes.push_back(codegen.opcodes.size()+4);
+							codegen.opcodes.push_back(iterator_pos);
+							codegen.opcodes.push_back(GDFunction::OPCODE_JUMP); //skip code for next
+							codegen.opcodes.push_back(codegen.opcodes.size()+9);
+							//break loop
+							break_pos=codegen.opcodes.size();
+							codegen.opcodes.push_back(GDFunction::OPCODE_JUMP); //skip code for next
+							codegen.opcodes.push_back(0); //skip code for next
+							//next loop
+							continue_pos=codegen.opcodes.size();
+							codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE_RANGE);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(step_pos);
+							codegen.opcodes.push_back(break_pos);
+							codegen.opcodes.push_back(iterator_pos);
+
+						} else {
+
+							int ret = _parse_expression(codegen,cf->arguments[1],slevel,false);
+							if (ret<0)
+								return ERR_COMPILATION_FAILED;
+
+							int lock_idx=codegen.for_depth;
+
+							//assign container
+							codegen.opcodes.push_back(GDFunction::OPCODE_ASSIGN);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(ret);
+
+							//begin loop
+							codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE_BEGIN);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(codegen.opcodes.size()+5);
+							codegen.opcodes.push_back(iterator_pos);
+							codegen.opcodes.push_back(lock_idx);
+							codegen.opcodes.push_back(GDFunction::OPCODE_JUMP); //skip code for next
+							codegen.opcodes.push_back(codegen.opcodes.size()+9);
+							//break loop
+							break_pos=codegen.opcodes.size();
+							codegen.opcodes.push_back(GDFunction::OPCODE_JUMP); //skip code for next
+							codegen.opcodes.push_back(0); //skip code for next
+							//next loop
+							continue_pos=codegen.opcodes.size();
+							codegen.opcodes.push_back(GDFunction::OPCODE_ITERATE);
+							codegen.opcodes.push_back(counter_pos);
+							codegen.opcodes.push_back(container_pos);
+							codegen.opcodes.push_back(break_pos);
+							codegen.opcodes.push_back(iterator_pos);
+							codegen.opcodes.push_back(lock_idx);
+						}
+
+						codegen.for_depth++;
+						if (codegen.for_depth>codegen.for_depth_max)
+							codegen.for_depth_max=codegen.for_depth;
 
 						Error err = _parse_block(codegen,cf->body,slevel,break_pos,continue_pos);
 						if (err)
 							return err;
 
+						codegen.for_depth--;
 
 						codegen.opcodes.push_back(GDFunction::OPCODE_JUMP);
 						codegen.opcodes.push_back(continue_pos);
@@ -1106,14 +1607,33 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 
 						int ret;
 
+						GDDataType return_type;
+						if (codegen.function_node)
+							return_type=_resolve_type(codegen.function_node->return_type);
+
 						if (cf->arguments.size()) {
 
 							ret = _parse_expression(codegen,cf->arguments[0],p_stack_level,false);
 							if (ret<0)
 								return ERR_PARSE_ERROR;
 
+							if (_needs_typed_assign(return_type,_get_expression_type(codegen,cf->arguments[0]),cf)) {
+
+								//convert into a temporary, the returned expression may be a variable
+								int dst = p_stack_level|(GDFunction::ADDR_TYPE_STACK<<GDFunction::ADDR_BITS);
+								codegen.alloc_stack(p_stack_level);
+								_write_typed_assign(codegen,return_type,dst,ret);
+								ret=dst;
+							}
+							if (error!="")
+								return ERR_PARSE_ERROR;
+
 						} else {
 
+							if (return_type.has_type()) {
+								_set_error("Expected a return value of type '"+return_type.get_name()+"'.",cf);
+								return ERR_PARSE_ERROR;
+							}
 							ret=GDFunction::ADDR_TYPE_NIL << GDFunction::ADDR_BITS;
 						}
 
@@ -1141,7 +1661,7 @@ Error GDCompiler::_parse_block(CodeGen& codegen,const GDParser::BlockNode *p_blo
 
 				const GDParser::LocalVarNode *lv = static_cast<const GDParser::LocalVarNode*>(s);
 
-				codegen.add_stack_identifier(lv->name,p_stack_level++);
+				codegen.add_stack_identifier(lv->name,p_stack_level++,_resolve_type(lv->datatype));
 				codegen.alloc_stack(p_stack_level);
 				new_identifiers++;
 
@@ -1172,6 +1692,9 @@ Error GDCompiler::_parse_function(GDScript *p_script,const GDParser::ClassNode *
 	codegen.stack_max=0;
 	codegen.current_line=0;
 	codegen.call_max=0;
+	codegen.cache_count=0;
+	codegen.for_depth=0;
+	codegen.for_depth_max=0;
 	codegen.debug_stack=ScriptDebugger::get_singleton()!=NULL;
 	Vector<StringName> argnames;
 
@@ -1180,7 +1703,7 @@ Error GDCompiler::_parse_function(GDScript *p_script,const GDParser::ClassNode *
 	if (p_func) {
 		for(int i=0;i<p_func->arguments.size();i++) {
 			int idx = i;
-			codegen.add_stack_identifier(p_func->arguments[i],i);
+			codegen.add_stack_identifier(p_func->arguments[i],i,_resolve_type(p_func->argument_types[i]));
 #ifdef TOOLS_ENABLED
 			argnames.push_back(p_func->arguments[i]);
 #endif
@@ -1232,7 +1755,14 @@ Error GDCompiler::_parse_function(GDScript *p_script,const GDParser::ClassNode *
 			defarg_addr.invert();
 		}
 
-
+		for(int i=0;i<p_func->arguments.size();i++) {
+			//typed arguments are checked (and converted) once on entry
+			GDDataType type = _resolve_type(p_func->argument_types[i]);
+			if (!type.has_type())
+				continue;
+			int addr = i|(GDFunction::ADDR_TYPE_STACK_VARIABLE<<GDFunction::ADDR_BITS);
+			_write_typed_assign(codegen,type,addr,addr);
+		}
 
 		Error err = _parse_block(codegen,p_func->body,stack_level);
 		if (err)
@@ -1245,6 +1775,10 @@ Error GDCompiler::_parse_function(GDScript *p_script,const GDParser::ClassNode *
 
 	codegen.opcodes.push_back(GDFunction::OPCODE_END);
 
+	code_size_before+=codegen.opcodes.size();
+	_optimize_function(codegen,defarg_addr);
+	code_size_after+=codegen.opcodes.size();
+
 	GDFunction *gdfunc=NULL;
 
 	//if (String(p_func->name)=="") { //initializer func
@@ -1305,6 +1839,39 @@ Error GDCompiler::_parse_function(GDScript *p_script,const GDParser::ClassNode *
 		gdfunc->_code_size=0;
 	}
 
+	if (codegen.operator_funcs.size()) {
+
+		gdfunc->operator_funcs=codegen.operator_funcs;
+		gdfunc->_operator_funcs_ptr=&gdfunc->operator_funcs[0];
+		gdfunc->_operator_funcs_count=gdfunc->operator_funcs.size();
+	} else {
+
+		gdfunc->_operator_funcs_ptr=NULL;
+		gdfunc->_operator_funcs_count=0;
+	}
+
+	if (codegen.methods.size()) {
+
+		gdfunc->methods=codegen.methods;
+		gdfunc->_methods_ptr=&gdfunc->methods[0];
+		gdfunc->_methods_count=gdfunc->methods.size();
+	} else {
+
+		gdfunc->_methods_ptr=NULL;
+		gdfunc->_methods_count=0;
+	}
+
+	if (codegen.cache_count) {
+
+		gdfunc->caches.resize(codegen.cache_count);
+		gdfunc->_caches_ptr=&gdfunc->caches[0];
+		gdfunc->_cache_count=gdfunc->caches.size();
+	} else {
+
+		gdfunc->_caches_ptr=NULL;
+		gdfunc->_cache_count=0;
+	}
+
 	if (defarg_addr.size()) {
 
 		gdfunc->default_arguments=defarg_addr;
@@ -1318,6 +1885,7 @@ Error GDCompiler::_parse_function(GDScript *p_script,const GDParser::ClassNode *
 	gdfunc->_argument_count=p_func ? p_func->arguments.size() : 0;
 	gdfunc->_stack_size=codegen.stack_max;
 	gdfunc->_call_size=codegen.call_max;
+	gdfunc->_iterator_lock_count=codegen.for_depth_max;
 	gdfunc->name=func_name;
 	gdfunc->_script=p_script;
 	gdfunc->source=source;
@@ -1337,6 +1905,13 @@ Error GDCompiler::_parse_function(GDScript *p_script,const GDParser::ClassNode *
 		gdfunc->_initial_line=0;
 	}
 
+#ifdef DEBUG_ENABLED
+
+	gdfunc->profile.signature=String(source)+"::"+itos(gdfunc->_initial_line)+"::"+String(func_name);
+	GDScriptLanguage::get_singleton()->add_profiled_function(gdfunc);
+
+#endif
+
 	if (codegen.debug_stack)
 		gdfunc->stack_debug=codegen.stack_debug;
 
@@ -1344,6 +1919,634 @@ Error GDCompiler::_parse_function(GDScript *p_script,const GDParser::ClassNode *
 		p_script->initializer=gdfunc;
 
 
+	return _verify_function(gdfunc,p_func);
+}
+
+bool GDCompiler::_verify_address(const GDFunction *p_func,int p_address) {
+
+	int address = p_address&GDFunction::ADDR_MASK;
+
+	switch((p_address&GDFunction::ADDR_TYPE_MASK)>>GDFunction::ADDR_BITS) {
+
+		case GDFunction::ADDR_TYPE_SELF:
+		case GDFunction::ADDR_TYPE_CLASS:
+		case GDFunction::ADDR_TYPE_MEMBER:
+		case GDFunction::ADDR_TYPE_NIL: return true;
+		case GDFunction::ADDR_TYPE_CLASS_CONSTANT: return address<p_func->_global_names_count;
+		case GDFunction::ADDR_TYPE_LOCAL_CONSTANT: return address<p_func->_constant_count;
+		case GDFunction::ADDR_TYPE_STACK:
+		case GDFunction::ADDR_TYPE_STACK_VARIABLE: return address<p_func->_stack_size;
+		case GDFunction::ADDR_TYPE_GLOBAL: return address<GDScriptLanguage::get_singleton()->get_global_array_size();
+	}
+
+	return false;
+}
+
+bool GDCompiler::_decode_instruction(const int *p_code,int p_code_size,int p_ip,Instruction& r_instr,String& r_error) {
+
+#define READ_OPERAND(m_ofs) (p_ip+(m_ofs)<p_code_size ? p_code[p_ip+(m_ofs)] : -1)
+
+	r_instr.len=-1;
+	r_instr.fixed_count=0;
+	r_instr.range_from=0;
+	r_instr.range_count=0;
+	r_instr.dst_ofs=-1;
+	r_instr.name_ofs=-1;
+	r_instr.jump_ofs=-1;
+	r_instr.cache_ofs=-1;
+	r_instr.operator_func_ofs=-1;
+	r_instr.method_ofs=-1;
+	r_instr.iterator_lock_ofs=-1;
+	r_instr.call_argc=0;
+
+	int *fixed_addr=r_instr.fixed_addr;
+	int argc=0;
+
+	switch(p_code[p_ip]) {
+
+		case GDFunction::OPCODE_OPERATOR: {
+
+			r_instr.len=5;
+			if (READ_OPERAND(1)<0 || READ_OPERAND(1)>=Variant::OP_MAX)
+				r_error="invalid operator";
+			fixed_addr[0]=2; fixed_addr[1]=3; fixed_addr[2]=4; r_instr.fixed_count=3;
+			r_instr.dst_ofs=4;
+		} break;
+		case GDFunction::OPCODE_OPERATOR_VALIDATED: {
+
+			r_instr.len=5;
+			r_instr.operator_func_ofs=1;
+			fixed_addr[0]=2; fixed_addr[1]=3; fixed_addr[2]=4; r_instr.fixed_count=3;
+			r_instr.dst_ofs=4;
+		} break;
+		case GDFunction::OPCODE_EXTENDS_TEST:
+		case GDFunction::OPCODE_GET: {
+
+			r_instr.len=4;
+			fixed_addr[0]=1; fixed_addr[1]=2; fixed_addr[2]=3; r_instr.fixed_count=3;
+			r_instr.dst_ofs=3;
+		} break;
+		case GDFunction::OPCODE_SET: {
+
+			r_instr.len=4;
+			fixed_addr[0]=1; fixed_addr[1]=2; fixed_addr[2]=3; r_instr.fixed_count=3;
+		} break;
+		case GDFunction::OPCODE_SET_NAMED: {
+
+			r_instr.len=5;
+			fixed_addr[0]=1; fixed_addr[1]=3; r_instr.fixed_count=2;
+			r_instr.name_ofs=2;
+			r_instr.cache_ofs=4;
+		} break;
+		case GDFunction::OPCODE_GET_NAMED: {
+
+			r_instr.len=5;
+			fixed_addr[0]=1; fixed_addr[1]=4; r_instr.fixed_count=2;
+			r_instr.name_ofs=2;
+			r_instr.cache_ofs=3;
+			r_instr.dst_ofs=4;
+		} break;
+		case GDFunction::OPCODE_ASSIGN: {
+
+			r_instr.len=3;
+			fixed_addr[0]=1; fixed_addr[1]=2; r_instr.fixed_count=2;
+			r_instr.dst_ofs=1;
+		} break;
+		case GDFunction::OPCODE_ASSIGN_TYPED_BUILTIN: {
+
+			r_instr.len=4;
+			if (READ_OPERAND(1)<0 || READ_OPERAND(1)>=Variant::VARIANT_MAX)
+				r_error="invalid type";
+			fixed_addr[0]=2; fixed_addr[1]=3; r_instr.fixed_count=2;
+			r_instr.dst_ofs=2;
+		} break;
+		case GDFunction::OPCODE_ASSIGN_TYPED_NATIVE: {
+
+			r_instr.len=4;
+			r_instr.name_ofs=1;
+			fixed_addr[0]=2; fixed_addr[1]=3; r_instr.fixed_count=2;
+			r_instr.dst_ofs=2;
+		} break;
+		case GDFunction::OPCODE_ASSIGN_TRUE:
+		case GDFunction::OPCODE_ASSIGN_FALSE:
+		case GDFunction::OPCODE_YIELD_RESUME: {
+
+			r_instr.len=2;
+			fixed_addr[0]=1; r_instr.fixed_count=1;
+			r_instr.dst_ofs=1;
+		} break;
+		case GDFunction::OPCODE_RETURN:
+		case GDFunction::OPCODE_ASSERT: {
+
+			r_instr.len=2;
+			fixed_addr[0]=1; r_instr.fixed_count=1;
+		} break;
+		case GDFunction::OPCODE_CONSTRUCT: {
+
+			if (READ_OPERAND(1)<0 || READ_OPERAND(1)>=Variant::VARIANT_MAX)
+				r_error="invalid type";
+			argc=READ_OPERAND(2);
+			r_instr.call_argc=argc;
+			r_instr.len=4+argc;
+			r_instr.range_from=3; r_instr.range_count=argc+1;
+			r_instr.dst_ofs=3+argc;
+		} break;
+		case GDFunction::OPCODE_CONSTRUCT_ARRAY: {
+
+			argc=READ_OPERAND(1);
+			r_instr.len=3+argc;
+			r_instr.range_from=2; r_instr.range_count=argc+1;
+			r_instr.dst_ofs=2+argc;
+		} break;
+		case GDFunction::OPCODE_CONSTRUCT_DICTIONARY: {
+
+			argc=READ_OPERAND(1)*2;
+			r_instr.len=3+argc;
+			r_instr.range_from=2; r_instr.range_count=argc+1;
+			r_instr.dst_ofs=2+argc;
+		} break;
+		case GDFunction::OPCODE_CALL:
+		case GDFunction::OPCODE_CALL_RETURN: {
+
+			argc=READ_OPERAND(1);
+			r_instr.call_argc=argc;
+			r_instr.len=6+argc;
+			fixed_addr[0]=2; r_instr.fixed_count=1;
+			r_instr.name_ofs=3;
+			r_instr.cache_ofs=4;
+			r_instr.range_from=5; r_instr.range_count=argc+1;
+			if (p_code[p_ip]==GDFunction::OPCODE_CALL_RETURN)
+				r_instr.dst_ofs=5+argc;
+		} break;
+		case GDFunction::OPCODE_CALL_METHOD_BIND: {
+
+			argc=READ_OPERAND(1);
+			r_instr.call_argc=argc;
+			r_instr.len=5+argc;
+			r_instr.method_ofs=3;
+			fixed_addr[0]=2; r_instr.fixed_count=1;
+			r_instr.range_from=4; r_instr.range_count=argc+1;
+			r_instr.dst_ofs=4+argc;
+		} break;
+		case GDFunction::OPCODE_CALL_BUILT_IN: {
+
+			if (READ_OPERAND(1)<0 || READ_OPERAND(1)>=GDFunctions::FUNC_MAX)
+				r_error="invalid built-in function";
+			argc=READ_OPERAND(2);
+			r_instr.call_argc=argc;
+			r_instr.len=4+argc;
+			r_instr.range_from=3; r_instr.range_count=argc+1;
+			r_instr.dst_ofs=3+argc;
+		} break;
+		case GDFunction::OPCODE_CALL_SELF_BASE: {
+
+			r_instr.name_ofs=1;
+			argc=READ_OPERAND(2);
+			r_instr.call_argc=argc;
+			r_instr.len=4+argc;
+			r_instr.range_from=3; r_instr.range_count=argc+1;
+			r_instr.dst_ofs=3+argc;
+		} break;
+		case GDFunction::OPCODE_YIELD: {
+
+			r_instr.len=1;
+		} break;
+		case GDFunction::OPCODE_YIELD_SIGNAL: {
+
+			r_instr.len=3;
+			fixed_addr[0]=1; fixed_addr[1]=2; r_instr.fixed_count=2;
+		} break;
+		case GDFunction::OPCODE_JUMP: {
+
+			r_instr.len=2;
+			r_instr.jump_ofs=1;
+		} break;
+		case GDFunction::OPCODE_JUMP_IF:
+		case GDFunction::OPCODE_JUMP_IF_NOT: {
+
+			r_instr.len=3;
+			fixed_addr[0]=1; r_instr.fixed_count=1;
+			r_instr.jump_ofs=2;
+		} break;
+		case GDFunction::OPCODE_JUMP_TO_DEF_ARGUMENT:
+		case GDFunction::OPCODE_END: {
+
+			r_instr.len=1;
+		} break;
+		case GDFunction::OPCODE_ITERATE_BEGIN:
+		case GDFunction::OPCODE_ITERATE: {
+
+			r_instr.len=6;
+			fixed_addr[0]=1; fixed_addr[1]=2; fixed_addr[2]=4; r_instr.fixed_count=3;
+			r_instr.jump_ofs=3;
+			r_instr.iterator_lock_ofs=5;
+		} break;
+		case GDFunction::OPCODE_ITERATE_RANGE_BEGIN: {
+
+			argc=READ_OPERAND(1);
+			if (argc<1 || argc>3)
+				r_error="invalid instruction size";
+			r_instr.call_argc=argc;
+			r_instr.len=7+argc;
+			r_instr.range_from=2; r_instr.range_count=3+argc;
+			r_instr.jump_ofs=5+argc;
+			fixed_addr[0]=6+argc; r_instr.fixed_count=1;
+		} break;
+		case GDFunction::OPCODE_ITERATE_RANGE: {
+
+			r_instr.len=6;
+			r_instr.range_from=1; r_instr.range_count=3;
+			r_instr.jump_ofs=4;
+			fixed_addr[0]=5; r_instr.fixed_count=1;
+		} break;
+		case GDFunction::OPCODE_LINE: {
+
+			r_instr.len=2;
+		} break;
+		default: {
+
+			r_error="invalid opcode";
+		} break;
+	}
+
+#undef READ_OPERAND
+
+	if (r_error=="" && (r_instr.len<1 || argc<0 || p_ip+r_instr.len>p_code_size))
+		r_error="invalid instruction size";
+
+	return r_error=="";
+}
+
+/* Cleans up the bytecode after generation. Conditional jumps on constants
+   become plain jumps, jumps to jumps are threaded, values computed into a
+   temporary only to be copied to a variable are computed in place, and code
+   that can't be reached (plus line markers in release builds) is removed. */
+
+void GDCompiler::_optimize_function(CodeGen& codegen,Vector<int>& r_defarg_addr) {
+
+	Vector<int> &code = codegen.opcodes;
+	int code_size = code.size();
+
+	if (code_size==0)
+		return;
+
+	Vector<int> starts;
+	Vector<Instruction> instrs;
+	Vector<int> index_at; //instruction starting at each position, or -1
+	index_at.resize(code_size+1);
+	for(int i=0;i<=code_size;i++)
+		index_at[i]=-1;
+
+	for(int ip=0;ip<code_size;) {
+
+		Instruction instr;
+		String err;
+		if (!_decode_instruction(code.ptr(),code_size,ip,instr,err))
+			return; //leave it for the verifier to report
+		index_at[ip]=instrs.size();
+		starts.push_back(ip);
+		instrs.push_back(instr);
+		ip+=instr.len;
+	}
+
+	int count = instrs.size();
+	index_at[code_size]=count;
+
+	for(int i=0;i<count;i++) {
+		int ofs=instrs[i].jump_ofs;
+		if (ofs>=0 && (code[starts[i]+ofs]<0 || code[starts[i]+ofs]>=code_size || index_at[code[starts[i]+ofs]]<0))
+			return;
+	}
+	for(int i=0;i<r_defarg_addr.size();i++) {
+		if (r_defarg_addr[i]<0 || r_defarg_addr[i]>=code_size || index_at[r_defarg_addr[i]]<0)
+			return;
+	}
+
+	Vector<Variant> constants;
+	constants.resize(codegen.constant_map.size());
+	const Variant *K=NULL;
+	while((K=codegen.constant_map.next(K)))
+		constants[codegen.constant_map[*K]]=*K;
+
+	Vector<bool> removed;
+	removed.resize(count);
+	for(int i=0;i<count;i++) {
+#ifdef DEBUG_ENABLED
+		removed[i]=false;
+#else
+		//only the debugger and error messages need lines
+		removed[i]=code[starts[i]]==GDFunction::OPCODE_LINE;
+#endif
+	}
+
+	/* conditional jumps on constants */
+
+	for(int i=0;i<count;i++) {
+
+		int op = code[starts[i]];
+		if (op!=GDFunction::OPCODE_JUMP_IF && op!=GDFunction::OPCODE_JUMP_IF_NOT)
+			continue;
+
+		int test = code[starts[i]+1];
+		if ((test&GDFunction::ADDR_TYPE_MASK)>>GDFunction::ADDR_BITS!=GDFunction::ADDR_TYPE_LOCAL_CONSTANT)
+			continue;
+
+		bool valid;
+		bool result = constants[test&GDFunction::ADDR_MASK].booleanize(valid);
+		if (!valid)
+			continue; //keep the runtime error
+
+		if (result==(op==GDFunction::OPCODE_JUMP_IF)) {
+			//always taken
+			code[starts[i]]=GDFunction::OPCODE_JUMP;
+			code[starts[i]+1]=code[starts[i]+2];
+			instrs[i].len=2;
+			instrs[i].fixed_count=0;
+			instrs[i].jump_ofs=1;
+		} else {
+			//never taken
+			removed[i]=true;
+		}
+	}
+
+	/* jump threading */
+
+	for(int i=0;i<count;i++) {
+
+		if (removed[i] || instrs[i].jump_ofs<0)
+			continue;
+
+		int target = index_at[code[starts[i]+instrs[i].jump_ofs]];
+		for(int hops=0;hops<count;hops++) {
+			//skip what won't be there, then follow plain jumps
+			while(target<count && removed[target])
+				target++;
+			if (target>=count || target==i || code[starts[target]]!=GDFunction::OPCODE_JUMP)
+				break;
+			target = index_at[code[starts[target]+1]];
+		}
+
+		if (target<count)
+			code[starts[i]+instrs[i].jump_ofs]=starts[target];
+	}
+
+	/* jumps to the next instruction */
+
+	for(int i=0;i<count;i++) {
+
+		if (removed[i] || code[starts[i]]!=GDFunction::OPCODE_JUMP)
+			continue;
+
+		int next=i+1;
+		while(next<count && removed[next])
+			next++;
+		if (next<count && code[starts[i]+1]==starts[next])
+			removed[i]=true;
+	}
+
+	/* copy propagation */
+
+	Vector<bool> jump_target;
+	jump_target.resize(count);
+	for(int i=0;i<count;i++)
+		jump_target[i]=false;
+	for(int i=0;i<count+r_defarg_addr.size();i++) {
+
+		int target;
+		if (i<count) {
+			if (removed[i] || instrs[i].jump_ofs<0)
+				continue;
+			target=index_at[code[starts[i]+instrs[i].jump_ofs]];
+		} else {
+			target=index_at[r_defarg_addr[i-count]];
+		}
+		//execution lands on the first instruction that is kept
+		while(target<count && removed[target])
+			target++;
+		if (target<count)
+			jump_target[target]=true;
+	}
+
+	for(int i=0;i<count-1;i++) {
+
+		if (removed[i] || removed[i+1] || jump_target[i+1] || instrs[i].dst_ofs<0)
+			continue;
+		if (code[starts[i+1]]!=GDFunction::OPCODE_ASSIGN)
+			continue;
+
+		int op = code[starts[i]];
+		bool alias_safe=false; //result is computed before it's stored
+
+		switch(op) {
+			case GDFunction::OPCODE_OPERATOR:
+			case GDFunction::OPCODE_OPERATOR_VALIDATED: alias_safe=true; break;
+			case GDFunction::OPCODE_GET:
+			case GDFunction::OPCODE_GET_NAMED:
+			case GDFunction::OPCODE_CONSTRUCT:
+			case GDFunction::OPCODE_CONSTRUCT_ARRAY:
+			case GDFunction::OPCODE_CONSTRUCT_DICTIONARY:
+			case GDFunction::OPCODE_CALL_RETURN:
+			case GDFunction::OPCODE_CALL_METHOD_BIND:
+			case GDFunction::OPCODE_CALL_BUILT_IN:
+			case GDFunction::OPCODE_CALL_SELF_BASE: break;
+			default: continue;
+		}
+
+		int temp = code[starts[i]+instrs[i].dst_ofs];
+		int dst = code[starts[i+1]+1];
+		int src = code[starts[i+1]+2];
+
+		//only expression temporaries die right after being copied
+		if (src!=temp || dst==temp || (temp&GDFunction::ADDR_TYPE_MASK)>>GDFunction::ADDR_BITS!=GDFunction::ADDR_TYPE_STACK)
+			continue;
+
+		if (!alias_safe) {
+
+			bool reads_dst=false;
+			for(int j=0;j<instrs[i].fixed_count;j++) {
+				if (instrs[i].fixed_addr[j]!=instrs[i].dst_ofs && code[starts[i]+instrs[i].fixed_addr[j]]==dst)
+					reads_dst=true;
+			}
+			for(int j=0;j<instrs[i].range_count;j++) {
+				if (instrs[i].range_from+j!=instrs[i].dst_ofs && code[starts[i]+instrs[i].range_from+j]==dst)
+					reads_dst=true;
+			}
+			if (reads_dst)
+				continue;
+		}
+
+		code[starts[i]+instrs[i].dst_ofs]=dst;
+		removed[i+1]=true;
+	}
+
+	/* unreachable code */
+
+	Vector<bool> reached;
+	reached.resize(count);
+	for(int i=0;i<count;i++)
+		reached[i]=false;
+
+	Vector<int> pending;
+	pending.push_back(0);
+	for(int i=0;i<r_defarg_addr.size();i++)
+		pending.push_back(index_at[r_defarg_addr[i]]);
+
+	while(pending.size()) {
+
+		int i = pending[pending.size()-1];
+		pending.resize(pending.size()-1);
+
+		while(i<count && !reached[i]) {
+
+			reached[i]=true;
+			if (removed[i]) {
+				i++;
+				continue;
+			}
+
+			if (instrs[i].jump_ofs>=0)
+				pending.push_back(index_at[code[starts[i]+instrs[i].jump_ofs]]);
+
+			int op = code[starts[i]];
+			if (op==GDFunction::OPCODE_JUMP || op==GDFunction::OPCODE_RETURN || op==GDFunction::OPCODE_END)
+				break;
+			i++;
+		}
+	}
+
+	for(int i=0;i<count-1;i++) {
+		if (!reached[i])
+			removed[i]=true;
+	}
+	removed[count-1]=false; //always keep the end
+
+	/* rebuild */
+
+	Vector<int> new_pos; //new position of each instruction, or of the next one kept
+	new_pos.resize(count+1);
+	int pos=0;
+	for(int i=0;i<count;i++) {
+		new_pos[i]=pos;
+		if (!removed[i])
+			pos+=instrs[i].len;
+	}
+	new_pos[count]=pos;
+
+	Vector<int> new_code;
+	new_code.resize(pos);
+	int w=0;
+	for(int i=0;i<count;i++) {
+
+		if (removed[i])
+			continue;
+		for(int j=0;j<instrs[i].len;j++)
+			new_code[w+j]=code[starts[i]+j];
+		if (instrs[i].jump_ofs>=0)
+			new_code[w+instrs[i].jump_ofs]=new_pos[index_at[code[starts[i]+instrs[i].jump_ofs]]];
+		w+=instrs[i].len;
+	}
+
+	for(int i=0;i<r_defarg_addr.size();i++)
+		r_defarg_addr[i]=new_pos[index_at[r_defarg_addr[i]]];
+
+	for(List<GDFunction::StackDebug>::Element *E=codegen.stack_debug.front();E;E=E->next()) {
+
+		int p = E->get().pos;
+		if (p>=0 && p<=code_size && index_at[p]>=0)
+			E->get().pos=new_pos[index_at[p]];
+	}
+
+	code=new_code;
+}
+
+/* Checks instruction sizes, operands and jump targets once, so GDFunction::call
+   does not need to check them on every instruction in release builds. */
+
+Error GDCompiler::_verify_function(const GDFunction *p_func,const GDParser::Node *p_node) {
+
+	const int *code = p_func->_code_ptr;
+	int code_size = p_func->_code_size;
+
+	if (!code)
+		return OK;
+
+	Vector<bool> instruction_start;
+	instruction_start.resize(code_size);
+	for(int i=0;i<code_size;i++)
+		instruction_start[i]=false;
+
+	Vector<int> jump_targets;
+	String error;
+	int ip=0;
+	int last_opcode=-1;
+
+	while(ip<code_size) {
+
+		instruction_start[ip]=true;
+		last_opcode=code[ip];
+
+		Instruction instr;
+		if (!_decode_instruction(code,code_size,ip,instr,error))
+			break;
+
+		if (instr.call_argc>p_func->_call_size)
+			error="invalid instruction size";
+
+		for(int i=0;error=="" && i<instr.fixed_count;i++) {
+			if (!_verify_address(p_func,code[ip+instr.fixed_addr[i]]))
+				error="invalid address";
+		}
+
+		for(int i=0;error=="" && i<instr.range_count;i++) {
+			if (!_verify_address(p_func,code[ip+instr.range_from+i]))
+				error="invalid address";
+		}
+
+		if (error=="" && instr.name_ofs>=0 && (code[ip+instr.name_ofs]<0 || code[ip+instr.name_ofs]>=p_func->_global_names_count))
+			error="invalid name";
+
+		if (error=="" && instr.cache_ofs>=0 && (code[ip+instr.cache_ofs]<0 || code[ip+instr.cache_ofs]>=p_func->_cache_count))
+			error="invalid cache";
+
+		if (error=="" && instr.operator_func_ofs>=0 && (code[ip+instr.operator_func_ofs]<0 || code[ip+instr.operator_func_ofs]>=p_func->_operator_funcs_count))
+			error="invalid operator function";
+
+		if (error=="" && instr.method_ofs>=0 && (code[ip+instr.method_ofs]<0 || code[ip+instr.method_ofs]>=p_func->_methods_count))
+			error="invalid method";
+
+		if (error=="" && instr.iterator_lock_ofs>=0 && (code[ip+instr.iterator_lock_ofs]<0 || code[ip+instr.iterator_lock_ofs]>=p_func->_iterator_lock_count))
+			error="invalid iterator lock";
+
+		if (error=="" && instr.jump_ofs>=0)
+			jump_targets.push_back(code[ip+instr.jump_ofs]);
+
+		if (error!="")
+			break;
+
+		ip+=instr.len;
+	}
+
+	for(int i=0;error=="" && i<jump_targets.size();i++) {
+
+		if (jump_targets[i]<0 || jump_targets[i]>=code_size || !instruction_start[jump_targets[i]])
+			error="invalid jump target";
+	}
+
+	for(int i=0;error=="" && i<p_func->_default_arg_count;i++) {
+
+		int addr=p_func->_default_arg_ptr[i];
+		if (addr<0 || addr>=code_size || !instruction_start[addr])
+			error="invalid default argument address";
+	}
+
+	if (error=="" && last_opcode!=GDFunction::OPCODE_END)
+		error="missing end";
+
+	if (error!="") {
+		_set_error("Compiler bug, "+error+" at address "+itos(ip)+" of function '"+String(p_func->name)+"'.",p_node);
+		return ERR_BUG;
+	}
+
 	return OK;
 }
 
@@ -1528,6 +2731,7 @@ Error GDCompiler::_parse_class(GDScript *p_script,GDScript *p_owner,const GDPars
 		minfo.index = p_script->member_indices.size();
 		minfo.setter = p_class->variables[i].setter;
 		minfo.getter = p_class->variables[i].getter;		
+		minfo.data_type = _resolve_type(p_class->variables[i].datatype);
 		p_script->member_indices[name]=minfo;
 		p_script->members.insert(name);
 
@@ -1647,13 +2851,20 @@ Error GDCompiler::compile(const GDParser *p_parser,GDScript *p_script) {
 
 	source=p_script->get_path();
 
+	//members and functions are about to be rebuilt
+	GDFunction::invalidate_caches();
 
+	code_size_before=0;
+	code_size_after=0;
 
 	Error err = _parse_class(p_script,NULL,static_cast<const GDParser::ClassNode*>(root));
 
 	if (err)
 		return err;
 
+	if (OS::get_singleton()->is_stdout_verbose())
+		print_line("GDScript: optimized bytecode of "+source+": "+itos(code_size_before)+" -> "+itos(code_size_after)+" words.");
+
 	return OK;
 
 }
@@ -1673,6 +2884,8 @@ int GDCompiler::get_error_column() const{
 
 GDCompiler::GDCompiler()
 {
+	code_size_before=0;
+	code_size_after=0;
 }
 
 
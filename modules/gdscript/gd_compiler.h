@@ -31,9 +31,11 @@
 
 #include "gd_parser.h"
 #include "gd_script.h"
+#include "oa_hash_map.h"
 
 
 class GDCompiler {
+friend class GDCompiledScript;
 
 	const GDParser *parser;
 	struct CodeGen {
@@ -44,13 +46,19 @@ class GDCompiler {
 
 	        List< Map<StringName,int> > stack_id_stack;
 			Map<StringName,int> stack_identifiers;
+	        List< Map<StringName,GDDataType> > stack_type_stack;
+	        Map<StringName,GDDataType> stack_identifier_types;
 	
 	        List<GDFunction::StackDebug> stack_debug;
 	        List< Map<StringName,int> > block_identifier_stack;
 	        Map<StringName,int> block_identifiers;
 
-	        void add_stack_identifier(const StringName& p_id,int p_stackpos) {
+	        void add_stack_identifier(const StringName& p_id,int p_stackpos,const GDDataType& p_type=GDDataType()) {
 	            stack_identifiers[p_id]=p_stackpos;
+	            if (p_type.has_type())
+	                stack_identifier_types[p_id]=p_type;
+	            else
+	                stack_identifier_types.erase(p_id);
 	            if (debug_stack) {
 	                block_identifiers[p_id]=p_stackpos;
 	                GDFunction::StackDebug sd;
@@ -64,6 +72,7 @@ class GDCompiler {
 
 	        void push_stack_identifiers() {
 	            stack_id_stack.push_back( stack_identifiers );
+	            stack_type_stack.push_back( stack_identifier_types );
 	            if (debug_stack) {
 	
 	                block_identifier_stack.push_back(block_identifiers);
@@ -74,6 +83,8 @@ class GDCompiler {
 	        void pop_stack_identifiers() {
 	            stack_identifiers = stack_id_stack.back()->get();
 	            stack_id_stack.pop_back();
+	            stack_identifier_types = stack_type_stack.back()->get();
+	            stack_type_stack.pop_back();
 	
 	            if (debug_stack) {
 	                for (Map<StringName,int>::Element *E=block_identifiers.front();E;E=E->next()) {
@@ -92,7 +103,7 @@ class GDCompiler {
 
 
 		//int get_identifier_pos(const StringName& p_dentifier) const;
-		HashMap<Variant,int,VariantHasher> constant_map;
+		OAHashMap<Variant,int,VariantHasher> constant_map;
 		Map<StringName,int> name_map;
 
 		int get_name_map_pos(const StringName& p_identifier) {
@@ -114,6 +125,36 @@ class GDCompiler {
 			return pos;
 		}
 
+		Vector<GDFunction::OperatorFunc> operator_funcs;
+		Vector<MethodBind*> methods;
+
+		int get_operator_func_pos(Variant::Operator p_op,Variant::Type p_type_a,Variant::Type p_type_b,Variant::OperatorEvaluator p_func) {
+			for(int i=0;i<operator_funcs.size();i++) {
+				const GDFunction::OperatorFunc &of=operator_funcs[i];
+				if (of.op==p_op && of.type_a==p_type_a && of.type_b==p_type_b)
+					return i;
+			}
+			GDFunction::OperatorFunc of;
+			of.func=p_func;
+			of.op=p_op;
+			of.type_a=p_type_a;
+			of.type_b=p_type_b;
+			operator_funcs.push_back(of);
+			return operator_funcs.size()-1;
+		}
+
+		int get_method_pos(MethodBind *p_method) {
+			int pos = methods.find(p_method);
+			if (pos==-1) {
+				pos=methods.size();
+				methods.push_back(p_method);
+			}
+			return pos;
+		}
+
+		int cache_count;
+		int alloc_cache() { return cache_count++; } //one inline cache per named get/set and call
+
 		Vector<int> opcodes;
 		void alloc_stack(int p_level) { if (p_level >= stack_max) stack_max=p_level+1; }
 		void alloc_call(int p_params) { if (p_params >= call_max) call_max=p_params; }
@@ -121,6 +162,8 @@ class GDCompiler {
         	int current_line;
 		int stack_max;
 		int call_max;
+		int for_depth; //for loops around the code being generated
+		int for_depth_max; //each nesting level gets its own iterator lock
 	};
 
 #if 0
@@ -134,21 +177,54 @@ class GDCompiler {
 	Ref<GDScript> _parse_class(GDParser::ClassNode *p_class);
 #endif
 
+	/* Operand layout of one instruction, shared by the optimizer and the verifier. */
+	struct Instruction {
+
+		int len;
+		int fixed_addr[3]; //operands that are addresses
+		int fixed_count;
+		int range_from; //variable amount of consecutive address operands
+		int range_count;
+		int dst_ofs; //address operand the result is written to
+		int name_ofs; //operand that is an index to global names
+		int jump_ofs; //operand that is a jump target
+		int cache_ofs; //operand that is an inline cache index
+		int operator_func_ofs; //operand that is an index to operator functions
+		int method_ofs; //operand that is an index to method binds
+		int iterator_lock_ofs; //operand that is an index to iterator locks
+		int call_argc; //arguments placed in the call buffer
+	};
+
 	void _set_error(const String& p_error,const GDParser::Node *p_node);
 
+	bool _get_constant_value(CodeGen& codegen,const GDParser::Node *p_expression,Variant& r_value,bool p_initializer=false);
+
+	static GDDataType _resolve_type(const GDParser::DataType& p_type);
+	GDDataType _get_identifier_type(CodeGen& codegen,const StringName& p_identifier,bool p_initializer=false);
+	GDDataType _get_operator_type(Variant::Operator p_op,const GDDataType& p_a,const GDDataType& p_b);
+	GDDataType _get_expression_type(CodeGen& codegen,const GDParser::Node *p_expression,bool p_initializer=false);
+	bool _needs_typed_assign(const GDDataType& p_dst,const GDDataType& p_src,const GDParser::Node *p_node);
+	void _write_typed_assign(CodeGen& codegen,const GDDataType& p_type,int p_dst,int p_src);
+
 	bool _create_unary_operator(CodeGen& codegen,const GDParser::OperatorNode *on,Variant::Operator op, int p_stack_level);
 	bool _create_binary_operator(CodeGen& codegen,const GDParser::OperatorNode *on,Variant::Operator op, int p_stack_level,bool p_initializer=false);
 
 	//int _parse_subexpression(CodeGen& codegen,const GDParser::BlockNode *p_block,const GDParser::Node *p_expression);
-	int _parse_assign_right_expression(CodeGen& codegen,const GDParser::OperatorNode *p_expression, int p_stack_level);
+	int _parse_assign_right_expression(CodeGen& codegen,const GDParser::OperatorNode *p_expression, int p_stack_level, GDDataType *r_type=NULL);
 	int _parse_expression(CodeGen& codegen,const GDParser::Node *p_expression, int p_stack_level,bool p_root=false,bool p_initializer=false);
 	Error _parse_block(CodeGen& codegen,const GDParser::BlockNode *p_block,int p_stack_level=0,int p_break_addr=-1,int p_continue_addr=-1);
 	Error _parse_function(GDScript *p_script,const GDParser::ClassNode *p_class,const GDParser::FunctionNode *p_func);
+	static bool _decode_instruction(const int *p_code,int p_code_size,int p_ip,Instruction& r_instr,String& r_error);
+	void _optimize_function(CodeGen& codegen,Vector<int>& r_defarg_addr);
+	static bool _verify_address(const GDFunction *p_func,int p_address);
+	Error _verify_function(const GDFunction *p_func,const GDParser::Node *p_node);
 	Error _parse_class(GDScript *p_script,GDScript *p_owner,const GDParser::ClassNode *p_class);
 	int err_line;
 	int err_column;
 	StringName source;
 	String error;
+	int code_size_before; //bytecode words before and after optimizing, for the verbose report
+	int code_size_after;
 
 public:
 
@@ -158,6 +234,9 @@ public:
 	int get_error_line() const;
 	int get_error_column() const;
 
+	int get_code_size_before() const { return code_size_before; }
+	int get_code_size_after() const { return code_size_after; }
+
 	GDCompiler();
 };
 
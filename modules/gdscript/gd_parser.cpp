@@ -1489,6 +1489,13 @@ void GDParser::_parse_block(BlockNode *p_block,bool p_static) {
 				lv->name=n;
 				p_block->statements.push_back(lv);
 
+				if (tokenizer->get_token()==GDTokenizer::TK_COLON) {
+
+					tokenizer->advance();
+					if (!_parse_type(lv->datatype))
+						return;
+				}
+
 				Node *assigned=NULL;
 
 				if (tokenizer->get_token()==GDTokenizer::TK_OP_ASSIGN) {
@@ -1504,9 +1511,7 @@ void GDParser::_parse_block(BlockNode *p_block,bool p_static) {
 					assigned=subexpr;
 				} else {
 
-					ConstantNode *c = alloc_node<ConstantNode>();
-					c->value=Variant();
-					assigned = c;
+					assigned = _make_default_value(lv->datatype);
 
 				}
 				IdentifierNode *id = alloc_node<IdentifierNode>();
@@ -1853,6 +1858,52 @@ bool GDParser::_parse_newline() {
 }
 
 
+bool GDParser::_parse_type(DataType& r_type) {
+
+	//optional type hint, either a built-in type or an engine class
+
+	if (tokenizer->get_token()==GDTokenizer::TK_BUILT_IN_TYPE) {
+
+		Variant::Type type = tokenizer->get_token_type();
+		if (type==Variant::OBJECT) {
+			r_type.kind=DataType::NATIVE;
+			r_type.native_type="Object";
+		} else {
+			r_type.kind=DataType::BUILTIN;
+			r_type.builtin_type=type;
+		}
+
+	} else if (tokenizer->get_token()==GDTokenizer::TK_IDENTIFIER) {
+
+		StringName identifier = tokenizer->get_token_identifier();
+		if (!ObjectTypeDB::type_exists(identifier)) {
+			_set_error("Unknown type: '"+String(identifier)+"'.");
+			return false;
+		}
+		r_type.kind=DataType::NATIVE;
+		r_type.native_type=identifier;
+
+	} else {
+
+		_set_error("Expected a built-in type or class name.");
+		return false;
+	}
+
+	tokenizer->advance();
+	return true;
+}
+
+GDParser::Node* GDParser::_make_default_value(const DataType& p_type) {
+
+	//typed variables start with the default value of their type, not null
+	ConstantNode *c = alloc_node<ConstantNode>();
+	if (p_type.kind==DataType::BUILTIN) {
+		Variant::CallError ce;
+		c->value=Variant::construct(p_type.builtin_type,NULL,0,ce);
+	}
+	return c;
+}
+
 void GDParser::_parse_extends(ClassNode *p_class) {
 
 
@@ -2062,7 +2113,9 @@ void GDParser::_parse_class(ClassNode *p_class) {
 				tokenizer->advance();
 
 				Vector<StringName> arguments;
+				Vector<DataType> argument_types;
 				Vector<Node*> default_values;
+				DataType return_type;
 
 				int fnline = tokenizer->get_token_line();
 
@@ -2089,6 +2142,15 @@ void GDParser::_parse_class(ClassNode *p_class) {
 
 						tokenizer->advance();
 
+						DataType argtype;
+						if (tokenizer->get_token()==GDTokenizer::TK_COLON) {
+
+							tokenizer->advance();
+							if (!_parse_type(argtype))
+								return;
+						}
+						argument_types.push_back(argtype);
+
 						if (defaulting && tokenizer->get_token()!=GDTokenizer::TK_OP_ASSIGN) {
 
 							_set_error("Default parameter expected.");
@@ -2198,6 +2260,13 @@ void GDParser::_parse_class(ClassNode *p_class) {
 					}
 				}
 
+				if (tokenizer->get_token()==GDTokenizer::TK_FORWARD_ARROW) {
+
+					tokenizer->advance();
+					if (!_parse_type(return_type))
+						return;
+				}
+
 				if (!_enter_indent_block(block)) {
 
 					_set_error("Indented block expected.");
@@ -2207,6 +2276,8 @@ void GDParser::_parse_class(ClassNode *p_class) {
 				FunctionNode *function = alloc_node<FunctionNode>();
 				function->name=name;
 				function->arguments=arguments;
+				function->argument_types=argument_types;
+				function->return_type=return_type;
 				function->default_values=default_values;
 				function->_static=_static;
 				function->line=fnline;
@@ -2533,6 +2604,31 @@ void GDParser::_parse_class(ClassNode *p_class) {
 				member.line=tokenizer->get_token_line();
 				tokenizer->advance();
 
+				if (tokenizer->get_token()==GDTokenizer::TK_COLON) {
+
+					tokenizer->advance();
+					if (!_parse_type(member.datatype))
+						return;
+
+					if (autoexport) {
+						//the type hint is enough to infer the export type
+						if (member.datatype.kind==DataType::BUILTIN) {
+
+							member._export.type=member.datatype.builtin_type;
+
+						} else if (ObjectTypeDB::is_type(member.datatype.native_type,"Resource")) {
+
+							member._export.type=Variant::OBJECT;
+							member._export.hint=PROPERTY_HINT_RESOURCE_TYPE;
+							member._export.hint_string=member.datatype.native_type;
+						} else {
+
+							_set_error("Only built-in types and resources can be exported.");
+							return;
+						}
+					}
+				}
+
 				if (tokenizer->get_token()==GDTokenizer::TK_OP_ASSIGN) {
 
 #ifdef DEBUG_ENABLED
@@ -2548,7 +2644,7 @@ void GDParser::_parse_class(ClassNode *p_class) {
 
 					member.expression=subexpr;
 
-					if (autoexport) {
+					if (autoexport && !member.datatype.has_type()) {
 						if (subexpr->type==Node::TYPE_ARRAY) {
 
 							member._export.type=Variant::ARRAY;
@@ -2603,12 +2699,19 @@ void GDParser::_parse_class(ClassNode *p_class) {
 
 				} else {
 
-					if (autoexport) {
+					if (autoexport && !member.datatype.has_type()) {
 
 						_set_error("Type-less export needs a constant expression assigned to infer type.");
 						return;
 					}
+#ifdef TOOLS_ENABLED
+					//typed members are created with the default value of their type
+					if (member.datatype.kind==DataType::BUILTIN && member._export.type!=Variant::NIL) {
 
+						Variant::CallError ce;
+						member.default_value=Variant::construct(member.datatype.builtin_type,NULL,0,ce);
+					}
+#endif
 				}
 
 				if (tokenizer->get_token()==GDTokenizer::TK_PR_SETGET) {
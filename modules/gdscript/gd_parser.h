@@ -65,6 +65,22 @@ public:
 		virtual ~Node() {}
 	};
 
+	struct DataType {
+
+		enum Kind {
+			UNTYPED,
+			BUILTIN,
+			NATIVE
+		};
+
+		Kind kind;
+		Variant::Type builtin_type;
+		StringName native_type;
+
+		bool has_type() const { return kind!=UNTYPED; }
+		DataType() { kind=UNTYPED; builtin_type=Variant::NIL; }
+	};
+
 	struct FunctionNode;
 	struct BlockNode;
 
@@ -86,6 +102,7 @@ public:
 			StringName getter;
 			int line;
 			Node *expression;
+			DataType datatype;
 		};
 		struct Constant {
 			StringName identifier;
@@ -112,7 +129,9 @@ public:
 		bool _static;
 		StringName name;
 		Vector<StringName> arguments;
+		Vector<DataType> argument_types;
 		Vector<Node*> default_values;
+		DataType return_type;
 		BlockNode *body;
 
 		FunctionNode() { type=TYPE_FUNCTION; _static=false; }
@@ -154,6 +173,7 @@ public:
 
 		StringName name;
 		Node *assign;
+		DataType datatype;
 		LocalVarNode() { type=TYPE_LOCAL_VAR;  assign=NULL;}
 	};
 
@@ -417,6 +437,8 @@ private:
 	void _set_error(const String& p_error, int p_line=-1, int p_column=-1);
 
 
+	bool _parse_type(DataType& r_type);
+	Node* _make_default_value(const DataType& p_type);
 	bool _parse_arguments(Node* p_parent, Vector<Node*>& p_args, bool p_static, bool p_can_codecomplete=false);
 	bool _enter_indent_block(BlockNode *p_block=NULL);
 	bool _parse_newline();
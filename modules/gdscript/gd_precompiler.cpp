@@ -0,0 +1,424 @@
+/*************************************************************************/
+/*  gd_precompiler.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "gd_precompiler.h"
+#include "gd_tokenizer.h"
+#include "gd_compiled_script.h"
+#include "globals.h"
+#include "path_remap.h"
+#include "io/resource_loader.h"
+#include "os/file_access.h"
+#include "os/dir_access.h"
+#include "os/os.h"
+
+void GDPrecompiler::_scan(Entry& e) {
+
+	Error err;
+	FileAccess *f=FileAccess::open(e.path,FileAccess::READ,&err);
+	if (!f) {
+		e.error=ERR_CANT_OPEN;
+		return;
+	}
+
+	int len = f->get_len();
+	Vector<uint8_t> sourcef;
+	sourcef.resize(len+1);
+	int r = f->get_buffer(sourcef.ptr(),len);
+	f->close();
+	memdelete(f);
+	sourcef[len]=0;
+
+	if (r!=len || e.source.parse_utf8((const char*)sourcef.ptr())) {
+		e.error=ERR_INVALID_DATA;
+		return;
+	}
+
+	e.source_hash=e.source.md5_text();
+
+	//only extends and preload matter for ordering, a token scan finds them without parsing
+	String base_dir=e.path.get_base_dir();
+
+	GDTokenizerText tokenizer;
+	tokenizer.set_code(e.source);
+
+	while(tokenizer.get_token()!=GDTokenizer::TK_EOF && tokenizer.get_token()!=GDTokenizer::TK_ERROR) {
+
+		if (tokenizer.get_token()==GDTokenizer::TK_PR_EXTENDS && tokenizer.get_token(1)==GDTokenizer::TK_CONSTANT && tokenizer.get_token_constant(1).get_type()==Variant::STRING) {
+
+			//same resolution as GDCompiler
+			String path = tokenizer.get_token_constant(1);
+			if (path.is_rel_path())
+				path=base_dir.plus_file(path);
+			e.dependencies.push_back(path.simplify_path());
+
+		} else if (tokenizer.get_token()==GDTokenizer::TK_PR_PRELOAD && tokenizer.get_token(1)==GDTokenizer::TK_PARENTHESIS_OPEN && tokenizer.get_token(2)==GDTokenizer::TK_CONSTANT && tokenizer.get_token_constant(2).get_type()==Variant::STRING) {
+
+			//same resolution as GDParser
+			String path = tokenizer.get_token_constant(2);
+			if (!path.is_abs_path() && base_dir!="")
+				path=base_dir+"/"+path;
+			e.dependencies.push_back(path.replace("///","//").simplify_path());
+		}
+
+		tokenizer.advance();
+	}
+}
+
+void GDPrecompiler::_compile(Entry& e) {
+
+	GDScript *script=e.script.ptr();
+
+	String cache_file;
+	if (e.key!="") {
+
+		cache_file=cache_dir.plus_file(e.key+".gdc");
+		FileAccess *f=FileAccess::open(cache_file,FileAccess::READ);
+		if (f) {
+
+			Vector<uint8_t> image;
+			image.resize(f->get_len());
+			int r = f->get_buffer(image.ptr(),image.size());
+			memdelete(f);
+
+			if (r==image.size() && GDCompiledScript::is_compiled_script(image) && GDCompiledScript::load(image,script)==OK) {
+
+				script->valid=true;
+				for(Map<StringName,Ref<GDScript> >::Element *E=script->subclasses.front();E;E=E->next()) {
+
+					script->_set_subclass_path(E->get(),script->path);
+				}
+				e.from_cache=true;
+				return;
+			}
+		}
+	}
+
+	e.error=script->_reload(e.error_text,e.error_line);
+
+	if (e.error==OK && cache_file!="") {
+
+		Vector<uint8_t> image = GDCompiledScript::save(e.script,Vector<uint8_t>());
+		if (!image.empty()) {
+
+			FileAccess *f=FileAccess::open(cache_file,FileAccess::WRITE);
+			if (f) {
+				f->store_buffer(image.ptr(),image.size());
+				memdelete(f);
+			}
+		}
+	}
+}
+
+int GDPrecompiler::_get_level(int p_idx,Vector<int>& r_state) {
+
+	//state is 0 when not visited, 1 while visiting and 2 once the level is known
+	if (r_state[p_idx]==2)
+		return entries[p_idx].level;
+	if (r_state[p_idx]==1)
+		return -1; //cyclic
+
+	r_state[p_idx]=1;
+
+	int level=0;
+	for(int i=0;i<entries[p_idx].scripts.size();i++) {
+
+		int l=_get_level(entries[p_idx].scripts[i],r_state);
+		if (l<0) {
+			level=-1;
+			break;
+		}
+		level=MAX(level,l+1);
+	}
+
+	r_state[p_idx]=2;
+	entries[p_idx].level=level;
+	return level;
+}
+
+void GDPrecompiler::_thread_func(void *p_ud) {
+
+	GDPrecompiler *pc=(GDPrecompiler*)p_ud;
+
+	while(true) {
+
+		int idx=-1;
+		if (pc->job_lock)
+			pc->job_lock->lock();
+		if (pc->next_job<pc->jobs.size())
+			idx=pc->jobs[pc->next_job++];
+		if (pc->job_lock)
+			pc->job_lock->unlock();
+
+		if (idx<0)
+			break;
+
+		if (pc->stage==STAGE_SCAN)
+			pc->_scan(pc->entries[idx]);
+		else
+			pc->_compile(pc->entries[idx]);
+	}
+}
+
+void GDPrecompiler::_run_jobs() {
+
+	next_job=0;
+
+	//the calling thread takes jobs too
+	Vector<Thread*> threads;
+	int count=MIN(thread_count,jobs.size())-1;
+	for(int i=0;i<count && job_lock;i++) {
+
+		Thread *t=Thread::create(_thread_func,this);
+		if (!t)
+			break;
+		threads.push_back(t);
+	}
+
+	_thread_func(this);
+
+	for(int i=0;i<threads.size();i++) {
+
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+}
+
+void GDPrecompiler::find_scripts(const String& p_dir,List<String> *r_paths) {
+
+	DirAccess *da=DirAccess::open(p_dir);
+	ERR_FAIL_COND(!da);
+
+	List<String> dirs;
+
+	da->list_dir_begin();
+	String f;
+	while((f=da->get_next())!="") {
+
+		if (da->current_is_dir()) {
+			if (!f.begins_with("."))
+				dirs.push_back(f);
+		} else if (f.extension()=="gd") {
+			r_paths->push_back(p_dir.plus_file(f));
+		}
+	}
+	da->list_dir_end();
+	memdelete(da);
+
+	for(List<String>::Element *E=dirs.front();E;E=E->next()) {
+
+		find_scripts(p_dir.plus_file(E->get()),r_paths);
+	}
+}
+
+void GDPrecompiler::set_cache_dir(const String& p_dir) {
+
+	cache_dir=p_dir;
+}
+
+void GDPrecompiler::set_thread_count(int p_count) {
+
+	thread_count=MAX(1,p_count);
+}
+
+Error GDPrecompiler::precompile(const List<String>& p_paths,List<Ref<GDScript> > *r_scripts) {
+
+	entries.clear();
+
+	Map<String,int> index;
+	for(const List<String>::Element *E=p_paths.front();E;E=E->next()) {
+
+		String path = Globals::get_singleton()->localize_path(E->get()).simplify_path();
+		if (index.has(path))
+			continue;
+		if (PathRemap::get_singleton()->has_remap(path))
+			continue; //exported, it's compiled already
+
+		Entry e;
+		e.path=path;
+		e.level=-1;
+		e.error=OK;
+		e.error_line=0;
+		e.from_cache=false;
+		index[path]=entries.size();
+		entries.push_back(e);
+	}
+
+	if (entries.empty())
+		return OK;
+
+	if (cache_dir!="") {
+
+		DirAccess *da=DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+		if (da->make_dir_recursive(cache_dir)!=OK)
+			cache_dir="";
+		memdelete(da);
+	}
+
+	uint64_t time=OS::get_singleton()->get_ticks_msec();
+
+	/* STEP 1, READ SOURCES AND FIND DEPENDENCIES */
+
+	stage=STAGE_SCAN;
+	jobs.resize(entries.size());
+	for(int i=0;i<entries.size();i++)
+		jobs[i]=i;
+	_run_jobs();
+
+	for(int i=0;i<entries.size();i++) {
+
+		Entry &e=entries[i];
+		for(int j=0;j<e.dependencies.size();j++) {
+
+			const Map<String,int>::Element *E=index.find(e.dependencies[j]);
+			if (E && entries[E->get()].error==OK) {
+				if (E->get()!=i)
+					e.scripts.push_back(E->get());
+			} else {
+				//outside the batch, or unreadable (the loader reports it)
+				e.resources.push_back(e.dependencies[j]);
+			}
+		}
+	}
+
+	/* STEP 2, COMPILE LEVEL BY LEVEL */
+
+	Vector<int> state;
+	state.resize(entries.size());
+	for(int i=0;i<entries.size();i++)
+		state[i]=0;
+
+	int max_level=-1;
+	for(int i=0;i<entries.size();i++) {
+
+		if (entries[i].error==OK)
+			max_level=MAX(max_level,_get_level(i,state));
+	}
+
+	List<RES> resources; //keeps preloaded resources in the cache until done
+	int cached=0;
+	int compiled=0;
+
+	stage=STAGE_COMPILE;
+
+	for(int l=0;l<=max_level;l++) {
+
+		jobs.clear();
+
+		for(int i=0;i<entries.size();i++) {
+
+			Entry &e=entries[i];
+			if (e.error!=OK || e.level!=l)
+				continue;
+
+			//the threads must only find things in the cache
+			for(int j=0;j<e.resources.size();j++) {
+
+				RES res = ResourceLoader::load(e.resources[j]);
+				if (res.is_valid())
+					resources.push_back(res);
+			}
+
+			if (cache_dir!="") {
+
+				String key=e.source_hash;
+				for(int j=0;j<e.scripts.size() && key!="";j++) {
+					if (entries[e.scripts[j]].key=="")
+						key="";
+					else
+						key+=entries[e.scripts[j]].key;
+				}
+				for(int j=0;j<e.resources.size() && key!="";j++) {
+					if (e.resources[j].extension()=="gd")
+						key=""; //compiled against a script the cache knows nothing about
+				}
+				e.key=key!="" ? key.md5_text() : String();
+			}
+
+			if (ResourceCache::has(e.path)) {
+
+				//loaded already, keep using it
+				e.script=Ref<GDScript>(ResourceCache::get(e.path)->cast_to<GDScript>());
+				continue;
+			}
+
+			e.script = Ref<GDScript>( memnew( GDScript ) );
+			e.script->set_source_code(e.source);
+			e.script->set_script_path(e.path);
+			e.script->set_path(e.path);
+
+			jobs.push_back(i);
+		}
+
+		_run_jobs();
+
+		for(int i=0;i<jobs.size();i++) {
+
+			Entry &e=entries[jobs[i]];
+			if (e.error!=OK) {
+				e.script->_report_error(e.error,e.error_text,e.error_line);
+			} else if (e.from_cache) {
+				cached++;
+			} else {
+				compiled++;
+			}
+		}
+	}
+
+	/* STEP 3, LOAD WHAT COULD NOT BE ORDERED */
+
+	for(int i=0;i<entries.size();i++) {
+
+		Entry &e=entries[i];
+		if (e.script.is_null())
+			e.script=ResourceLoader::load(e.path);
+		if (e.script.is_valid() && r_scripts)
+			r_scripts->push_back(e.script);
+	}
+
+	if (OS::get_singleton()->is_stdout_verbose())
+		print_line("precompiled "+itos(entries.size())+" scripts ("+itos(compiled)+" compiled, "+itos(cached)+" from cache) in "+itos(OS::get_singleton()->get_ticks_msec()-time)+" msec");
+
+	entries.clear();
+	jobs.clear();
+
+	return OK;
+}
+
+GDPrecompiler::GDPrecompiler() {
+
+	thread_count=MAX(1,OS::get_singleton()->get_processor_count());
+	stage=STAGE_SCAN;
+	next_job=0;
+	job_lock=Mutex::create();
+}
+
+GDPrecompiler::~GDPrecompiler() {
+
+	if (job_lock)
+		memdelete(job_lock);
+}
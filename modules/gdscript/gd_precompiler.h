@@ -0,0 +1,98 @@
+/*************************************************************************/
+/*  gd_precompiler.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef GD_PRECOMPILER_H
+#define GD_PRECOMPILER_H
+
+#include "gd_script.h"
+#include "os/thread.h"
+#include "os/mutex.h"
+
+/* Loads a batch of scripts ahead of time, parsing and compiling them on
+   several threads. A script is compiled once everything it extends or
+   preloads is loaded, so the loader only ever hits the resource cache
+   from the threads. Scripts that can't be ordered this way (cyclic
+   preloads) are loaded afterwards as usual.
+
+   With a cache directory, compiled scripts are stored by a hash of their
+   source and of the scripts they depend on, unchanged scripts are then
+   only deserialized the next time. */
+
+class GDPrecompiler {
+
+	struct Entry {
+
+		String path;
+		String source;
+		String source_hash;
+		String key; ///< source hash combined with the keys of dependencies, empty if not cacheable
+		Vector<String> dependencies; ///< extended or preloaded paths
+		Vector<int> scripts; ///< dependencies within the batch
+		Vector<String> resources; ///< dependencies loaded the regular way first
+		int level;
+		Ref<GDScript> script;
+		Error error;
+		String error_text;
+		int error_line;
+		bool from_cache;
+	};
+
+	enum Stage {
+		STAGE_SCAN,
+		STAGE_COMPILE
+	};
+
+	Vector<Entry> entries;
+	String cache_dir;
+	int thread_count;
+
+	Stage stage;
+	Vector<int> jobs;
+	int next_job;
+	Mutex *job_lock;
+
+	void _scan(Entry& e);
+	void _compile(Entry& e);
+	int _get_level(int p_idx,Vector<int>& r_state);
+	void _run_jobs();
+	static void _thread_func(void *p_ud);
+
+public:
+
+	static void find_scripts(const String& p_dir,List<String> *r_paths);
+
+	void set_cache_dir(const String& p_dir); ///< empty disables the cache
+	void set_thread_count(int p_count);
+
+	Error precompile(const List<String>& p_paths,List<Ref<GDScript> > *r_scripts);
+
+	GDPrecompiler();
+	~GDPrecompiler();
+};
+
+#endif // GD_PRECOMPILER_H
@@ -27,11 +27,22 @@
 /* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
 /*************************************************************************/
 #include "gd_script.h"
+#include "gd_worker.h"
 #include "globals.h"
 #include "global_constants.h"
 #include "gd_compiler.h"
+#include "gd_compiled_script.h"
+#include "gd_precompiler.h"
 #include "os/file_access.h"
+#include "os/os.h"
 #include "io/file_access_encrypted.h"
+#include "core_string_names.h"
+
+/* GCC and Clang can dispatch bytecode with computed goto (labels as values),
+   other compilers use the switch */
+#if defined(__GNUC__) && !defined(GDSCRIPT_NO_COMPUTED_GOTO)
+#define GDSCRIPT_COMPUTED_GOTO
+#endif
 
 /* TODO:
 
@@ -46,6 +57,66 @@
  */
 
 
+bool GDDataType::is_type(const Variant& p_variant) const {
+
+	switch(kind) {
+
+		case UNTYPED: {
+
+			return true;
+		} break;
+		case BUILTIN: {
+
+			return p_variant.get_type()==builtin_type;
+		} break;
+		case NATIVE: {
+
+			if (p_variant.get_type()==Variant::NIL)
+				return true;
+			if (p_variant.get_type()!=Variant::OBJECT)
+				return false;
+			Object *obj = p_variant;
+			return !obj || obj->is_type(native_type);
+		} break;
+	}
+
+	return false;
+}
+
+bool GDDataType::convert(const Variant& p_value,Variant& r_ret) const {
+
+	if (kind==BUILTIN && p_value.get_type()!=builtin_type) {
+
+		if (builtin_type==Variant::REAL && p_value.get_type()==Variant::INT) {
+			r_ret=p_value.operator double();
+			return true;
+		}
+		if (builtin_type==Variant::INT && p_value.get_type()==Variant::REAL) {
+			r_ret=p_value.operator int();
+			return true;
+		}
+		return false;
+	}
+
+	if (!is_type(p_value))
+		return false;
+
+	r_ret=p_value;
+	return true;
+}
+
+String GDDataType::get_name() const {
+
+	switch(kind) {
+
+		case UNTYPED: return "Variant";
+		case BUILTIN: return Variant::get_type_name(builtin_type);
+		case NATIVE: return native_type;
+	}
+
+	return String();
+}
+
 
 Variant *GDFunction::_get_variant(int p_address,GDInstance *p_instance,GDScript *p_script,Variant &self, Variant *p_stack,String& r_error) const{
 
@@ -183,6 +254,167 @@ static String _get_var_type(const Variant* p_type) {
 
 }
 
+/* Inline caches. Scripted objects are keyed by their GDScript, plain engine
+   objects by their type name. Entries from before a script was recompiled or
+   freed are dropped through the global epoch. */
+
+SafeRefCount GDFunction::cache_epoch;
+
+static _FORCE_INLINE_ Object *_get_cacheable_object(const Variant *p_base,GDInstance *&r_instance) {
+
+	if (p_base->get_type()!=Variant::OBJECT)
+		return NULL;
+
+	Object *obj = *p_base;
+	if (!obj)
+		return NULL;
+#ifdef DEBUG_ENABLED
+	//same check Variant does before touching the object, the slow path reports the error
+	if (ScriptDebugger::get_singleton() && !p_base->is_ref() && !ObjectDB::instance_validate(obj))
+		return NULL;
+#endif
+
+	ScriptInstance *si = obj->get_script_instance();
+	if (!si) {
+		r_instance=NULL;
+	} else if (si->get_language()==GDScriptLanguage::get_singleton()) {
+		r_instance=static_cast<GDInstance*>(si);
+	} else {
+		return NULL;
+	}
+
+	return obj;
+}
+
+bool GDFunction::_cache_lookup(const InlineCache& p_cache,Object *p_object,GDInstance *p_instance,const void *&r_target) const {
+
+	if (p_cache.epoch!=uint32_t(cache_epoch.get()))
+		return false;
+
+	if (p_instance) {
+
+		const GDScript *script=p_instance->script.ptr();
+		for(int i=0;i<InlineCache::MAX_ENTRIES;i++) {
+
+			if (p_cache.entries[i].script==script) {
+				r_target=p_cache.entries[i].target;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	StringName type = p_object->get_type_name();
+	for(int i=0;i<InlineCache::MAX_ENTRIES;i++) {
+
+		if (!p_cache.entries[i].script && p_cache.entries[i].type==type) {
+			r_target=p_cache.entries[i].target;
+			return true;
+		}
+	}
+	return false;
+}
+
+void GDFunction::_cache_store(InlineCache& p_cache,Object *p_object,GDInstance *p_instance,const void *p_target) {
+
+	uint32_t epoch=cache_epoch.get();
+	if (p_cache.epoch!=epoch) {
+
+		for(int i=0;i<InlineCache::MAX_ENTRIES;i++) {
+			p_cache.entries[i].script=NULL;
+			p_cache.entries[i].type=StringName();
+			p_cache.entries[i].target=NULL;
+		}
+		p_cache.next=0;
+		p_cache.epoch=epoch;
+	}
+
+	InlineCache::Entry &e = p_cache.entries[p_cache.next];
+	p_cache.next=(p_cache.next+1)%InlineCache::MAX_ENTRIES;
+
+	if (p_instance) {
+		e.script=p_instance->script.ptr();
+		e.type=StringName();
+	} else {
+		e.script=NULL;
+		e.type=p_object->get_type_name();
+	}
+	e.target=p_target;
+}
+
+template<class T>
+void GDFunction::IteratorLock::_lock(const DVector<T>& p_array) {
+
+	typedef typename DVector<T>::Read Read;
+	Read *r = memnew_placement(read,Read(p_array.read()));
+	ptr=r->ptr();
+	size=p_array.size();
+}
+
+template<class T>
+void GDFunction::IteratorLock::_unlock() {
+
+	typedef typename DVector<T>::Read Read;
+	reinterpret_cast<Read*>(read)->~Read();
+}
+
+bool GDFunction::IteratorLock::lock(const Variant& p_array) {
+
+	unlock();
+
+	switch(p_array.get_type()) {
+
+		case Variant::RAW_ARRAY: _lock<uint8_t>(p_array.operator DVector<uint8_t>()); break;
+		case Variant::INT_ARRAY: _lock<int>(p_array.operator DVector<int>()); break;
+		case Variant::REAL_ARRAY: _lock<real_t>(p_array.operator DVector<real_t>()); break;
+		case Variant::STRING_ARRAY: _lock<String>(p_array.operator DVector<String>()); break;
+		case Variant::VECTOR2_ARRAY: _lock<Vector2>(p_array.operator DVector<Vector2>()); break;
+		case Variant::VECTOR3_ARRAY: _lock<Vector3>(p_array.operator DVector<Vector3>()); break;
+		case Variant::COLOR_ARRAY: _lock<Color>(p_array.operator DVector<Color>()); break;
+		default: return false;
+	}
+
+	type=p_array.get_type();
+	array=p_array;
+	return true;
+}
+
+void GDFunction::IteratorLock::unlock() {
+
+	switch(type) {
+
+		case Variant::NIL: return;
+		case Variant::RAW_ARRAY: _unlock<uint8_t>(); break;
+		case Variant::INT_ARRAY: _unlock<int>(); break;
+		case Variant::REAL_ARRAY: _unlock<real_t>(); break;
+		case Variant::STRING_ARRAY: _unlock<String>(); break;
+		case Variant::VECTOR2_ARRAY: _unlock<Vector2>(); break;
+		case Variant::VECTOR3_ARRAY: _unlock<Vector3>(); break;
+		case Variant::COLOR_ARRAY: _unlock<Color>(); break;
+		default: {}
+	}
+
+	type=Variant::NIL;
+	array=Variant();
+	ptr=NULL;
+	size=0;
+}
+
+void GDFunction::IteratorLock::get(int p_idx,Variant& r_dst) const {
+
+	switch(type) {
+
+		case Variant::RAW_ARRAY: r_dst=static_cast<const uint8_t*>(ptr)[p_idx]; break;
+		case Variant::INT_ARRAY: r_dst=static_cast<const int*>(ptr)[p_idx]; break;
+		case Variant::REAL_ARRAY: r_dst=static_cast<const real_t*>(ptr)[p_idx]; break;
+		case Variant::STRING_ARRAY: r_dst=static_cast<const String*>(ptr)[p_idx]; break;
+		case Variant::VECTOR2_ARRAY: r_dst=static_cast<const Vector2*>(ptr)[p_idx]; break;
+		case Variant::VECTOR3_ARRAY: r_dst=static_cast<const Vector3*>(ptr)[p_idx]; break;
+		case Variant::COLOR_ARRAY: r_dst=static_cast<const Color*>(ptr)[p_idx]; break;
+		default: {}
+	}
+}
+
 Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_argcount, Variant::CallError& r_err, CallState *p_state) {
 
 
@@ -211,12 +443,12 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 	int line=_initial_line;
 
 	if (p_state) {
-		//use existing (supplied) state (yielded)
-		stack=(Variant*)p_state->stack.ptr();
+		//use existing (supplied) state (yielded), the frame stays where it is
+		stack=(Variant*)p_state->stack;
 		call_args=(Variant**)&p_state->stack[sizeof(Variant)*p_state->stack_size];
 		line=p_state->line;
 		ip=p_state->ip;
-		alloca_size=p_state->stack.size();
+		alloca_size=p_state->alloca_size;
 		_class=p_state->_class;
 		p_instance=p_state->instance;
 		defarg=p_state->defarg;
@@ -288,53 +520,175 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 		}
 	}
 
+	bool stack_moved=false; //yielded, the state owns the variants now
+
+	IteratorLock *iterator_locks=NULL;
+	if (_iterator_lock_count) {
+		//not part of the yield state, loops lock their arrays again after resuming
+		iterator_locks=(IteratorLock*)alloca(sizeof(IteratorLock)*_iterator_lock_count);
+		for(int i=0;i<_iterator_lock_count;i++)
+			memnew_placement(&iterator_locks[i],IteratorLock);
+	}
+
 	String err_text;
 
+	//workers may only touch the objects they were given, and leave the inline caches to the main thread
+	GDScriptWorker *worker=GDScriptWorker::get_current();
+	bool use_caches=Thread::get_caller_ID()==Thread::get_main_ID();
+
 #ifdef DEBUG_ENABLED
 
-    if (ScriptDebugger::get_singleton())
+    if (ScriptDebugger::get_singleton() && !worker)
         GDScriptLanguage::get_singleton()->enter_function(p_instance,this,stack,&ip,&line);
 
+	uint64_t function_start_time=0;
+	uint64_t function_call_time=0; //time spent in called script functions, to obtain self time
+	uint64_t *caller_call_time=NULL;
+	bool profiling = GDScriptLanguage::get_singleton()->profiling && Thread::get_main_ID()==Thread::get_caller_ID();
+
+	if (profiling) {
+		function_start_time=OS::get_singleton()->get_ticks_usec();
+		caller_call_time=GDScriptLanguage::get_singleton()->profile_call_time;
+		GDScriptLanguage::get_singleton()->profile_call_time=&function_call_time;
+	}
+
+#define GD_ERR_BREAK(m_cond) \
+	{ if ( m_cond ) {	\
+		_err_print_error(FUNCTION_STR,__FILE__,__LINE__,"Condition ' "_STR(m_cond)" ' is true. Breaking..:");	\
+		OPCODE_BREAK;\
+	} else _err_error_exists=false;}
+
 #define CHECK_SPACE(m_space)\
-	ERR_BREAK((ip+m_space)>_code_size)
+	GD_ERR_BREAK((ip+m_space)>_code_size)
 
 #define GET_VARIANT_PTR(m_v,m_code_ofs) \
 	Variant *m_v; \
 	m_v = _get_variant(_code_ptr[ip+m_code_ofs],p_instance,_class,self,stack,err_text);\
 	if (!m_v)\
-		break;
+		OPCODE_BREAK;
 
 
 #else
+/* code layout, operands and jump targets were checked by GDCompiler::_verify_function,
+   so release builds don't check them again on every instruction. Addresses can still
+   resolve to nothing at run time (self or members without an instance, missing class
+   constants), so operands are always checked. */
+#define GD_ERR_BREAK(m_cond)
 #define CHECK_SPACE(m_space)
 #define GET_VARIANT_PTR(m_v,m_code_ofs) \
 	Variant *m_v; \
-	m_v = _get_variant(_code_ptr[ip+m_code_ofs],p_instance,_class,self,stack,err_text);
+	m_v = _get_variant(_code_ptr[ip+m_code_ofs],p_instance,_class,self,stack,err_text);\
+	if (!m_v)\
+		OPCODE_BREAK;
 
 #endif
 
+#define CHECK_WORKER_ACCESS(m_v) \
+	if (worker && !worker->can_access(*m_v)) {\
+		err_text="Object was not given to this worker, or was freed.";\
+		OPCODE_BREAK;\
+	}
+
+#define CHECK_WORKER_ARGS(m_args,m_argc) \
+	if (worker) {\
+		int foreign=worker->find_foreign((const Variant**)m_args,m_argc);\
+		if (foreign>=0) {\
+			err_text="Object in argument "+itos(foreign+1)+" was not given to this worker, or was freed.";\
+			OPCODE_BREAK;\
+		}\
+	}
+
+#ifdef GDSCRIPT_COMPUTED_GOTO
+
+	/* threaded dispatch, each instruction jumps straight to the next one. Must follow the Opcode enum. */
+	static const void *switch_table_ops[OPCODE_END+1]={
+		&&OPCODE_OPERATOR,
+		&&OPCODE_OPERATOR_VALIDATED,
+		&&OPCODE_EXTENDS_TEST,
+		&&OPCODE_SET,
+		&&OPCODE_GET,
+		&&OPCODE_SET_NAMED,
+		&&OPCODE_GET_NAMED,
+		&&OPCODE_ASSIGN,
+		&&OPCODE_ASSIGN_TRUE,
+		&&OPCODE_ASSIGN_FALSE,
+		&&OPCODE_ASSIGN_TYPED_BUILTIN,
+		&&OPCODE_ASSIGN_TYPED_NATIVE,
+		&&OPCODE_CONSTRUCT,
+		&&OPCODE_CONSTRUCT_ARRAY,
+		&&OPCODE_CONSTRUCT_DICTIONARY,
+		&&OPCODE_CALL,
+		&&OPCODE_CALL_RETURN,
+		&&OPCODE_CALL_BUILT_IN,
+		&&OPCODE_CALL_SELF,
+		&&OPCODE_CALL_SELF_BASE,
+		&&OPCODE_CALL_METHOD_BIND,
+		&&OPCODE_YIELD,
+		&&OPCODE_YIELD_SIGNAL,
+		&&OPCODE_YIELD_RESUME,
+		&&OPCODE_JUMP,
+		&&OPCODE_JUMP_IF,
+		&&OPCODE_JUMP_IF_NOT,
+		&&OPCODE_JUMP_TO_DEF_ARGUMENT,
+		&&OPCODE_RETURN,
+		&&OPCODE_ITERATE_BEGIN,
+		&&OPCODE_ITERATE,
+		&&OPCODE_ITERATE_RANGE_BEGIN,
+		&&OPCODE_ITERATE_RANGE,
+		&&OPCODE_ASSERT,
+		&&OPCODE_LINE,
+		&&OPCODE_END
+	};
+
+#define OPCODE(m_op) m_op:
+#define OPCODE_WHILE(m_test)
+#define OPCODE_SWITCH(m_test) DISPATCH_OPCODE;
+#define DISPATCH_OPCODE goto *switch_table_ops[_code_ptr[ip]]
+#define OPCODE_BREAK goto OPSEXIT
+#define OPCODE_OUT goto OPSOUT
+#define OPCODES_END OPSEXIT:
+#define OPCODES_OUT OPSOUT:
+
+#else
+
+#define OPCODE(m_op) case m_op:
+#ifdef DEBUG_ENABLED
+#define OPCODE_WHILE(m_test) while(m_test)
+#else
+#define OPCODE_WHILE(m_test) while(true)
+#endif
+#define OPCODE_SWITCH(m_test) switch(m_test)
+#define DISPATCH_OPCODE continue
+#define OPCODE_BREAK break
+#define OPCODE_OUT break
+#define OPCODES_END
+#define OPCODES_OUT
 
+#endif
 
 	bool exit_ok=false;
 
-	while(ip<_code_size) {
+	OPCODE_WHILE(ip<_code_size) {
 
 
-		int last_opcode=_code_ptr[ip];
-		switch(_code_ptr[ip]) {
+		OPCODE_SWITCH(_code_ptr[ip]) {
 
-			case OPCODE_OPERATOR: {
+			OPCODE(OPCODE_OPERATOR) {
 
 				CHECK_SPACE(5);
 
 				bool valid;
 				Variant::Operator op = (Variant::Operator)_code_ptr[ip+1];
-				ERR_BREAK(op>=Variant::OP_MAX);
+				GD_ERR_BREAK(op>=Variant::OP_MAX);
 
 				GET_VARIANT_PTR(a,2);
 				GET_VARIANT_PTR(b,3);
 				GET_VARIANT_PTR(dst,4);
 
+				if (op==Variant::OP_IN) {
+					CHECK_WORKER_ACCESS(b); //reads a property of an object
+				}
+
 				Variant::evaluate(op,*a,*b,*dst,valid);
 				if (!valid) {
 					if (false && dst->get_type()==Variant::STRING) {
@@ -343,13 +697,44 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					} else {
 						err_text="Invalid operands '"+Variant::get_type_name(a->get_type())+"' and '"+Variant::get_type_name(b->get_type())+"' in operator '"+Variant::get_operator_name(op)+"'.";
 					}
-					break;
+					OPCODE_BREAK;
+				}
+
+				ip+=5;
+
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_OPERATOR_VALIDATED) {
+
+				CHECK_SPACE(5);
+
+				int func_idx = _code_ptr[ip+1];
+				GD_ERR_BREAK(func_idx<0 || func_idx>=_operator_funcs_count);
+
+				GET_VARIANT_PTR(a,2);
+				GET_VARIANT_PTR(b,3);
+				GET_VARIANT_PTR(dst,4);
+
+				//the slots were typed at compile time, but constants, set() from outside
+				//and call returns can still put other types in them
+				const OperatorFunc &of=_operator_funcs_ptr[func_idx];
+				if (a->get_type()==of.type_a && b->get_type()==of.type_b) {
+					of.func(*a,*b,*dst);
+				} else {
+					if (of.op==Variant::OP_IN) {
+						CHECK_WORKER_ACCESS(b);
+					}
+					bool valid;
+					Variant::evaluate(of.op,*a,*b,*dst,valid);
+					if (!valid) {
+						err_text="Invalid operands '"+Variant::get_type_name(a->get_type())+"' and '"+Variant::get_type_name(b->get_type())+"' in operator '"+Variant::get_operator_name(of.op)+"'.";
+						OPCODE_BREAK;
+					}
 				}
 
 				ip+=5;
 
-			} continue;
-			case OPCODE_EXTENDS_TEST: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_EXTENDS_TEST) {
 
 				CHECK_SPACE(4);
 
@@ -362,18 +747,21 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (a->get_type()!=Variant::OBJECT || a->operator Object*()==NULL) {
 
 					err_text="Left operand of 'extends' is not an instance of anything.";
-					break;
+					OPCODE_BREAK;
 
 				}
 				if (b->get_type()!=Variant::OBJECT || b->operator Object*()==NULL) {
 
 					err_text="Right operand of 'extends' is not a class.";
-					break;
+					OPCODE_BREAK;
 
 				}
 #endif
 
 
+				CHECK_WORKER_ACCESS(a);
+				CHECK_WORKER_ACCESS(b);
+
 				Object *obj_A = *a;
 				Object *obj_B = *b;
 
@@ -413,7 +801,7 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					if (!nc) {
 
 						err_text="Right operand of 'extends' is not a class (type: '"+obj_B->get_type()+"').";
-						break;
+						OPCODE_BREAK;
 					}
 
 					extends_ok=ObjectTypeDB::is_type(obj_A->get_type_name(),nc->get_name());
@@ -422,14 +810,15 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst=extends_ok;
 				ip+=4;
 
-			} continue;
-			case OPCODE_SET: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_SET) {
 
 				CHECK_SPACE(3);
 
 				GET_VARIANT_PTR(dst,1);
 				GET_VARIANT_PTR(index,2);
 				GET_VARIANT_PTR(value,3);
+				CHECK_WORKER_ACCESS(dst);
 
 				bool valid;
 				dst->set(*index,*value,&valid);
@@ -442,18 +831,19 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 						v="of type '"+_get_var_type(index)+"'";
 					}
 					err_text="Invalid set index "+v+" (on base: '"+_get_var_type(dst)+"').";
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip+=4;
-			} continue;
-			case OPCODE_GET: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_GET) {
 
 				CHECK_SPACE(3);
 
 				GET_VARIANT_PTR(src,1);
 				GET_VARIANT_PTR(index,2);
 				GET_VARIANT_PTR(dst,3);
+				CHECK_WORKER_ACCESS(src);
 
 				bool valid;
 				*dst = src->get(*index,&valid);
@@ -466,61 +856,144 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 						v="of type '"+_get_var_type(index)+"'";
 					}
 					err_text="Invalid get index "+v+" (on base: '"+_get_var_type(src)+"').";
-					break;
+					OPCODE_BREAK;
 				}
 				ip+=4;
-			} continue;
-			case OPCODE_SET_NAMED: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_SET_NAMED) {
 
-				CHECK_SPACE(3);
+				CHECK_SPACE(4);
 
 				GET_VARIANT_PTR(dst,1);
 				GET_VARIANT_PTR(value,3);
+				CHECK_WORKER_ACCESS(dst);
 
 				int indexname = _code_ptr[ip+2];
 
-				ERR_BREAK(indexname<0 || indexname>=_global_names_count);
+				GD_ERR_BREAK(indexname<0 || indexname>=_global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
-				bool valid;
-				dst->set_named(*index,*value,&valid);
+				int cacheidx = _code_ptr[ip+4];
+				GD_ERR_BREAK(cacheidx<0 || cacheidx>=_cache_count);
+				InlineCache &cache = _caches_ptr[cacheidx];
+
+				GDInstance *instance;
+				const void *target=NULL;
+				Object *obj = _get_cacheable_object(dst,instance);
+
+				if (obj && !(use_caches && _cache_lookup(cache,obj,instance,target))) {
+
+					if (instance) {
+						const Map<StringName,GDScript::MemberInfo>::Element *E = instance->script->member_indices.find(*index);
+						if (E && !E->get().setter)
+							target=&E->get();
+					} else {
+						target=ObjectTypeDB::get_property_setter(obj->get_type_name(),*index);
+					}
+					if (use_caches)
+						_cache_store(cache,obj,instance,target);
+				}
+
+				bool valid=false;
+
+				if (target) {
+
+					if (instance) {
+						const GDScript::MemberInfo *member = (const GDScript::MemberInfo*)target;
+						//values that need converting take the regular path
+						if (!member->data_type.has_type() || member->data_type.is_type(*value)) {
+							instance->members[member->index]=*value;
+							valid=true;
+						}
+					} else {
+						const Variant *arg[1]={value};
+						Variant::CallError ce;
+						((MethodBind*)target)->call(obj,arg,1,ce);
+						valid=true;
+					}
+#ifdef TOOLS_ENABLED
+					if (valid)
+						obj->set_edited(true);
+#endif
+				}
 
 				if (!valid) {
-					String err_type;
-					err_text="Invalid set index '"+String(*index)+"' (on base: '"+_get_var_type(dst)+"').";
-					break;
+
+					dst->set_named(*index,*value,&valid);
+
+					if (!valid) {
+						String err_type;
+						err_text="Invalid set index '"+String(*index)+"' (on base: '"+_get_var_type(dst)+"').";
+						OPCODE_BREAK;
+					}
 				}
 
-				ip+=4;
-			} continue;
-			case OPCODE_GET_NAMED: {
+				ip+=5;
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_GET_NAMED) {
 
 
-				CHECK_SPACE(3);
+				CHECK_SPACE(4);
 
 				GET_VARIANT_PTR(src,1);
-				GET_VARIANT_PTR(dst,3);
+				GET_VARIANT_PTR(dst,4);
+				CHECK_WORKER_ACCESS(src);
 
 				int indexname = _code_ptr[ip+2];
 
-				ERR_BREAK(indexname<0 || indexname>=_global_names_count);
+				GD_ERR_BREAK(indexname<0 || indexname>=_global_names_count);
 				const StringName *index = &_global_names_ptr[indexname];
 
-				bool valid;
-				*dst = src->get_named(*index,&valid);
+				int cacheidx = _code_ptr[ip+3];
+				GD_ERR_BREAK(cacheidx<0 || cacheidx>=_cache_count);
+				InlineCache &cache = _caches_ptr[cacheidx];
 
-				if (!valid) {
-					if (src->has_method(*index)) {
-						err_text="Invalid get index '"+index->operator String()+"' (on base: '"+_get_var_type(src)+"'). Did you mean '."+index->operator String()+"()' ?";
+				GDInstance *instance;
+				const void *target=NULL;
+				Object *obj = _get_cacheable_object(src,instance);
+
+				if (obj && !(use_caches && _cache_lookup(cache,obj,instance,target))) {
+
+					if (instance) {
+						const Map<StringName,GDScript::MemberInfo>::Element *E = instance->script->member_indices.find(*index);
+						if (E && !E->get().getter)
+							target=&E->get();
 					} else {
-						err_text="Invalid get index '"+index->operator String()+"' (on base: '"+_get_var_type(src)+"').";
+						target=ObjectTypeDB::get_property_getter(obj->get_type_name(),*index);
 					}
-					break;
+					if (use_caches)
+						_cache_store(cache,obj,instance,target);
 				}
 
-				ip+=4;
-			} continue;
-			case OPCODE_ASSIGN: {
+				if (target) {
+
+					if (instance) {
+						//dst may be the slot that holds the object, copy before assigning
+						Variant member = instance->members[((const GDScript::MemberInfo*)target)->index];
+						*dst = member;
+					} else {
+						Variant::CallError ce;
+						*dst = ((MethodBind*)target)->call(obj,NULL,0,ce);
+					}
+
+				} else {
+
+					bool valid;
+					*dst = src->get_named(*index,&valid);
+
+					if (!valid) {
+						if (src->has_method(*index)) {
+							err_text="Invalid get index '"+index->operator String()+"' (on base: '"+_get_var_type(src)+"'). Did you mean '."+index->operator String()+"()' ?";
+						} else {
+							err_text="Invalid get index '"+index->operator String()+"' (on base: '"+_get_var_type(src)+"').";
+						}
+						OPCODE_BREAK;
+					}
+				}
+
+				ip+=5;
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSIGN) {
 
 				CHECK_SPACE(3);
 				GET_VARIANT_PTR(dst,1);
@@ -530,8 +1003,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 				ip+=3;
 
-			} continue;
-			case OPCODE_ASSIGN_TRUE: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSIGN_TRUE) {
 
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(dst,1);
@@ -539,8 +1012,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst = true;
 
 				ip+=2;
-			} continue;
-			case OPCODE_ASSIGN_FALSE: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSIGN_FALSE) {
 
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(dst,1);
@@ -548,8 +1021,55 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*dst = false;
 
 				ip+=2;
-			} continue;
-			case OPCODE_CONSTRUCT: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSIGN_TYPED_BUILTIN) {
+
+				CHECK_SPACE(4);
+				Variant::Type var_type = (Variant::Type)_code_ptr[ip+1];
+				GD_ERR_BREAK(var_type<0 || var_type>=Variant::VARIANT_MAX);
+				GET_VARIANT_PTR(dst,2);
+				GET_VARIANT_PTR(src,3);
+
+				if (src->get_type()==var_type) {
+					*dst = *src;
+				} else if (var_type==Variant::REAL && src->get_type()==Variant::INT) {
+					*dst = src->operator double();
+				} else if (var_type==Variant::INT && src->get_type()==Variant::REAL) {
+					*dst = src->operator int();
+				} else {
+					err_text="Trying to assign value of type '"+_get_var_type(src)+"' to a variable of type '"+Variant::get_type_name(var_type)+"'.";
+					OPCODE_BREAK;
+				}
+
+				ip+=4;
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSIGN_TYPED_NATIVE) {
+
+				CHECK_SPACE(4);
+				int type_idx = _code_ptr[ip+1];
+				GD_ERR_BREAK(type_idx<0 || type_idx>=_global_names_count);
+				const StringName *native_type = &_global_names_ptr[type_idx];
+				GET_VARIANT_PTR(dst,2);
+				GET_VARIANT_PTR(src,3);
+
+				CHECK_WORKER_ACCESS(src);
+
+				bool valid = src->get_type()==Variant::NIL;
+				if (src->get_type()==Variant::OBJECT) {
+					Object *obj = *src;
+					valid = !obj || obj->is_type(*native_type);
+				}
+
+				if (!valid) {
+					err_text="Trying to assign value of type '"+_get_var_type(src)+"' to a variable of type '"+String(*native_type)+"'.";
+					OPCODE_BREAK;
+				}
+
+				*dst = *src;
+
+				ip+=4;
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CONSTRUCT) {
 
 				CHECK_SPACE(2);
 				Variant::Type t=Variant::Type(_code_ptr[ip+1]);
@@ -561,6 +1081,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					argptrs[i]=v;
 				}
 
+				CHECK_WORKER_ARGS(argptrs,argc);
+
 				GET_VARIANT_PTR(dst,3+argc);
 				Variant::CallError err;
 				*dst = Variant::construct(t,(const Variant**)argptrs,argc,err);
@@ -568,13 +1090,13 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (err.error!=Variant::CallError::CALL_OK) {
 
 					err_text=_get_call_error(err,"'"+Variant::get_type_name(t)+"' constructor",(const Variant**)argptrs);
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip+=4+argc;
 				//construct a basic type
-			} continue;
-			case OPCODE_CONSTRUCT_ARRAY: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CONSTRUCT_ARRAY) {
 
 				CHECK_SPACE(1);
 				int argc=_code_ptr[ip+1];
@@ -594,8 +1116,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 				ip+=3+argc;
 
-			} continue;
-			case OPCODE_CONSTRUCT_DICTIONARY: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CONSTRUCT_DICTIONARY) {
 
 				CHECK_SPACE(1);
 				int argc=_code_ptr[ip+1];
@@ -617,9 +1139,9 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 				ip+=3+argc*2;
 
-			} continue;
-			case OPCODE_CALL_RETURN:
-			case OPCODE_CALL: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CALL_RETURN)
+			OPCODE(OPCODE_CALL) {
 
 
 				CHECK_SPACE(4);
@@ -627,13 +1149,18 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 				int argc=_code_ptr[ip+1];
 				GET_VARIANT_PTR(base,2);
+				CHECK_WORKER_ACCESS(base);
 				int nameg=_code_ptr[ip+3];
 
-				ERR_BREAK(nameg<0 || nameg>=_global_names_count);
+				GD_ERR_BREAK(nameg<0 || nameg>=_global_names_count);
 				const StringName *methodname = &_global_names_ptr[nameg];
 
-				ERR_BREAK(argc<0);
-				ip+=4;
+				int cacheidx = _code_ptr[ip+4];
+				GD_ERR_BREAK(cacheidx<0 || cacheidx>=_cache_count);
+				InlineCache &cache = _caches_ptr[cacheidx];
+
+				GD_ERR_BREAK(argc<0);
+				ip+=5;
 				CHECK_SPACE(argc+1);
 				Variant **argptrs = call_args;
 
@@ -642,14 +1169,53 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					argptrs[i]=v;
 				}
 
+				CHECK_WORKER_ARGS(argptrs,argc); //the callee would get them
+
+				GDInstance *instance;
+				const void *target=NULL;
+				Object *obj = _get_cacheable_object(base,instance);
+
+				if (obj && !(use_caches && _cache_lookup(cache,obj,instance,target))) {
+
+					//free() is special cased by Object::call
+					if (*methodname!=CoreStringNames::get_singleton()->_free) {
+
+						if (instance) {
+							for(GDScript *sptr=instance->script.ptr();sptr;sptr=sptr->_base) {
+								Map<StringName,GDFunction>::Element *E = sptr->member_functions.find(*methodname);
+								if (E) {
+									target=&E->get();
+									break;
+								}
+							}
+						} else {
+							target=ObjectTypeDB::get_method(obj->get_type_name(),*methodname);
+						}
+					}
+					if (use_caches)
+						_cache_store(cache,obj,instance,target);
+				}
+
 				Variant::CallError err;
-				if (call_ret) {
+				Variant ret;
 
-					GET_VARIANT_PTR(ret,argc);
-					*ret = base->call(*methodname,(const Variant**)argptrs,argc,err);
+				if (target) {
+#ifdef DEBUG_ENABLED
+					_ObjectDebugLock debug_lock(obj);
+#endif
+					if (instance)
+						ret = ((GDFunction*)target)->call(instance,(const Variant**)argptrs,argc,err);
+					else
+						ret = ((MethodBind*)target)->call(obj,(const Variant**)argptrs,argc,err);
 				} else {
 
-					base->call(*methodname,(const Variant**)argptrs,argc,err);
+					ret = base->call(*methodname,(const Variant**)argptrs,argc,err);
+				}
+
+				if (call_ret) {
+
+					GET_VARIANT_PTR(dst,argc);
+					*dst = ret;
 				}
 
 				if (err.error!=Variant::CallError::CALL_OK) {
@@ -671,29 +1237,29 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 							if (base->is_ref()) {
 								err_text="Attempted to free a reference.";
-								break;
+								OPCODE_BREAK;
 							} else if (base->get_type()==Variant::OBJECT) {
 
 								err_text="Attempted to free a locked object (calling or emitting).";
-								break;
+								OPCODE_BREAK;
 							}
 						}
 					}
 					err_text=_get_call_error(err,"function '"+methodstr+"' in base '"+basestr+"'",(const Variant**)argptrs);
-					break;
+					OPCODE_BREAK;
 				}
 
 				//_call_func(NULL,base,*methodname,ip,argc,p_instance,stack);
 				ip+=argc+1;
 
-			} continue;
-			case OPCODE_CALL_BUILT_IN: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CALL_BUILT_IN) {
 
 				CHECK_SPACE(4);
 
 				GDFunctions::Function func = GDFunctions::Function(_code_ptr[ip+1]);
 				int argc=_code_ptr[ip+2];
-				ERR_BREAK(argc<0);
+				GD_ERR_BREAK(argc<0);
 
 				ip+=3;
 				CHECK_SPACE(argc+1);
@@ -704,6 +1270,8 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					argptrs[i]=v;
 				}
 
+				CHECK_WORKER_ARGS(argptrs,argc); //str(), print() and friends read objects too
+
 				GET_VARIANT_PTR(dst,argc);
 
 				Variant::CallError err;
@@ -715,16 +1283,16 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 					String methodstr = GDFunctions::get_func_name(func);
 					err_text=_get_call_error(err,"built-in function '"+methodstr+"'",(const Variant**)argptrs);
-					break;
+					OPCODE_BREAK;
 				}
 				ip+=argc+1;
 
-			} continue;
-			case OPCODE_CALL_SELF: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CALL_SELF) {
 
 
-			} break;
-			case OPCODE_CALL_SELF_BASE: {
+			} OPCODE_BREAK;
+			OPCODE(OPCODE_CALL_SELF_BASE) {
 
 				CHECK_SPACE(2);
 				int self_fun = _code_ptr[ip+1];
@@ -733,7 +1301,7 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (self_fun<0 || self_fun>=_global_names_count) {
 
 					err_text="compiler bug, function name not found";
-					break;
+					OPCODE_BREAK;
 				}
 #endif
 				const StringName *methodname = &_global_names_ptr[self_fun];
@@ -796,113 +1364,185 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					String methodstr = *methodname;
 					err_text=_get_call_error(err,"function '"+methodstr+"'",(const Variant**)argptrs);
 
-					break;
+					OPCODE_BREAK;
 				}
 
 				ip+=4+argc;
 
-			} continue;
-			case OPCODE_YIELD:
-			case OPCODE_YIELD_SIGNAL: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_CALL_METHOD_BIND) {
 
-				int ipofs=1;
-				if (_code_ptr[ip]==OPCODE_YIELD_SIGNAL) {
-					CHECK_SPACE(4);
-					ipofs+=2;
-				} else {
-					CHECK_SPACE(2);
+				CHECK_SPACE(4);
+
+				int argc=_code_ptr[ip+1];
+				GET_VARIANT_PTR(base,2);
+				CHECK_WORKER_ACCESS(base);
+				int method_idx=_code_ptr[ip+3];
+				GD_ERR_BREAK(method_idx<0 || method_idx>=_methods_count);
+				MethodBind *method = _methods_ptr[method_idx];
 
+				GD_ERR_BREAK(argc<0);
+				ip+=4;
+				CHECK_SPACE(argc+1);
+				Variant **argptrs = call_args;
+
+				for(int i=0;i<argc;i++) {
+					GET_VARIANT_PTR(v,i);
+					argptrs[i]=v;
 				}
 
-				Ref<GDFunctionState> gdfs = memnew( GDFunctionState );
-				gdfs->function=this;
+				CHECK_WORKER_ARGS(argptrs,argc);
+
+				GET_VARIANT_PTR(ret,argc);
+
+				//typed slots can still receive other values at run time (freed objects, set() from outside)
+				Object *obj = base->get_type()==Variant::OBJECT ? base->operator Object*() : NULL;
+				Variant::CallError err;
+
+#ifdef DEBUG_ENABLED
+				if (obj && !ObjectDB::instance_validate(obj))
+					obj=NULL; //freed, same error as Variant::call
+#endif
+
+				if (!obj) {
+
+					err.error=Variant::CallError::CALL_ERROR_INSTANCE_IS_NULL;
+				} else if (obj->get_script_instance() || !obj->is_type(method->get_instance_type())) {
+
+					//scripts may override the method, and other classes need a regular call
+					*ret = base->call(method->get_name(),(const Variant**)argptrs,argc,err);
+				} else {
+#ifdef DEBUG_ENABLED
+					_ObjectDebugLock debug_lock(obj);
+#endif
+					*ret = method->call(obj,(const Variant**)argptrs,argc,err);
+				}
+
+				if (err.error!=Variant::CallError::CALL_OK) {
 
-				gdfs->state.stack.resize(alloca_size);
-				//copy variant stack
-				for(int i=0;i<_stack_size;i++) {
-					memnew_placement(&gdfs->state.stack[sizeof(Variant)*i],Variant(stack[i]));
+					err_text=_get_call_error(err,"function '"+String(method->get_name())+"' in base '"+_get_var_type(base)+"'",(const Variant**)argptrs);
+					OPCODE_BREAK;
 				}
-				gdfs->state.stack_size=_stack_size;
-				gdfs->state.self=self;
-				gdfs->state.alloca_size=alloca_size;
-				gdfs->state._class=_class;
-				gdfs->state.ip=ip+ipofs;
-				gdfs->state.line=line;
-				//gdfs->state.result_pos=ip+ipofs-1;
-				gdfs->state.defarg=defarg;
-				gdfs->state.instance=p_instance;
-				gdfs->function=this;
 
-				retvalue=gdfs;
+				ip+=argc+1;
+
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_YIELD)
+			OPCODE(OPCODE_YIELD_SIGNAL) {
+
+				int ipofs=1;
+				Object *obj=NULL;
+				String signal;
+
+				if (worker) {
+					//nothing would resume the function on the worker's thread
+					err_text="yield() can't be used in a function running on a worker.";
+					OPCODE_BREAK;
+				}
 
 				if (_code_ptr[ip]==OPCODE_YIELD_SIGNAL) {
+					CHECK_SPACE(4);
+					ipofs+=2;
+
 					GET_VARIANT_PTR(argobj,1);
 					GET_VARIANT_PTR(argname,2);
 					//do the oneshot connect
 
 					if (argobj->get_type()!=Variant::OBJECT) {
 						err_text="First argument of yield() not of type object.";
-						break;
+						OPCODE_BREAK;
 					}
 					if (argname->get_type()!=Variant::STRING) {
 						err_text="Second argument of yield() not a string (for signal name).";
-						break;
+						OPCODE_BREAK;
 					}
-					Object *obj=argobj->operator Object *();
-					String signal = argname->operator String();
+					obj=argobj->operator Object *();
+					signal = argname->operator String();
 #ifdef DEBUG_ENABLED
 
 					if (!obj) {
 						err_text="First argument of yield() is null.";
-						break;
+						OPCODE_BREAK;
 					}
 					if (ScriptDebugger::get_singleton()) {
 						if (!ObjectDB::instance_validate(obj)) {
 							err_text="First argument of yield() is a previously freed instance.";
-							break;
+							OPCODE_BREAK;
 						}
 					}
 					if (signal.length()==0) {
 
 						err_text="Second argument of yield() is an empty string (for signal name).";
-						break;
+						OPCODE_BREAK;
 					}
 
 #endif
+				} else {
+					CHECK_SPACE(2);
+
+				}
+
+				Ref<GDFunctionState> gdfs = memnew( GDFunctionState );
+				gdfs->function=this;
+
+				if (p_state) {
+					//already in a frame of its own, hand it over
+					gdfs->state.stack=p_state->stack;
+					p_state->stack=NULL;
+				} else {
+					//move the variant stack out of alloca, variants don't point to themselves
+					gdfs->state.stack=GDScriptLanguage::get_singleton()->alloc_frame(alloca_size);
+					if (_stack_size)
+						copymem(gdfs->state.stack,stack,sizeof(Variant)*_stack_size);
+				}
+				stack_moved=true;
+
+				gdfs->state.stack_size=_stack_size;
+				gdfs->state.self=self;
+				gdfs->state.alloca_size=alloca_size;
+				gdfs->state._class=_class;
+				gdfs->state.ip=ip+ipofs;
+				gdfs->state.line=line;
+				//gdfs->state.result_pos=ip+ipofs-1;
+				gdfs->state.defarg=defarg;
+				gdfs->state.instance=p_instance;
+				gdfs->function=this;
+
+				retvalue=gdfs;
+
+				if (obj) {
 					Error err = obj->connect(signal,gdfs.ptr(),"_signal_callback",varray(gdfs),Object::CONNECT_ONESHOT);
 					if (err!=OK) {
 						err_text="Error connecting to signal: "+signal+" during yield().";
-						break;
+						OPCODE_BREAK;
 					}
-
-
 				}
 
 				exit_ok=true;
 
-			} break;
-			case OPCODE_YIELD_RESUME: {
+			} OPCODE_BREAK;
+			OPCODE(OPCODE_YIELD_RESUME) {
 
 				CHECK_SPACE(2);
 				if (!p_state) {
 					err_text=("Invalid Resume (bug?)");
-					break;
+					OPCODE_BREAK;
 				}
 				GET_VARIANT_PTR(result,1);
 				*result=p_state->result;
 				ip+=2;
 
-			} continue;
-			case OPCODE_JUMP: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_JUMP) {
 
 				CHECK_SPACE(2);
 				int to = _code_ptr[ip+1];
 
-				ERR_BREAK(to<0 || to>_code_size);
+				GD_ERR_BREAK(to<0 || to>_code_size);
 				ip=to;
 
-			} continue;
-			case OPCODE_JUMP_IF: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_JUMP_IF) {
 
 				CHECK_SPACE(3);
 
@@ -914,18 +1554,18 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!valid) {
 
 					err_text="cannot evaluate conditional expression of type: "+Variant::get_type_name(test->get_type());
-					break;
+					OPCODE_BREAK;
 				}
 #endif
 				if (result) {
 					int to = _code_ptr[ip+2];
-					ERR_BREAK(to<0 || to>_code_size);
+					GD_ERR_BREAK(to<0 || to>_code_size);
 					ip=to;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				ip+=3;
-			} continue;
-			case OPCODE_JUMP_IF_NOT: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_JUMP_IF_NOT) {
 
 				CHECK_SPACE(3);
 
@@ -937,48 +1577,68 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!valid) {
 
 					err_text="cannot evaluate conditional expression of type: "+Variant::get_type_name(test->get_type());
-					break;
+					OPCODE_BREAK;
 				}
 #endif
 				if (!result) {
 					int to = _code_ptr[ip+2];
-					ERR_BREAK(to<0 || to>_code_size);
+					GD_ERR_BREAK(to<0 || to>_code_size);
 					ip=to;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				ip+=3;
-			} continue;
-			case OPCODE_JUMP_TO_DEF_ARGUMENT: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_JUMP_TO_DEF_ARGUMENT) {
 
 				CHECK_SPACE(2);
 				ip=_default_arg_ptr[defarg];
 
-			} continue;
-			case OPCODE_RETURN: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_RETURN) {
 
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(r,1);
 				retvalue=*r;
 				exit_ok=true;
 
-			} break;
-			case OPCODE_ITERATE_BEGIN: {
+			} OPCODE_BREAK;
+			OPCODE(OPCODE_ITERATE_BEGIN) {
 
-				CHECK_SPACE(8); //space for this an regular iterate
+				CHECK_SPACE(9); //space for this an regular iterate
 
 				GET_VARIANT_PTR(counter,1);
 				GET_VARIANT_PTR(container,2);
+				CHECK_WORKER_ACCESS(container); //_iter_init()/_iter_next() on objects
+				int lockidx=_code_ptr[ip+5];
+				GD_ERR_BREAK(lockidx<0 || lockidx>=_iterator_lock_count);
+				IteratorLock &il=iterator_locks[lockidx];
+
+				if (il.lock(*container)) {
+					//packed array, read elements straight from the locked memory
+					if (il.size==0) {
+						il.unlock();
+						int jumpto=_code_ptr[ip+3];
+						GD_ERR_BREAK(jumpto<0 || jumpto>_code_size);
+						ip=jumpto;
+						DISPATCH_OPCODE;
+					}
+					GET_VARIANT_PTR(iterator,4);
+					*counter=0;
+					il.get(0,*iterator);
+					ip+=6; //skip regular iterate which is always next
+					DISPATCH_OPCODE;
+				}
 
 				bool valid;
 				if (!container->iter_init(*counter,valid)) {
 					if (!valid) {
 						err_text="Unable to iterate on object of type  "+Variant::get_type_name(container->get_type())+"'.";
-						break;
+						OPCODE_BREAK;
 					}
 					int jumpto=_code_ptr[ip+3];
-					ERR_BREAK(jumpto<0 || jumpto>_code_size);
+					GD_ERR_BREAK(jumpto<0 || jumpto>_code_size);
 					ip=jumpto;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				GET_VARIANT_PTR(iterator,4);
 
@@ -986,42 +1646,148 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				*iterator=container->iter_get(*counter,valid);
 				if (!valid) {
 					err_text="Unable to obtain iterator object of type  "+Variant::get_type_name(container->get_type())+"'.";
-					break;
+					OPCODE_BREAK;
 				}
 
 
-				ip+=5; //skip regular iterate which is always next
+				ip+=6; //skip regular iterate which is always next
 
-			} continue;
-			case OPCODE_ITERATE: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ITERATE) {
 
-				CHECK_SPACE(4);
+				CHECK_SPACE(6);
 
 				GET_VARIANT_PTR(counter,1);
 				GET_VARIANT_PTR(container,2);
+				CHECK_WORKER_ACCESS(container); //_iter_init()/_iter_next() on objects
+				int lockidx=_code_ptr[ip+5];
+				GD_ERR_BREAK(lockidx<0 || lockidx>=_iterator_lock_count);
+				IteratorLock &il=iterator_locks[lockidx];
+
+				if (il.type!=Variant::NIL || il.lock(*container)) {
+					//locked again after a yield, the counter is still in the stack
+					int idx=int(*counter)+1;
+					if (idx>=il.size) {
+						il.unlock();
+						int jumpto=_code_ptr[ip+3];
+						GD_ERR_BREAK(jumpto<0 || jumpto>_code_size);
+						ip=jumpto;
+						DISPATCH_OPCODE;
+					}
+					GET_VARIANT_PTR(iterator,4);
+					*counter=idx;
+					il.get(idx,*iterator);
+					ip+=6; //loop again
+					DISPATCH_OPCODE;
+				}
 
 				bool valid;
 				if (!container->iter_next(*counter,valid)) {
 					if (!valid) {
 						err_text="Unable to iterate on object of type  "+Variant::get_type_name(container->get_type())+"' (type changed since first iteration?).";
-						break;
+						OPCODE_BREAK;
 					}
 					int jumpto=_code_ptr[ip+3];
-					ERR_BREAK(jumpto<0 || jumpto>_code_size);
+					GD_ERR_BREAK(jumpto<0 || jumpto>_code_size);
 					ip=jumpto;
-					continue;
+					DISPATCH_OPCODE;
 				}
 				GET_VARIANT_PTR(iterator,4);
 
 				*iterator=container->iter_get(*counter,valid);
 				if (!valid) {
 					err_text="Unable to obtain iterator object of type  "+Variant::get_type_name(container->get_type())+"' (but was obtained on first iteration?).";
-					break;
+					OPCODE_BREAK;
+				}
+
+				ip+=6; //loop again
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ITERATE_RANGE_BEGIN) {
+
+				CHECK_SPACE(2);
+				int argc=_code_ptr[ip+1];
+				GD_ERR_BREAK(argc<1 || argc>3);
+				CHECK_SPACE(13+argc); //space for this and regular iterate
+
+				GET_VARIANT_PTR(counter,2);
+				GET_VARIANT_PTR(limit,3);
+				GET_VARIANT_PTR(step,4);
+
+				Variant **argptrs = call_args;
+				int args[3];
+
+				for(int i=0;i<argc;i++) {
+					GET_VARIANT_PTR(v,5+i);
+					argptrs[i]=v;
+				}
+
+				for(int i=0;i<argc;i++) {
+#ifdef DEBUG_ENABLED
+					//same checks range() does
+					if (!argptrs[i]->is_num()) {
+						Variant::CallError err;
+						err.error=Variant::CallError::CALL_ERROR_INVALID_ARGUMENT;
+						err.argument=i;
+						err.expected=Variant::REAL;
+						err_text=_get_call_error(err,"built-in function '"+String(GDFunctions::get_func_name(GDFunctions::GEN_RANGE))+"'",(const Variant**)argptrs);
+						OPCODE_BREAK;
+					}
+#endif
+					args[i]=*argptrs[i];
+				}
+
+				int from = argc==1 ? 0 : args[0];
+				int to = argc==1 ? args[0] : args[1];
+				int incr = argc==3 ? args[2] : 1;
+
+				if (incr==0) {
+					err_text="Step argument of built-in function 'range' is zero.";
+					OPCODE_BREAK;
+				}
+
+				if ((incr>0 && from>=to) || (incr<0 && from<=to)) {
+					int jumpto=_code_ptr[ip+5+argc];
+					GD_ERR_BREAK(jumpto<0 || jumpto>_code_size);
+					ip=jumpto;
+					DISPATCH_OPCODE;
+				}
+
+				GET_VARIANT_PTR(iterator,6+argc);
+				*counter=from;
+				*limit=to;
+				*step=incr;
+				*iterator=from;
+
+				ip+=7+argc; //skip regular iterate which is always next
+
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ITERATE_RANGE) {
+
+				CHECK_SPACE(6);
+
+				GET_VARIANT_PTR(counter,1);
+				GET_VARIANT_PTR(limit,2);
+				GET_VARIANT_PTR(step,3);
+
+				//all three are private to the loop and were set to ints when it began
+				int incr=*step;
+				int to=*limit;
+				int idx=int(*counter)+incr;
+
+				if (incr>0 ? idx>=to : idx<=to) {
+					int jumpto=_code_ptr[ip+4];
+					GD_ERR_BREAK(jumpto<0 || jumpto>_code_size);
+					ip=jumpto;
+					DISPATCH_OPCODE;
 				}
 
-				ip+=5; //loop again
-			} continue;
-			case OPCODE_ASSERT: {
+				GET_VARIANT_PTR(iterator,5);
+				*counter=idx;
+				*iterator=idx;
+
+				ip+=6; //loop again
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_ASSERT) {
 				CHECK_SPACE(2);
 				GET_VARIANT_PTR(test,1);
 
@@ -1033,27 +1799,27 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 				if (!valid) {
 
 					err_text="cannot evaluate conditional expression of type: "+Variant::get_type_name(test->get_type());
-					break;
+					OPCODE_BREAK;
 				}
 
 
 				if (!result) {
 
 					err_text="Assertion failed.";
-					break;
+					OPCODE_BREAK;
 				}
 
 #endif
 
 				ip+=2;
-			} continue;
-			case OPCODE_LINE: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_LINE) {
 				CHECK_SPACE(2);
 
 				line=_code_ptr[ip+1];
 				ip+=2;
 
-				if (ScriptDebugger::get_singleton()) {
+				if (ScriptDebugger::get_singleton() && !worker) {
 			    // line
 					bool do_break=false;
 
@@ -1075,22 +1841,26 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 					ScriptDebugger::get_singleton()->line_poll();
 
 				}
-			} continue;
-			case OPCODE_END: {
+			} DISPATCH_OPCODE;
+			OPCODE(OPCODE_END) {
 
 				exit_ok=true;
-				break;
+				OPCODE_BREAK;
 
-			} break;
+			}
+#ifndef GDSCRIPT_COMPUTED_GOTO
 			default: {
 
 				err_text="Illegal opcode "+itos(_code_ptr[ip])+" at address "+itos(ip);
-			} break;
+			} OPCODE_BREAK;
+#endif
 
 		}
 
+		OPCODES_END
+
 		if (exit_ok)
-			break;
+			OPCODE_OUT;
 		//error
 		// function, file, line, error, explanation
 		String err_file;
@@ -1105,7 +1875,7 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 			err_func=p_instance->script->name+"."+err_func;
 		int err_line=line;
 		if (err_text=="") {
-			err_text="Internal Script Error! - opcode #"+itos(last_opcode)+" (report please).";
+			err_text="Internal Script Error! - near address #"+itos(ip)+" (report please).";
 		}
 
 	if (!GDScriptLanguage::get_singleton()->debug_break(err_text,false)) {
@@ -1115,14 +1885,41 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
         }
 
 
-		break;
+		OPCODE_OUT;
 	}
 
-    if (ScriptDebugger::get_singleton())
+	OPCODES_OUT
+
+    if (ScriptDebugger::get_singleton() && !worker)
         GDScriptLanguage::get_singleton()->exit_function();
 
+#ifdef DEBUG_ENABLED
+	if (profiling) {
+
+		uint64_t time_taken = OS::get_singleton()->get_ticks_usec() - function_start_time;
+		uint64_t self_time = time_taken - function_call_time;
+
+		if (!p_state) {
+			//resuming after yield is not a new call
+			profile.call_count++;
+			profile.frame_call_count++;
+		}
+		profile.total_time+=time_taken;
+		profile.frame_total_time+=time_taken;
+		profile.self_time+=self_time;
+		profile.frame_self_time+=self_time;
+
+		GDScriptLanguage::get_singleton()->profile_call_time=caller_call_time;
+		if (caller_call_time)
+			*caller_call_time+=time_taken;
+	}
+#endif
+
 
-	if (_stack_size) {
+	for(int i=0;i<_iterator_lock_count;i++)
+		iterator_locks[i].~IteratorLock();
+
+	if (_stack_size && !stack_moved) {
 		//free stack
 		for(int i=0;i<_stack_size;i++)
 			stack[i].~Variant();
@@ -1132,6 +1929,20 @@ Variant GDFunction::call(GDInstance *p_instance, const Variant **p_args, int p_a
 
 }
 
+#undef GD_ERR_BREAK
+#undef CHECK_SPACE
+#undef GET_VARIANT_PTR
+#undef CHECK_WORKER_ACCESS
+#undef CHECK_WORKER_ARGS
+#undef OPCODE
+#undef OPCODE_WHILE
+#undef OPCODE_SWITCH
+#undef DISPATCH_OPCODE
+#undef OPCODE_BREAK
+#undef OPCODE_OUT
+#undef OPCODES_END
+#undef OPCODES_OUT
+
 const int* GDFunction::get_code() const {
 
 	return _code_ptr;
@@ -1153,6 +1964,12 @@ StringName GDFunction::get_global_name(int p_idx) const {
 	return global_names[p_idx];
 }
 
+MethodBind *GDFunction::get_method_bind(int p_idx) const {
+
+	ERR_FAIL_INDEX_V(p_idx,methods.size(),NULL);
+	return methods[p_idx];
+}
+
 int GDFunction::get_default_argument_count() const {
 
 	return default_arguments.size();
@@ -1270,13 +2087,38 @@ GDFunction::GDFunction() {
 
 	_stack_size=0;
 	_call_size=0;
+	_iterator_lock_count=0;
+	_operator_funcs_ptr=NULL;
+	_operator_funcs_count=0;
+	_methods_ptr=NULL;
+	_methods_count=0;
+	_caches_ptr=NULL;
+	_cache_count=0;
 	name="<anonymous>";
 #ifdef DEBUG_ENABLED
 	_func_cname=NULL;
+
+	profile.call_count=0;
+	profile.self_time=0;
+	profile.total_time=0;
+	profile.frame_call_count=0;
+	profile.frame_self_time=0;
+	profile.frame_total_time=0;
+	profile.last_frame_call_count=0;
+	profile.last_frame_self_time=0;
+	profile.last_frame_total_time=0;
 #endif
 
 }
 
+GDFunction::~GDFunction() {
+
+#ifdef DEBUG_ENABLED
+	if (GDScriptLanguage::get_singleton())
+		GDScriptLanguage::get_singleton()->remove_profiled_function(this);
+#endif
+}
+
 /////////////////////
 
 
@@ -1316,6 +2158,7 @@ Variant GDFunctionState::_signal_callback(const Variant** p_args, int p_argcount
 	Variant ret = function->call(NULL,NULL,0,r_error,&state);
 	function=NULL; //cleaned up;
 	state.result=Variant();
+	_free_stack(); //unless it yielded again and took the frame
 	return ret;
 }
 
@@ -1334,6 +2177,7 @@ Variant GDFunctionState::resume(const Variant& p_arg) {
 	Variant ret = function->call(NULL,NULL,0,err,&state);
 	function=NULL; //cleaned up;
 	state.result=Variant();
+	_free_stack(); //unless it yielded again and took the frame
 	return ret;
 }
 
@@ -1346,20 +2190,34 @@ void GDFunctionState::_bind_methods() {
 
 }
 
+void GDFunctionState::_free_stack() {
+
+	if (!state.stack)
+		return;
+
+	if (GDScriptLanguage::get_singleton())
+		GDScriptLanguage::get_singleton()->free_frame(state.stack,state.alloca_size);
+	else
+		memfree(state.stack);
+	state.stack=NULL;
+}
+
 GDFunctionState::GDFunctionState() {
 
 	function=NULL;
+	state.stack=NULL;
 }
 
 GDFunctionState::~GDFunctionState() {
 
-	if (function!=NULL) {
+	if (function!=NULL && state.stack) {
 		//never called, deinitialize stack
 		for(int i=0;i<state.stack_size;i++) {
 			Variant *v=(Variant*)&state.stack[sizeof(Variant)*i];
 			v->~Variant();
 		}
 	}
+	_free_stack();
 }
 
 ///////////////////////////
@@ -1403,6 +2261,9 @@ Variant GDNativeClass::_new() {
 		ERR_FAIL_COND_V(!o,Variant());
 	}
 
+	if (GDScriptWorker::get_current())
+		GDScriptWorker::get_current()->add_object(o);
+
 	Reference *ref = o->cast_to<Reference>();
 	if (ref) {
 		return REF(ref);
@@ -1427,13 +2288,25 @@ GDInstance* GDScript::_create_instance(const Variant** p_args,int p_argcount,Obj
 	GDInstance* instance = memnew( GDInstance );
 	instance->base_ref=p_isref;
 	instance->members.resize(member_indices.size());
+	for(const Map<StringName,MemberInfo>::Element *E=member_indices.front();E;E=E->next()) {
+		//typed members must hold their type even before the initializer runs
+		if (E->get().data_type.kind==GDDataType::BUILTIN) {
+			Variant::CallError ce;
+			instance->members[E->get().index]=Variant::construct(E->get().data_type.builtin_type,NULL,0,ce);
+		}
+	}
 	instance->script=Ref<GDScript>(this);
 	instance->owner=p_owner;
 	instance->owner->set_script_instance(instance);
 
 	/* STEP 2, INITIALIZE AND CONSRTUCT */
 
+	if (GDScriptWorker::get_current())
+		GDScriptWorker::get_current()->add_object(p_owner); //_init() runs on the worker too
+
+	GDScriptLanguage::singleton->table_lock->lock();
 	instances.insert(instance->owner);
+	GDScriptLanguage::singleton->table_lock->unlock();
 
 	Variant::CallError err;
 	initializer->call(instance,p_args,p_argcount,err);
@@ -1441,11 +2314,12 @@ GDInstance* GDScript::_create_instance(const Variant** p_args,int p_argcount,Obj
 	if (err.error!=Variant::CallError::CALL_OK) {
 		instance->script=Ref<GDScript>();
 		instance->owner->set_script_instance(NULL);
+		GDScriptLanguage::singleton->table_lock->lock();
 		instances.erase(p_owner);
+		GDScriptLanguage::singleton->table_lock->unlock();
 		ERR_FAIL_COND_V(err.error!=Variant::CallError::CALL_OK, NULL); //error consrtucting
 	}
 
-	//@TODO make thread safe
 	return instance;
 
 }
@@ -1612,7 +2486,11 @@ ScriptInstance* GDScript::instance_create(Object *p_this) {
 }
 bool GDScript::instance_has(const Object *p_this) const {
 
-	return instances.has((Object*)p_this);
+	GDScriptLanguage::singleton->table_lock->lock();
+	bool has = instances.has((Object*)p_this);
+	GDScriptLanguage::singleton->table_lock->unlock();
+
+	return has;
 }
 
 bool GDScript::has_source_code() const {
@@ -1790,10 +2668,7 @@ void GDScript::_set_subclass_path(Ref<GDScript>& p_sc,const String& p_path) {
 	}
 }
 
-Error GDScript::reload() {
-
-
-	ERR_FAIL_COND_V(instances.size(),ERR_ALREADY_IN_USE);
+Error GDScript::_reload(String& r_error,int& r_error_line) {
 
 	String basedir=path;
 
@@ -1804,28 +2679,22 @@ Error GDScript::reload() {
 		basedir=basedir.get_base_dir();
 
 
-
-
 	valid=false;
 	GDParser parser;
 	Error err = parser.parse(source,basedir,false,path);
 	if (err) {
-		if (ScriptDebugger::get_singleton()) {
-			GDScriptLanguage::get_singleton()->debug_break_parse(get_path(),parser.get_error_line(),"Parser Error: "+parser.get_error());
-		}
-		_err_print_error("GDScript::reload",path.empty()?"built-in":(const char*)path.utf8().get_data(),parser.get_error_line(),("Parse Error: "+parser.get_error()).utf8().get_data());
-		ERR_FAIL_V(ERR_PARSE_ERROR);
+		r_error=parser.get_error();
+		r_error_line=parser.get_error_line();
+		return ERR_PARSE_ERROR;
 	}
 
 	GDCompiler compiler;
 	err = compiler.compile(&parser,this);
 
 	if (err) {
-		if (ScriptDebugger::get_singleton()) {
-			GDScriptLanguage::get_singleton()->debug_break_parse(get_path(),compiler.get_error_line(),"Parser Error: "+compiler.get_error());
-		}
-		_err_print_error("GDScript::reload",path.empty()?"built-in":(const char*)path.utf8().get_data(),compiler.get_error_line(),("Compile Error: "+compiler.get_error()).utf8().get_data());
-		ERR_FAIL_V(ERR_COMPILATION_FAILED);
+		r_error=compiler.get_error();
+		r_error_line=compiler.get_error_line();
+		return ERR_COMPILATION_FAILED;
 	}
 
 	valid=true;
@@ -1835,6 +2704,31 @@ Error GDScript::reload() {
 		_set_subclass_path(E->get(),path);
 	}
 
+	return OK;
+}
+
+void GDScript::_report_error(Error p_err,const String& p_error,int p_error_line) {
+
+	if (ScriptDebugger::get_singleton() && Thread::get_caller_ID()==Thread::get_main_ID()) {
+		GDScriptLanguage::get_singleton()->debug_break_parse(get_path(),p_error_line,"Parser Error: "+p_error);
+	}
+	String kind = p_err==ERR_PARSE_ERROR ? "Parse Error: " : "Compile Error: ";
+	_err_print_error("GDScript::reload",path.empty()?"built-in":(const char*)path.utf8().get_data(),p_error_line,(kind+p_error).utf8().get_data());
+}
+
+Error GDScript::reload() {
+
+
+	ERR_FAIL_COND_V(instances.size(),ERR_ALREADY_IN_USE);
+
+	String error;
+	int error_line=0;
+	Error err = _reload(error,error_line);
+	if (err) {
+		_report_error(err,error,error_line);
+		ERR_FAIL_V(err);
+	}
+
 #ifdef TOOLS_ENABLED
 	/*for (Set<PlaceHolderScriptInstance*>::Element *E=placeholders.front();E;E=E->next()) {
 
@@ -1981,6 +2875,29 @@ Error GDScript::load_byte_code(const String& p_path) {
 		basedir=basedir.get_base_dir();
 
 	valid=false;
+
+	if (GDCompiledScript::is_compiled_script(bytecode)) {
+
+		Vector<uint8_t> tokens;
+		if (GDCompiledScript::load(bytecode,this,&tokens)==OK) {
+
+			valid=true;
+
+			for(Map<StringName,Ref<GDScript> >::Element *E=subclasses.front();E;E=E->next()) {
+
+				_set_subclass_path(E->get(),path);
+			}
+
+			return OK;
+		}
+
+		//exported with another engine version, or something it uses changed
+		if (OS::get_singleton()->is_stdout_verbose())
+			print_line("GDScript: compiled bytecode of "+path+" can't be used, compiling it again.");
+		ERR_FAIL_COND_V(tokens.size()==0,ERR_PARSE_ERROR);
+		bytecode=tokens;
+	}
+
 	GDParser parser;
 	Error err = parser.parse_bytecode(bytecode,basedir,get_path());
 	if (err) {
@@ -2086,6 +3003,12 @@ GDScript::GDScript() {
 
 }
 
+GDScript::~GDScript() {
+
+	//inline caches may point to this script's members and functions
+	GDFunction::invalidate_caches();
+}
+
 
 
 
@@ -2101,9 +3024,19 @@ bool GDInstance::set(const StringName& p_name, const Variant& p_value) {
 	{
 		const Map<StringName,GDScript::MemberInfo>::Element *E = script->member_indices.find(p_name);
 		if (E) {
-			members[E->get().index]=p_value;
+			const Variant *val=&p_value;
+			Variant converted;
+			const GDDataType &data_type = E->get().data_type;
+			if (data_type.has_type() && !data_type.is_type(p_value)) {
+
+				if (!data_type.convert(p_value,converted)) {
+					ERR_EXPLAIN("Trying to assign value of type '"+Variant::get_type_name(p_value.get_type())+"' to member '"+String(p_name)+"' of type '"+data_type.get_name()+"'.");
+					ERR_FAIL_V(false);
+				}
+				val=&converted;
+			}
+			members[E->get().index]=*val;
 			if (E->get().setter) {
-				const Variant *val=&p_value;
 				Variant::CallError err;
 				call(E->get().setter,&val,1,err);
 				if (err.error==Variant::CallError::CALL_OK) {
@@ -2431,7 +3364,9 @@ GDInstance::GDInstance() {
 
 GDInstance::~GDInstance() {
 	if (script.is_valid() && owner) {
+		GDScriptLanguage::singleton->table_lock->lock();
 		script->instances.erase(owner);
+		GDScriptLanguage::singleton->table_lock->unlock();
 	}
 }
 
@@ -2453,15 +3388,18 @@ String GDScriptLanguage::get_name() const {
 
 void GDScriptLanguage::_add_global(const StringName& p_name,const Variant& p_value) {
 
+	table_lock->lock();
 
 	if (globals.has(p_name)) {
 		//overwrite existing
 		global_array[globals[p_name]]=p_value;
-		return;
+	} else {
+		globals[p_name]=global_array.size();
+		global_array.push_back(p_value);
+		_global_array=global_array.ptr();
 	}
-	globals[p_name]=global_array.size();
-	global_array.push_back(p_value);
-	_global_array=global_array.ptr();
+
+	table_lock->unlock();
 }
 
 void GDScriptLanguage::init() {
@@ -2501,6 +3439,15 @@ void GDScriptLanguage::init() {
 
 		_add_global(E->get().name,E->get().ptr);
 	}
+
+	//compile the project scripts on all cores, instead of one by one as scenes load them
+	if (GLOBAL_DEF("application/precompile_scripts",false) && Globals::get_singleton()->get_resource_path()!="") {
+
+		List<String> paths;
+		GDPrecompiler::find_scripts("res://",&paths);
+		GDPrecompiler precompiler;
+		precompiler.precompile(paths,&precompiled_scripts);
+	}
 }
 
 String GDScriptLanguage::get_type() const {
@@ -2526,6 +3473,134 @@ void GDScriptLanguage::frame() {
 
 //	print_line("calls: "+itos(calls));
 	calls=0;
+
+#ifdef DEBUG_ENABLED
+	if (profiling) {
+
+		lock->lock();
+
+		for(Set<GDFunction*>::Element *E=function_list.front();E;E=E->next()) {
+
+			GDFunction::Profile &profile=E->get()->profile;
+			profile.last_frame_call_count=profile.frame_call_count;
+			profile.last_frame_self_time=profile.frame_self_time;
+			profile.last_frame_total_time=profile.frame_total_time;
+			profile.frame_call_count=0;
+			profile.frame_self_time=0;
+			profile.frame_total_time=0;
+		}
+
+		lock->unlock();
+	}
+#endif
+}
+
+/* PROFILER FUNCTIONS */
+
+void GDScriptLanguage::add_profiled_function(GDFunction *p_function) {
+
+#ifdef DEBUG_ENABLED
+	lock->lock();
+	function_list.insert(p_function);
+	lock->unlock();
+#endif
+}
+
+void GDScriptLanguage::remove_profiled_function(GDFunction *p_function) {
+
+#ifdef DEBUG_ENABLED
+	lock->lock();
+	function_list.erase(p_function);
+	lock->unlock();
+#endif
+}
+
+void GDScriptLanguage::profiling_start() {
+
+#ifdef DEBUG_ENABLED
+	lock->lock();
+
+	for(Set<GDFunction*>::Element *E=function_list.front();E;E=E->next()) {
+
+		GDFunction::Profile &profile=E->get()->profile;
+		profile.call_count=0;
+		profile.self_time=0;
+		profile.total_time=0;
+		profile.frame_call_count=0;
+		profile.frame_self_time=0;
+		profile.frame_total_time=0;
+		profile.last_frame_call_count=0;
+		profile.last_frame_self_time=0;
+		profile.last_frame_total_time=0;
+	}
+
+	profiling=true;
+	lock->unlock();
+#endif
+}
+
+void GDScriptLanguage::profiling_stop() {
+
+#ifdef DEBUG_ENABLED
+	lock->lock();
+	profiling=false;
+	lock->unlock();
+#endif
+}
+
+bool GDScriptLanguage::is_profiling() const {
+
+#ifdef DEBUG_ENABLED
+	return profiling;
+#else
+	return false;
+#endif
+}
+
+int GDScriptLanguage::profiling_get_accumulated_data(ProfilingInfo *p_info_arr,int p_info_max) {
+
+	int current=0;
+#ifdef DEBUG_ENABLED
+	lock->lock();
+
+	for(Set<GDFunction*>::Element *E=function_list.front();E && current<p_info_max;E=E->next()) {
+
+		const GDFunction::Profile &profile=E->get()->profile;
+		if (profile.call_count==0)
+			continue;
+		p_info_arr[current].signature=profile.signature;
+		p_info_arr[current].call_count=profile.call_count;
+		p_info_arr[current].self_time=profile.self_time;
+		p_info_arr[current].total_time=profile.total_time;
+		current++;
+	}
+
+	lock->unlock();
+#endif
+	return current;
+}
+
+int GDScriptLanguage::profiling_get_frame_data(ProfilingInfo *p_info_arr,int p_info_max) {
+
+	int current=0;
+#ifdef DEBUG_ENABLED
+	lock->lock();
+
+	for(Set<GDFunction*>::Element *E=function_list.front();E && current<p_info_max;E=E->next()) {
+
+		const GDFunction::Profile &profile=E->get()->profile;
+		if (profile.last_frame_call_count==0)
+			continue;
+		p_info_arr[current].signature=profile.signature;
+		p_info_arr[current].call_count=profile.last_frame_call_count;
+		p_info_arr[current].self_time=profile.last_frame_self_time;
+		p_info_arr[current].total_time=profile.last_frame_total_time;
+		current++;
+	}
+
+	lock->unlock();
+#endif
+	return current;
 }
 
 /* EDITOR FUNCTIONS */
@@ -2581,11 +3656,63 @@ void GDScriptLanguage::get_reserved_words(List<String> *p_words) const  {
 
 }
 
+int GDScriptLanguage::_get_frame_class(uint32_t p_size) const {
+
+	uint32_t class_size=FRAME_POOL_MIN_SIZE;
+	for(int i=0;i<FRAME_POOL_CLASSES;i++) {
+		if (p_size<=class_size)
+			return i;
+		class_size<<=1;
+	}
+	return -1;
+}
+
+uint8_t *GDScriptLanguage::alloc_frame(uint32_t p_size) {
+
+	int fc = _get_frame_class(p_size);
+	if (fc<0)
+		return (uint8_t*)memalloc(p_size);
+
+	frame_lock->lock();
+	void *frame=frame_pool[fc];
+	if (frame) {
+		frame_pool[fc]=*(void**)frame;
+		frame_pool_free[fc]--;
+	}
+	frame_lock->unlock();
+
+	if (!frame)
+		frame=memalloc(FRAME_POOL_MIN_SIZE<<fc);
+	return (uint8_t*)frame;
+}
+
+void GDScriptLanguage::free_frame(uint8_t *p_frame,uint32_t p_size) {
+
+	int fc = _get_frame_class(p_size);
+	if (fc<0) {
+		memfree(p_frame);
+		return;
+	}
+
+	frame_lock->lock();
+	if (frame_pool_free[fc]<FRAME_POOL_MAX_FREE) {
+		*(void**)p_frame=frame_pool[fc];
+		frame_pool[fc]=p_frame;
+		frame_pool_free[fc]++;
+		p_frame=NULL;
+	}
+	frame_lock->unlock();
+
+	if (p_frame)
+		memfree(p_frame);
+}
+
 GDScriptLanguage::GDScriptLanguage() {
 
 	calls=0;
 	ERR_FAIL_COND(singleton);
 	singleton=this;
+	GDFunction::cache_epoch.init(1); //inline caches start at 0, so none of them match
 	strings._init = StaticCString::create("_init");
 	strings._notification = StaticCString::create("_notification");
 	strings._set= StaticCString::create("_set");
@@ -2595,6 +3722,19 @@ GDScriptLanguage::GDScriptLanguage() {
 	_debug_parse_err_line=-1;
 	_debug_parse_err_file="";
 
+	frame_lock=Mutex::create();
+	table_lock=Mutex::create();
+	for(int i=0;i<FRAME_POOL_CLASSES;i++) {
+		frame_pool[i]=NULL;
+		frame_pool_free[i]=0;
+	}
+
+#ifdef DEBUG_ENABLED
+	lock=Mutex::create();
+	profiling=false;
+	profile_call_time=NULL;
+#endif
+
     _debug_call_stack_pos=0;
     int dmcs=GLOBAL_DEF("debug/script_max_call_stack",1024);
     if (ScriptDebugger::get_singleton()) {
@@ -2615,9 +3755,25 @@ GDScriptLanguage::GDScriptLanguage() {
 
 GDScriptLanguage::~GDScriptLanguage() {
 
+	precompiled_scripts.clear();
+
     if (_call_stack)  {
         memdelete_arr(_call_stack);
     }
+
+	for(int i=0;i<FRAME_POOL_CLASSES;i++) {
+		while(frame_pool[i]) {
+			void *next=*(void**)frame_pool[i];
+			memfree(frame_pool[i]);
+			frame_pool[i]=next;
+		}
+	}
+	memdelete(frame_lock);
+	memdelete(table_lock);
+
+#ifdef DEBUG_ENABLED
+    memdelete(lock);
+#endif
     singleton=NULL;
 }
 
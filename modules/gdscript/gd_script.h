@@ -33,17 +33,45 @@
 #include "io/resource_loader.h"
 #include "io/resource_saver.h"
 #include "os/thread.h"
+#include "os/mutex.h"
+#include "safe_refcount.h"
 #include "pair.h"
+#include "set.h"
 class GDInstance;
 class GDScript;
+class MethodBind;
 
 
+struct GDDataType {
+
+	enum Kind {
+		UNTYPED,
+		BUILTIN,
+		NATIVE
+	};
+
+	Kind kind;
+	Variant::Type builtin_type;
+	StringName native_type;
+
+	_FORCE_INLINE_ bool has_type() const { return kind!=UNTYPED; }
+	bool is_type(const Variant& p_variant) const;
+	bool convert(const Variant& p_value,Variant& r_ret) const; ///< false if the value can't be stored with this type, int and float convert implicitly
+	String get_name() const;
+
+	bool operator==(const GDDataType& p_type) const { return kind==p_type.kind && builtin_type==p_type.builtin_type && native_type==p_type.native_type; }
+	bool operator!=(const GDDataType& p_type) const { return !(*this==p_type); }
+
+	GDDataType() { kind=UNTYPED; builtin_type=Variant::NIL; }
+};
+
 
 class GDFunction {
 public:
 
 	enum Opcode {
 		OPCODE_OPERATOR,
+		OPCODE_OPERATOR_VALIDATED, //operand types known at compile time
 		OPCODE_EXTENDS_TEST,
 		OPCODE_SET,
 		OPCODE_GET,
@@ -52,6 +80,8 @@ public:
 		OPCODE_ASSIGN,
 		OPCODE_ASSIGN_TRUE,
 		OPCODE_ASSIGN_FALSE,
+		OPCODE_ASSIGN_TYPED_BUILTIN,
+		OPCODE_ASSIGN_TYPED_NATIVE,
 		OPCODE_CONSTRUCT, //only for basic types!!
 		OPCODE_CONSTRUCT_ARRAY,
 		OPCODE_CONSTRUCT_DICTIONARY,
@@ -60,6 +90,7 @@ public:
 		OPCODE_CALL_BUILT_IN,
 		OPCODE_CALL_SELF,
 		OPCODE_CALL_SELF_BASE,
+		OPCODE_CALL_METHOD_BIND,
 		OPCODE_YIELD,
 		OPCODE_YIELD_SIGNAL,
 		OPCODE_YIELD_RESUME,
@@ -70,6 +101,8 @@ public:
 		OPCODE_RETURN,
 		OPCODE_ITERATE_BEGIN,
 		OPCODE_ITERATE,
+		OPCODE_ITERATE_RANGE_BEGIN, //for over range(), without creating the array
+		OPCODE_ITERATE_RANGE,
 		OPCODE_ASSERT,
 		OPCODE_LINE,
 		OPCODE_END
@@ -98,8 +131,70 @@ public:
         StringName identifier;
     };
 
+	/* Remembers what a named get/set or a call resolved to for the last
+	   few scripts or native types seen at one instruction. */
+	struct InlineCache {
+
+		enum {
+			MAX_ENTRIES=4
+		};
+
+		struct Entry {
+
+			const GDScript *script; //NULL for native types
+			StringName type;
+			const void *target; //MemberInfo, GDFunction or MethodBind, NULL when the lookup can't be cached
+		};
+
+		uint32_t epoch;
+		int next;
+		Entry entries[MAX_ENTRIES];
+
+		InlineCache() { epoch=0; next=0; for(int i=0;i<MAX_ENTRIES;i++) { entries[i].script=NULL; entries[i].target=NULL; } }
+	};
+
+	/* A direct evaluator chosen at compile time, with the operand types it
+	   was chosen for. Typed slots can still hold other types at run time. */
+	struct OperatorFunc {
+
+		Variant::OperatorEvaluator func;
+		Variant::Operator op;
+		Variant::Type type_a;
+		Variant::Type type_b;
+	};
+
 private:
 friend class GDCompiler;
+friend class GDCompiledScript;
+friend class GDScriptLanguage;
+
+	/* Keeps a packed array locked while a for loop walks it, instead of
+	   locking it again for every element. One per for loop nesting level. */
+	struct IteratorLock {
+
+		Variant::Type type; //NIL when nothing is locked
+		Variant array; //holds a reference, so writes to the array copy it instead of moving it
+		union {
+			uint8_t read[sizeof(DVector<uint8_t>::Read)]; //DVector<T>::Read of the locked type
+			void *_align;
+		};
+		const void *ptr;
+		int size;
+
+		template<class T>
+		void _lock(const DVector<T>& p_array);
+		template<class T>
+		void _unlock();
+
+		bool lock(const Variant& p_array);
+		void unlock();
+		_FORCE_INLINE_ void get(int p_idx,Variant& r_dst) const;
+
+		IteratorLock() { type=Variant::NIL; ptr=NULL; size=0; }
+		~IteratorLock() { unlock(); }
+	};
+
+	static SafeRefCount cache_epoch; //bumped from any thread that loads or frees a script
 
 	StringName source;
 
@@ -110,11 +205,18 @@ friend class GDCompiler;
 	int _global_names_count;
 	const int *_default_arg_ptr;
 	int _default_arg_count;
+	const OperatorFunc *_operator_funcs_ptr;
+	int _operator_funcs_count;
+	MethodBind * const *_methods_ptr;
+	int _methods_count;
+	InlineCache *_caches_ptr;
+	int _cache_count;
 	const int *_code_ptr;
 	int _code_size;
 	int _argument_count;
 	int _stack_size;
 	int _call_size;
+	int _iterator_lock_count;
 	int _initial_line;
 	bool _static;
 	GDScript *_script;
@@ -123,10 +225,27 @@ friend class GDCompiler;
 	Vector<Variant> constants;
 	Vector<StringName> global_names;
 	Vector<int> default_arguments;
+	Vector<OperatorFunc> operator_funcs;
+	Vector<MethodBind*> methods;
+	Vector<InlineCache> caches;
 	Vector<int> code;
 #ifdef DEBUG_ENABLED
 	CharString func_cname;
 	const char*_func_cname;
+
+	struct Profile {
+
+		StringName signature;
+		uint64_t call_count;
+		uint64_t self_time;
+		uint64_t total_time;
+		uint64_t frame_call_count;
+		uint64_t frame_self_time;
+		uint64_t frame_total_time;
+		uint64_t last_frame_call_count;
+		uint64_t last_frame_self_time;
+		uint64_t last_frame_total_time;
+	} profile;
 #endif
 
 #ifdef TOOLS_ENABLED
@@ -137,6 +256,8 @@ friend class GDCompiler;
 
 	_FORCE_INLINE_ Variant *_get_variant(int p_address,GDInstance *p_instance,GDScript *p_script,Variant &self,Variant *p_stack,String& r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Variant::CallError& p_err, const String& p_where,const Variant**argptrs) const;
+	_FORCE_INLINE_ bool _cache_lookup(const InlineCache& p_cache,Object *p_object,GDInstance *p_instance,const void *&r_target) const;
+	void _cache_store(InlineCache& p_cache,Object *p_object,GDInstance *p_instance,const void *p_target);
 
 
 public:
@@ -144,7 +265,7 @@ public:
 	struct CallState {
 
 		GDInstance *instance;
-		Vector<uint8_t> stack;
+		uint8_t *stack; //frame from GDScriptLanguage::alloc_frame, owned by the state
 		int stack_size;
 		Variant self;
 		uint32_t alloca_size;
@@ -162,6 +283,7 @@ public:
 	int get_code_size() const;
 	Variant get_constant(int p_idx) const;
 	StringName get_global_name(int p_idx) const;
+	MethodBind *get_method_bind(int p_idx) const;
 	StringName get_name() const;
 	int get_max_stack_size() const;
 	int get_default_argument_count() const;
@@ -188,7 +310,10 @@ public:
 
 	Variant call(GDInstance *p_instance,const Variant **p_args, int p_argcount,Variant::CallError& r_err,CallState *p_state=NULL);
 
+	static void invalidate_caches() { cache_epoch.ref(); } ///< call when script members or functions change, from any thread
+
 	GDFunction();
+	~GDFunction();
 };
 
 
@@ -199,6 +324,7 @@ friend class GDFunction;
 	GDFunction *function;
 	GDFunction::CallState state;
 	Variant _signal_callback(const Variant** p_args, int p_argcount, Variant::CallError& r_error);
+	void _free_stack();
 protected:
 	static void _bind_methods();
 public:
@@ -241,13 +367,16 @@ class GDScript : public Script {
 		int index;
 		StringName setter;
 		StringName getter;
+		GDDataType data_type;
 	};
 
 friend class GDInstance;
 friend class GDFunction;
 friend class GDCompiler;
+friend class GDCompiledScript;
 friend class GDFunctions;
 friend class GDScriptLanguage;
+friend class GDPrecompiler;
 
 	Variant _static_ref; //used for static call
 	Ref<GDNativeClass> native;
@@ -289,6 +418,9 @@ friend class GDScriptLanguage;
 
 	void _set_subclass_path(Ref<GDScript>& p_sc,const String& p_path);
 
+	Error _reload(String& r_error,int& r_error_line); ///< parse and compile, errors are left to the caller
+	void _report_error(Error p_err,const String& p_error,int p_error_line);
+
 #ifdef TOOLS_ENABLED
 	Set<PlaceHolderScriptInstance*> placeholders;
 	//void _update_placeholder(PlaceHolderScriptInstance *p_placeholder);
@@ -348,6 +480,7 @@ public:
 	virtual ScriptLanguage *get_language() const;
 
 	GDScript();
+	~GDScript();
 };
 
 class GDInstance : public ScriptInstance {
@@ -419,6 +552,38 @@ class GDScriptLanguage : public ScriptLanguage {
 
 	void _add_global(const StringName& p_name,const Variant& p_value);
 
+	/* Guards writes to the global table and the instance sets of scripts,
+	   which workers touch too. Globals are only added from init(), before
+	   any script runs, so reading them takes no lock. */
+	Mutex *table_lock;
+
+	List<Ref<GDScript> > precompiled_scripts; //kept loaded for the whole run
+
+	/* Frames of yielded functions are recycled, so coroutines that yield
+	   every frame don't allocate a new stack each time. */
+	enum {
+		FRAME_POOL_MIN_SIZE=256,
+		FRAME_POOL_CLASSES=8, //256 bytes to 32 kb, larger frames are not pooled
+		FRAME_POOL_MAX_FREE=256 //per size class
+	};
+
+	Mutex *frame_lock;
+	void *frame_pool[FRAME_POOL_CLASSES]; //free frames, linked through their first bytes
+	int frame_pool_free[FRAME_POOL_CLASSES];
+
+	_FORCE_INLINE_ int _get_frame_class(uint32_t p_size) const;
+
+friend class GDFunction;
+friend class GDScript;
+friend class GDInstance;
+
+#ifdef DEBUG_ENABLED
+	Mutex *lock;
+	Set<GDFunction*> function_list;
+	bool profiling;
+	uint64_t *profile_call_time; // time spent in callees by the function being profiled
+#endif
+
 
 public:
 
@@ -487,6 +652,9 @@ public:
 
 	_FORCE_INLINE_ static GDScriptLanguage *get_singleton() { return singleton; }
 
+	uint8_t *alloc_frame(uint32_t p_size);
+	void free_frame(uint8_t *p_frame,uint32_t p_size);
+
 	virtual String get_name() const;
 
 	/* LANGUAGE FUNCTIONS */
@@ -526,6 +694,17 @@ public:
 	virtual void get_public_functions(List<MethodInfo> *p_functions) const;
 	virtual void get_public_constants(List<Pair<String,Variant> > *p_constants) const;
 
+	/* PROFILER FUNCTIONS */
+
+	void add_profiled_function(GDFunction *p_function);
+	void remove_profiled_function(GDFunction *p_function);
+
+	virtual void profiling_start();
+	virtual void profiling_stop();
+	virtual bool is_profiling() const;
+	virtual int profiling_get_accumulated_data(ProfilingInfo *p_info_arr,int p_info_max);
+	virtual int profiling_get_frame_data(ProfilingInfo *p_info_arr,int p_info_max);
+
 	/* LOADER FUNCTIONS */
 
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
@@ -542,6 +721,7 @@ public:
 	virtual void get_recognized_extensions(List<String> *p_extensions) const;
 	virtual bool handles_type(const String& p_type) const;
 	virtual String get_resource_type(const String &p_path) const;
+	virtual bool is_thread_safe() const { return true; } //preloads go through ResourceLoader, which hands them to the main thread if needed
 
 };
 
@@ -111,7 +111,8 @@ const char* GDTokenizer::token_names[TK_MAX]={
 "'\\n'",
 "Error",
 "EOF",
-"Cursor"};
+"Cursor",
+"'->'"};
 
 const char *GDTokenizer::get_token_name(Token p_token) {
 
@@ -513,6 +514,9 @@ void GDTokenizerText::_advance() {
 				if (GETCHAR(1)=='=') {
 					_make_token(TK_OP_ASSIGN_SUB);
 					INCPOS(1);
+				} else if (GETCHAR(1)=='>') {
+					_make_token(TK_FORWARD_ARROW);
+					INCPOS(1);
 				//}  else if (GETCHAR(1)=='-') {
 				//	_make_token(TK_OP_MINUS_MINUS);
 				//	INCPOS(1);
@@ -1036,7 +1040,7 @@ void GDTokenizerText::advance(int p_amount) {
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
-#define BYTECODE_VERSION 3
+#define BYTECODE_VERSION 4
 
 Error GDTokenizerBuffer::set_code_buffer(const Vector<uint8_t> & p_buffer) {
 
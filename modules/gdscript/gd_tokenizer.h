@@ -119,6 +119,7 @@ public:
 		TK_ERROR,
 		TK_EOF,
 		TK_CURSOR, //used for code completion
+		TK_FORWARD_ARROW, //appended to keep older bytecode valid
 		TK_MAX
 	};
 
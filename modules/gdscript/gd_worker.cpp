@@ -0,0 +1,263 @@
+/*************************************************************************/
+/*  gd_worker.cpp                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "gd_worker.h"
+#include "gd_script.h"
+
+static _THREAD_LOCAL GDScriptWorker *_current_worker=NULL;
+
+GDScriptWorker *GDScriptWorker::get_current() {
+
+	return _current_worker;
+}
+
+void GDScriptWorker::_start_func(void *ud) {
+
+	GDScriptWorker *w=(GDScriptWorker*)ud;
+
+	Object *obj=w->target;
+	Vector<const Variant*> argptrs;
+	argptrs.resize(w->args.size());
+	for(int i=0;i<w->args.size();i++)
+		argptrs[i]=&w->args[i];
+
+	_current_worker=w;
+	Variant::CallError ce;
+	w->ret=obj->call(w->target_method,argptrs.size()?&argptrs[0]:NULL,argptrs.size(),ce);
+	_current_worker=NULL;
+	w->finished=true;
+
+	if (ce.error!=Variant::CallError::CALL_OK) {
+
+		String reason;
+		switch(ce.error) {
+			case Variant::CallError::CALL_ERROR_INVALID_ARGUMENT: {
+
+				reason="Invalid Argument #"+itos(ce.argument);
+			} break;
+			case Variant::CallError::CALL_ERROR_TOO_MANY_ARGUMENTS: {
+
+				reason="Too Many Arguments";
+			} break;
+			case Variant::CallError::CALL_ERROR_TOO_FEW_ARGUMENTS: {
+
+				reason="Too Few Arguments";
+			} break;
+			case Variant::CallError::CALL_ERROR_INVALID_METHOD: {
+
+				reason="Method Not Found";
+			} break;
+			default: {}
+		}
+
+		ERR_EXPLAIN("Could not call function '"+w->target_method.operator String()+"' on worker. Reason: "+reason);
+		ERR_FAIL();
+	}
+}
+
+void GDScriptWorker::_add(Object *p_object,bool p_keep) {
+
+	Allowed a;
+	a.id=p_object->get_instance_ID();
+	if (p_keep) {
+		Reference *r = p_object->cast_to<Reference>();
+		if (r)
+			a.ref=REF(r);
+	}
+	objects[p_object]=a;
+}
+
+void GDScriptWorker::allow(Object *p_object) {
+
+	ERR_FAIL_COND(active);
+	ERR_FAIL_NULL(p_object);
+	_add(p_object,true);
+}
+
+bool GDScriptWorker::_isolate(const Variant& p_value,Variant& r_copy,int p_depth) {
+
+	if (p_depth>64)
+		return false; //arrays containing themselves can't be copied
+
+	switch(p_value.get_type()) {
+
+		case Variant::ARRAY: {
+
+			Array src=p_value;
+			Array dst(src.is_shared());
+			dst.resize(src.size());
+			for(int i=0;i<src.size();i++) {
+				if (!_isolate(src[i],dst[i],p_depth+1))
+					return false;
+			}
+			r_copy=dst;
+		} break;
+		case Variant::DICTIONARY: {
+
+			Dictionary src=p_value;
+			Dictionary dst(src.is_shared());
+			List<Variant> keys;
+			src.get_key_list(&keys);
+			for(List<Variant>::Element *E=keys.front();E;E=E->next()) {
+				Variant key,value;
+				if (!_isolate(E->get(),key,p_depth+1) || !_isolate(src[E->get()],value,p_depth+1))
+					return false;
+				dst[key]=value;
+			}
+			r_copy=dst;
+		} break;
+		default: {
+
+			r_copy=p_value; //everything else is copied by value, or is an object checked when used
+		}
+	}
+
+	return true;
+}
+
+Error GDScriptWorker::start(Object *p_instance,const StringName& p_method,const Array& p_args) {
+
+	ERR_FAIL_COND_V(active,ERR_ALREADY_IN_USE);
+	ERR_FAIL_COND_V(!p_instance,ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(p_method==StringName(),ERR_INVALID_PARAMETER);
+
+	Reference *r = p_instance->cast_to<Reference>();
+	if (r)
+		target=REF(r);
+	else
+		target=p_instance;
+	Variant copy;
+	if (!_isolate(p_args,copy)) {
+		target=Variant();
+		ERR_EXPLAIN("Worker arguments are nested too deep, or contain themselves.");
+		ERR_FAIL_V(ERR_INVALID_PARAMETER);
+	}
+
+	target_method=p_method;
+	args=copy; //own copy, the caller may keep modifying its containers
+	ret=Variant();
+	finished=false;
+	_add(p_instance,false); //target already holds it
+	active=true;
+
+	thread = Thread::create(_start_func,this);
+	if (!thread) {
+		active=false;
+		target=Variant();
+		target_method=StringName();
+		args=Array();
+		return ERR_CANT_CREATE;
+	}
+
+	return OK;
+}
+
+bool GDScriptWorker::is_active() const {
+
+	return active;
+}
+
+bool GDScriptWorker::is_finished() const {
+
+	return active && finished;
+}
+
+Variant GDScriptWorker::wait_to_finish() {
+
+	ERR_FAIL_COND_V(!thread,Variant());
+	ERR_FAIL_COND_V(!active,Variant());
+	Thread::wait_to_finish(thread);
+	memdelete(thread);
+	Variant r = ret;
+	active=false;
+	target=Variant();
+	target_method=StringName();
+	args=Array();
+	ret=Variant();
+	thread=NULL;
+
+	return r;
+}
+
+bool GDScriptWorker::can_access(const Variant& p_value) const {
+
+	if (p_value.get_type()!=Variant::OBJECT)
+		return true;
+
+	Object *obj=p_value;
+	if (!obj)
+		return true; //calls on null fail on their own
+
+	//look up the pointer before touching the object, it may have been freed
+	const Map<Object*,Allowed>::Element *E=objects.find(obj);
+	if (E)
+		return ObjectDB::get_instance(E->get().id)==obj;
+
+	if (!p_value.is_ref())
+		return false; //someone else's object, which may be gone already
+
+	//classes are shared by everyone, calling new() on them is fine
+	return obj->cast_to<GDNativeClass>() || obj->cast_to<Script>();
+}
+
+int GDScriptWorker::find_foreign(const Variant **p_args,int p_argc) const {
+
+	for(int i=0;i<p_argc;i++) {
+
+		if (!can_access(*p_args[i]))
+			return i;
+	}
+	return -1;
+}
+
+void GDScriptWorker::add_object(Object *p_object) {
+
+	_add(p_object,false);
+}
+
+void GDScriptWorker::_bind_methods() {
+
+	ObjectTypeDB::bind_method(_MD("allow","object"),&GDScriptWorker::allow);
+	ObjectTypeDB::bind_method(_MD("start:Error","instance","method","args"),&GDScriptWorker::start,DEFVAL(Array()));
+	ObjectTypeDB::bind_method(_MD("is_active"),&GDScriptWorker::is_active);
+	ObjectTypeDB::bind_method(_MD("is_finished"),&GDScriptWorker::is_finished);
+	ObjectTypeDB::bind_method(_MD("wait_to_finish:var"),&GDScriptWorker::wait_to_finish);
+}
+
+GDScriptWorker::GDScriptWorker() {
+
+	thread=NULL;
+	active=false;
+	finished=false;
+}
+
+GDScriptWorker::~GDScriptWorker() {
+
+	if (active)
+		wait_to_finish();
+}
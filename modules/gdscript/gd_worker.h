@@ -0,0 +1,96 @@
+/*************************************************************************/
+/*  gd_worker.h                                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef GD_WORKER_H
+#define GD_WORKER_H
+
+#include "reference.h"
+#include "os/thread.h"
+#include "map.h"
+
+/* Runs a script function on its own thread. Besides its own instance, the
+   function may only touch the objects it was given with allow() and the
+   ones it creates itself (and classes), the VM refuses any other object.
+   Objects are looked up by pointer and checked against their ID, so one
+   that was freed meanwhile is refused instead of dereferenced. Inline
+   caches are not used from other threads than the main one, so workers
+   and the main thread never write to the same bytecode.
+
+   Arguments are deep copied when starting, so arrays and dictionaries
+   given to the worker are its own. The members of the target instance
+   are not copied: they stay shared with the main thread without any
+   locking, and must be left alone by one side while the worker runs. */
+
+class GDScriptWorker : public Reference {
+
+	OBJ_TYPE(GDScriptWorker,Reference);
+
+	Thread *thread;
+	volatile bool active;
+	volatile bool finished;
+	Variant target; //keeps references alive while running
+	StringName target_method;
+	Array args;
+	Variant ret;
+
+	struct Allowed {
+
+		ObjectID id;
+		Variant ref; //keeps given references alive while the worker exists
+	};
+
+	Map<Object*,Allowed> objects;
+
+	void _add(Object *p_object,bool p_keep);
+	static bool _isolate(const Variant& p_value,Variant& r_copy,int p_depth=0);
+
+	static void _start_func(void *ud);
+
+protected:
+
+	static void _bind_methods();
+
+public:
+
+	void allow(Object *p_object);
+	Error start(Object *p_instance,const StringName& p_method,const Array& p_args=Array());
+	bool is_active() const; ///< started and not waited for yet
+	bool is_finished() const; ///< the function returned, wait_to_finish() won't block
+	Variant wait_to_finish();
+
+	bool can_access(const Variant& p_value) const;
+	int find_foreign(const Variant **p_args,int p_argc) const; ///< index of the first argument the worker can't access, -1 if none
+	void add_object(Object *p_object); ///< objects created while running belong to the worker
+
+	static GDScriptWorker *get_current(); ///< worker running on the calling thread, if any
+
+	GDScriptWorker();
+	~GDScriptWorker();
+};
+
+#endif // GD_WORKER_H
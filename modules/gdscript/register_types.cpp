@@ -12,6 +12,7 @@
 #include "register_types.h"
 
 #include "gd_script.h"
+#include "gd_worker.h"
 #include "io/resource_loader.h"
 #include "os/file_access.h"
 #include "io/file_access_encrypted.h"
@@ -26,6 +27,8 @@ ResourceFormatSaverGDScript *resource_saver_gd=NULL;
 
 #include "tools/editor/editor_import_export.h"
 #include "gd_tokenizer.h"
+#include "gd_compiled_script.h"
+#include "gd_precompiler.h"
 #include "tools/editor/editor_node.h"
 #include "tools/editor/editor_settings.h"
 
@@ -33,8 +36,33 @@ class EditorExportGDScript : public EditorExportPlugin {
 
 	OBJ_TYPE(EditorExportGDScript,EditorExportPlugin);
 
+	List<Ref<GDScript> > precompiled; //kept loaded while exporting
+
 public:
 
+	virtual void export_begin(const Vector<StringName>& p_files,const Ref<EditorExportPlatform> &p_platform) {
+
+		if (EditorImportExport::get_singleton()->script_get_action()==EditorImportExport::SCRIPT_ACTION_NONE)
+			return;
+
+		//compile the exported scripts all at once, custom_export then finds them loaded
+		List<String> paths;
+		for(int i=0;i<p_files.size();i++) {
+
+			if (String(p_files[i]).ends_with(".gd"))
+				paths.push_back(p_files[i]);
+		}
+
+		GDPrecompiler precompiler;
+		precompiler.set_cache_dir(EditorSettings::get_singleton()->get_settings_path().plus_file("tmp/script_cache"));
+		precompiler.precompile(paths,&precompiled);
+	}
+
+	virtual void export_end() {
+
+		precompiled.clear();
+	}
+
 	virtual Vector<uint8_t> custom_export(String& p_path,const Ref<EditorExportPlatform> &p_platform) {
 		//compile gdscript to bytecode
 
@@ -50,6 +78,14 @@ public:
 
 				if (!file.empty()) {
 
+					//ship the compiled script too, the tokens remain as fallback
+					Ref<GDScript> script = ResourceLoader::load(p_path);
+					if (script.is_valid()) {
+						Vector<uint8_t> compiled = GDCompiledScript::save(script,file);
+						if (!compiled.empty())
+							file=compiled;
+					}
+
 					if (EditorImportExport::get_singleton()->script_get_action()==EditorImportExport::SCRIPT_ACTION_ENCRYPT) {
 
 						String tmp_path=EditorSettings::get_singleton()->get_settings_path().plus_file("tmp/script.gde");
@@ -123,6 +159,7 @@ void register_gdscript_types() {
 
 	ObjectTypeDB::register_type<GDScript>();
 	ObjectTypeDB::register_virtual_type<GDFunctionState>();
+	ObjectTypeDB::register_type<GDScriptWorker>();
 
 	script_language_gd=memnew( GDScriptLanguage );
 	//script_language_gd->init();
@@ -46,6 +46,7 @@ void *ThreadAndroid::thread_callback(void *userdata) {
 	setup_thread();
 	t->id=(ID)pthread_self();
 	t->callback(t->user);
+	thread_exited();
 	return NULL;
 }
 
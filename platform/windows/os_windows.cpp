@@ -31,6 +31,7 @@
 #include "os_windows.h"
 #include "drivers/nedmalloc/memory_pool_static_nedmalloc.h"
 #include "drivers/unix/memory_pool_static_malloc.h"
+#include "os/memory_pool_static_size_class.h"
 #include "os/memory_pool_dynamic_static.h"
 #include "drivers/windows/thread_windows.h"
 #include "drivers/windows/semaphore_windows.h"
@@ -188,7 +189,11 @@ void OS_Windows::initialize_core() {
 	StreamPeerWinsock::make_default();
 	PacketPeerUDPWinsock::make_default();
 	
+#ifdef SIZE_CLASS_MEMORY_POOL_ENABLED
+	mempool_static = new MemoryPoolStaticSizeClass;
+#else
 	mempool_static = new MemoryPoolStaticMalloc;
+#endif
 #if 1
 	mempool_dynamic = memnew( MemoryPoolDynamicStatic );
 #else
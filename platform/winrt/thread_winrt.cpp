@@ -2,10 +2,16 @@
 
 #include "os/memory.h"
 
+static void _thread_func_winrt(ThreadCreateCallback p_callback,void *p_user) {
+
+	p_callback(p_user);
+	Thread::thread_exited();
+}
+
 Thread* ThreadWinrt::create_func_winrt(ThreadCreateCallback p_callback,void *p_user,const Settings&) {
 
 	ThreadWinrt* thread = memnew(ThreadWinrt);
-	std::thread new_thread(p_callback, p_user);
+	std::thread new_thread(_thread_func_winrt, p_callback, p_user);
 	std::swap(thread->thread, new_thread);
 
 	return thread;
@@ -1056,7 +1056,7 @@ bool Node::is_in_group(const StringName& p_identifier) const {
 
 void Node::add_to_group(const StringName& p_identifier,bool p_persistent) {
 	
-	ERR_FAIL_COND(!p_identifier.operator String().length());
+	ERR_FAIL_COND(!p_identifier);
 	
 	if (data.grouped.has(p_identifier))
 		return;
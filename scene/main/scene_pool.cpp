@@ -0,0 +1,271 @@
+/*************************************************************************/
+/*  scene_pool.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "scene_pool.h"
+#include "globals.h"
+
+ScenePool *ScenePool::singleton=NULL;
+
+ScenePool *ScenePool::get_singleton() {
+
+	return singleton;
+}
+
+void ScenePool::_reset(Node *p_node) {
+
+	ScriptInstance *si=p_node->get_script_instance();
+	if (si && si->has_method(reset_func)) {
+		Variant::CallError ce;
+		si->call(reset_func,NULL,0,ce);
+	}
+
+	for(int i=0;i<p_node->get_child_count();i++)
+		_reset(p_node->get_child(i));
+}
+
+Node *ScenePool::_take(Pool &p_pool) {
+
+	while(p_pool.nodes.size()) {
+
+		ObjectID id=p_pool.nodes[p_pool.nodes.size()-1];
+		p_pool.nodes.resize(p_pool.nodes.size()-1);
+		Object *obj=ObjectDB::get_instance(id);
+		if (obj)
+			return static_cast<Node*>(obj);
+	}
+
+	return NULL;
+}
+
+void ScenePool::_prune_active() {
+
+	//instances freed without being released are only noticed here
+	List<ObjectID> freed;
+	for(Map<ObjectID,ObjectID>::Element *E=active.front();E;E=E->next()) {
+		if (!ObjectDB::get_instance(E->key()))
+			freed.push_back(E->key());
+	}
+
+	for(List<ObjectID>::Element *E=freed.front();E;E=E->next())
+		active.erase(E->get());
+
+	active_prune_size=MAX(64,active.size()*2);
+}
+
+Node *ScenePool::instance(const Ref<PackedScene>& p_scene) {
+
+	ERR_FAIL_COND_V(p_scene.is_null(),NULL);
+
+	ObjectID id=p_scene->get_instance_ID();
+	Map<ObjectID,Pool>::Element *E=pools.find(id);
+	if (!E) {
+		Pool pool;
+		pool.scene=p_scene;
+		E=pools.insert(id,pool);
+	}
+
+	Node *node=_take(E->get());
+
+	if (node) {
+
+		hits++;
+		_reset(node);
+
+	} else {
+
+		node=p_scene->instance();
+		ERR_FAIL_COND_V(!node,NULL);
+		misses++;
+	}
+
+	if (active.size()>=active_prune_size)
+		_prune_active();
+	active[node->get_instance_ID()]=id;
+
+	return node;
+}
+
+void ScenePool::release(Node *p_node) {
+
+	ERR_FAIL_NULL(p_node);
+
+	Map<ObjectID,ObjectID>::Element *A=active.find(p_node->get_instance_ID());
+	if (!A) {
+		ERR_EXPLAIN("Node was not instanced from the scene pool: "+String(p_node->get_name()));
+		ERR_FAIL();
+	}
+
+	ObjectID scene=A->get();
+	active.erase(A);
+
+	if (p_node->get_parent()) {
+		//may be released from a callback of the tree itself, detach once idle
+		call_deferred("_detach_released",p_node->get_instance_ID(),scene);
+		return;
+	}
+
+	_pool(p_node,scene);
+}
+
+void ScenePool::_detach_released(ObjectID p_node,ObjectID p_scene) {
+
+	Object *obj=ObjectDB::get_instance(p_node);
+	if (!obj)
+		return; //freed meanwhile
+
+	Node *node=static_cast<Node*>(obj);
+	if (node->get_parent())
+		node->get_parent()->remove_child(node);
+
+	_pool(node,p_scene);
+}
+
+void ScenePool::_pool(Node *p_node,ObjectID p_scene) {
+
+	Map<ObjectID,Pool>::Element *E=pools.find(p_scene);
+
+	if (!E || E->get().nodes.size()>=max_pooled) {
+		//pool is full (or was cleared), free it as usual
+		discarded++;
+		memdelete(p_node);
+		return;
+	}
+
+	E->get().nodes.push_back(p_node->get_instance_ID());
+}
+
+void ScenePool::prefill(const Ref<PackedScene>& p_scene,int p_count) {
+
+	ERR_FAIL_COND(p_scene.is_null());
+
+	ObjectID id=p_scene->get_instance_ID();
+	Map<ObjectID,Pool>::Element *E=pools.find(id);
+	if (!E) {
+		Pool pool;
+		pool.scene=p_scene;
+		E=pools.insert(id,pool);
+	}
+
+	int count=MIN(p_count,max_pooled);
+	while(E->get().nodes.size()<count) {
+
+		Node *node=p_scene->instance();
+		ERR_FAIL_COND(!node);
+		E->get().nodes.push_back(node->get_instance_ID());
+	}
+}
+
+int ScenePool::get_pooled_count(const Ref<PackedScene>& p_scene) const {
+
+	ERR_FAIL_COND_V(p_scene.is_null(),0);
+
+	const Map<ObjectID,Pool>::Element *E=pools.find(p_scene->get_instance_ID());
+	if (!E)
+		return 0;
+	return E->get().nodes.size();
+}
+
+void ScenePool::clear() {
+
+	for(Map<ObjectID,Pool>::Element *E=pools.front();E;E=E->next()) {
+
+		const Vector<ObjectID> &nodes=E->get().nodes;
+		for(int i=0;i<nodes.size();i++) {
+			Object *obj=ObjectDB::get_instance(nodes[i]);
+			if (obj)
+				memdelete(obj);
+		}
+	}
+
+	pools.clear();
+}
+
+void ScenePool::set_max_pooled(int p_max) {
+
+	ERR_FAIL_COND(p_max<0);
+	max_pooled=p_max;
+}
+
+int ScenePool::get_max_pooled() const {
+
+	return max_pooled;
+}
+
+uint64_t ScenePool::get_hit_count() const {
+
+	return hits;
+}
+
+uint64_t ScenePool::get_miss_count() const {
+
+	return misses;
+}
+
+uint64_t ScenePool::get_discarded_count() const {
+
+	return discarded;
+}
+
+void ScenePool::reset_stats() {
+
+	hits=0;
+	misses=0;
+	discarded=0;
+}
+
+void ScenePool::_bind_methods() {
+
+	ObjectTypeDB::bind_method(_MD("instance:Node","scene:PackedScene"),&ScenePool::instance);
+	ObjectTypeDB::bind_method(_MD("release","node:Node"),&ScenePool::release);
+	ObjectTypeDB::bind_method(_MD("prefill","scene:PackedScene","count"),&ScenePool::prefill);
+	ObjectTypeDB::bind_method(_MD("get_pooled_count","scene:PackedScene"),&ScenePool::get_pooled_count);
+	ObjectTypeDB::bind_method(_MD("clear"),&ScenePool::clear);
+	ObjectTypeDB::bind_method(_MD("set_max_pooled","max"),&ScenePool::set_max_pooled);
+	ObjectTypeDB::bind_method(_MD("get_max_pooled"),&ScenePool::get_max_pooled);
+	ObjectTypeDB::bind_method(_MD("get_hit_count"),&ScenePool::get_hit_count);
+	ObjectTypeDB::bind_method(_MD("get_miss_count"),&ScenePool::get_miss_count);
+	ObjectTypeDB::bind_method(_MD("get_discarded_count"),&ScenePool::get_discarded_count);
+	ObjectTypeDB::bind_method(_MD("reset_stats"),&ScenePool::reset_stats);
+
+	ObjectTypeDB::bind_method(_MD("_detach_released"),&ScenePool::_detach_released);
+}
+
+ScenePool::ScenePool() {
+
+	singleton=this;
+	max_pooled=GLOBAL_DEF("application/scene_pool_max_per_scene",64);
+	active_prune_size=64;
+	reset_func="_pool_reset";
+	reset_stats();
+}
+
+ScenePool::~ScenePool() {
+
+	clear();
+	singleton=NULL;
+}
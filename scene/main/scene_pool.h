@@ -0,0 +1,97 @@
+/*************************************************************************/
+/*  scene_pool.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef SCENE_POOL_H
+#define SCENE_POOL_H
+
+#include "scene/resources/packed_scene.h"
+
+/* Keeps instances of short lived scenes (projectiles, pickups..) around
+   once released, and hands them out again instead of instancing anew.
+   Released trees are detached at idle time, like queue_delete(), and
+   only pooled once out of the tree. They keep the state they had when released,
+   scripts reset themselves in _pool_reset(), called on every node of the
+   tree before it is handed out again. */
+
+class ScenePool : public Object {
+
+	OBJ_TYPE(ScenePool,Object);
+
+	struct Pool {
+
+		Ref<PackedScene> scene;
+		Vector<ObjectID> nodes; //a pooled node may still be freed by whoever kept it
+	};
+
+	Map<ObjectID,Pool> pools; //by scene
+	Map<ObjectID,ObjectID> active; //handed out instances to their scene
+	int active_prune_size;
+
+	int max_pooled;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t discarded;
+
+	StringName reset_func;
+
+	static ScenePool *singleton;
+
+	Node *_take(Pool &p_pool);
+	void _pool(Node *p_node,ObjectID p_scene);
+	void _detach_released(ObjectID p_node,ObjectID p_scene);
+	void _reset(Node *p_node);
+	void _prune_active();
+
+protected:
+
+	static void _bind_methods();
+
+public:
+
+	static ScenePool *get_singleton();
+
+	Node *instance(const Ref<PackedScene>& p_scene);
+	void release(Node *p_node);
+
+	void prefill(const Ref<PackedScene>& p_scene,int p_count);
+	int get_pooled_count(const Ref<PackedScene>& p_scene) const;
+	void clear();
+
+	void set_max_pooled(int p_max); ///< per scene
+	int get_max_pooled() const;
+
+	uint64_t get_hit_count() const;
+	uint64_t get_miss_count() const;
+	uint64_t get_discarded_count() const; ///< released while the pool was full
+	void reset_stats();
+
+	ScenePool();
+	~ScenePool();
+};
+
+#endif // SCENE_POOL_H
@@ -152,6 +152,7 @@
 #include "scene/resources/sample.h"
 #include "scene/audio/sample_player.h"
 #include "scene/resources/texture.h"
+#include "scene/resources/streaming_texture.h"
 #include "scene/resources/material.h"
 #include "scene/resources/mesh.h"
 #include "scene/resources/room.h"
@@ -214,6 +215,9 @@
 static ResourceFormatLoaderImage *resource_loader_image=NULL;
 static ResourceFormatLoaderWAV *resource_loader_wav=NULL;
 static ResourceFormatLoaderBitMap *resource_loader_bitmap=NULL;
+static ResourceFormatLoaderStreamingTexture *resource_loader_stex=NULL;
+static ResourceFormatSaverStreamingTexture *resource_saver_stex=NULL;
+static TextureStreamer *texture_streamer=NULL;
 
 #ifdef TOOLS_ENABLED
 
@@ -241,6 +245,14 @@ void register_scene_types() {
 	resource_loader_bitmap = memnew( ResourceFormatLoaderBitMap );
 	ResourceLoader::add_resource_format_loader( resource_loader_bitmap );
 
+	resource_loader_stex = memnew( ResourceFormatLoaderStreamingTexture );
+	ResourceLoader::add_resource_format_loader( resource_loader_stex );
+
+	resource_saver_stex = memnew( ResourceFormatSaverStreamingTexture );
+	ResourceSaver::add_resource_format_saver( resource_saver_stex );
+
+	texture_streamer = memnew( TextureStreamer );
+
 #ifdef TOOLS_ENABLED
 
 	//scene first!
@@ -542,6 +554,7 @@ void register_scene_types() {
 	ObjectTypeDB::register_type<World2D>();
 	ObjectTypeDB::register_virtual_type<Texture>();
 	ObjectTypeDB::register_type<ImageTexture>();
+	ObjectTypeDB::register_type<StreamingTexture>();
 	ObjectTypeDB::register_type<AtlasTexture>();
 	ObjectTypeDB::register_type<LargeTexture>();
 	ObjectTypeDB::register_type<CubeMap>();
@@ -602,6 +615,9 @@ void unregister_scene_types() {
 	memdelete( resource_loader_image );
 	memdelete( resource_loader_wav );
 	memdelete( resource_loader_bitmap );
+	memdelete( texture_streamer );
+	memdelete( resource_loader_stex );
+	memdelete( resource_saver_stex );
 #ifdef TOOLS_ENABLED
 
 
@@ -38,10 +38,61 @@ bool PackedScene::can_instance() const {
 	return nodes.size()>0;
 }
 
+void PackedScene::_compile() {
+
+	compiled_nodes.clear();
+	compiled_binds.clear();
+
+	int nc=nodes.size();
+	compiled_nodes.resize(nc);
+
+	for(int i=0;i<nc;i++) {
+
+		const NodeData &n=nodes[i];
+		CompiledNode &cn=compiled_nodes[i];
+		cn.create=NULL;
+		cn.enabled=true;
+
+		if (n.type<0 || n.type>=names.size())
+			continue; //instance() will complain
+		StringName type=names[n.type];
+		cn.enabled=ObjectTypeDB::is_type_enabled(type);
+
+		if (n.instance>=0 || !ObjectTypeDB::is_type(type,"Node"))
+			continue;
+
+		cn.create=ObjectTypeDB::get_creation_func(type);
+		if (!cn.create)
+			continue;
+
+		//setters are only valid for the type created above
+		cn.setters.resize(n.properties.size());
+		for(int j=0;j<n.properties.size();j++) {
+
+			int name=n.properties[j].name;
+			cn.setters[j] = (name>=0 && name<names.size()) ? ObjectTypeDB::get_property_setter(type,names[name]) : (MethodBind*)NULL;
+		}
+	}
+
+	int cc=connections.size();
+	compiled_binds.resize(cc);
+	for(int i=0;i<cc;i++) {
+
+		const ConnectionData &c=connections[i];
+		Vector<Variant> &binds=compiled_binds[i];
+		binds.resize(c.binds.size());
+		for(int j=0;j<c.binds.size();j++) {
+			if (c.binds[j]>=0 && c.binds[j]<variants.size())
+				binds[j]=variants[c.binds[j]];
+		}
+	}
+}
+
 Node *PackedScene::instance(bool p_gen_edit_state) const {
 
 	int nc = nodes.size();
 	ERR_FAIL_COND_V(nc==0,NULL);
+	ERR_FAIL_COND_V(compiled_nodes.size()!=nc,NULL);
 
 	const StringName*snames=NULL;
 	int sname_count=names.size();
@@ -53,9 +104,8 @@ Node *PackedScene::instance(bool p_gen_edit_state) const {
 	if (prop_count)
 		props=&variants[0];
 
-	Vector<Variant> properties;
-
 	const NodeData *nd = &nodes[0];
+	const CompiledNode *cnd = &compiled_nodes[0];
 
 	Node **ret_nodes=(Node**)alloca( sizeof(Node*)*nc );
 
@@ -63,8 +113,9 @@ Node *PackedScene::instance(bool p_gen_edit_state) const {
 	for(int i=0;i<nc;i++) {
 
 		const NodeData &n=nd[i];
+		const CompiledNode &cn=cnd[i];
 
-		if (!ObjectTypeDB::is_type_enabled(snames[n.type])) {
+		if (!cn.enabled) {
 			ret_nodes[i]=NULL;
 			continue;
 		}
@@ -80,6 +131,10 @@ Node *PackedScene::instance(bool p_gen_edit_state) const {
 			if (p_gen_edit_state)
 				node->generate_instance_state();
 
+		} else if (cn.create) {
+
+			node = static_cast<Node*>(cn.create());
+
 		} else {
 			//create anew
 			Object * obj = ObjectTypeDB::instance(snames[ n.type ]);
@@ -114,6 +169,7 @@ Node *PackedScene::instance(bool p_gen_edit_state) const {
 		if (nprop_count) {
 
 			const NodeData::Property* nprops=&n.properties[0];
+			MethodBind *const* setters = cn.create ? cn.setters.ptr() : NULL;
 
 			for(int j=0;j<nprop_count;j++) {
 
@@ -121,7 +177,18 @@ Node *PackedScene::instance(bool p_gen_edit_state) const {
 				ERR_FAIL_INDEX_V( nprops[j].name, sname_count, NULL );
 				ERR_FAIL_INDEX_V( nprops[j].value, prop_count, NULL );
 
-				node->set(snames[ nprops[j].name ],props[ nprops[j].value ],&valid);
+				//a script, once set, may override any property
+				if (setters && setters[j] && !node->get_script_instance()) {
+
+					const Variant* arg[1]={&props[ nprops[j].value ]};
+					Variant::CallError ce;
+					setters[j]->call(node,arg,1,ce);
+#ifdef TOOLS_ENABLED
+					node->set_edited(true);
+#endif
+				} else {
+					node->set(snames[ nprops[j].name ],props[ nprops[j].value ],&valid);
+				}
 			}
 		}
 
@@ -159,6 +226,7 @@ Node *PackedScene::instance(bool p_gen_edit_state) const {
 
 	int cc = connections.size();
 	const ConnectionData *cdata = connections.ptr();
+	const Vector<Variant> *cbinds = compiled_binds.ptr();
 
 	for(int i=0;i<cc;i++) {
 
@@ -166,16 +234,9 @@ Node *PackedScene::instance(bool p_gen_edit_state) const {
 		ERR_FAIL_INDEX_V( c.from, nc, NULL );
 		ERR_FAIL_INDEX_V( c.to, nc, NULL );
 
-		Vector<Variant> binds;
-		if (c.binds.size()) {
-			binds.resize(c.binds.size());
-			for(int j=0;j<c.binds.size();j++)
-				binds[j]=props[ c.binds[j] ];
-		}
-
 		if (!ret_nodes[c.from] || !ret_nodes[c.to])
 			continue;
-		ret_nodes[c.from]->connect( snames[ c.signal], ret_nodes[ c.to ], snames[ c.method], binds,CONNECT_PERSIST|c.flags );
+		ret_nodes[c.from]->connect( snames[ c.signal], ret_nodes[ c.to ], snames[ c.method], cbinds[i],CONNECT_PERSIST|c.flags );
 	}
 
 	Node *s = ret_nodes[0];
@@ -435,6 +496,8 @@ Error PackedScene::pack(Node *p_scene) {
 		variants[idx]=*K;
 	}
 
+	_compile();
+
 	return OK;
 }
 
@@ -444,6 +507,8 @@ void PackedScene::clear() {
 	variants.clear();
 	nodes.clear();
 	connections.clear();
+	compiled_nodes.clear();
+	compiled_binds.clear();
 
 }
 
@@ -537,6 +602,8 @@ void PackedScene::_set_bundled_scene(const Dictionary& d) {
 
 //	path=d["path"];
 
+	_compile();
+
 }
 
 Dictionary PackedScene::_get_bundled_scene() const {
@@ -77,6 +77,19 @@ class PackedScene : public Resource {
 
 	Vector<ConnectionData> connections;
 
+	//resolved once from the data above, so instance() does no lookups by name
+	struct CompiledNode {
+
+		bool enabled;
+		ObjectTypeDB::CreationFunc create; //NULL if instanced or not a node type
+		Vector<MethodBind*> setters; //one per property, NULL sets it by name
+	};
+
+	Vector<CompiledNode> compiled_nodes;
+	Vector< Vector<Variant> > compiled_binds;
+
+	void _compile();
+
 	Error _parse_node(Node *p_owner,Node *p_node,int p_parent_idx, Map<StringName,int> &name_map,HashMap<Variant,int,VariantHasher> &variant_map,Map<Node*,int> &node_map);
 	Error _parse_connections(Node *p_owner,Node *p_node, Map<StringName,int> &name_map,HashMap<Variant,int,VariantHasher> &variant_map,Map<Node*,int> &node_map);
 
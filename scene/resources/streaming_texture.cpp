@@ -0,0 +1,528 @@
+/*************************************************************************/
+/*  streaming_texture.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "streaming_texture.h"
+#include "os/file_access.h"
+#include "globals.h"
+
+#define STREAM_FORMAT_VERSION 1
+#define STREAM_BASE_SIZE 64 //largest base level, in pixels
+#define STREAM_MAX_SIZE 16384 //same limit as Image
+
+int StreamingTexture::_get_data_size(int p_from_level) const {
+
+	int size=0;
+	for(int i=p_from_level;i<levels.size();i++)
+		size+=levels[i].size;
+	return size;
+}
+
+void StreamingTexture::_upload(int p_level,const DVector<uint8_t>& p_data) {
+
+	const Level &l=levels[p_level];
+	Image img(l.width,l.height,levels.size()-p_level-1,format,p_data);
+	ERR_FAIL_COND(img.empty());
+
+	//allocated at the size of the level, drawn at the full size
+	VisualServer::get_singleton()->texture_allocate(texture,l.width,l.height,format,flags);
+	VisualServer::get_singleton()->texture_set_data(texture,img);
+	VisualServer::get_singleton()->texture_set_size_override(texture,w,h);
+	level=p_level;
+}
+
+Error StreamingTexture::load(const String& p_path) {
+
+	FileAccess *f=FileAccess::open(p_path,FileAccess::READ);
+	ERR_FAIL_COND_V(!f,ERR_CANT_OPEN);
+
+	uint8_t magic[4];
+	f->get_buffer(magic,4);
+	if (magic[0]!='G' || magic[1]!='D' || magic[2]!='S' || magic[3]!='T') {
+		memdelete(f);
+		ERR_EXPLAIN("Not a streaming texture: "+p_path);
+		ERR_FAIL_V(ERR_FILE_UNRECOGNIZED);
+	}
+
+	uint32_t version=f->get_32();
+	if (version>STREAM_FORMAT_VERSION) {
+		memdelete(f);
+		ERR_EXPLAIN("Streaming texture version newer than supported: "+p_path);
+		ERR_FAIL_V(ERR_FILE_UNRECOGNIZED);
+	}
+
+	int width=f->get_32();
+	int height=f->get_32();
+	Image::Format fmt=Image::Format(f->get_32());
+	uint32_t tflags=f->get_32();
+	int level_count=f->get_32();
+	bool valid_fmt = fmt>=0 && fmt<Image::FORMAT_MAX && fmt!=Image::FORMAT_INDEXED && fmt!=Image::FORMAT_INDEXED_ALPHA && fmt!=Image::FORMAT_CUSTOM;
+	if (!valid_fmt || width<1 || width>STREAM_MAX_SIZE || height<1 || height>STREAM_MAX_SIZE || level_count<1 || level_count>Image::get_image_required_mipmaps(width,height,fmt)+1) {
+		memdelete(f);
+		ERR_EXPLAIN("Corrupt streaming texture: "+p_path);
+		ERR_FAIL_V(ERR_FILE_CORRUPT);
+	}
+
+	//levels are written as save_image() lays them out, anything else is corrupt
+	Vector<Level> lv;
+	lv.resize(level_count);
+	int prev_size=0;
+	for(int i=0;i<level_count;i++) {
+		lv[i].width=f->get_32();
+		lv[i].height=f->get_32();
+		lv[i].size=f->get_32();
+
+		int total_size=Image::get_image_data_size(width,height,fmt,i);
+		if (lv[i].width!=MAX(1,width>>i) || lv[i].height!=MAX(1,height>>i) || lv[i].size!=total_size-prev_size) {
+			memdelete(f);
+			ERR_EXPLAIN("Corrupt streaming texture: "+p_path);
+			ERR_FAIL_V(ERR_FILE_CORRUPT);
+		}
+		prev_size=total_size;
+	}
+
+	uint64_t ofs=f->get_pos();
+	for(int i=0;i<level_count;i++) {
+		lv[i].offset=ofs;
+		ofs+=lv[i].size;
+	}
+
+	if (ofs>f->get_len()) {
+		memdelete(f);
+		ERR_EXPLAIN("Corrupt streaming texture: "+p_path);
+		ERR_FAIL_V(ERR_FILE_CORRUPT);
+	}
+
+	//everything past the base level is read later, when drawn
+	int base=0;
+	while(base<level_count-1 && MAX(lv[base].width,lv[base].height)>STREAM_BASE_SIZE)
+		base++;
+
+	levels=lv;
+	format=fmt;
+	flags=tflags;
+	w=width;
+	h=height;
+	base_level=base;
+	file=p_path;
+
+	base_data.resize(_get_data_size(base));
+	{
+		DVector<uint8_t>::Write wr=base_data.write();
+		f->seek(levels[base].offset);
+		f->get_buffer(wr.ptr(),base_data.size());
+	}
+	memdelete(f);
+
+	loading_level=-1;
+	_upload(base_level,base_data);
+
+	return OK;
+}
+
+Error StreamingTexture::save_image(const String& p_path,const Image& p_image,uint32_t p_flags) {
+
+	ERR_FAIL_COND_V(p_image.empty(),ERR_INVALID_PARAMETER);
+	ERR_FAIL_COND_V(p_image.get_format()==Image::FORMAT_INDEXED || p_image.get_format()==Image::FORMAT_INDEXED_ALPHA || p_image.get_format()==Image::FORMAT_CUSTOM,ERR_INVALID_PARAMETER);
+
+	Image img=p_image;
+	if (p_flags&FLAG_MIPMAPS && img.get_mipmaps()==0 && img.get_format()<Image::FORMAT_INDEXED)
+		img.generate_mipmaps();
+
+	FileAccess *f=FileAccess::open(p_path,FileAccess::WRITE);
+	ERR_FAIL_COND_V(!f,ERR_CANT_CREATE);
+
+	int level_count=img.get_mipmaps()+1;
+
+	f->store_buffer((const uint8_t*)"GDST",4);
+	f->store_32(STREAM_FORMAT_VERSION);
+	f->store_32(img.get_width());
+	f->store_32(img.get_height());
+	f->store_32(img.get_format());
+	f->store_32(p_flags);
+	f->store_32(level_count);
+
+	for(int i=0;i<level_count;i++) {
+
+		int ofs,size;
+		img.get_mipmap_offset_and_size(i,ofs,size);
+		f->store_32(MAX(1,img.get_width()>>i));
+		f->store_32(MAX(1,img.get_height()>>i));
+		f->store_32(size);
+	}
+
+	DVector<uint8_t> data=img.get_data();
+	DVector<uint8_t>::Read r=data.read();
+	f->store_buffer(r.ptr(),data.size());
+
+	memdelete(f);
+	return OK;
+}
+
+int StreamingTexture::get_width() const {
+
+	return w;
+}
+
+int StreamingTexture::get_height() const {
+
+	return h;
+}
+
+RID StreamingTexture::get_rid() const {
+
+	return texture;
+}
+
+bool StreamingTexture::has_alpha() const {
+
+	return ( format==Image::FORMAT_GRAYSCALE_ALPHA || format==Image::FORMAT_INDEXED_ALPHA || format==Image::FORMAT_RGBA );
+}
+
+void StreamingTexture::set_flags(uint32_t p_flags) {
+
+	flags=p_flags;
+	VisualServer::get_singleton()->texture_set_flags(texture,p_flags);
+}
+
+uint32_t StreamingTexture::get_flags() const {
+
+	return flags;
+}
+
+Image::Format StreamingTexture::get_format() const {
+
+	return format;
+}
+
+int StreamingTexture::get_level_count() const {
+
+	return levels.size();
+}
+
+int StreamingTexture::get_resident_level() const {
+
+	return level;
+}
+
+void StreamingTexture::_bind_methods() {
+
+	ObjectTypeDB::bind_method(_MD("load:Error","path"),&StreamingTexture::load);
+	ObjectTypeDB::bind_method(_MD("get_format"),&StreamingTexture::get_format);
+	ObjectTypeDB::bind_method(_MD("get_level_count"),&StreamingTexture::get_level_count);
+	ObjectTypeDB::bind_method(_MD("get_resident_level"),&StreamingTexture::get_resident_level);
+}
+
+StreamingTexture::StreamingTexture() {
+
+	w=h=0;
+	flags=FLAGS_DEFAULT;
+	format=Image::FORMAT_GRAYSCALE;
+	base_level=0;
+	level=0;
+	loading_level=-1;
+	texture = VisualServer::get_singleton()->texture_create();
+	if (TextureStreamer::get_singleton())
+		TextureStreamer::get_singleton()->_add(this);
+}
+
+StreamingTexture::~StreamingTexture() {
+
+	if (TextureStreamer::get_singleton())
+		TextureStreamer::get_singleton()->_remove(this);
+	VisualServer::get_singleton()->free( texture );
+}
+
+//////////////////////////////////////////
+
+TextureStreamer *TextureStreamer::singleton=NULL;
+
+void TextureStreamer::_read(Request *p_request) {
+
+	p_request->ok=false;
+	FileAccess *f=FileAccess::open(p_request->file,FileAccess::READ);
+	if (!f)
+		return;
+
+	p_request->data.resize(p_request->size);
+	DVector<uint8_t>::Write w=p_request->data.write();
+	f->seek(p_request->offset);
+	p_request->ok = f->get_buffer(w.ptr(),p_request->size)==p_request->size;
+	memdelete(f);
+}
+
+void TextureStreamer::_thread_func(void *p_ud) {
+
+	TextureStreamer *ts=(TextureStreamer*)p_ud;
+
+	while(true) {
+
+		ts->semaphore->wait();
+		if (ts->exit_thread)
+			break;
+
+		ts->mutex->lock();
+		Request *r = ts->queue.size() ? ts->queue.front()->get() : NULL;
+		if (r)
+			ts->queue.pop_front();
+		ts->mutex->unlock();
+
+		if (!r)
+			continue;
+
+		_read(r);
+
+		ts->mutex->lock();
+		ts->done.push_back(r);
+		ts->mutex->unlock();
+	}
+}
+
+void TextureStreamer::_request(StreamingTexture *p_texture,int p_level) {
+
+	Request *r = memnew( Request );
+	r->texture=Ref<StreamingTexture>(p_texture);
+	r->file=p_texture->file;
+	r->offset=p_texture->levels[p_level].offset;
+	r->size=p_texture->_get_data_size(p_level);
+	r->level=p_level;
+	r->ok=false;
+	p_texture->loading_level=p_level;
+
+	if (!started) {
+		//started the first time something is streamed
+		started=true;
+		semaphore=Semaphore::create();
+		if (semaphore) {
+			thread=Thread::create(_thread_func,this);
+			if (!thread) {
+				memdelete(semaphore);
+				semaphore=NULL;
+			}
+		}
+	}
+
+	if (!thread) {
+		//no threads, read it now and upload it on the next poll
+		_read(r);
+		mutex->lock();
+		done.push_back(r);
+		mutex->unlock();
+		return;
+	}
+
+	mutex->lock();
+	queue.push_back(r);
+	mutex->unlock();
+	semaphore->post();
+}
+
+struct _StreamIdle {
+
+	StreamingTexture *texture;
+	int unused; //frames since drawn, read once per poll
+
+	//least recently drawn first
+	bool operator<(const _StreamIdle& p_other) const { return unused>p_other.unused; }
+};
+
+void TextureStreamer::poll() {
+
+	VisualServer *vs=VisualServer::get_singleton();
+
+	mutex->lock();
+	List<Request*> finished=done;
+	done.clear();
+	mutex->unlock();
+
+	for(List<Request*>::Element *E=finished.front();E;E=E->next()) {
+
+		Request *r=E->get();
+		StreamingTexture *t=r->texture.ptr();
+		if (t->loading_level==r->level) {
+			t->loading_level=-1;
+			if (r->ok)
+				t->_upload(r->level,r->data);
+			else
+				ERR_PRINT(String("Failed streaming texture data from: "+r->file).utf8().get_data());
+		}
+		memdelete(r); //may free the texture, if nothing else uses it
+	}
+
+	mutex->lock();
+
+	uint64_t used=0;
+	Vector<StreamingTexture*> wanted;
+	Vector<_StreamIdle> idle;
+
+	for(Set<StreamingTexture*>::Element *E=textures.front();E;E=E->next()) {
+
+		StreamingTexture *t=E->get();
+		if (t->levels.empty())
+			continue; //not loaded
+
+		used+=t->_get_data_size(t->level);
+		int unused=vs->texture_get_frames_since_drawn(t->texture);
+
+		if (unused<=1 && t->level>0 && t->loading_level<0)
+			wanted.push_back(t);
+		else if (unused>frames_to_evict && t->level<t->base_level) {
+			_StreamIdle si;
+			si.texture=t;
+			si.unused=unused;
+			idle.push_back(si);
+		}
+	}
+
+	if (idle.size()>1)
+		idle.sort();
+
+	int evict=0;
+	for(int i=0;i<wanted.size();i++) {
+
+		StreamingTexture *t=wanted[i];
+		uint64_t need=t->_get_data_size(0)-t->_get_data_size(t->level);
+
+		while(used+need>budget && evict<idle.size()) {
+
+			//make room dropping the large levels of what is not being drawn
+			StreamingTexture *e=idle[evict++].texture;
+			used-=e->_get_data_size(e->level)-e->_get_data_size(e->base_level);
+			e->loading_level=-1;
+			e->_upload(e->base_level,e->base_data);
+		}
+
+		if (used+need>budget)
+			break;
+
+		used+=need;
+		_request(t,0);
+	}
+
+	resident_memory=used;
+
+	mutex->unlock();
+}
+
+void TextureStreamer::_add(StreamingTexture *p_texture) {
+
+	mutex->lock();
+	textures.insert(p_texture);
+	mutex->unlock();
+}
+
+void TextureStreamer::_remove(StreamingTexture *p_texture) {
+
+	mutex->lock();
+	textures.erase(p_texture);
+	mutex->unlock();
+}
+
+TextureStreamer::TextureStreamer() {
+
+	singleton=this;
+	mutex=Mutex::create();
+	semaphore=NULL;
+	thread=NULL;
+	started=false;
+	exit_thread=false;
+	resident_memory=0;
+	budget=uint64_t(GLOBAL_DEF("rasterizer/texture_stream_budget_mb",256).operator int())*1024*1024;
+	frames_to_evict=GLOBAL_DEF("rasterizer/texture_stream_evict_frames",120);
+}
+
+TextureStreamer::~TextureStreamer() {
+
+	if (thread) {
+		exit_thread=true;
+		semaphore->post();
+		Thread::wait_to_finish(thread);
+		memdelete(thread);
+		memdelete(semaphore);
+	}
+
+	while(queue.size()) {
+		memdelete(queue.front()->get());
+		queue.pop_front();
+	}
+	while(done.size()) {
+		memdelete(done.front()->get());
+		done.pop_front();
+	}
+
+	memdelete(mutex);
+	singleton=NULL;
+}
+
+//////////////////////////////////////////
+
+RES ResourceFormatLoaderStreamingTexture::load(const String &p_path,const String& p_original_path) {
+
+	Ref<StreamingTexture> st = memnew( StreamingTexture );
+	Error err = st->load(p_path);
+	ERR_FAIL_COND_V(err!=OK,RES());
+
+	return st;
+}
+
+void ResourceFormatLoaderStreamingTexture::get_recognized_extensions(List<String> *p_extensions) const {
+
+	p_extensions->push_back("stex");
+}
+
+bool ResourceFormatLoaderStreamingTexture::handles_type(const String& p_type) const {
+
+	return ObjectTypeDB::is_type(p_type,"StreamingTexture") || p_type=="Texture";
+}
+
+String ResourceFormatLoaderStreamingTexture::get_resource_type(const String &p_path) const {
+
+	if (p_path.extension().to_lower()=="stex")
+		return "StreamingTexture";
+	return "";
+}
+
+//////////////////////////////////////////
+
+Error ResourceFormatSaverStreamingTexture::save(const String &p_path,const RES& p_resource,uint32_t p_flags) {
+
+	Ref<ImageTexture> tex=p_resource;
+	ERR_FAIL_COND_V(tex.is_null(),ERR_INVALID_PARAMETER);
+
+	return StreamingTexture::save_image(p_path,tex->get_data(),tex->get_flags());
+}
+
+bool ResourceFormatSaverStreamingTexture::recognize(const RES& p_resource) const {
+
+	return p_resource->cast_to<ImageTexture>()!=NULL;
+}
+
+void ResourceFormatSaverStreamingTexture::get_recognized_extensions(const RES& p_resource,List<String> *p_extensions) const {
+
+	if (p_resource->cast_to<ImageTexture>())
+		p_extensions->push_back("stex");
+}
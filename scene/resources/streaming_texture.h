@@ -0,0 +1,164 @@
+/*************************************************************************/
+/*  streaming_texture.h                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef STREAMING_TEXTURE_H
+#define STREAMING_TEXTURE_H
+
+#include "scene/resources/texture.h"
+#include "io/resource_loader.h"
+#include "io/resource_saver.h"
+#include "os/thread.h"
+#include "os/mutex.h"
+#include "os/semaphore.h"
+#include "set.h"
+
+/* Texture that keeps only its small mipmaps in memory until it's drawn,
+   the rest are read from the file in the background. Large mipmaps of the
+   textures that are not being drawn are dropped when the texture memory
+   budget is exceeded. */
+
+class StreamingTexture : public Texture {
+
+	OBJ_TYPE( StreamingTexture, Texture );
+	RES_BASE_EXTENSION("stex");
+
+	friend class TextureStreamer;
+
+	struct Level {
+
+		int width;
+		int height;
+		int size;
+		uint64_t offset; //in the file
+	};
+
+	RID texture;
+	String file;
+	Image::Format format;
+	uint32_t flags;
+	int w,h;
+	Vector<Level> levels;
+	int base_level; //this level and the smaller ones are always loaded
+	DVector<uint8_t> base_data;
+	int level; //first level uploaded
+	int loading_level; //-1 when nothing is being read
+
+	int _get_data_size(int p_from_level) const;
+	void _upload(int p_level,const DVector<uint8_t>& p_data);
+
+protected:
+
+	static void _bind_methods();
+
+public:
+
+	Error load(const String& p_path);
+	static Error save_image(const String& p_path,const Image& p_image,uint32_t p_flags=FLAGS_DEFAULT);
+
+	virtual int get_width() const;
+	virtual int get_height() const;
+	virtual RID get_rid() const;
+
+	virtual bool has_alpha() const;
+
+	virtual void set_flags(uint32_t p_flags);
+	virtual uint32_t get_flags() const;
+
+	Image::Format get_format() const;
+	int get_level_count() const;
+	int get_resident_level() const;
+
+	StreamingTexture();
+	~StreamingTexture();
+};
+
+class TextureStreamer {
+
+	struct Request {
+
+		Ref<StreamingTexture> texture; //only touched from the main thread
+		String file;
+		uint64_t offset;
+		int size;
+		int level;
+		DVector<uint8_t> data;
+		bool ok;
+	};
+
+	static TextureStreamer *singleton;
+
+	Mutex *mutex;
+	Semaphore *semaphore;
+	Thread *thread; //NULL when threads are not available, requests are read right away then
+	bool started;
+	volatile bool exit_thread;
+	Set<StreamingTexture*> textures;
+	List<Request*> queue;
+	List<Request*> done;
+	uint64_t budget;
+	int frames_to_evict;
+	uint64_t resident_memory;
+
+	static void _thread_func(void *p_ud);
+	static void _read(Request *p_request);
+
+	void _request(StreamingTexture *p_texture,int p_level);
+
+friend class StreamingTexture;
+	void _add(StreamingTexture *p_texture);
+	void _remove(StreamingTexture *p_texture);
+
+public:
+
+	static TextureStreamer *get_singleton() { return singleton; }
+
+	void poll(); ///< main thread, once per frame
+
+	uint64_t get_resident_memory() const { return resident_memory; } ///< as of the last poll
+	uint64_t get_budget() const { return budget; }
+
+	TextureStreamer();
+	~TextureStreamer();
+};
+
+class ResourceFormatLoaderStreamingTexture : public ResourceFormatLoader {
+public:
+	virtual RES load(const String &p_path,const String& p_original_path="");
+	virtual void get_recognized_extensions(List<String> *p_extensions) const;
+	virtual bool handles_type(const String& p_type) const;
+	virtual String get_resource_type(const String &p_path) const;
+};
+
+class ResourceFormatSaverStreamingTexture : public ResourceFormatSaver {
+public:
+	virtual Error save(const String &p_path,const RES& p_resource,uint32_t p_flags=0);
+	virtual bool recognize(const RES& p_resource) const;
+	virtual void get_recognized_extensions(const RES& p_resource,List<String> *p_extensions) const;
+};
+
+#endif // STREAMING_TEXTURE_H
@@ -192,6 +192,7 @@ public:
 
 
 	virtual void texture_set_reload_hook(RID p_texture,ObjectID p_owner,const StringName& p_function) const=0;
+	virtual int texture_get_frames_since_drawn(RID p_texture) const=0;
 
 	/* SHADER API */
 
@@ -141,6 +141,11 @@ void RasterizerDummy::texture_set_reload_hook(RID p_texture,ObjectID p_owner,con
 
 }
 
+int RasterizerDummy::texture_get_frames_since_drawn(RID p_texture) const {
+
+	return 0;
+}
+
 /* SHADER API */
 
 /* SHADER API */
@@ -112,6 +112,11 @@ void VisualServerRaster::texture_set_reload_hook(RID p_texture,ObjectID p_owner,
 	rasterizer->texture_set_reload_hook(p_texture,p_owner,p_function);
 }
 
+int VisualServerRaster::texture_get_frames_since_drawn(RID p_texture) const {
+
+	return rasterizer->texture_get_frames_since_drawn(p_texture);
+}
+
 /* SHADER API */
 
 RID VisualServerRaster::shader_create(ShaderMode p_mode) {
@@ -644,6 +644,7 @@ public:
 	virtual void texture_set_size_override(RID p_texture,int p_width, int p_height);
 	virtual bool texture_can_stream(RID p_texture) const;
 	virtual void texture_set_reload_hook(RID p_texture,ObjectID p_owner,const StringName& p_function) const;
+	virtual int texture_get_frames_since_drawn(RID p_texture) const;
 
 
 	/* SHADER API */
@@ -640,6 +640,7 @@ public:
 	FUNC1RC(uint32_t,texture_get_height,RID);
 	FUNC3(texture_set_size_override,RID,int,int);
 	FUNC1RC(bool,texture_can_stream,RID);
+	FUNC1RC(int,texture_get_frames_since_drawn,RID);
 	FUNC3C(texture_set_reload_hook,RID,ObjectID,const StringName&);
 
 	/* SHADER API */
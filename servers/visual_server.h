@@ -131,6 +131,7 @@ public:
 	virtual void texture_set_size_override(RID p_texture,int p_width, int p_height)=0;
 	virtual bool texture_can_stream(RID p_texture) const=0;
 	virtual void texture_set_reload_hook(RID p_texture,ObjectID p_owner,const StringName& p_function) const=0;
+	virtual int texture_get_frames_since_drawn(RID p_texture) const=0; ///< frames since the texture was last drawn, so the data can be streamed
 
 
 
@@ -34,9 +34,114 @@
 #include "editor_node.h"
 #include "io/resource_saver.h"
 
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#define FS_CACHE_VERSION 2
 
 EditorFileSystem *EditorFileSystem::singleton=NULL;
 
+/* Tells which directories changed since the last scan, so the ones that did
+   not are taken from the cache without even checking modification times.
+   Only directories watched before they were last scanned can be trusted,
+   everything else (and everything, on platforms without a watcher) is
+   checked as usual. Used from the scan thread only. */
+
+class EditorFileSystemWatcher {
+
+#ifdef __linux__
+	int fd;
+	Map<int,String> watches;
+	Set<String> watched;
+	Set<String> dirty;
+	bool overflow;
+#endif
+
+public:
+
+	void watch(const String& p_dir) {
+#ifdef __linux__
+		if (fd<0 || watched.has(p_dir))
+			return;
+
+		uint32_t mask=IN_CREATE|IN_DELETE|IN_MOVED_FROM|IN_MOVED_TO|IN_CLOSE_WRITE|IN_MODIFY|IN_ATTRIB|IN_DELETE_SELF|IN_MOVE_SELF;
+		int wd=inotify_add_watch(fd,p_dir.utf8().get_data(),mask);
+		if (wd<0)
+			return; //likely out of watches, this dir will just be checked
+		watches[wd]=p_dir;
+		watched.insert(p_dir);
+#endif
+	}
+
+	void poll() {
+#ifdef __linux__
+		if (fd<0)
+			return;
+
+		char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+		while(true) {
+
+			ssize_t len=read(fd,buf,sizeof(buf));
+			if (len<=0)
+				break;
+
+			for(char *ptr=buf;ptr<buf+len;) {
+
+				const struct inotify_event *ev=(const struct inotify_event*)ptr;
+				ptr+=sizeof(struct inotify_event)+ev->len;
+
+				if (ev->mask&IN_Q_OVERFLOW) {
+					overflow=true;
+					continue;
+				}
+
+				Map<int,String>::Element *E=watches.find(ev->wd);
+				if (!E)
+					continue;
+				dirty.insert(E->get());
+
+				if (ev->mask&(IN_IGNORED|IN_DELETE_SELF|IN_MOVE_SELF)) {
+					watched.erase(E->get());
+					watches.erase(E);
+				}
+			}
+		}
+#endif
+	}
+
+	bool is_clean(const String& p_dir) const {
+#ifdef __linux__
+		return !overflow && watched.has(p_dir) && !dirty.has(p_dir);
+#else
+		return false;
+#endif
+	}
+
+	void scan_done() {
+#ifdef __linux__
+		dirty.clear();
+		overflow=false;
+#endif
+	}
+
+	EditorFileSystemWatcher() {
+#ifdef __linux__
+		fd=inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
+		overflow=false;
+#endif
+	}
+
+	~EditorFileSystemWatcher() {
+#ifdef __linux__
+		if (fd>=0)
+			close(fd);
+#endif
+	}
+};
+
 
 int EditorFileSystemDirectory::get_subdir_count() const {
 
@@ -118,6 +223,12 @@ bool EditorFileSystemDirectory::is_missing_sources(int p_idx) const {
 	return false;
 }
 
+Vector<String> EditorFileSystemDirectory::get_file_deps(int p_idx) const {
+
+	ERR_FAIL_INDEX_V(p_idx,files.size(),Vector<String>());
+	return files[p_idx].deps;
+}
+
 String EditorFileSystemDirectory::get_file_type(int p_idx) const {
 
 	ERR_FAIL_INDEX_V(p_idx,files.size(),"");
@@ -143,6 +254,7 @@ void EditorFileSystemDirectory::_bind_methods() {
 	ObjectTypeDB::bind_method(_MD("get_file_path","idx"),&EditorFileSystemDirectory::get_file_path);
 	ObjectTypeDB::bind_method(_MD("get_file_types","idx"),&EditorFileSystemDirectory::get_file_type);
 	ObjectTypeDB::bind_method(_MD("is_missing_sources","idx"),&EditorFileSystemDirectory::is_missing_sources);
+	ObjectTypeDB::bind_method(_MD("get_file_deps","idx"),&EditorFileSystemDirectory::get_file_deps);
 	ObjectTypeDB::bind_method(_MD("get_name"),&EditorFileSystemDirectory::get_name);
 	ObjectTypeDB::bind_method(_MD("get_parent"),&EditorFileSystemDirectory::get_parent);
 
@@ -206,12 +318,6 @@ EditorFileSystem::DirItem* EditorFileSystem::_scan_dir(DirAccess *da,Set<String>
 	if (abort_scan)
 		return NULL;
 
-	if (p_path!=String()) {
-		if (FileAccess::exists(("res://"+p_path).plus_file("engine.cfg"))) {
-			return NULL;
-		}
-	}
-
 	List<String> dirs;
 	List<String> files;
 	Set<String> pngs;
@@ -222,12 +328,23 @@ EditorFileSystem::DirItem* EditorFileSystem::_scan_dir(DirAccess *da,Set<String>
 	String global_path = Globals::get_singleton()->get_resource_path().plus_file(path);
 
 	path="res://"+path;
-	uint64_t mtime = FileAccess::get_modified_time(global_path);
 
 	DirCache *dc = dir_cache.getptr(path);
+	//nothing happened in there since the cache was written, not even to the files
+	bool unchanged = dc && watcher->is_clean(global_path);
+	watcher->watch(global_path); //before listing, so nothing is missed
 
+	uint64_t mtime = unchanged ? dc->modification_time : FileAccess::get_modified_time(global_path);
+	bool listed = dc && dc->modification_time==mtime && mtime<cache_time;
 
-	if (false && dc && dc->modification_time==mtime) {
+	if (!listed && p_path!=String()) {
+		//cached directories were checked already
+		if (FileAccess::exists(("res://"+p_path).plus_file("engine.cfg"))) {
+			return NULL;
+		}
+	}
+
+	if (listed) {
 		//use the cached files, since directory did not change
 		for (Set<String>::Element *E=dc->subdirs.front();E;E=E->next()) {
 			dirs.push_back(E->get());
@@ -275,6 +392,7 @@ EditorFileSystem::DirItem* EditorFileSystem::_scan_dir(DirAccess *da,Set<String>
 
 	//find subdirs
 	Vector<DirItem*> subdirs;
+	Vector<String> subdir_names;
 
 	//String current = da->get_current_dir();
 	float idx=0;
@@ -283,6 +401,7 @@ EditorFileSystem::DirItem* EditorFileSystem::_scan_dir(DirAccess *da,Set<String>
 		String d = E->get();
 		if (d.begins_with(".")) //ignore hidden and . / ..
 			continue;
+		subdir_names.push_back(d);
 
 		//ERR_CONTINUE( da->change_dir(d)!= OK );
 		DirItem *sdi = _scan_dir(da,extensions,d,p_from+(idx/dirs.size())*p_range,p_range/dirs.size(),p_path+d+"/",file_cache,dir_cache,p_prog);
@@ -303,6 +422,7 @@ EditorFileSystem::DirItem* EditorFileSystem::_scan_dir(DirAccess *da,Set<String>
 	di->path=path;
 	di->name=p_name;
 	di->dirs=subdirs;
+	di->subdir_names=subdir_names;
 	di->modified_time=mtime;
 
 	//add files
@@ -312,18 +432,24 @@ EditorFileSystem::DirItem* EditorFileSystem::_scan_dir(DirAccess *da,Set<String>
 		si->file=E->get();
 		si->path="res://"+p_path+si->file;
 		FileCache *fc = file_cache.getptr(si->path);
-		uint64_t mt = FileAccess::get_modified_time(si->path);
+		uint64_t mt = (unchanged && fc) ? fc->modification_time : FileAccess::get_modified_time(si->path);
 
-		if (fc && fc->modification_time == mt) {
+		if (fc && fc->modification_time == mt && mt<cache_time) {
 
 			si->meta=fc->meta;
 			si->type=fc->type;
+			si->deps=fc->deps;
 			si->modified_time=fc->modification_time;
 		} else {
 			si->meta=_get_meta(si->path);
 			si->type=ResourceLoader::get_resource_type(si->path);
 			si->modified_time=mt;
 
+			List<String> deps;
+			if (si->type!="")
+				ResourceLoader::get_dependencies(si->path,&deps);
+			for(List<String>::Element *F=deps.front();F;F=F->next())
+				si->deps.push_back(F->get());
 		}
 
 		if (si->meta.enabled) {
@@ -354,10 +480,42 @@ void EditorFileSystem::_scan_scenes() {
 
 	sources_changed.clear();
 
+	List<String> extensionsl;
+	ResourceLoader::get_recognized_extensions_for_type("",&extensionsl);
+	Set<String> extensions;
+	for(List<String>::Element *E = extensionsl.front();E;E=E->next()) {
+
+		extensions.insert(E->get());
+	}
+
+	//file lists in the cache are only good for the same extensions
+	String signature;
+	for(Set<String>::Element *E=extensions.front();E;E=E->next()) {
+		if (E!=extensions.front())
+			signature+=",";
+		signature+=E->get();
+	}
+	signature=signature.md5_text();
 
+	uint64_t scan_time=OS::get_singleton()->get_unix_time();
+	watcher->poll();
 
 	String project=Globals::get_singleton()->get_resource_path();
 	FileAccess *f =FileAccess::open(project+"/.fscache",FileAccess::READ);
+	cache_time=0;
+
+	if (f) {
+
+		Vector<String> header = f->get_line().strip_edges().split("::");
+		if (header.size()!=4 || header[0]!="GDFSCACHE" || header[1].to_int()!=FS_CACHE_VERSION || header[3]!=signature) {
+			//old or for other extensions, scan everything again
+			f->close();
+			memdelete(f);
+			f=NULL;
+		} else {
+			cache_time=header[2].to_int64();
+		}
+	}
 
 	if (f) {
 		//read the disk cache
@@ -369,24 +527,20 @@ void EditorFileSystem::_scan_scenes() {
 
 			if (l.begins_with("::")) {
 				Vector<String> split = l.split("::");
-				ERR_CONTINUE( split.size() != 3);
+				ERR_CONTINUE( split.size() != 4);
 				String name = split[1];
 
 				dir_cache[name]=DirCache();
 				dc=&dir_cache[name];
 				dc->modification_time=split[2].to_int64();
 
+				Vector<String> subdirs = split[3].split("<>",false);
+				for(int i=0;i<subdirs.size();i++)
+					dc->subdirs.insert(subdirs[i]);
+
 				if (name!="res://") {
 
 					cpath=name+"/";
-
-					int sp=name.find_last("/");
-					if (sp==5)
-						sp=6;
-					String pd = name.substr(0,sp);
-					DirCache *dcp = dir_cache.getptr(pd);
-					ERR_CONTINUE(!dcp);
-					dcp->subdirs.insert(name.get_file());
 				} else {
 
 					cpath=name;
@@ -395,7 +549,7 @@ void EditorFileSystem::_scan_scenes() {
 
 			} else {
 				Vector<String> split = l.split("::");
-				ERR_CONTINUE( split.size() != 4);
+				ERR_CONTINUE( split.size() != 5);
 				String name = split[0];
 				String file;
 
@@ -427,6 +581,7 @@ void EditorFileSystem::_scan_scenes() {
 					}
 
 				}
+				fc.deps=split[4].split("<>",false);
 				file_cache[name]=fc;
 
 				ERR_CONTINUE(!dc);
@@ -448,15 +603,6 @@ void EditorFileSystem::_scan_scenes() {
 	DirAccess *da = DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
 	//da->change_dir( Globals::get_singleton()->get_resource_path() );
 
-
-	List<String> extensionsl;
-	ResourceLoader::get_recognized_extensions_for_type("",&extensionsl);
-	Set<String> extensions;
-	for(List<String>::Element *E = extensionsl.front();E;E=E->next()) {
-
-		extensions.insert(E->get());
-	}
-
 	EditorProgressBG scan_progress("efs","ScanFS",100);
 
 	md_count=0;
@@ -469,8 +615,13 @@ void EditorFileSystem::_scan_scenes() {
 	}
 
 
+	if (!abort_scan)
+		watcher->scan_done();
+	cache_time=0;
+
 	//save back the findings
 	f=FileAccess::open(project+"/.fscache",FileAccess::WRITE);
+	f->store_line("GDFSCACHE::"+itos(FS_CACHE_VERSION)+"::"+String::num(scan_time)+"::"+signature);
 	_save_type_cache_fs(scandir,f);
 	f->close();
 	memdelete(f);
@@ -659,6 +810,7 @@ EditorFileSystemDirectory* EditorFileSystem::_update_tree(DirItem *p_item) {
 		fi.file=p_item->files[i]->file;
 		fi.type=p_item->files[i]->type;
 		fi.meta=p_item->files[i]->meta;
+		fi.deps=p_item->files[i]->deps;
 		fi.modified_time=p_item->files[i]->modified_time;
 
 		efd->files.push_back(fi);
@@ -780,7 +932,13 @@ void EditorFileSystem::_save_type_cache_fs(DirItem *p_dir,FileAccess *p_file) {
 
 	if (!p_dir)
 		return; //none
-	p_file->store_line("::"+p_dir->path+"::"+String::num(p_dir->modified_time));
+	String subdirs;
+	for(int i=0;i<p_dir->subdir_names.size();i++) {
+		if (i>0)
+			subdirs+="<>";
+		subdirs+=p_dir->subdir_names[i];
+	}
+	p_file->store_line("::"+p_dir->path+"::"+String::num(p_dir->modified_time)+"::"+subdirs);
 
 	for(int i=0;i<p_dir->files.size();i++) {
 
@@ -794,6 +952,12 @@ void EditorFileSystem::_save_type_cache_fs(DirItem *p_dir,FileAccess *p_file) {
 
 			}
 		}
+		s+="::";
+		for(int j=0;j<p_dir->files[i]->deps.size();j++) {
+			if (j>0)
+				s+="<>";
+			s+=p_dir->files[i]->deps[j];
+		}
 		p_file->store_line(s);
 	}
 
@@ -1064,6 +1228,12 @@ void EditorFileSystem::update_file(const String& p_file) {
 	fs->files[cpos].modified_time=FileAccess::get_modified_time(p_file);
 	fs->files[cpos].meta=_get_meta(p_file);
 
+	List<String> deps;
+	ResourceLoader::get_dependencies(p_file,&deps);
+	fs->files[cpos].deps.clear();
+	for(List<String>::Element *E=deps.front();E;E=E->next())
+		fs->files[cpos].deps.push_back(E->get());
+
 	call_deferred("emit_signal","filesystem_changed"); //update later
 
 }
@@ -1093,10 +1263,13 @@ EditorFileSystem::EditorFileSystem() {
 	scanning_sources=false;
 	ResourceSaver::set_save_callback(_resource_saved);
 
+	cache_time=0;
+	watcher=memnew( EditorFileSystemWatcher );
 
 }
 
 EditorFileSystem::~EditorFileSystem() {
 
+	memdelete(watcher);
 
 }
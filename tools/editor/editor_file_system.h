@@ -37,6 +37,7 @@
 class FileAccess;
 
 class EditorProgressBG;
+class EditorFileSystemWatcher;
 class EditorFileSystemDirectory : public Object {
 
 	OBJ_TYPE( EditorFileSystemDirectory,Object );
@@ -69,6 +70,7 @@ class EditorFileSystemDirectory : public Object {
 		uint64_t modified_time;
 
 		ImportMeta meta;
+		Vector<String> deps;
 	};
 
 	Vector<FileInfo> files;
@@ -91,6 +93,7 @@ public:
 	bool get_file_meta(int p_idx) const;
 	bool is_missing_sources(int p_idx) const;
 	Vector<String> get_missing_sources(int p_idx) const;
+	Vector<String> get_file_deps(int p_idx) const;
 
 	EditorFileSystemDirectory *get_parent();
 
@@ -112,6 +115,7 @@ class EditorFileSystem : public Node {
 		String type;
 		uint64_t modified_time;
 		EditorFileSystemDirectory::ImportMeta meta;
+		Vector<String> deps;
 	};
 
 	struct DirItem {
@@ -119,6 +123,7 @@ class EditorFileSystem : public Node {
 		uint64_t modified_time;
 		String path;
 		String name;
+		Vector<String> subdir_names; //everything listed, including dirs with nothing to show
 		Vector<DirItem*> dirs;
 		Vector<SceneItem*> files;
 		~DirItem();
@@ -149,6 +154,7 @@ class EditorFileSystem : public Node {
 		String type;
 		uint64_t modification_time;
 		EditorFileSystemDirectory::ImportMeta meta;
+		Vector<String> deps;
 	};
 
 	struct DirCache {
@@ -158,6 +164,10 @@ class EditorFileSystem : public Node {
 		Set<String> subdirs;
 	};
 
+	uint64_t cache_time; //when the loaded .fscache was scanned, anything modified since is not trusted
+
+	EditorFileSystemWatcher *watcher;
+
 
 	static EditorFileSystemDirectory::ImportMeta _get_meta(const String& p_path);
 
@@ -39,6 +39,7 @@
 #include "io/config_file.h"
 #include "io/resource_saver.h"
 #include "io/md5.h"
+#include "io/file_access_pack.h"
 #include "io_plugins/editor_texture_import_plugin.h"
 
 String EditorImportPlugin::validate_source_path(const String& p_path) {
@@ -116,6 +117,21 @@ Vector<uint8_t> EditorImportPlugin::custom_export(const String& p_path, const Re
 	return Vector<uint8_t>();
 }
 
+Variant EditorImportPlugin::import_prepare(const String& p_path, const Ref<ResourceImportMetadata>& p_from) {
+
+	return Variant();
+}
+
+Error EditorImportPlugin::import_commit(const String& p_path, const Ref<ResourceImportMetadata>& p_from,const Variant& p_prepared) {
+
+	return import(p_path,p_from);
+}
+
+void EditorImportPlugin::get_import_outputs(const String& p_path, const Ref<ResourceImportMetadata>& p_from,List<String> *r_outputs) const {
+
+	//not cacheable, imports may merge with what is already at p_path or write other files
+}
+
 EditorImportPlugin::EditorImportPlugin() {
 
 
@@ -130,6 +146,11 @@ void EditorExportPlugin::_bind_methods() {
 }
 
 
+void EditorExportPlugin::export_begin(const Vector<StringName>& p_files,const Ref<EditorExportPlatform> &p_platform) {
+
+
+}
+
 Vector<uint8_t> EditorExportPlugin::custom_export(String& p_path,const Ref<EditorExportPlatform> &p_platform) {
 
 	if (get_script_instance()) {
@@ -149,6 +170,11 @@ Vector<uint8_t> EditorExportPlugin::custom_export(String& p_path,const Ref<Edito
 
 }
 
+void EditorExportPlugin::export_end() {
+
+
+}
+
 
 EditorExportPlugin::EditorExportPlugin() {
 
@@ -824,6 +850,13 @@ Error EditorExportPlatform::export_project_files(EditorExportSaveFunction p_func
 
 	StringName engine_cfg="res://engine.cfg";
 
+	Ref<EditorExportPlatform> ep=EditorImportExport::get_singleton()->get_export_platform(get_name());
+	for(int i=0;i<EditorImportExport::get_singleton()->get_export_plugin_count();i++) {
+		EditorImportExport::get_singleton()->get_export_plugin(i)->export_begin(files,ep);
+	}
+
+	Error files_err=OK;
+
 	for(int i=0;i<files.size();i++) {
 
 		if (remap_files.has(files[i]) || files[i]==engine_cfg) //gonna be remapped (happened before!)
@@ -833,9 +866,9 @@ Error EditorExportPlatform::export_project_files(EditorExportSaveFunction p_func
 
 		ERR_CONTINUE( saved.has(src) );
 
-		Error err = p_func(p_udata,src,buf,counter++,files.size());
-		if (err)
-			return err;
+		files_err = p_func(p_udata,src,buf,counter++,files.size());
+		if (files_err)
+			break;
 
 		saved.insert(src);
 		if (src!=String(files[i]))
@@ -843,6 +876,13 @@ Error EditorExportPlatform::export_project_files(EditorExportSaveFunction p_func
 
 	}
 
+	for(int i=0;i<EditorImportExport::get_singleton()->get_export_plugin_count();i++) {
+		EditorImportExport::get_singleton()->get_export_plugin(i)->export_end();
+	}
+
+	if (files_err)
+		return files_err;
+
 
 	{
 
@@ -910,13 +950,22 @@ Error EditorExportPlatform::save_pack_file(void *p_userdata,const String& p_path
 
 	PackData *pd = (PackData*)p_userdata;
 
+	pd->paths.push_back(p_path);
+	pd->entries.push_back(pd->f->get_pos()-pd->table_begin);
+
+	Vector<uint8_t> cdata;
+	uint32_t flags=0;
+	if (pd->compress && PackedData::compress_file(p_data.ptr(),p_data.size(),cdata,pd->compression_mode))
+		flags|=PackedData::PACK_FILE_COMPRESSED;
+	const Vector<uint8_t>& stored = (flags&PackedData::PACK_FILE_COMPRESSED) ? cdata : p_data;
+
 	CharString cs=p_path.utf8();
 	pd->f->store_32(cs.length());
 	pd->f->store_buffer((uint8_t*)cs.get_data(),cs.length());
 	TempData td;
 	td.pos=pd->f->get_pos();;
 	td.ofs=pd->ftmp->get_pos();
-	td.size=p_data.size();
+	td.size=stored.size();
 	pd->file_ofs.push_back(td);
 	pd->f->store_64(0); //ofs
 	pd->f->store_64(0); //size
@@ -927,9 +976,10 @@ Error EditorExportPlatform::save_pack_file(void *p_userdata,const String& p_path
 		MD5Final(&ctx);
 		pd->f->store_buffer(ctx.digest,16);
 	}
+	pd->f->store_32(flags);
 	pd->ep->step("Storing File: "+p_path,2+p_file*100/p_total);
 	pd->count++;
-	pd->ftmp->store_buffer(p_data.ptr(),p_data.size());
+	pd->ftmp->store_buffer(stored.ptr(),stored.size());
 	return OK;
 
 }
@@ -943,7 +993,7 @@ Error EditorExportPlatform::save_pack(FileAccess *dst,bool p_make_bundles) {
 	uint64_t ofs_begin = dst->get_pos();
 
 	dst->store_32(0x43504447); //GDPK
-	dst->store_32(0); //pack version
+	dst->store_32(2); //pack version
 	dst->store_32(VERSION_MAJOR);
 	dst->store_32(VERSION_MINOR);
 	dst->store_32(0); //hmph
@@ -961,6 +1011,12 @@ Error EditorExportPlatform::save_pack(FileAccess *dst,bool p_make_bundles) {
 	pd.f=dst;
 	pd.ftmp=tmp;
 	pd.count=0;
+	pd.table_begin=fcountpos;
+	switch(EditorImportExport::get_singleton()->pack_get_compression()) {
+		case EditorImportExport::PACK_COMPRESSION_NONE: pd.compress=false; pd.compression_mode=Compression::MODE_FASTLZ; break;
+		case EditorImportExport::PACK_COMPRESSION_LZ4: pd.compress=true; pd.compression_mode=Compression::MODE_LZ4; break;
+		case EditorImportExport::PACK_COMPRESSION_DEFLATE: pd.compress=true; pd.compression_mode=Compression::MODE_DEFLATE; break;
+	}
 	Error err = export_project_files(save_pack_file,&pd,p_make_bundles);
 	memdelete(tmp);
 	if (err)
@@ -985,11 +1041,19 @@ Error EditorExportPlatform::save_pack(FileAccess *dst,bool p_make_bundles) {
 
 	memdelete(tmp);
 
+	uint64_t index_ofs = dst->get_pos()-ofs_begin;
+	uint32_t bucket_count = PackedData::store_hash_index(dst,pd.paths,pd.entries);
+
 	dst->store_64(dst->get_pos()-ofs_begin);
 	dst->store_32(0x43504447); //GDPK
 
 	//fix offsets
 
+	dst->seek(ofs_begin+20);
+	dst->store_64(index_ofs);
+	dst->store_32(bucket_count);
+	dst->store_32(ofsplus-fcountpos);
+
 	dst->seek(fcountpos);
 	dst->store_32(pd.count);
 	for(int i=0;i<pd.file_ofs.size();i++) {
@@ -1587,6 +1651,17 @@ void EditorImportExport::load_config() {
 		}
 	}
 
+	if (cf->has_section_key("pack","compression")) {
+
+		String compression = cf->get_value("pack","compression");
+		if (compression=="lz4")
+			pack_compression=PACK_COMPRESSION_LZ4;
+		else if (compression=="deflate")
+			pack_compression=PACK_COMPRESSION_DEFLATE;
+		else
+			pack_compression=PACK_COMPRESSION_NONE;
+	}
+
 }
 
 
@@ -1696,6 +1771,12 @@ void EditorImportExport::save_config() {
 
 	cf->set_value("script","encrypt_key",script_key);
 
+	switch(pack_compression) {
+		case PACK_COMPRESSION_NONE: cf->set_value("pack","compression","none"); break;
+		case PACK_COMPRESSION_LZ4: cf->set_value("pack","compression","lz4"); break;
+		case PACK_COMPRESSION_DEFLATE: cf->set_value("pack","compression","deflate"); break;
+	}
+
 	cf->save("res://export.cfg");
 
 }
@@ -1720,6 +1801,16 @@ String EditorImportExport::script_get_encryption_key() const{
 	return script_key;
 }
 
+void EditorImportExport::pack_set_compression(PackCompression p_compression) {
+
+	pack_compression=p_compression;
+}
+
+EditorImportExport::PackCompression EditorImportExport::pack_get_compression() const{
+
+	return pack_compression;
+}
+
 
 void EditorImportExport::_bind_methods() {
 
@@ -1736,6 +1827,12 @@ void EditorImportExport::_bind_methods() {
 	ObjectTypeDB::bind_method(_MD("script_set_encryption_key"),&EditorImportExport::script_set_encryption_key);
 	ObjectTypeDB::bind_method(_MD("script_get_action"),&EditorImportExport::script_get_action);
 	ObjectTypeDB::bind_method(_MD("script_get_encryption_key"),&EditorImportExport::script_get_encryption_key);
+	ObjectTypeDB::bind_method(_MD("pack_set_compression","compression"),&EditorImportExport::pack_set_compression);
+	ObjectTypeDB::bind_method(_MD("pack_get_compression"),&EditorImportExport::pack_get_compression);
+
+	BIND_CONSTANT( PACK_COMPRESSION_NONE );
+	BIND_CONSTANT( PACK_COMPRESSION_LZ4 );
+	BIND_CONSTANT( PACK_COMPRESSION_DEFLATE );
 
 }
 
@@ -1749,6 +1846,7 @@ EditorImportExport::EditorImportExport() {
 	image_shrink=1;
 
 	script_action=SCRIPT_ACTION_COMPILE;
+	pack_compression=PACK_COMPRESSION_NONE;
 
 }
 
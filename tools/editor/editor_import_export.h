@@ -32,6 +32,7 @@
 #include "resource.h"
 #include "scene/main/node.h"
 #include "scene/resources/texture.h"
+#include "io/compression.h"
 
 class EditorExportPlatform;
 class FileAccess;
@@ -57,6 +58,15 @@ public:
 	virtual Error import(const String& p_path, const Ref<ResourceImportMetadata>& p_from);
 	virtual Vector<uint8_t> custom_export(const String& p_path,const Ref<EditorExportPlatform> &p_platform);
 
+	/* Batch imports (EditorImportScheduler) are split in two: prepare does
+	   the heavy work and may run on a worker thread, so it must not touch
+	   servers, the resource cache or the editor; commit then runs on the
+	   main thread, in order. Plugins that don't split just import on commit. */
+
+	virtual Variant import_prepare(const String& p_path, const Ref<ResourceImportMetadata>& p_from);
+	virtual Error import_commit(const String& p_path, const Ref<ResourceImportMetadata>& p_from,const Variant& p_prepared);
+	virtual void get_import_outputs(const String& p_path, const Ref<ResourceImportMetadata>& p_from,List<String> *r_outputs) const; ///< files written by import; none (the default) keeps the import out of the cache, list them only if the result depends on nothing else
+
 	EditorImportPlugin();
 };
 
@@ -69,7 +79,9 @@ protected:
 
 public:
 
+	virtual void export_begin(const Vector<StringName>& p_files,const Ref<EditorExportPlatform> &p_platform); ///< called before the files of a project are exported
 	virtual Vector<uint8_t> custom_export(String& p_path,const Ref<EditorExportPlatform> &p_platform);
+	virtual void export_end(); ///< called once all files were exported
 
 	EditorExportPlugin();
 };
@@ -98,6 +110,11 @@ protected:
 		FileAccess *ftmp;
 		FileAccess *f;
 		Vector<TempData> file_ofs;
+		Vector<String> paths;
+		Vector<uint32_t> entries; //from the start of the file table, for the hash index
+		uint64_t table_begin;
+		bool compress;
+		Compression::Mode compression_mode;
 		EditorProgress *ep;
 		int count;
 
@@ -233,6 +250,12 @@ public:
 		SCRIPT_ACTION_ENCRYPT
 	};
 
+	enum PackCompression {
+		PACK_COMPRESSION_NONE,
+		PACK_COMPRESSION_LZ4,
+		PACK_COMPRESSION_DEFLATE
+	};
+
 protected:
 
 	struct ImageGroup {
@@ -260,6 +283,7 @@ protected:
 	Vector<String> diff_packs;
 
 	ScriptAction script_action;
+	PackCompression pack_compression;
 	String script_key;
 
 	static EditorImportExport* singleton;
@@ -331,6 +355,9 @@ public:
 	void script_set_encryption_key(const String& p_key);
 	String script_get_encryption_key() const;
 
+	void pack_set_compression(PackCompression p_compression);
+	PackCompression pack_get_compression() const;
+
 	void load_config();
 	void save_config();
 
@@ -339,5 +366,6 @@ public:
 
 VARIANT_ENUM_CAST(EditorImportExport::ImageAction);
 VARIANT_ENUM_CAST(EditorImportExport::ScriptAction);
+VARIANT_ENUM_CAST(EditorImportExport::PackCompression);
 
 #endif // EDITOR_IMPORT_EXPORT_H
@@ -0,0 +1,439 @@
+/*************************************************************************/
+/*  editor_import_scheduler.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#include "editor_import_scheduler.h"
+#include "editor_node.h"
+#include "editor_file_system.h"
+#include "io/resource_loader.h"
+#include "io/marshalls.h"
+#include "io/md5.h"
+#include "os/file_access.h"
+#include "os/dir_access.h"
+#include "os/os.h"
+#include "version.h"
+
+static void _md5_add(MD5_CTX *p_md5,const String& p_string) {
+
+	CharString cs=p_string.utf8();
+	//the terminating zero keeps "ab"+"c" and "a"+"bc" apart
+	MD5Update(p_md5,(unsigned char*)cs.get_data(),cs.length()+1);
+}
+
+static Error _copy_file(const String& p_from,const String& p_to) {
+
+	FileAccess *src=FileAccess::open(p_from,FileAccess::READ);
+	if (!src)
+		return ERR_CANT_OPEN;
+
+	Error err;
+	FileAccess *dst=FileAccess::open(p_to,FileAccess::WRITE,&err);
+	if (!dst) {
+		memdelete(src);
+		return err;
+	}
+
+	uint8_t buf[32768];
+	err=OK;
+
+	while(true) {
+
+		int r=src->get_buffer(buf,sizeof(buf));
+		if (r>0)
+			dst->store_buffer(buf,r);
+		if (dst->get_error()!=OK) {
+			err=ERR_FILE_CANT_WRITE;
+			break;
+		}
+		if (r<(int)sizeof(buf))
+			break;
+	}
+
+	memdelete(src);
+	memdelete(dst);
+	return err;
+}
+
+String EditorImportScheduler::_get_key(const Job& p_job) const {
+
+	MD5_CTX md5;
+	MD5Init(&md5);
+
+	//importers change between versions, never restore what an older one wrote
+	_md5_add(&md5,VERSION_MKSTRING);
+	_md5_add(&md5,p_job.metadata->get_editor());
+	_md5_add(&md5,p_job.path);
+
+	List<String> options;
+	p_job.metadata->get_options(&options);
+	options.sort();
+
+	for(List<String>::Element *E=options.front();E;E=E->next()) {
+
+		Variant value=p_job.metadata->get_option(E->get());
+		int len;
+		if (encode_variant(value,NULL,len)!=OK)
+			return String();
+
+		Vector<uint8_t> buf;
+		buf.resize(len);
+		encode_variant(value,buf.ptr(),len);
+
+		_md5_add(&md5,E->get());
+		MD5Update(&md5,buf.ptr(),buf.size());
+	}
+
+	for(int i=0;i<p_job.metadata->get_source_count();i++) {
+
+		String path=p_job.metadata->get_source_path(i);
+		String source_md5=FileAccess::get_md5(EditorImportPlugin::expand_source_path(path));
+		if (source_md5=="")
+			return String(); //missing source, the import will fail and report it
+
+		_md5_add(&md5,path);
+		_md5_add(&md5,source_md5);
+	}
+
+	MD5Final(&md5);
+
+	return String::md5(md5.digest);
+}
+
+bool EditorImportScheduler::_has_entry(const Job& p_job) const {
+
+	String dir=cache_dir.plus_file(p_job.key);
+
+	int idx=0;
+	for(const List<String>::Element *E=p_job.outputs.front();E;E=E->next(),idx++) {
+
+		if (!FileAccess::exists(dir.plus_file(itos(idx))))
+			return false;
+	}
+
+	return true;
+}
+
+bool EditorImportScheduler::_restore(const Job& p_job) const {
+
+	String dir=cache_dir.plus_file(p_job.key);
+
+	int idx=0;
+	for(const List<String>::Element *E=p_job.outputs.front();E;E=E->next(),idx++) {
+
+		if (_copy_file(dir.plus_file(itos(idx)),E->get())!=OK)
+			return false;
+	}
+
+	return true;
+}
+
+void EditorImportScheduler::_store(const Job& p_job) const {
+
+	String dir=cache_dir.plus_file(p_job.key);
+
+	DirAccess *da=DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	Error err=da->make_dir_recursive(dir);
+	memdelete(da);
+	if (err!=OK)
+		return;
+
+	int idx=0;
+	for(const List<String>::Element *E=p_job.outputs.front();E;E=E->next(),idx++) {
+
+		if (_copy_file(E->get(),dir.plus_file(itos(idx)))!=OK)
+			return; //incomplete entries are never restored
+	}
+}
+
+struct _ImportCacheEntry {
+
+	String dir;
+	uint64_t time;
+	uint64_t size;
+
+	bool operator<(const _ImportCacheEntry& p_other) const { return time<p_other.time; }
+};
+
+void EditorImportScheduler::_trim_cache() const {
+
+	DirAccess *da=DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+	if (da->change_dir(cache_dir)!=OK || da->list_dir_begin()) { //true on error
+		memdelete(da);
+		return;
+	}
+
+	Vector<_ImportCacheEntry> entries;
+	uint64_t total=0;
+
+	while(true) {
+
+		bool is_dir;
+		String name=da->get_next(&is_dir);
+		if (name=="")
+			break;
+		if (!is_dir || name.begins_with("."))
+			continue;
+
+		_ImportCacheEntry e;
+		e.dir=cache_dir.plus_file(name);
+		e.time=FileAccess::get_modified_time(e.dir.plus_file("0")); //written when stored
+		e.size=0;
+
+		for(int i=0;;i++) {
+
+			FileAccess *f=FileAccess::open(e.dir.plus_file(itos(i)),FileAccess::READ);
+			if (!f)
+				break;
+			e.size+=f->get_len();
+			memdelete(f);
+		}
+
+		total+=e.size;
+		entries.push_back(e);
+	}
+
+	da->list_dir_end();
+
+	if (total>cache_max_size) {
+
+		entries.sort();
+		for(int i=0;i<entries.size() && total>cache_max_size;i++) {
+
+			//oldest first
+			if (da->change_dir(entries[i].dir)!=OK)
+				continue;
+			da->erase_contents_recursive();
+			da->change_dir(cache_dir);
+			da->remove(entries[i].dir);
+			total-=entries[i].size;
+		}
+	}
+
+	memdelete(da);
+}
+
+void EditorImportScheduler::_prepare(Job& p_job) {
+
+	if (p_job.use_cache) {
+
+		p_job.key=_get_key(p_job);
+		if (p_job.key!="" && _has_entry(p_job)) {
+			p_job.cached=true; //copied back when committing
+			return;
+		}
+	}
+
+	p_job.prepared=p_job.plugin->import_prepare(p_job.path,p_job.metadata);
+}
+
+bool EditorImportScheduler::_is_done(int p_idx) {
+
+	if (job_lock)
+		job_lock->lock();
+	bool done=jobs[p_idx].done;
+	if (job_lock)
+		job_lock->unlock();
+
+	return done;
+}
+
+void EditorImportScheduler::_thread_func(void *p_ud) {
+
+	EditorImportScheduler *is=(EditorImportScheduler*)p_ud;
+
+	while(true) {
+
+		int idx=-1;
+		is->job_lock->lock();
+		if (is->next_job<is->jobs.size())
+			idx=is->next_job++;
+		is->job_lock->unlock();
+
+		if (idx<0)
+			break;
+
+		is->_prepare(is->jobs[idx]);
+
+		is->job_lock->lock();
+		is->jobs[idx].done=true;
+		is->job_lock->unlock();
+	}
+}
+
+void EditorImportScheduler::set_cache_dir(const String& p_dir) {
+
+	cache_dir=p_dir;
+}
+
+void EditorImportScheduler::set_cache_max_size(uint64_t p_bytes) {
+
+	cache_max_size=p_bytes;
+}
+
+void EditorImportScheduler::set_thread_count(int p_count) {
+
+	thread_count=MAX(1,p_count);
+}
+
+Error EditorImportScheduler::import(const Vector<String>& p_paths) {
+
+	jobs.clear();
+
+	for(int i=0;i<p_paths.size();i++) {
+
+		Job job;
+		job.path=p_paths[i];
+		job.metadata=ResourceLoader::load_import_metadata(job.path);
+		if (job.metadata.is_null()) {
+			EditorNode::add_io_error("Error Importing:\n  "+job.path);
+			continue;
+		}
+		job.plugin=EditorImportExport::get_singleton()->get_import_plugin_by_name(job.metadata->get_editor());
+		if (job.plugin.is_null()) {
+			EditorNode::add_io_error("Error Importing:\n  "+job.path);
+			continue;
+		}
+
+		job.plugin->get_import_outputs(job.path,job.metadata,&job.outputs);
+		job.use_cache=cache_dir!="" && !job.outputs.empty();
+		for(List<String>::Element *E=job.outputs.front();E && job.use_cache;E=E->next()) {
+			if (ResourceCache::has(E->get()))
+				job.use_cache=false;
+		}
+		job.cached=false;
+		job.done=false;
+		jobs.push_back(job);
+	}
+
+	if (jobs.empty())
+		return OK;
+
+	if (cache_dir!="") {
+
+		DirAccess *da=DirAccess::create(DirAccess::ACCESS_FILESYSTEM);
+		if (da->make_dir_recursive(cache_dir)!=OK) {
+			cache_dir="";
+			for(int i=0;i<jobs.size();i++)
+				jobs[i].use_cache=false;
+		}
+		memdelete(da);
+	}
+
+	uint64_t time=OS::get_singleton()->get_ticks_msec();
+
+	next_job=0;
+
+	//the main thread only commits, it has to keep the editor responsive
+	Vector<Thread*> threads;
+	int count=MIN(thread_count,jobs.size());
+	for(int i=0;i<count && job_lock;i++) {
+
+		Thread *t=Thread::create(_thread_func,this);
+		if (!t)
+			break;
+		threads.push_back(t);
+	}
+
+	EditorProgress ep("reimport","Re-Importing",jobs.size());
+
+	Error ret=OK;
+	int cached=0;
+
+	for(int i=0;i<jobs.size();i++) {
+
+		Job &job=jobs[i];
+		String label=job.path.replace_first("res://","");
+
+		if (threads.empty()) {
+			ep.step(label,i);
+			_prepare(job);
+			job.done=true;
+		}
+
+		while(!_is_done(i)) {
+			ep.step(label,i);
+			OS::get_singleton()->delay_usec(10000);
+		}
+
+		ep.step(label,i);
+
+		if (job.cached) {
+
+			if (_restore(job)) {
+
+				for(List<String>::Element *E=job.outputs.front();E;E=E->next())
+					EditorFileSystem::get_singleton()->update_file(E->get());
+				cached++;
+				continue;
+			}
+
+			//entry went away or could not be copied, import it after all
+			job.prepared=job.plugin->import_prepare(job.path,job.metadata);
+		}
+
+		print_line("reload import from: "+job.path);
+		Error err=job.plugin->import_commit(job.path,job.metadata,job.prepared);
+		job.prepared=Variant(); //big images, release them as soon as possible
+
+		if (err!=OK) {
+			EditorNode::add_io_error("Error Importing:\n  "+job.path);
+			ret=err;
+		} else if (job.use_cache && job.key!="") {
+			_store(job);
+		}
+	}
+
+	for(int i=0;i<threads.size();i++) {
+
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	if (cache_dir!="")
+		_trim_cache();
+
+	if (OS::get_singleton()->is_stdout_verbose())
+		print_line("imported "+itos(jobs.size())+" resources ("+itos(cached)+" from cache) in "+itos(OS::get_singleton()->get_ticks_msec()-time)+" msec");
+
+	jobs.clear();
+
+	return ret;
+}
+
+EditorImportScheduler::EditorImportScheduler() {
+
+	thread_count=MAX(1,OS::get_singleton()->get_processor_count());
+	cache_max_size=uint64_t(256)*1024*1024;
+	next_job=0;
+	job_lock=Mutex::create();
+}
+
+EditorImportScheduler::~EditorImportScheduler() {
+
+	if (job_lock)
+		memdelete(job_lock);
+}
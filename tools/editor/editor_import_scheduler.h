@@ -0,0 +1,92 @@
+/*************************************************************************/
+/*  editor_import_scheduler.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                    http://www.godotengine.org                         */
+/*************************************************************************/
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                 */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+#ifndef EDITOR_IMPORT_SCHEDULER_H
+#define EDITOR_IMPORT_SCHEDULER_H
+
+#include "editor_import_export.h"
+#include "os/thread.h"
+#include "os/mutex.h"
+
+/* Imports a batch of resources, such as everything that changed after
+   switching branches. Plugins prepare the imports on worker threads and
+   commit them on the main thread, in order, while the progress dialog
+   keeps updating.
+
+   With a cache directory, the files an import writes are stored by a hash
+   of the engine version, the plugin, the target path, the options and the
+   source md5s. An import seen before is then only copied back from the
+   cache, on the main thread like any other commit. Only plugins that list
+   their outputs are cached, and the oldest entries are removed once the
+   cache grows past its maximum size. */
+
+class EditorImportScheduler {
+
+	struct Job {
+
+		String path;
+		Ref<ResourceImportMetadata> metadata;
+		Ref<EditorImportPlugin> plugin;
+		List<String> outputs;
+		bool use_cache; ///< false if an output is loaded, it must be updated in place
+		String key; ///< empty if not cacheable
+		bool cached; ///< an entry exists for the key, restored when committing
+		Variant prepared;
+		bool done;
+	};
+
+	Vector<Job> jobs;
+	String cache_dir;
+	uint64_t cache_max_size;
+	int thread_count;
+
+	int next_job;
+	Mutex *job_lock;
+
+	String _get_key(const Job& p_job) const;
+	bool _has_entry(const Job& p_job) const;
+	bool _restore(const Job& p_job) const;
+	void _store(const Job& p_job) const;
+	void _trim_cache() const;
+	void _prepare(Job& p_job);
+	bool _is_done(int p_idx);
+	static void _thread_func(void *p_ud);
+
+public:
+
+	void set_cache_dir(const String& p_dir); ///< empty disables the cache
+	void set_cache_max_size(uint64_t p_bytes);
+	void set_thread_count(int p_count);
+
+	Error import(const Vector<String>& p_paths);
+
+	EditorImportScheduler();
+	~EditorImportScheduler();
+};
+
+#endif // EDITOR_IMPORT_SCHEDULER_H
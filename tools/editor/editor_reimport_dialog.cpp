@@ -29,6 +29,8 @@
 #include "editor_reimport_dialog.h"
 #include "editor_file_system.h"
 #include "editor_node.h"
+#include "editor_import_scheduler.h"
+#include "editor_settings.h"
 void EditorReImportDialog::popup_reimport() {
 
 	if (EditorFileSystem::get_singleton()->is_scanning()) {
@@ -98,8 +100,6 @@ void EditorReImportDialog::ok_pressed() {
 	}
 
 
-
-	EditorProgress ep("reimport","Re-Importing",items.size());
 	String reload_fname;
 	if (scene_must_save && EditorNode::get_singleton()->get_edited_scene()) {
 		reload_fname = EditorNode::get_singleton()->get_edited_scene()->get_filename();
@@ -107,22 +107,20 @@ void EditorReImportDialog::ok_pressed() {
 		EditorNode::get_singleton()->clear_scene();
 	}
 
+	Vector<String> paths;
 	for(int i=0;i<items.size();i++) {
 
-		String it = items[i]->get_metadata(0);
-		ep.step(items[i]->get_text(0),i);
-		print_line("reload import from: "+it);
-		Ref<ResourceImportMetadata> rimd = ResourceLoader::load_import_metadata(it);
-		ERR_CONTINUE(rimd.is_null());
-		String editor = rimd->get_editor();
-		Ref<EditorImportPlugin> eip = EditorImportExport::get_singleton()->get_import_plugin_by_name(editor);
-		ERR_CONTINUE(eip.is_null());
-		Error err = eip->import(it,rimd);
-		if (err!=OK) {
-			EditorNode::add_io_error("Error Importing:\n  "+it);
-		}
+		if (items[i]->is_checked(0))
+			paths.push_back(items[i]->get_metadata(0));
+	}
 
+	EditorImportScheduler scheduler;
+	if (bool(EDITOR_DEF("import/use_import_cache",true))) {
+		scheduler.set_cache_dir(EditorSettings::get_singleton()->get_settings_path().plus_file("import_cache"));
+		scheduler.set_cache_max_size(uint64_t(EDITOR_DEF("import/import_cache_max_mb",256).operator int())*1024*1024);
 	}
+	scheduler.import(paths);
+
 	if (reload_fname!="") {
 		EditorNode::get_singleton()->load_scene(reload_fname);
 	}
@@ -35,6 +35,7 @@
 #include "io/md5.h"
 #include "io/marshalls.h"
 #include "globals.h"
+#include "scene/resources/streaming_texture.h"
 
 static const char *flag_names[]={
 	"Streaming Format",
@@ -48,6 +49,7 @@ static const char *flag_names[]={
 	"Convert SRGB->Linear",
 	"Convert NormalMap to XY",
 	"Use Anisotropy",
+	"Stream MipMaps (.stex)",
 	NULL
 };
 
@@ -63,6 +65,7 @@ static const char *flag_short_names[]={
 	"ToLinear",
 	"ToRG",
 	"Anisoropic",
+	"StreamMip",
 	NULL
 };
 
@@ -366,7 +369,10 @@ void EditorTextureImportDialog::_import() {
 		for(int i=0;i<files.size();i++) {
 
 			String dst_file = dst_path.plus_file(files[i].get_file());
-			dst_file=dst_file.basename()+".tex";
+			if (texture_options->get_flags()&EditorTextureImportPlugin::IMAGE_FLAG_STREAM_MIPMAPS)
+				dst_file=dst_file.basename()+".stex";
+			else
+				dst_file=dst_file.basename()+".tex";
 			Ref<ResourceImportMetadata> imd = memnew( ResourceImportMetadata );
 			//imd->set_editor();
 			imd->add_source(EditorImportPlugin::validate_source_path(files[i]));
@@ -714,6 +720,111 @@ void EditorTextureImportPlugin::compress_image(EditorExportPlatform::ImageCompre
 
 }
 
+static uint32_t _get_texture_flags(int p_flags) {
+
+	uint32_t tex_flags=0;
+
+	if (p_flags&EditorTextureImportPlugin::IMAGE_FLAG_REPEAT)
+		tex_flags|=Texture::FLAG_REPEAT;
+	if (p_flags&EditorTextureImportPlugin::IMAGE_FLAG_FILTER)
+		tex_flags|=Texture::FLAG_FILTER;
+	if (!(p_flags&EditorTextureImportPlugin::IMAGE_FLAG_NO_MIPMAPS))
+		tex_flags|=Texture::FLAG_MIPMAPS;
+	if (p_flags&EditorTextureImportPlugin::IMAGE_FLAG_CONVERT_TO_LINEAR)
+		tex_flags|=Texture::FLAG_CONVERT_TO_LINEAR;
+	if (p_flags&EditorTextureImportPlugin::IMAGE_FLAG_USE_ANISOTROPY)
+		tex_flags|=Texture::FLAG_ANISOTROPIC_FILTER;
+
+	return tex_flags;
+}
+
+static Error _save_texture(const String& p_path,Ref<ImageTexture>& p_texture,const Image& p_image,const Size2& p_orig_size,uint32_t p_tex_flags,int p_format,float p_quality) {
+
+	if (p_path.extension().to_lower()=="stex") {
+		//mipmaps are read from the file when drawn, there is no import metadata to store
+		Error err = StreamingTexture::save_image(p_path,p_image,p_tex_flags);
+		if (err!=OK)
+			EditorNode::add_io_error("Couldn't save streaming texture: "+p_path);
+		return err;
+	}
+
+	p_texture->create_from_image(p_image,p_tex_flags);
+	if (p_image.get_width()!=p_orig_size.width || p_image.get_height()!=p_orig_size.height) {
+		p_texture->set_size_override(p_orig_size);
+	}
+
+	uint32_t save_flags=0;
+
+	if (p_format==EditorTextureImportPlugin::IMAGE_FORMAT_COMPRESS_DISK_LOSSLESS || p_format==EditorTextureImportPlugin::IMAGE_FORMAT_COMPRESS_DISK_LOSSY) {
+
+		if (p_format==EditorTextureImportPlugin::IMAGE_FORMAT_COMPRESS_DISK_LOSSLESS) {
+			p_texture->set_storage(ImageTexture::STORAGE_COMPRESS_LOSSLESS);
+		} else {
+			p_texture->set_storage(ImageTexture::STORAGE_COMPRESS_LOSSY);
+		}
+
+		p_texture->set_lossy_storage_quality(p_quality);
+	} else {
+
+		save_flags=ResourceSaver::FLAG_COMPRESS;
+	}
+
+	Error err = ResourceSaver::save(p_path,p_texture,save_flags);
+	if (err!=OK) {
+		EditorNode::add_io_error("Couldn't save converted texture: "+p_path);
+		return err;
+	}
+
+	return OK;
+}
+
+void EditorTextureImportPlugin::_process_image(Image& image,int p_flags,int p_format,int p_shrink,EditorExportPlatform::ImageCompression p_compr) {
+
+	bool has_alpha=image.detect_alpha();
+	if (!has_alpha && image.get_format()==Image::FORMAT_RGBA) {
+
+		image.convert(Image::FORMAT_RGB);
+
+	}
+
+	if (image.get_format()==Image::FORMAT_RGBA && p_flags&IMAGE_FLAG_FIX_BORDER_ALPHA) {
+
+		image.fix_alpha_edges();
+	}
+
+	if (image.get_format()==Image::FORMAT_RGBA && p_flags&IMAGE_FLAG_PREMULT_ALPHA) {
+
+		image.premultiply_alpha();
+	}
+
+	if (p_flags&IMAGE_FLAG_CONVERT_NORMAL_TO_XY) {
+		image.normalmap_to_xy();
+	}
+
+	//if ((image.get_format()==Image::FORMAT_RGB || image.get_format()==Image::FORMAT_RGBA) && flags&IMAGE_FLAG_CONVERT_TO_LINEAR) {
+
+	//	image.srgb_to_linear();
+	//}
+
+	if (p_shrink>1) {
+
+		image.resize(image.get_width()/p_shrink,image.get_height()/p_shrink);
+	}
+
+	if (p_format==IMAGE_FORMAT_COMPRESS_DISK_LOSSLESS || p_format==IMAGE_FORMAT_COMPRESS_DISK_LOSSY)
+		return; //compressed by the saver
+
+	if (!(p_flags&IMAGE_FLAG_NO_MIPMAPS)) {
+		image.generate_mipmaps();
+
+	}
+
+	if (p_format!=IMAGE_FORMAT_UNCOMPRESSED) {
+
+		compress_image(p_compr,image,p_flags&IMAGE_FLAG_COMPRESS_EXTRA);
+	}
+}
+
 Error EditorTextureImportPlugin::import(const String& p_path, const Ref<ResourceImportMetadata>& p_from) {
 
 
@@ -734,18 +845,7 @@ Error EditorTextureImportPlugin::import2(const String& p_path, const Ref<Resourc
 
 	int flags=from->get_option("flags");
 
-	uint32_t tex_flags=0;
-
-	if (flags&EditorTextureImportPlugin::IMAGE_FLAG_REPEAT)
-		tex_flags|=Texture::FLAG_REPEAT;
-	if (flags&EditorTextureImportPlugin::IMAGE_FLAG_FILTER)
-		tex_flags|=Texture::FLAG_FILTER;
-	if (!(flags&EditorTextureImportPlugin::IMAGE_FLAG_NO_MIPMAPS))
-		tex_flags|=Texture::FLAG_MIPMAPS;
-	if (flags&EditorTextureImportPlugin::IMAGE_FLAG_CONVERT_TO_LINEAR)
-		tex_flags|=Texture::FLAG_CONVERT_TO_LINEAR;
-	if (flags&EditorTextureImportPlugin::IMAGE_FLAG_USE_ANISOTROPY)
-		tex_flags|=Texture::FLAG_ANISOTROPIC_FILTER;
+	uint32_t tex_flags=_get_texture_flags(flags);
 
 	print_line("path: "+p_path+" flags: "+itos(tex_flags));
 	int shrink=1;
@@ -920,142 +1020,82 @@ Error EditorTextureImportPlugin::import2(const String& p_path, const Ref<Resourc
 	}
 
 
-	if (format==IMAGE_FORMAT_COMPRESS_DISK_LOSSLESS || format==IMAGE_FORMAT_COMPRESS_DISK_LOSSY) {
-
-		Image image=texture->get_data();
-		ERR_FAIL_COND_V(image.empty(),ERR_INVALID_DATA);
-
-		bool has_alpha=image.detect_alpha();
-		if (!has_alpha && image.get_format()==Image::FORMAT_RGBA) {
-
-			image.convert(Image::FORMAT_RGB);
-
-		}
-
-		if (image.get_format()==Image::FORMAT_RGBA && flags&IMAGE_FLAG_FIX_BORDER_ALPHA) {
-
-			image.fix_alpha_edges();
-		}
-
-		if (image.get_format()==Image::FORMAT_RGBA && flags&IMAGE_FLAG_PREMULT_ALPHA) {
-
-			image.premultiply_alpha();
-		}
-
-		if (flags&IMAGE_FLAG_CONVERT_NORMAL_TO_XY) {
-			image.normalmap_to_xy();
-		}
-
-		//if ((image.get_format()==Image::FORMAT_RGB || image.get_format()==Image::FORMAT_RGBA) && flags&IMAGE_FLAG_CONVERT_TO_LINEAR) {
-
-		//	image.srgb_to_linear();
-		//}
-
-		if (shrink>1) {
-
-			int orig_w=image.get_width();
-			int orig_h=image.get_height();
-			image.resize(orig_w/shrink,orig_h/shrink);
-			texture->create_from_image(image,tex_flags);
-			texture->set_size_override(Size2(orig_w,orig_h));
-
-
-		} else {
-
-			texture->create_from_image(image,tex_flags);
-		}
-
-
-		if (format==IMAGE_FORMAT_COMPRESS_DISK_LOSSLESS) {
-			texture->set_storage(ImageTexture::STORAGE_COMPRESS_LOSSLESS);
-		} else {
-			texture->set_storage(ImageTexture::STORAGE_COMPRESS_LOSSY);
-		}
-
-
+	Image image=texture->get_data();
+	ERR_FAIL_COND_V(image.empty(),ERR_INVALID_DATA);
 
-		texture->set_lossy_storage_quality(quality);
+	Size2 orig_size(image.get_width(),image.get_height());
+	_process_image(image,flags,format,shrink,p_compr);
 
-		Error err = ResourceSaver::save(p_path,texture);
-
-		if (err!=OK) {
-			EditorNode::add_io_error("Couldn't save converted texture: "+p_path);
-			return err;
-		}
-
-
-	} else {
-
-
-		Image image=texture->get_data();
-		ERR_FAIL_COND_V(image.empty(),ERR_INVALID_DATA);
-
-
-		bool has_alpha=image.detect_alpha();
-		if (!has_alpha && image.get_format()==Image::FORMAT_RGBA) {
+	return _save_texture(p_path,texture,image,orig_size,_get_texture_flags(flags),format,quality);
+}
 
-			image.convert(Image::FORMAT_RGB);
+Variant EditorTextureImportPlugin::import_prepare(const String& p_path, const Ref<ResourceImportMetadata>& p_from) {
 
-		}
+	//atlases create AtlasTextures, they are built on commit
+	if (p_from->get_source_count()!=1 || bool(p_from->get_option("atlas")))
+		return Variant();
 
-		if (image.get_format()==Image::FORMAT_RGBA && flags&IMAGE_FLAG_FIX_BORDER_ALPHA) {
+	String src_path = EditorImportPlugin::expand_source_path(p_from->get_source_path(0));
 
-			image.fix_alpha_edges();
-		}
+	Image image;
+	Error err = ImageLoader::load_image(src_path,&image);
+	if (err!=OK || image.empty())
+		return Variant();
 
-		if (image.get_format()==Image::FORMAT_RGBA && flags&IMAGE_FLAG_PREMULT_ALPHA) {
+	Size2 orig_size(image.get_width(),image.get_height());
 
-			image.premultiply_alpha();
-		}
-
-		if (flags&IMAGE_FLAG_CONVERT_NORMAL_TO_XY) {
-			image.normalmap_to_xy();
-		}
+	int shrink=1;
+	if (p_from->has_option("shrink"))
+		shrink=p_from->get_option("shrink");
 
-		//if ((image.get_format()==Image::FORMAT_RGB || image.get_format()==Image::FORMAT_RGBA) && flags&IMAGE_FLAG_CONVERT_TO_LINEAR) {
-//
-		//	print_line("CONVERT BECAUSE: "+itos(flags));
-		//	image.srgb_to_linear();
-		//}
+	_process_image(image,p_from->get_option("flags"),p_from->get_option("format"),shrink,EditorExportPlatform::IMAGE_COMPRESSION_BC);
 
-		int orig_w=image.get_width();
-		int orig_h=image.get_height();
+	Dictionary d;
+	d["image"]=image;
+	d["size"]=orig_size;
+	d["md5"]=FileAccess::get_md5(src_path);
+	return d;
+}
 
-		if (shrink>1) {
-			image.resize(orig_w/shrink,orig_h/shrink);
-			texture->create_from_image(image,tex_flags);
-			texture->set_size_override(Size2(orig_w,orig_h));
-		}
+Error EditorTextureImportPlugin::import_commit(const String& p_path, const Ref<ResourceImportMetadata>& p_from,const Variant& p_prepared) {
 
-		if (!(flags&IMAGE_FLAG_NO_MIPMAPS)) {
-			image.generate_mipmaps();
+	if (p_prepared.get_type()!=Variant::DICTIONARY)
+		return import(p_path,p_from);
 
-		}
+	Dictionary d=p_prepared;
+	Image image=d["image"];
+	Size2 orig_size=d["size"];
+	ERR_FAIL_COND_V(image.empty(),ERR_INVALID_DATA);
 
-		if (format!=IMAGE_FORMAT_UNCOMPRESSED) {
+	Ref<ResourceImportMetadata> from=p_from;
 
-			compress_image(p_compr,image,flags&IMAGE_FLAG_COMPRESS_EXTRA);
-		}
+	Ref<ImageTexture> texture;
+	if (ResourceCache::has(p_path)) {
+		texture = Ref<ImageTexture> ( ResourceCache::get(p_path)->cast_to<ImageTexture>() );
+	}
+	if (texture.is_null()) {
+		texture = Ref<ImageTexture>( memnew( ImageTexture ) );
+	}
 
+	from->set_source_md5(0,d["md5"]);
+	from->set_editor(get_name());
+	texture->set_path(p_path);
+	texture->set_import_metadata(from);
 
-		texture->create_from_image(image,tex_flags);
+	return _save_texture(p_path,texture,image,orig_size,_get_texture_flags(from->get_option("flags")),from->get_option("format"),from->get_option("quality"));
+}
 
+void EditorTextureImportPlugin::get_import_outputs(const String& p_path, const Ref<ResourceImportMetadata>& p_from,List<String> *r_outputs) const {
 
-		if (shrink>1 || (format!=IMAGE_FORMAT_UNCOMPRESSED && (image.get_width()!=orig_w || image.get_height()!=orig_h))) {
-			texture->set_size_override(Size2(orig_w,orig_h));
-		}
+	r_outputs->push_back(p_path);
 
-		uint32_t save_flags=ResourceSaver::FLAG_COMPRESS;
+	if (!bool(p_from->get_option("atlas")))
+		return;
 
-		Error err = ResourceSaver::save(p_path,texture,save_flags);
-		if (err!=OK) {
-			EditorNode::add_io_error("Couldn't save converted texture: "+p_path);
-			return err;
-		}
+	for(int i=0;i<p_from->get_source_count();i++) {
 
+		r_outputs->push_back(p_path.get_base_dir().plus_file(p_from->get_source_path(i).get_file().basename()+".atex"));
 	}
-
-	return OK;
 }
 
 Vector<uint8_t> EditorTextureImportPlugin::custom_export(const String& p_path, const Ref<EditorExportPlatform> &p_platform) {
@@ -70,6 +70,7 @@ private:
 
 
 	void compress_image(EditorExportPlatform::ImageCompression p_mode,Image& image,bool p_smaller);
+	void _process_image(Image& image,int p_flags,int p_format,int p_shrink,EditorExportPlatform::ImageCompression p_compr); ///< safe to call from worker threads
 public:
 
 
@@ -96,6 +97,7 @@ public:
 		IMAGE_FLAG_CONVERT_TO_LINEAR=256, //convert image to linear
 		IMAGE_FLAG_CONVERT_NORMAL_TO_XY=512, //convert image to linear
 		IMAGE_FLAG_USE_ANISOTROPY=1024, //convert image to linear
+		IMAGE_FLAG_STREAM_MIPMAPS=2048, //save as a StreamingTexture (.stex)
 	};
 
 	Mode get_mode() const { return mode; }
@@ -104,6 +106,9 @@ public:
 	virtual void import_dialog(const String& p_from="");
 	virtual Error import(const String& p_path, const Ref<ResourceImportMetadata>& p_from);
 	virtual Error import2(const String& p_path, const Ref<ResourceImportMetadata>& p_from,EditorExportPlatform::ImageCompression p_compr, bool p_external=false);
+	virtual Variant import_prepare(const String& p_path, const Ref<ResourceImportMetadata>& p_from);
+	virtual Error import_commit(const String& p_path, const Ref<ResourceImportMetadata>& p_from,const Variant& p_prepared);
+	virtual void get_import_outputs(const String& p_path, const Ref<ResourceImportMetadata>& p_from,List<String> *r_outputs) const;
 	virtual Vector<uint8_t> custom_export(const String& p_path,const Ref<EditorExportPlatform> &p_platform);
 
 
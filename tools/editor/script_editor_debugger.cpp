@@ -342,6 +342,11 @@ void ScriptEditorDebugger::_parse_message(const String& p_msg,const Array& p_dat
 		perf_history.push_front(p);
 		perf_draw->update();
 
+	} else if (p_msg=="profile_data") {
+
+		ERR_FAIL_COND(p_data.size()!=2);
+		_profiler_update(p_data[0],p_data[1]);
+
 	} else if (p_msg=="kill_me") {
 
 		editor->call_deferred("stop_child_process");
@@ -350,6 +355,72 @@ void ScriptEditorDebugger::_parse_message(const String& p_msg,const Array& p_dat
 }
 
 
+void ScriptEditorDebugger::_profiler_toggled(bool p_pressed) {
+
+	profiler_toggle->set_text(p_pressed?"Stop":"Start");
+
+	if (connection.is_null() || !connection->is_connected())
+		return;
+
+	Array msg;
+	msg.push_back(p_pressed?"start_profiling":"stop_profiling");
+	ppeer->put_var(msg);
+}
+
+struct _ScriptProfilerEntry {
+
+	String signature;
+	int calls;
+	float total;
+	float self;
+	float frame_self;
+
+	bool operator<(const _ScriptProfilerEntry& p_entry) const { return self > p_entry.self; } //most expensive first
+};
+
+void ScriptEditorDebugger::_profiler_update(const Array& p_accumulated,const Array& p_frame) {
+
+	//both arrays are flat: signature, calls, total msec, self msec
+	Map<String,float> frame_self;
+	for(int i=0;i+3<p_frame.size();i+=4) {
+		frame_self[p_frame[i]]=p_frame[i+3];
+	}
+
+	List<_ScriptProfilerEntry> entries;
+	for(int i=0;i+3<p_accumulated.size();i+=4) {
+
+		_ScriptProfilerEntry e;
+		e.signature=p_accumulated[i];
+		e.calls=p_accumulated[i+1];
+		e.total=p_accumulated[i+2];
+		e.self=p_accumulated[i+3];
+		e.frame_self=frame_self.has(e.signature)?frame_self[e.signature]:0;
+		entries.push_back(e);
+	}
+
+	entries.sort();
+
+	profiler->clear();
+	TreeItem *root = profiler->create_item();
+
+	for(List<_ScriptProfilerEntry>::Element *E=entries.front();E;E=E->next()) {
+
+		const _ScriptProfilerEntry &e=E->get();
+		// signature is source::line::function
+		String source = e.signature.get_slice("::",0);
+		String line = e.signature.get_slice("::",1);
+		String function = e.signature.get_slice("::",2);
+
+		TreeItem *it = profiler->create_item(root);
+		it->set_text(0,function+" ("+source.get_file()+":"+line+")");
+		it->set_tooltip(0,source+":"+line);
+		it->set_text(1,itos(e.calls));
+		it->set_text(2,String::num(e.total,2));
+		it->set_text(3,String::num(e.self,2));
+		it->set_text(4,String::num(e.frame_self,2));
+	}
+}
+
 void ScriptEditorDebugger::_performance_select(Object*,int,bool) {
 
 	perf_draw->update();
@@ -460,6 +531,10 @@ void ScriptEditorDebugger::_notification(int p_what) {
 
 					ppeer->set_stream_peer(connection);
 
+					profiler->clear();
+					if (profiler_toggle->is_pressed())
+						_profiler_toggled(true);
+
 
 					show();
 					dobreak->set_disabled(false);
@@ -675,6 +750,7 @@ void ScriptEditorDebugger::_bind_methods() {
 	ObjectTypeDB::bind_method(_MD("_hide_request"),&ScriptEditorDebugger::_hide_request);
 	ObjectTypeDB::bind_method(_MD("_performance_draw"),&ScriptEditorDebugger::_performance_draw);
 	ObjectTypeDB::bind_method(_MD("_performance_select"),&ScriptEditorDebugger::_performance_select);
+	ObjectTypeDB::bind_method(_MD("_profiler_toggled"),&ScriptEditorDebugger::_profiler_toggled);
 	ObjectTypeDB::bind_method(_MD("_scene_tree_request"),&ScriptEditorDebugger::_scene_tree_request);
 
 	ADD_SIGNAL(MethodInfo("goto_script_line"));
@@ -832,6 +908,34 @@ ScriptEditorDebugger::ScriptEditorDebugger(EditorNode *p_editor){
 
 	}
 
+	VBoxContainer *profiler_vb = memnew( VBoxContainer );
+	profiler_vb->set_name("Profiler");
+	tabs->add_child(profiler_vb);
+
+	HBoxContainer *profiler_hb = memnew( HBoxContainer );
+	profiler_vb->add_child(profiler_hb);
+	profiler_toggle = memnew( Button );
+	profiler_toggle->set_toggle_mode(true);
+	profiler_toggle->set_text("Start");
+	profiler_toggle->connect("toggled",this,"_profiler_toggled");
+	profiler_hb->add_child(profiler_toggle);
+
+	profiler = memnew( Tree );
+	profiler->set_columns(5);
+	profiler->set_column_title(0,"Function");
+	profiler->set_column_title(1,"Calls");
+	profiler->set_column_title(2,"Total (msec)");
+	profiler->set_column_title(3,"Self (msec)");
+	profiler->set_column_title(4,"Frame Self (msec)");
+	for(int i=1;i<5;i++) {
+		profiler->set_column_expand(i,false);
+		profiler->set_column_min_width(i,110);
+	}
+	profiler->set_column_titles_visible(true);
+	profiler->set_hide_root(true);
+	profiler->set_v_size_flags(SIZE_EXPAND_FILL);
+	profiler_vb->add_child(profiler);
+
 	info = memnew( HSplitContainer );
 	info->set_name("Info");
 	tabs->add_child(info);
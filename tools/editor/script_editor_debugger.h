@@ -83,6 +83,9 @@ class ScriptEditorDebugger : public Control {
 	Tree *perf_monitors;
 	Control *perf_draw;
 
+	Tree *profiler;
+	Button *profiler_toggle;
+
 	Tree *stack_dump;
 	PropertyEditor *inspector;
 
@@ -101,6 +104,8 @@ class ScriptEditorDebugger : public Control {
 
 	void _performance_draw();
 	void _performance_select(Object *, int, bool);
+	void _profiler_toggled(bool p_pressed);
+	void _profiler_update(const Array& p_accumulated,const Array& p_frame);
 	void _stack_dump_frame_selected();
 	void _output_clear();
 	void _hide_request();
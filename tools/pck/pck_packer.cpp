@@ -1,6 +1,7 @@
 #include "pck_packer.h"
 
 #include "core/os/file_access.h"
+#include "core/io/file_access_pack.h"
 
 static uint64_t _align(uint64_t p_n, int p_alignment) {
 
@@ -24,13 +25,13 @@ static void _pad(FileAccess* p_file, int p_bytes) {
 
 void PCKPacker::_bind_methods() {
 
-	ObjectTypeDB::bind_method(_MD("pck_start","pck_name","alignment"),&PCKPacker::pck_start);
+	ObjectTypeDB::bind_method(_MD("pck_start","pck_name","alignment","compress"),&PCKPacker::pck_start,DEFVAL(false));
 	ObjectTypeDB::bind_method(_MD("add_file","pck_path","source_path"),&PCKPacker::add_file);
 	ObjectTypeDB::bind_method(_MD("flush"),&PCKPacker::flush);
 };
 
 
-Error PCKPacker::pck_start(const String& p_file, int p_alignment) {
+Error PCKPacker::pck_start(const String& p_file, int p_alignment, bool p_compress) {
 
 	file = FileAccess::open(p_file, FileAccess::WRITE);
 	if (file == NULL) {
@@ -39,9 +40,10 @@ Error PCKPacker::pck_start(const String& p_file, int p_alignment) {
 	};
 
 	alignment = p_alignment;
+	compress = p_compress;
 
 	file->store_32(0x43504447); // MAGIC
-	file->store_32(0); // # version
+	file->store_32(2); // # version
 	file->store_32(0); // # major
 	file->store_32(0); // # minor
 	file->store_32(0); // # revision
@@ -86,10 +88,16 @@ Error PCKPacker::flush(bool p_verbose) {
 
 	// write the index
 
+	uint64_t table_begin = file->get_pos();
+	Vector<String> paths;
+	Vector<uint32_t> entries;
+
 	file->store_32(files.size());
 
 	for (int i=0; i<files.size(); i++) {
 
+		paths.push_back(files[i].path);
+		entries.push_back(file->get_pos() - table_begin);
 		file->store_pascal_string(files[i].path);
 		files[i].offset_offset = file->get_pos();
 		file->store_64(0); // offset
@@ -100,9 +108,12 @@ Error PCKPacker::flush(bool p_verbose) {
 		file->store_32(0);
 		file->store_32(0);
 		file->store_32(0);
+
+		file->store_32(0); // flags
 	};
 
 
+	uint64_t table_size = file->get_pos() - table_begin;
 	uint64_t ofs = file->get_pos();
 	ofs = _align(ofs, alignment);
 
@@ -115,20 +126,46 @@ Error PCKPacker::flush(bool p_verbose) {
 	for (int i=0; i<files.size(); i++) {
 
 		FileAccess* src = FileAccess::open(files[i].src_path, FileAccess::READ);
-		uint64_t to_write = files[i].size;
-		while (to_write > 0) {
+		uint64_t stored_size = files[i].size;
+		uint32_t flags = 0;
+
+		Vector<uint8_t> data;
+		Vector<uint8_t> cdata;
+		if (compress) {
+			data.resize(files[i].size);
+			src->get_buffer(data.ptr(), data.size());
+			if (PackedData::compress_file(data.ptr(), data.size(), cdata, Compression::MODE_LZ4)) {
+				flags |= PackedData::PACK_FILE_COMPRESSED;
+				stored_size = cdata.size();
+			};
+		};
+
+		if (flags & PackedData::PACK_FILE_COMPRESSED) {
+
+			file->store_buffer(cdata.ptr(), cdata.size());
+		} else if (compress) {
 
-			int read = src->get_buffer(buf, MIN(to_write, buf_max));
-			file->store_buffer(buf, read);
-			to_write -= read;
+			file->store_buffer(data.ptr(), data.size());
+		} else {
+
+			uint64_t to_write = files[i].size;
+			while (to_write > 0) {
+
+				int read = src->get_buffer(buf, MIN(to_write, buf_max));
+				file->store_buffer(buf, read);
+				to_write -= read;
+			};
 		};
 
 		uint64_t pos = file->get_pos();
 		file->seek(files[i].offset_offset); // go back to store the file's offset
 		file->store_64(ofs);
+		file->store_64(stored_size);
+		file->seek(files[i].offset_offset + 32);
+		file->store_32(flags);
 		file->seek(pos);
 
-		ofs = _align(ofs + files[i].size, alignment);
+		ofs = _align(ofs + stored_size, alignment);
 		_pad(file, ofs - pos);
 
 		src->close();
@@ -145,6 +182,16 @@ Error PCKPacker::flush(bool p_verbose) {
 	if (p_verbose)
 		printf("\n");
 
+	// hash index, so the pack can be used without reading the file table
+
+	uint64_t index_ofs = file->get_pos();
+	uint32_t bucket_count = PackedData::store_hash_index(file, paths, entries);
+
+	file->seek(20);
+	file->store_64(index_ofs);
+	file->store_32(bucket_count);
+	file->store_32(table_size);
+
 	file->close();
 
 	return OK;
@@ -153,6 +200,7 @@ Error PCKPacker::flush(bool p_verbose) {
 PCKPacker::PCKPacker() {
 
 	file = NULL;
+	compress = false;
 };
 
 PCKPacker::~PCKPacker() {
@@ -8,6 +8,7 @@ class PCKPacker : public Object {
 
 	FileAccess* file;
 	int alignment;
+	bool compress;
 
 	static void _bind_methods();
 
@@ -21,7 +22,7 @@ class PCKPacker : public Object {
 	Vector<File> files;
 
 public:
-	Error pck_start(const String& p_file, int p_alignment);
+	Error pck_start(const String& p_file, int p_alignment, bool p_compress = false);
 	Error add_file(const String& p_file, const String& p_src);
 	Error flush(bool p_verbose = false);
 